@@ -0,0 +1,456 @@
+/**
+ * @file dnsStats.c
+ * @brief Implementation of DNS transaction matching and per-name aggregation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dnsStats.h"
+#include "dnsLayer.h"
+#include "histogram.h"
+#include "hash.h"
+#include "clock.h"
+#include "logger.h"
+
+#define DNS_MAX_PROBE        16
+#define DNS_EXPIRE_PERIOD_MS 500
+#define DNS_RCODE_TIMEOUT    0xFF    // Cache key for unanswered queries
+
+/**
+ * @brief Transaction key: the client is the sender of the query.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t ip_version;
+    uint8_t client[16];
+    uint8_t server[16];
+    uint16_t client_port;
+    uint16_t id;
+} TransactionKey;
+
+typedef struct {
+    uint64_t hash;              // 0 = empty slot
+    uint64_t ts_ns;             // First query's capture time
+    TransactionKey key;
+    uint16_t qtype;
+    char qname[DNS_MAX_NAME + 1];
+} PendingQuery;
+
+typedef struct {
+    uint64_t hash;              // 0 = free
+    int32_t chain;              // Next entry in the same bucket (-1 = end)
+    int32_t prev;               // LRU neighbours (head = most recent)
+    int32_t next;
+    uint8_t rcode;
+    uint16_t qtype;             // Last query type seen
+    uint64_t count;             // Responses (or timeouts)
+    uint64_t matched;           // Responses matched to their query
+    uint64_t answers;           // Answer records
+    uint64_t latency_sum_us;
+    uint32_t latency_max_us;
+    char qname[DNS_MAX_NAME + 1];
+} NameEntry;
+
+struct DnsStats {
+    DnsConfig config;
+    int if_id;
+
+    // Outstanding queries
+    PendingQuery* pending;
+    uint32_t pending_mask;
+
+    // (qname, rcode) cache
+    NameEntry* names;
+    int32_t* buckets;
+    uint32_t bucket_mask;
+    int32_t lru_head;
+    int32_t lru_tail;
+    int32_t free_head;          // Free entries, linked through 'next'
+    uint32_t names_used;
+
+    uint64_t next_expire_ms;
+    uint64_t next_export_ms;
+    uint64_t interval_start_ms;
+
+    // Interval totals
+    uint64_t queries;
+    uint64_t responses;
+    uint64_t unmatched;
+    uint64_t timeouts;
+    uint64_t nxdomain;
+    uint64_t servfail;
+    uint64_t malformed;
+    uint64_t evicted;
+    Histogram latency;          // µs
+};
+
+static uint32_t round_pow2(uint32_t n) {
+    uint32_t size = 64;
+    while (size < n) size <<= 1;
+    return size;
+}
+
+// --- Name Cache ---
+
+static void export_entry(DnsStats* stats, const NameEntry* e) {
+    const char* qtype = dns_type_name(e->qtype);
+    char qtype_buf[16];
+    if (!qtype) {
+        snprintf(qtype_buf, sizeof(qtype_buf), "TYPE%u", e->qtype);
+        qtype = qtype_buf;
+    }
+
+    char json[512];
+    snprintf(json, sizeof(json),
+        "{\"event\": \"dns\","
+        "\"if_id\": %d,"
+        "\"qname\": \"%s\","
+        "\"rcode\": \"%s\","
+        "\"qtype\": \"%s\","
+        "\"count\": %llu,"
+        "\"matched\": %llu,"
+        "\"answers\": %llu,"
+        "\"latency_us_avg\": %llu,"
+        "\"latency_us_max\": %u}",
+        stats->if_id, e->qname,
+        e->rcode == DNS_RCODE_TIMEOUT ? "TIMEOUT" : dns_rcode_name(e->rcode), qtype,
+        (unsigned long long)e->count, (unsigned long long)e->matched, (unsigned long long)e->answers,
+        (unsigned long long)(e->matched ? e->latency_sum_us / e->matched : 0), e->latency_max_us);
+    log_event(json);
+}
+
+static void lru_unlink(DnsStats* stats, int32_t idx) {
+    NameEntry* e = &stats->names[idx];
+    if (e->prev >= 0) stats->names[e->prev].next = e->next; else stats->lru_head = e->next;
+    if (e->next >= 0) stats->names[e->next].prev = e->prev; else stats->lru_tail = e->prev;
+    e->prev = e->next = -1;
+}
+
+static void lru_push_head(DnsStats* stats, int32_t idx) {
+    NameEntry* e = &stats->names[idx];
+    e->prev = -1;
+    e->next = stats->lru_head;
+    if (stats->lru_head >= 0) stats->names[stats->lru_head].prev = idx; else stats->lru_tail = idx;
+    stats->lru_head = idx;
+}
+
+static void cache_reset(DnsStats* stats) {
+    for (uint32_t i = 0; i <= stats->bucket_mask; i++) stats->buckets[i] = -1;
+    for (uint32_t i = 0; i < stats->config.cache_size; i++) {
+        stats->names[i].hash = 0;
+        stats->names[i].next = (i + 1 < stats->config.cache_size) ? (int32_t)(i + 1) : -1;
+    }
+    stats->free_head = 0;
+    stats->lru_head = stats->lru_tail = -1;
+    stats->names_used = 0;
+}
+
+// Exports and frees the least recently updated entry
+static int32_t cache_evict(DnsStats* stats) {
+    int32_t idx = stats->lru_tail;
+    NameEntry* e = &stats->names[idx];
+    export_entry(stats, e);
+    stats->evicted++;
+
+    int32_t* link = &stats->buckets[e->hash & stats->bucket_mask];
+    while (*link != idx) link = &stats->names[*link].chain;
+    *link = e->chain;
+
+    lru_unlink(stats, idx);
+    stats->names_used--;
+    return idx;
+}
+
+static NameEntry* cache_lookup(DnsStats* stats, const char* qname, uint8_t rcode) {
+    size_t len = strlen(qname);
+    uint64_t hash = hash_bytes(qname, len, rcode + 1ULL);
+    if (hash == 0) hash = 1;
+
+    int32_t* bucket = &stats->buckets[hash & stats->bucket_mask];
+    for (int32_t idx = *bucket; idx >= 0; idx = stats->names[idx].chain) {
+        NameEntry* e = &stats->names[idx];
+        if (e->hash == hash && e->rcode == rcode && strcmp(e->qname, qname) == 0) {
+            lru_unlink(stats, idx);
+            lru_push_head(stats, idx);
+            return e;
+        }
+    }
+
+    int32_t idx = stats->free_head;
+    if (idx >= 0) {
+        stats->free_head = stats->names[idx].next;
+    } else {
+        idx = cache_evict(stats);
+    }
+
+    NameEntry* e = &stats->names[idx];
+    memset(e, 0, sizeof(*e));
+    e->hash = hash;
+    e->rcode = rcode;
+    memcpy(e->qname, qname, len + 1);
+    e->chain = *bucket;
+    *bucket = idx;
+    lru_push_head(stats, idx);
+    stats->names_used++;
+    return e;
+}
+
+static void account(DnsStats* stats, const char* qname, uint8_t rcode, uint16_t qtype,
+                    uint16_t answers, int64_t latency_us) {
+    NameEntry* e = cache_lookup(stats, qname, rcode);
+    e->count++;
+    e->qtype = qtype;
+    e->answers += answers;
+    if (latency_us >= 0) {
+        e->matched++;
+        e->latency_sum_us += (uint64_t)latency_us;
+        if ((uint32_t)latency_us > e->latency_max_us) e->latency_max_us = (uint32_t)latency_us;
+    }
+}
+
+// --- Pending Queries ---
+
+static void pending_remove(DnsStats* stats, uint32_t slot) {
+    uint32_t hole = slot;
+    uint32_t next = slot;
+
+    // Backward-shift deletion, as in the flow table
+    while (1) {
+        next = (next + 1) & stats->pending_mask;
+        if (stats->pending[next].hash == 0) break;
+
+        uint32_t home = (uint32_t)(stats->pending[next].hash & stats->pending_mask);
+        int in_range = (hole <= next) ? (hole < home && home <= next)
+                                      : (hole < home || home <= next);
+        if (in_range) continue;
+
+        stats->pending[hole] = stats->pending[next];
+        hole = next;
+    }
+    stats->pending[hole].hash = 0;
+}
+
+static void expire_query(DnsStats* stats, uint32_t slot) {
+    PendingQuery* q = &stats->pending[slot];
+    account(stats, q->qname, DNS_RCODE_TIMEOUT, q->qtype, 0, -1);
+    stats->timeouts++;
+    pending_remove(stats, slot);
+}
+
+static uint64_t key_hash(const TransactionKey* key) {
+    uint64_t hash = hash_bytes(key, sizeof(*key), 0x444e53);
+    return hash ? hash : 1;
+}
+
+// Returns 0 if stored, or the slot of the oldest query in the (full) neighbourhood plus one
+static uint32_t store_query(DnsStats* stats, const TransactionKey* key, const DnsMessage* msg, uint64_t ts_ns) {
+    uint64_t hash = key_hash(key);
+    uint32_t home = (uint32_t)(hash & stats->pending_mask);
+    uint32_t oldest = home;
+
+    for (int probe = 0; probe < DNS_MAX_PROBE; probe++) {
+        uint32_t slot = (home + probe) & stats->pending_mask;
+        PendingQuery* q = &stats->pending[slot];
+
+        if (q->hash == hash && memcmp(&q->key, key, sizeof(*key)) == 0) {
+            return 0; // Retransmitted query: latency counts from the first one
+        }
+        if (q->hash == 0) {
+            q->hash = hash;
+            q->ts_ns = ts_ns;
+            q->key = *key;
+            q->qtype = msg->qtype;
+            memcpy(q->qname, msg->qname, sizeof(q->qname));
+            return 0;
+        }
+        if (q->ts_ns < stats->pending[oldest].ts_ns) oldest = slot;
+    }
+    return oldest + 1;
+}
+
+static void track_query(DnsStats* stats, const TransactionKey* key, const DnsMessage* msg, uint64_t ts_ns) {
+    uint32_t full = store_query(stats, key, msg, ts_ns);
+    if (full) {
+        // Neighbourhood full: give up on the oldest query and retry once
+        expire_query(stats, full - 1);
+        if (store_query(stats, key, msg, ts_ns)) stats->timeouts++;
+    }
+}
+
+static int match_response(DnsStats* stats, const TransactionKey* key, uint64_t ts_ns, int64_t* latency_us) {
+    uint64_t hash = key_hash(key);
+    uint32_t home = (uint32_t)(hash & stats->pending_mask);
+
+    for (int probe = 0; probe < DNS_MAX_PROBE; probe++) {
+        uint32_t slot = (home + probe) & stats->pending_mask;
+        PendingQuery* q = &stats->pending[slot];
+        if (q->hash == 0) return 0;
+        if (q->hash == hash && memcmp(&q->key, key, sizeof(*key)) == 0) {
+            *latency_us = (ts_ns > q->ts_ns) ? (int64_t)((ts_ns - q->ts_ns) / 1000) : 0;
+            pending_remove(stats, slot);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// --- Export ---
+
+static void export_interval(DnsStats* stats, uint64_t now_ms) {
+    uint32_t names = stats->names_used;
+    for (int32_t idx = stats->lru_head; idx >= 0; idx = stats->names[idx].next) {
+        export_entry(stats, &stats->names[idx]);
+    }
+
+    if (stats->queries || stats->responses || stats->timeouts) {
+        char json[1024];
+        int pos = snprintf(json, sizeof(json),
+            "{\"event\": \"dns_summary\","
+            "\"if_id\": %d,"
+            "\"interval_ms\": %llu,"
+            "\"queries\": %llu,"
+            "\"responses\": %llu,"
+            "\"unmatched_responses\": %llu,"
+            "\"timeouts\": %llu,"
+            "\"nxdomain\": %llu,"
+            "\"servfail\": %llu,"
+            "\"malformed\": %llu,"
+            "\"names\": %u,"
+            "\"evicted\": %llu",
+            stats->if_id, (unsigned long long)(now_ms - stats->interval_start_ms),
+            (unsigned long long)stats->queries, (unsigned long long)stats->responses,
+            (unsigned long long)stats->unmatched, (unsigned long long)stats->timeouts,
+            (unsigned long long)stats->nxdomain, (unsigned long long)stats->servfail,
+            (unsigned long long)stats->malformed, names, (unsigned long long)stats->evicted);
+        pos = histogram_append_json(json, sizeof(json), pos, "latency", &stats->latency);
+        if (pos < (int)sizeof(json) - 2) {
+            snprintf(json + pos, sizeof(json) - pos, "}");
+            log_event(json);
+        }
+    }
+
+    cache_reset(stats);
+    stats->queries = stats->responses = stats->unmatched = stats->timeouts = 0;
+    stats->nxdomain = stats->servfail = stats->malformed = stats->evicted = 0;
+    memset(&stats->latency, 0, sizeof(stats->latency));
+    stats->interval_start_ms = now_ms;
+    stats->next_export_ms = now_ms + stats->config.interval_ms;
+}
+
+// --- Public API ---
+
+void dns_config_defaults(DnsConfig* config) {
+    config->pending_slots = 4096;
+    config->cache_size = 1024;
+    config->interval_ms = 10000;
+}
+
+DnsStats* dns_stats_create(const DnsConfig* config, int if_id) {
+    DnsStats* stats = (DnsStats*)calloc(1, sizeof(DnsStats));
+    if (!stats) return NULL;
+
+    stats->config = *config;
+    if (stats->config.cache_size == 0) stats->config.cache_size = 1;
+    stats->if_id = if_id;
+
+    uint32_t pending = round_pow2(config->pending_slots);
+    uint32_t buckets = round_pow2(stats->config.cache_size * 2);
+    stats->pending_mask = pending - 1;
+    stats->bucket_mask = buckets - 1;
+    stats->pending = (PendingQuery*)calloc(pending, sizeof(PendingQuery));
+    stats->names = (NameEntry*)calloc(stats->config.cache_size, sizeof(NameEntry));
+    stats->buckets = (int32_t*)calloc(buckets, sizeof(int32_t));
+    if (!stats->pending || !stats->names || !stats->buckets) {
+        free(stats->pending);
+        free(stats->names);
+        free(stats->buckets);
+        free(stats);
+        return NULL;
+    }
+
+    cache_reset(stats);
+    uint64_t now = clock_coarse_ms();
+    stats->interval_start_ms = now;
+    stats->next_export_ms = now + stats->config.interval_ms;
+    stats->next_expire_ms = now + DNS_EXPIRE_PERIOD_MS;
+    return stats;
+}
+
+void dns_stats_destroy(DnsStats* stats) {
+    if (!stats) return;
+
+    for (uint32_t slot = 0; slot <= stats->pending_mask;) {
+        if (stats->pending[slot].hash != 0) {
+            expire_query(stats, slot); // A later entry may have shifted into this slot
+        } else {
+            slot++;
+        }
+    }
+    export_interval(stats, clock_coarse_ms());
+
+    free(stats->pending);
+    free(stats->names);
+    free(stats->buckets);
+    free(stats);
+}
+
+void dns_stats_process(DnsStats* stats, const PacketMetadata* meta, const unsigned char* payload, int len) {
+    DnsMessage msg;
+    if (parse_dns(payload, len, &msg) != 0) {
+        stats->malformed++;
+        return;
+    }
+    if (msg.opcode != 0) return; // Standard queries only (no NOTIFY / UPDATE)
+
+    uint64_t ts_ns = meta->timestamp_ns ? meta->timestamp_ns : clock_realtime_ms() * 1000000ULL;
+    int addr_len = (meta->ip_version == 6) ? 16 : 4;
+    TransactionKey key;
+    memset(&key, 0, sizeof(key));
+    key.ip_version = meta->ip_version;
+    key.id = msg.id;
+
+    if (!msg.is_response) {
+        memcpy(key.client, meta->src_addr, addr_len);
+        memcpy(key.server, meta->dest_addr, addr_len);
+        key.client_port = meta->src_port;
+        stats->queries++;
+        track_query(stats, &key, &msg, ts_ns);
+        return;
+    }
+
+    memcpy(key.client, meta->dest_addr, addr_len);
+    memcpy(key.server, meta->src_addr, addr_len);
+    key.client_port = meta->dest_port;
+    stats->responses++;
+    if (msg.rcode == DNS_RCODE_NXDOMAIN) stats->nxdomain++;
+    if (msg.rcode == DNS_RCODE_SERVFAIL) stats->servfail++;
+
+    int64_t latency_us = -1;
+    if (match_response(stats, &key, ts_ns, &latency_us)) {
+        histogram_add(&stats->latency, (uint64_t)latency_us);
+    } else {
+        stats->unmatched++;
+    }
+    account(stats, msg.qname, msg.rcode, msg.qtype, msg.answers, latency_us);
+}
+
+void dns_stats_housekeeping(DnsStats* stats) {
+    uint64_t now = clock_coarse_ms();
+
+    if (now >= stats->next_expire_ms) {
+        uint64_t deadline_ns = (clock_realtime_ms() - DNS_QUERY_TIMEOUT_MS) * 1000000ULL;
+        for (uint32_t slot = 0; slot <= stats->pending_mask;) {
+            PendingQuery* q = &stats->pending[slot];
+            if (q->hash != 0 && q->ts_ns < deadline_ns) {
+                expire_query(stats, slot);
+            } else {
+                slot++;
+            }
+        }
+        stats->next_expire_ms = now + DNS_EXPIRE_PERIOD_MS;
+    }
+
+    if (now >= stats->next_export_ms) {
+        export_interval(stats, now);
+    }
+}
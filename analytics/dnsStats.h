@@ -0,0 +1,70 @@
+/**
+ * @file dnsStats.h
+ * @brief DNS transaction matching and per-name aggregation.
+ *
+ * Queries wait in a small open-addressing table keyed by (client, server,
+ * client port, transaction ID) until their response arrives; the match gives
+ * the query's latency. Unanswered queries time out.
+ *
+ * Outcomes are aggregated per (qname, rcode) in a bounded LRU cache instead of
+ * being exported per packet. The cache is exported as one {"event": "dns"}
+ * record per entry every interval; entries evicted early are exported when they
+ * leave. A {"event": "dns_summary"} record per interval carries the totals and
+ * a latency histogram.
+ *
+ * Each capture worker owns its own instance, so no locks are taken.
+ */
+
+#ifndef DNS_STATS_H
+#define DNS_STATS_H
+
+#include <stdint.h>
+#include "Types.h"
+
+/**
+ * @brief Queries without a response after this long count as timed out.
+ */
+#define DNS_QUERY_TIMEOUT_MS 5000
+
+/**
+ * @brief DNS analysis settings.
+ */
+typedef struct {
+    uint32_t pending_slots;     // Outstanding queries tracked (power of two)
+    uint32_t cache_size;        // (qname, rcode) entries aggregated per interval
+    uint32_t interval_ms;       // Export interval
+} DnsConfig;
+
+typedef struct DnsStats DnsStats;
+
+/**
+ * @brief Fills @p config with the defaults.
+ */
+void dns_config_defaults(DnsConfig* config);
+
+/**
+ * @brief Allocates the state of one capture source.
+ * @return DnsStats* or NULL on allocation failure.
+ */
+DnsStats* dns_stats_create(const DnsConfig* config, int if_id);
+
+/**
+ * @brief Exports what is left (pending queries count as timed out) and frees the state.
+ */
+void dns_stats_destroy(DnsStats* stats);
+
+/**
+ * @brief Decodes a UDP payload to or from port 53 and accounts it.
+ *
+ * @param meta Parsed packet (addresses, ports, timestamp).
+ * @param payload DNS message inside the captured frame.
+ * @param len Payload bytes present in the frame.
+ */
+void dns_stats_process(DnsStats* stats, const PacketMetadata* meta, const unsigned char* payload, int len);
+
+/**
+ * @brief Periodic work: expires unanswered queries and exports the cache when the interval is due.
+ */
+void dns_stats_housekeeping(DnsStats* stats);
+
+#endif // DNS_STATS_H
@@ -0,0 +1,646 @@
+/**
+ * @file httpStats.c
+ * @brief Implementation of HTTP/1.x transaction matching and per-host aggregation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "httpStats.h"
+#include "httpLayer.h"
+#include "histogram.h"
+#include "hash.h"
+#include "clock.h"
+#include "logger.h"
+
+#define HTTP_MAX_CHUNK_LINE 20      // Chunk size digits kept (extensions are ignored)
+
+/**
+ * @brief Where a direction is within its current message.
+ */
+typedef enum {
+    HTTP_STATE_HEAD,            // Expecting (or collecting) a head
+    HTTP_STATE_BODY,            // Content-Length body
+    HTTP_STATE_CHUNK_SIZE,      // Chunk size line
+    HTTP_STATE_CHUNK_DATA,      // Chunk data and its CRLF
+    HTTP_STATE_TRAILER,         // Trailer lines after the last chunk
+    HTTP_STATE_UNTIL_CLOSE      // Response body delimited by the end of the connection
+} HttpStreamState;
+
+typedef struct {
+    uint8_t state;              // HttpStreamState
+    uint8_t line_len;           // Partial chunk size or trailer line
+    uint8_t matched;            // Response: answers the oldest pending request
+    uint16_t status;            // Response: status code
+    char line[HTTP_MAX_CHUNK_LINE];
+    uint64_t remaining;         // Body or chunk bytes left
+    uint64_t body;              // Body bytes of the current message
+    int64_t latency_us;         // Response: request -> response head
+    char* head;                 // Partial head (NULL unless a head spans deliveries)
+    uint32_t head_len;
+} HttpStream;
+
+typedef struct {
+    uint64_t ts_ns;             // Request head complete
+    uint64_t body;              // Request body bytes
+    uint8_t method;
+    char host[HTTP_MAX_HOST];
+    char path[HTTP_MAX_PATH];
+} PendingRequest;
+
+/**
+ * @brief Stream parser state of one flow.
+ */
+typedef struct {
+    HttpStats* stats;
+    HttpStream streams[2];
+    PendingRequest pending[HTTP_MAX_PIPELINE];
+    uint8_t first;              // Oldest pending request
+    uint8_t count;
+    uint8_t seen_request;
+    uint8_t done;
+} HttpFlow;
+
+typedef struct {
+    uint64_t hash;              // 0 = free
+    int32_t chain;              // Next entry in the same bucket (-1 = end)
+    int32_t prev;               // LRU neighbours (head = most recent)
+    int32_t next;
+    uint64_t requests;
+    uint64_t responses;
+    uint64_t unanswered;
+    uint64_t methods[HTTP_METHOD_COUNT];
+    uint64_t status[5];         // 1xx .. 5xx
+    uint64_t request_bytes;     // Body bytes
+    uint64_t response_bytes;
+    uint32_t slowest_us;
+    char slowest_path[HTTP_MAX_PATH];
+    char host[HTTP_MAX_HOST];
+    Histogram latency;          // µs
+} HostEntry;
+
+struct HttpStats {
+    HttpConfig config;
+    int if_id;
+
+    // Host cache
+    HostEntry* hosts;
+    int32_t* buckets;
+    uint32_t bucket_mask;
+    int32_t lru_head;
+    int32_t lru_tail;
+    int32_t free_head;          // Free entries, linked through 'next'
+    uint32_t hosts_used;
+
+    uint64_t next_export_ms;
+    uint64_t interval_start_ms;
+
+    // Interval totals
+    uint64_t requests;
+    uint64_t responses;
+    uint64_t unmatched;         // Responses without a pending request
+    uint64_t unanswered;
+    uint64_t malformed;         // Flows given up on after their first request
+    uint64_t evicted;
+    Histogram latency;          // µs
+};
+
+static uint32_t round_pow2(uint32_t n) {
+    uint32_t size = 64;
+    while (size < n) size <<= 1;
+    return size;
+}
+
+// --- Host Cache ---
+
+static void export_entry(HttpStats* stats, const HostEntry* e, uint64_t now_ms) {
+    uint64_t elapsed_ms = now_ms > stats->interval_start_ms ? now_ms - stats->interval_start_ms : 1;
+
+    char json[1536];
+    int pos = snprintf(json, sizeof(json),
+        "{\"event\": \"http\","
+        "\"if_id\": %d,"
+        "\"host\": \"%s\","
+        "\"requests\": %llu,"
+        "\"requests_per_s\": %.2f,"
+        "\"responses\": %llu,"
+        "\"unanswered\": %llu,"
+        "\"methods\": {",
+        stats->if_id, e->host,
+        (unsigned long long)e->requests, e->requests * 1000.0 / elapsed_ms,
+        (unsigned long long)e->responses, (unsigned long long)e->unanswered);
+
+    int first = 1;
+    for (int m = 0; m < HTTP_METHOD_COUNT; m++) {
+        if (!e->methods[m]) continue;
+        pos += snprintf(json + pos, sizeof(json) - pos, "%s\"%s\": %llu",
+                        first ? "" : ", ", http_method_name((uint8_t)m), (unsigned long long)e->methods[m]);
+        first = 0;
+    }
+
+    pos += snprintf(json + pos, sizeof(json) - pos,
+        "},\"status\": [%llu, %llu, %llu, %llu, %llu],"
+        "\"request_bytes\": %llu,"
+        "\"response_bytes\": %llu,"
+        "\"slowest_path\": \"%s\"",
+        (unsigned long long)e->status[0], (unsigned long long)e->status[1],
+        (unsigned long long)e->status[2], (unsigned long long)e->status[3],
+        (unsigned long long)e->status[4],
+        (unsigned long long)e->request_bytes, (unsigned long long)e->response_bytes,
+        e->slowest_path);
+    pos = histogram_append_json(json, sizeof(json), pos, "latency", &e->latency);
+
+    if (pos < (int)sizeof(json) - 2) {
+        snprintf(json + pos, sizeof(json) - pos, "}");
+        log_event(json);
+    }
+}
+
+static void lru_unlink(HttpStats* stats, int32_t idx) {
+    HostEntry* e = &stats->hosts[idx];
+    if (e->prev >= 0) stats->hosts[e->prev].next = e->next; else stats->lru_head = e->next;
+    if (e->next >= 0) stats->hosts[e->next].prev = e->prev; else stats->lru_tail = e->prev;
+    e->prev = e->next = -1;
+}
+
+static void lru_push_head(HttpStats* stats, int32_t idx) {
+    HostEntry* e = &stats->hosts[idx];
+    e->prev = -1;
+    e->next = stats->lru_head;
+    if (stats->lru_head >= 0) stats->hosts[stats->lru_head].prev = idx; else stats->lru_tail = idx;
+    stats->lru_head = idx;
+}
+
+static void cache_reset(HttpStats* stats) {
+    for (uint32_t i = 0; i <= stats->bucket_mask; i++) stats->buckets[i] = -1;
+    for (uint32_t i = 0; i < stats->config.cache_size; i++) {
+        stats->hosts[i].hash = 0;
+        stats->hosts[i].next = (i + 1 < stats->config.cache_size) ? (int32_t)(i + 1) : -1;
+    }
+    stats->free_head = 0;
+    stats->lru_head = stats->lru_tail = -1;
+    stats->hosts_used = 0;
+}
+
+// Exports and frees the least recently updated entry
+static int32_t cache_evict(HttpStats* stats) {
+    int32_t idx = stats->lru_tail;
+    HostEntry* e = &stats->hosts[idx];
+    export_entry(stats, e, clock_coarse_ms());
+    stats->evicted++;
+
+    int32_t* link = &stats->buckets[e->hash & stats->bucket_mask];
+    while (*link != idx) link = &stats->hosts[*link].chain;
+    *link = e->chain;
+
+    lru_unlink(stats, idx);
+    stats->hosts_used--;
+    return idx;
+}
+
+static HostEntry* cache_lookup(HttpStats* stats, const char* host) {
+    size_t len = strlen(host);
+    uint64_t hash = hash_bytes(host, len, 0x48545450);
+    if (hash == 0) hash = 1;
+
+    int32_t* bucket = &stats->buckets[hash & stats->bucket_mask];
+    for (int32_t idx = *bucket; idx >= 0; idx = stats->hosts[idx].chain) {
+        HostEntry* e = &stats->hosts[idx];
+        if (e->hash == hash && strcmp(e->host, host) == 0) {
+            lru_unlink(stats, idx);
+            lru_push_head(stats, idx);
+            return e;
+        }
+    }
+
+    int32_t idx = stats->free_head;
+    if (idx >= 0) {
+        stats->free_head = stats->hosts[idx].next;
+    } else {
+        idx = cache_evict(stats);
+    }
+
+    HostEntry* e = &stats->hosts[idx];
+    memset(e, 0, sizeof(*e));
+    e->hash = hash;
+    memcpy(e->host, host, len + 1);
+    e->chain = *bucket;
+    *bucket = idx;
+    lru_push_head(stats, idx);
+    stats->hosts_used++;
+    return e;
+}
+
+/**
+ * @brief Accounts one transaction.
+ * @param latency_us Request -> response head, or -1 if the request went unanswered.
+ */
+static void account(HttpStats* stats, const PendingRequest* req, uint16_t status,
+                    int64_t latency_us, uint64_t response_bytes) {
+    HostEntry* e = cache_lookup(stats, req->host[0] ? req->host : "-");
+    e->requests++;
+    e->methods[req->method]++;
+    e->request_bytes += req->body;
+    stats->requests++;
+
+    if (latency_us < 0) {
+        e->unanswered++;
+        stats->unanswered++;
+        return;
+    }
+
+    int cls = status / 100;
+    if (cls >= 1 && cls <= 5) e->status[cls - 1]++;
+    e->responses++;
+    e->response_bytes += response_bytes;
+    histogram_add(&e->latency, (uint64_t)latency_us);
+    histogram_add(&stats->latency, (uint64_t)latency_us);
+    stats->responses++;
+
+    if (e->responses == 1 || (uint32_t)latency_us > e->slowest_us) {
+        e->slowest_us = (uint32_t)latency_us;
+        memcpy(e->slowest_path, req->path, sizeof(e->slowest_path));
+    }
+}
+
+// --- Transactions ---
+
+static PendingRequest* push_request(HttpFlow* f) {
+    if (f->count == HTTP_MAX_PIPELINE) {
+        // Deeper than we track: the oldest is given up on
+        account(f->stats, &f->pending[f->first], 0, -1, 0);
+        f->first = (uint8_t)((f->first + 1) % HTTP_MAX_PIPELINE);
+        f->count--;
+    }
+    PendingRequest* req = &f->pending[(f->first + f->count) % HTTP_MAX_PIPELINE];
+    f->count++;
+    return req;
+}
+
+// A message of this direction ended
+static void message_done(HttpFlow* f, int dir) {
+    HttpStream* st = &f->streams[dir];
+    st->state = HTTP_STATE_HEAD;
+
+    if (dir == 0) {
+        if (f->count) f->pending[(f->first + f->count - 1) % HTTP_MAX_PIPELINE].body += st->body;
+    } else if (st->matched) {
+        account(f->stats, &f->pending[f->first], st->status, st->latency_us, st->body);
+        f->first = (uint8_t)((f->first + 1) % HTTP_MAX_PIPELINE);
+        f->count--;
+        st->matched = 0;
+    }
+    st->body = 0;
+}
+
+// Sets up the body that follows a head; returns 0, or -1 to stop following the flow
+static int start_body(HttpFlow* f, int dir, const HttpHead* head, int no_body) {
+    HttpStream* st = &f->streams[dir];
+    st->body = 0;
+
+    if (no_body) {
+        message_done(f, dir);
+    } else if (head->chunked) {
+        st->state = HTTP_STATE_CHUNK_SIZE;
+        st->line_len = 0;
+    } else if (head->content_length > 0) {
+        st->state = HTTP_STATE_BODY;
+        st->remaining = (uint64_t)head->content_length;
+    } else if (head->content_length == 0 || dir == 0) {
+        message_done(f, dir);       // Requests without framing have no body
+    } else {
+        st->state = HTTP_STATE_UNTIL_CLOSE;
+    }
+    return 0;
+}
+
+static int on_head(HttpFlow* f, int dir, const char* data, uint32_t len, uint64_t ts_ns) {
+    HttpHead head;
+
+    if (dir == 0) {
+        if (parse_http_request(data, len, &head) != 0) return -1;
+        PendingRequest* req = push_request(f);
+        req->ts_ns = ts_ns;
+        req->body = 0;
+        req->method = head.method;
+        memcpy(req->host, head.host, sizeof(req->host));
+        memcpy(req->path, head.path, sizeof(req->path));
+        f->seen_request = 1;
+        return start_body(f, dir, &head, 0);
+    }
+
+    if (parse_http_response(data, len, &head) != 0) return -1;
+    HttpStream* st = &f->streams[1];
+
+    // Interim responses (100 Continue, 103 Early Hints) do not answer the request
+    if (head.status < 200 && head.status != 101) return 0;
+
+    st->status = head.status;
+    st->matched = (f->count > 0);
+    if (st->matched) {
+        const PendingRequest* req = &f->pending[f->first];
+        st->latency_us = ts_ns > req->ts_ns ? (int64_t)((ts_ns - req->ts_ns) / 1000) : 0;
+    } else {
+        f->stats->unmatched++;
+    }
+
+    // Switching protocols: account it, the rest is not HTTP
+    if (head.status == 101) {
+        message_done(f, 1);
+        return -1;
+    }
+
+    int no_body = st->matched && f->pending[f->first].method == HTTP_METHOD_HEAD;
+    no_body |= (head.status == 204 || head.status == 304);
+    return start_body(f, dir, &head, no_body);
+}
+
+// Collects a head; returns bytes consumed or -1
+static int64_t take_head(HttpFlow* f, int dir, const char* data, uint32_t len, uint64_t ts_ns) {
+    HttpStream* st = &f->streams[dir];
+
+    if (st->head_len == 0) {
+        // Common case: the whole head is in this chunk, decode it in place
+        uint32_t end = http_head_end(data, len, 0);
+        if (end) return on_head(f, dir, data, end, ts_ns) == 0 ? (int64_t)end : -1;
+
+        if (len >= HTTP_MAX_HEAD) return -1;
+        if (!st->head && !(st->head = (char*)malloc(HTTP_MAX_HEAD))) return -1;
+        memcpy(st->head, data, len);
+        st->head_len = len;
+        return len;
+    }
+
+    uint32_t take = HTTP_MAX_HEAD - st->head_len;
+    if (take > len) take = len;
+    memcpy(st->head + st->head_len, data, take);
+
+    uint32_t end = http_head_end(st->head, st->head_len + take, st->head_len);
+    if (!end) {
+        st->head_len += take;
+        return st->head_len >= HTTP_MAX_HEAD ? -1 : (int64_t)take;
+    }
+
+    uint32_t used = end - st->head_len;
+    int rc = on_head(f, dir, st->head, end, ts_ns);
+    free(st->head);                 // Split heads are rare: do not hold the buffer
+    st->head = NULL;
+    st->head_len = 0;
+    return rc == 0 ? (int64_t)used : -1;
+}
+
+// Reads one line of a chunked body; returns bytes consumed, line_done set when a line ended
+static uint32_t take_line(HttpStream* st, const char* data, uint32_t len, int* line_done) {
+    const char* nl = (const char*)memchr(data, '\n', len);
+    uint32_t n = nl ? (uint32_t)(nl - data) : len;
+
+    for (uint32_t i = 0; i < n; i++) {
+        if (st->line_len < HTTP_MAX_CHUNK_LINE - 1) st->line[st->line_len] = data[i];
+        if (st->line_len < 255) st->line_len++;
+    }
+    *line_done = (nl != NULL);
+    return nl ? n + 1 : n;
+}
+
+static int consume(HttpFlow* f, int dir, const char* data, uint32_t len, uint64_t ts_ns) {
+    HttpStream* st = &f->streams[dir];
+
+    while (len > 0) {
+        uint64_t n;
+        int line_done;
+
+        switch (st->state) {
+            case HTTP_STATE_HEAD:
+                // Stray line breaks between messages are allowed
+                if (st->head_len == 0 && (*data == '\r' || *data == '\n')) {
+                    n = 1;
+                    break;
+                }
+                {
+                    int64_t used = take_head(f, dir, data, len, ts_ns);
+                    if (used < 0) return -1;
+                    n = (uint64_t)used;
+                }
+                break;
+
+            case HTTP_STATE_BODY:
+            case HTTP_STATE_CHUNK_DATA:
+                n = st->remaining < len ? st->remaining : len;
+                st->remaining -= n;
+                st->body += n;
+                if (st->remaining == 0) {
+                    if (st->state == HTTP_STATE_BODY) {
+                        message_done(f, dir);
+                    } else {
+                        st->body = st->body >= 2 ? st->body - 2 : 0;   // The chunk's CRLF
+                        st->state = HTTP_STATE_CHUNK_SIZE;
+                        st->line_len = 0;
+                    }
+                }
+                break;
+
+            case HTTP_STATE_CHUNK_SIZE:
+                n = take_line(st, data, len, &line_done);
+                if (line_done) {
+                    uint64_t size = 0;
+                    int digits = 0;
+                    for (int i = 0; i < st->line_len && i < HTTP_MAX_CHUNK_LINE - 1; i++) {
+                        char c = st->line[i];
+                        int v = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 :
+                                (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+                        if (v < 0) break;
+                        if (++digits > 15) return -1;
+                        size = size * 16 + (uint64_t)v;
+                    }
+                    if (digits == 0) return -1;
+                    st->line_len = 0;
+                    if (size == 0) {
+                        st->state = HTTP_STATE_TRAILER;
+                    } else {
+                        st->state = HTTP_STATE_CHUNK_DATA;
+                        st->remaining = size + 2;
+                    }
+                }
+                break;
+
+            case HTTP_STATE_TRAILER:
+                n = take_line(st, data, len, &line_done);
+                if (line_done) {
+                    // An empty line ends the message
+                    int empty = st->line_len == 0 || (st->line_len == 1 && st->line[0] == '\r');
+                    st->line_len = 0;
+                    if (empty) message_done(f, dir);
+                }
+                break;
+
+            default:    // HTTP_STATE_UNTIL_CLOSE
+                st->body += len;
+                n = len;
+                break;
+        }
+
+        data += n;
+        len -= (uint32_t)n;
+    }
+    return 0;
+}
+
+// --- Stream Parser ---
+
+static void* http_open(void* worker, const FlowRecord* flow) {
+    (void)flow;
+    if (!worker) return NULL;
+
+    HttpFlow* f = (HttpFlow*)calloc(1, sizeof(HttpFlow));
+    if (f) f->stats = (HttpStats*)worker;
+    return f;
+}
+
+static int http_data(void* state, const TcpStreamInfo* info, const uint8_t* data, uint32_t len) {
+    HttpFlow* f = (HttpFlow*)state;
+    if (f->done) return 1;
+
+    if (!f->seen_request && f->streams[0].head_len == 0) {
+        // The client must speak first, and with a request line
+        if (info->dir != 0 || http_looks_like_request((const char*)data, len) == 0) {
+            f->done = 1;
+            return 1;
+        }
+    }
+
+    uint64_t ts_ns = info->ts_ns ? info->ts_ns : clock_realtime_ms() * 1000000ULL;
+    if (consume(f, info->dir, (const char*)data, len, ts_ns) != 0) {
+        if (f->seen_request) f->stats->malformed++;
+        f->done = 1;
+        return 1;
+    }
+    return 0;
+}
+
+static void http_gap(void* state, const TcpStreamInfo* info, uint32_t len) {
+    HttpFlow* f = (HttpFlow*)state;
+    HttpStream* st = &f->streams[info->dir];
+
+    // Lost body bytes do not break the framing
+    if ((st->state == HTTP_STATE_BODY || st->state == HTTP_STATE_CHUNK_DATA) && len < st->remaining) {
+        st->remaining -= len;
+        return;
+    }
+    if (st->state == HTTP_STATE_UNTIL_CLOSE) return;
+    f->done = 1;
+}
+
+static void http_close(void* state, FlowRecord* flow) {
+    (void)flow;
+    HttpFlow* f = (HttpFlow*)state;
+
+    // A close-delimited response ends here
+    if (f->streams[1].state == HTTP_STATE_UNTIL_CLOSE) message_done(f, 1);
+
+    while (f->count > 0) {
+        account(f->stats, &f->pending[f->first], 0, -1, 0);
+        f->first = (uint8_t)((f->first + 1) % HTTP_MAX_PIPELINE);
+        f->count--;
+    }
+
+    free(f->streams[0].head);
+    free(f->streams[1].head);
+    free(f);
+}
+
+const TcpStreamParser http_stream_parser = {
+    .name = "http",
+    .open = http_open,
+    .data = http_data,
+    .gap = http_gap,
+    .close = http_close
+};
+
+// --- Export ---
+
+static void export_interval(HttpStats* stats, uint64_t now_ms) {
+    uint32_t hosts = stats->hosts_used;
+    for (int32_t idx = stats->lru_head; idx >= 0; idx = stats->hosts[idx].next) {
+        export_entry(stats, &stats->hosts[idx], now_ms);
+    }
+
+    if (stats->requests || stats->unmatched || stats->malformed) {
+        char json[1024];
+        int pos = snprintf(json, sizeof(json),
+            "{\"event\": \"http_summary\","
+            "\"if_id\": %d,"
+            "\"interval_ms\": %llu,"
+            "\"requests\": %llu,"
+            "\"responses\": %llu,"
+            "\"unanswered\": %llu,"
+            "\"unmatched_responses\": %llu,"
+            "\"malformed\": %llu,"
+            "\"hosts\": %u,"
+            "\"evicted\": %llu",
+            stats->if_id, (unsigned long long)(now_ms - stats->interval_start_ms),
+            (unsigned long long)stats->requests, (unsigned long long)stats->responses,
+            (unsigned long long)stats->unanswered, (unsigned long long)stats->unmatched,
+            (unsigned long long)stats->malformed, hosts, (unsigned long long)stats->evicted);
+        pos = histogram_append_json(json, sizeof(json), pos, "latency", &stats->latency);
+        if (pos < (int)sizeof(json) - 2) {
+            snprintf(json + pos, sizeof(json) - pos, "}");
+            log_event(json);
+        }
+    }
+
+    cache_reset(stats);
+    stats->requests = stats->responses = stats->unanswered = 0;
+    stats->unmatched = stats->malformed = stats->evicted = 0;
+    memset(&stats->latency, 0, sizeof(stats->latency));
+    stats->interval_start_ms = now_ms;
+    stats->next_export_ms = now_ms + stats->config.interval_ms;
+}
+
+// --- Public API ---
+
+void http_config_defaults(HttpConfig* config) {
+    config->cache_size = 1024;
+    config->interval_ms = 10000;
+}
+
+HttpStats* http_stats_create(const HttpConfig* config, int if_id) {
+    HttpStats* stats = (HttpStats*)calloc(1, sizeof(HttpStats));
+    if (!stats) return NULL;
+
+    stats->config = *config;
+    if (stats->config.cache_size == 0) stats->config.cache_size = 1;
+    stats->if_id = if_id;
+
+    uint32_t buckets = round_pow2(stats->config.cache_size * 2);
+    stats->bucket_mask = buckets - 1;
+    stats->hosts = (HostEntry*)calloc(stats->config.cache_size, sizeof(HostEntry));
+    stats->buckets = (int32_t*)calloc(buckets, sizeof(int32_t));
+    if (!stats->hosts || !stats->buckets) {
+        free(stats->hosts);
+        free(stats->buckets);
+        free(stats);
+        return NULL;
+    }
+
+    cache_reset(stats);
+    uint64_t now = clock_coarse_ms();
+    stats->interval_start_ms = now;
+    stats->next_export_ms = now + stats->config.interval_ms;
+    return stats;
+}
+
+void http_stats_destroy(HttpStats* stats) {
+    if (!stats) return;
+
+    export_interval(stats, clock_coarse_ms());
+    free(stats->hosts);
+    free(stats->buckets);
+    free(stats);
+}
+
+void http_stats_housekeeping(HttpStats* stats) {
+    uint64_t now = clock_coarse_ms();
+    if (now >= stats->next_export_ms) {
+        export_interval(stats, now);
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ * @file httpStats.h
+ * @brief HTTP/1.x transaction analysis on reassembled TCP streams, aggregated per host.
+ *
+ * A stream parser follows both directions of every flow that opens with an
+ * HTTP request. It decodes each head (method, Host, path prefix, status,
+ * Content-Length / chunked framing), skips the bodies, and matches responses
+ * to requests in order, so keep-alive and pipelined connections are timed
+ * transaction by transaction. Flows that do not start with a request are
+ * dropped at their first bytes.
+ *
+ * Outcomes are aggregated per Host in a bounded LRU cache, exported as one
+ * {"event": "http"} record per host every interval (request rate, methods,
+ * status classes, body bytes, latency histogram, slowest path), plus a
+ * {"event": "http_summary"} record with the interval totals.
+ *
+ * Each capture worker owns its own instance, so no locks are taken.
+ */
+
+#ifndef HTTP_STATS_H
+#define HTTP_STATS_H
+
+#include <stdint.h>
+#include "tcpReassembly.h"
+
+/**
+ * @brief Requests awaiting their response on one connection (pipelining depth).
+ */
+#define HTTP_MAX_PIPELINE 4
+
+/**
+ * @brief HTTP analysis settings.
+ */
+typedef struct {
+    uint32_t cache_size;        // Hosts aggregated per interval
+    uint32_t interval_ms;       // Export interval
+} HttpConfig;
+
+typedef struct HttpStats HttpStats;
+
+/**
+ * @brief The HTTP stream parser. Register it, then bind each worker's HttpStats
+ * to it with tcp_reassembly_set_worker().
+ */
+extern const TcpStreamParser http_stream_parser;
+
+/**
+ * @brief Fills @p config with the defaults.
+ */
+void http_config_defaults(HttpConfig* config);
+
+/**
+ * @brief Allocates the state of one capture source.
+ * @return HttpStats* or NULL on allocation failure.
+ */
+HttpStats* http_stats_create(const HttpConfig* config, int if_id);
+
+/**
+ * @brief Exports what is left and frees the state. The flows using it must have been released.
+ */
+void http_stats_destroy(HttpStats* stats);
+
+/**
+ * @brief Periodic work: exports the cache when the interval is due.
+ */
+void http_stats_housekeeping(HttpStats* stats);
+
+#endif // HTTP_STATS_H
@@ -0,0 +1,57 @@
+/**
+ * @file hyperLogLog.c
+ * @brief Implementation of the HyperLogLog sketch.
+ */
+
+#include <string.h>
+#include <math.h>
+#include "hyperLogLog.h"
+#include "hash.h"
+
+#define HLL_HASH_SEED 0x484c4cu
+
+void hll_reset(HyperLogLog* hll) {
+    memset(hll->registers, 0, sizeof(hll->registers));
+}
+
+void hll_add(HyperLogLog* hll, const void* key, size_t len) {
+    uint64_t hash = hash_bytes(key, len, HLL_HASH_SEED);
+
+    // Top bits select the register, the rest give the rank
+    uint32_t idx = (uint32_t)(hash >> (64 - HLL_PRECISION));
+    uint64_t rest = (hash << HLL_PRECISION) | (1ULL << (HLL_PRECISION - 1)); // Sentinel bounds the rank
+    uint8_t rank = (uint8_t)(__builtin_clzll(rest) + 1);
+
+    if (rank > hll->registers[idx]) {
+        hll->registers[idx] = rank;
+    }
+}
+
+void hll_merge(HyperLogLog* dst, const HyperLogLog* src) {
+    for (int i = 0; i < HLL_REGISTERS; i++) {
+        if (src->registers[i] > dst->registers[i]) {
+            dst->registers[i] = src->registers[i];
+        }
+    }
+}
+
+uint64_t hll_estimate(const HyperLogLog* hll) {
+    const double m = HLL_REGISTERS;
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+
+    double sum = 0.0;
+    int zeros = 0;
+    for (int i = 0; i < HLL_REGISTERS; i++) {
+        sum += ldexp(1.0, -hll->registers[i]);
+        if (hll->registers[i] == 0) zeros++;
+    }
+
+    double estimate = alpha * m * m / sum;
+
+    // Small range correction (linear counting)
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * log(m / zeros);
+    }
+
+    return (uint64_t)(estimate + 0.5);
+}
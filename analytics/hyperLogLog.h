@@ -0,0 +1,45 @@
+/**
+ * @file hyperLogLog.h
+ * @brief HyperLogLog distinct-count sketch.
+ *
+ * Estimates the number of distinct keys with ~1.6% standard error in a fixed
+ * 4 KB register array. Two sketches merge by taking the register-wise maximum.
+ */
+
+#ifndef HYPER_LOG_LOG_H
+#define HYPER_LOG_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Precision: 2^HLL_PRECISION registers.
+ */
+#define HLL_PRECISION 12
+#define HLL_REGISTERS (1 << HLL_PRECISION)
+
+typedef struct {
+    uint8_t registers[HLL_REGISTERS];
+} HyperLogLog;
+
+/**
+ * @brief Clears all registers.
+ */
+void hll_reset(HyperLogLog* hll);
+
+/**
+ * @brief Adds a key to the sketch.
+ */
+void hll_add(HyperLogLog* hll, const void* key, size_t len);
+
+/**
+ * @brief Merges @p src into @p dst (register-wise maximum).
+ */
+void hll_merge(HyperLogLog* dst, const HyperLogLog* src);
+
+/**
+ * @brief Returns the estimated number of distinct keys added.
+ */
+uint64_t hll_estimate(const HyperLogLog* hll);
+
+#endif // HYPER_LOG_LOG_H
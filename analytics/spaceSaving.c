@@ -0,0 +1,171 @@
+/**
+ * @file spaceSaving.c
+ * @brief Implementation of the Space-Saving heavy hitter sketch.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "spaceSaving.h"
+#include "hash.h"
+
+#define SS_INDEX_SIZE (SS_CAPACITY * 2)
+#define SS_INDEX_MASK (SS_INDEX_SIZE - 1)
+#define SS_HASH_SEED  0x5353u
+
+// --- Heap Helpers ---
+
+static void heap_swap(SpaceSaving* ss, int a, int b) {
+    SpaceSavingEntry tmp = ss->heap[a];
+    ss->heap[a] = ss->heap[b];
+    ss->heap[b] = tmp;
+    ss->index[ss->heap[a].slot] = (int16_t)a;
+    ss->index[ss->heap[b].slot] = (int16_t)b;
+}
+
+static void sift_up(SpaceSaving* ss, int pos) {
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (ss->heap[parent].count <= ss->heap[pos].count) break;
+        heap_swap(ss, parent, pos);
+        pos = parent;
+    }
+}
+
+static void sift_down(SpaceSaving* ss, int pos) {
+    while (1) {
+        int left = 2 * pos + 1;
+        int right = left + 1;
+        int smallest = pos;
+
+        if (left < ss->size && ss->heap[left].count < ss->heap[smallest].count) smallest = left;
+        if (right < ss->size && ss->heap[right].count < ss->heap[smallest].count) smallest = right;
+        if (smallest == pos) break;
+
+        heap_swap(ss, pos, smallest);
+        pos = smallest;
+    }
+}
+
+// --- Index Helpers (linear probing) ---
+
+static int index_find(const SpaceSaving* ss, const void* key, uint64_t hash) {
+    int slot = (int)(hash & SS_INDEX_MASK);
+    while (ss->index[slot] != -1) {
+        const SpaceSavingEntry* e = &ss->heap[ss->index[slot]];
+        if (e->hash == hash && memcmp(e->key, key, ss->key_len) == 0) {
+            return ss->index[slot];
+        }
+        slot = (slot + 1) & SS_INDEX_MASK;
+    }
+    return -1;
+}
+
+static int index_insert(SpaceSaving* ss, uint64_t hash, int heap_pos) {
+    int slot = (int)(hash & SS_INDEX_MASK);
+    while (ss->index[slot] != -1) {
+        slot = (slot + 1) & SS_INDEX_MASK;
+    }
+    ss->index[slot] = (int16_t)heap_pos;
+    return slot;
+}
+
+// Backward-shift deletion keeps probe chains intact without tombstones
+static void index_remove(SpaceSaving* ss, int slot) {
+    int hole = slot;
+    int next = slot;
+    ss->index[hole] = -1;
+
+    while (1) {
+        next = (next + 1) & SS_INDEX_MASK;
+        if (ss->index[next] == -1) break;
+
+        int home = (int)(ss->heap[ss->index[next]].hash & SS_INDEX_MASK);
+        // Skip entries whose home lies cyclically in (hole, next]
+        int in_range = (hole <= next) ? (hole < home && home <= next)
+                                      : (hole < home || home <= next);
+        if (in_range) continue;
+
+        ss->index[hole] = ss->index[next];
+        ss->heap[ss->index[hole]].slot = (int16_t)hole;
+        ss->index[next] = -1;
+        hole = next;
+    }
+}
+
+// --- Public API ---
+
+void ss_init(SpaceSaving* ss, int key_len) {
+    ss->key_len = key_len > SS_KEY_MAX ? SS_KEY_MAX : key_len;
+    ss_reset(ss);
+}
+
+void ss_reset(SpaceSaving* ss) {
+    ss->size = 0;
+    memset(ss->index, 0xFF, sizeof(ss->index));
+}
+
+static void ss_add_hashed(SpaceSaving* ss, const void* key, uint64_t hash, uint64_t weight, uint64_t error) {
+    int pos = index_find(ss, key, hash);
+
+    // 1. Already monitored: just bump the counter
+    if (pos >= 0) {
+        ss->heap[pos].count += weight;
+        ss->heap[pos].error += error;
+        sift_down(ss, pos);
+        return;
+    }
+
+    // 2. Free counter available
+    if (ss->size < SS_CAPACITY) {
+        pos = ss->size++;
+        SpaceSavingEntry* e = &ss->heap[pos];
+        memset(e->key, 0, sizeof(e->key));
+        memcpy(e->key, key, ss->key_len);
+        e->count = weight;
+        e->error = error;
+        e->hash = hash;
+        e->slot = (int16_t)index_insert(ss, hash, pos);
+        sift_up(ss, pos);
+        return;
+    }
+
+    // 3. Replace the minimum: the new key inherits its count as error bound
+    SpaceSavingEntry* min = &ss->heap[0];
+    uint64_t min_count = min->count;
+
+    index_remove(ss, min->slot);
+    memcpy(min->key, key, ss->key_len);
+    min->count = min_count + weight;
+    min->error = min_count + error;
+    min->hash = hash;
+    min->slot = (int16_t)index_insert(ss, hash, 0);
+    sift_down(ss, 0);
+}
+
+void ss_add(SpaceSaving* ss, const void* key, uint64_t weight) {
+    ss_add_hashed(ss, key, hash_bytes(key, ss->key_len, SS_HASH_SEED), weight, 0);
+}
+
+void ss_merge(SpaceSaving* dst, const SpaceSaving* src) {
+    for (int i = 0; i < src->size; i++) {
+        const SpaceSavingEntry* e = &src->heap[i];
+        ss_add_hashed(dst, e->key, e->hash, e->count, e->error);
+    }
+}
+
+static int compare_desc(const void* a, const void* b) {
+    const SpaceSavingEntry* ea = (const SpaceSavingEntry*)a;
+    const SpaceSavingEntry* eb = (const SpaceSavingEntry*)b;
+    if (ea->count == eb->count) return 0;
+    return (ea->count < eb->count) ? 1 : -1;
+}
+
+int ss_top(const SpaceSaving* ss, SpaceSavingEntry* out, int k) {
+    SpaceSavingEntry sorted[SS_CAPACITY];
+    memcpy(sorted, ss->heap, ss->size * sizeof(SpaceSavingEntry));
+    qsort(sorted, ss->size, sizeof(SpaceSavingEntry), compare_desc);
+
+    int n = (k < ss->size) ? k : ss->size;
+    memcpy(out, sorted, n * sizeof(SpaceSavingEntry));
+    return n;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file spaceSaving.h
+ * @brief Space-Saving top-K heavy hitter sketch.
+ *
+ * Tracks the most frequent keys of a stream using a fixed number of counters.
+ * Counters live in a min-heap (so the eviction victim is always at the root)
+ * and are located through a small open-addressing index, so every update is
+ * O(log K) and memory never grows with the number of distinct keys.
+ */
+
+#ifndef SPACE_SAVING_H
+#define SPACE_SAVING_H
+
+#include <stdint.h>
+
+/**
+ * @brief Number of counters kept per sketch.
+ *
+ * Any key whose true frequency exceeds N / SS_CAPACITY is guaranteed to be tracked.
+ */
+#define SS_CAPACITY 64
+
+/**
+ * @brief Maximum key size in bytes (large enough for a 5-tuple with IPv6 addresses).
+ */
+#define SS_KEY_MAX 40
+
+/**
+ * @brief One monitored key.
+ */
+typedef struct {
+    uint8_t key[SS_KEY_MAX];
+    uint64_t count;         // Estimated count (never an underestimate)
+    uint64_t error;         // Maximum overestimation of count
+    uint64_t hash;          // Cached key hash
+    int16_t slot;           // Position in the index table
+} SpaceSavingEntry;
+
+/**
+ * @brief Space-Saving sketch with a fixed key length.
+ */
+typedef struct {
+    SpaceSavingEntry heap[SS_CAPACITY];   // Min-heap ordered by count
+    int16_t index[SS_CAPACITY * 2];       // Hash slot -> heap position (-1 = empty)
+    int size;
+    int key_len;
+} SpaceSaving;
+
+/**
+ * @brief Initializes an empty sketch.
+ * @param ss Sketch to initialize.
+ * @param key_len Length of every key in bytes (<= SS_KEY_MAX).
+ */
+void ss_init(SpaceSaving* ss, int key_len);
+
+/**
+ * @brief Clears all counters (keeps the key length).
+ */
+void ss_reset(SpaceSaving* ss);
+
+/**
+ * @brief Adds @p weight occurrences of @p key.
+ */
+void ss_add(SpaceSaving* ss, const void* key, uint64_t weight);
+
+/**
+ * @brief Merges @p src into @p dst (both must use the same key length).
+ *
+ * The merged counts keep the Space-Saving guarantees, so per-worker sketches
+ * can be combined into one global view.
+ */
+void ss_merge(SpaceSaving* dst, const SpaceSaving* src);
+
+/**
+ * @brief Copies the @p k heaviest entries into @p out, sorted by count (descending).
+ * @return int Number of entries written.
+ */
+int ss_top(const SpaceSaving* ss, SpaceSavingEntry* out, int k);
+
+#endif // SPACE_SAVING_H
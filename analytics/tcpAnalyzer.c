@@ -0,0 +1,176 @@
+/**
+ * @file tcpAnalyzer.c
+ * @brief Implementation of the passive TCP performance analyzer.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "tcpAnalyzer.h"
+#include "logger.h"
+
+// TCP flag bits as packed by parse_tcp()
+#define TCP_FLAG_FIN 0x01
+#define TCP_FLAG_SYN 0x02
+#define TCP_FLAG_RST 0x04
+#define TCP_FLAG_ACK 0x10
+
+// A resent segment arriving sooner than this after the original is network reordering
+#define REORDER_THRESHOLD_NS 3000000ULL
+
+static inline int32_t seq_diff(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b);
+}
+
+// --- Per-Flow Analysis ---
+
+static void add_rtt_sample(TcpAnalyzer* analyzer, FlowRecord* record, uint64_t ns) {
+    uint32_t us = (uint32_t)(ns / 1000);
+    TcpPerf* perf = &record->tcp;
+
+    if (perf->rtt_samples == 0 || us < perf->rtt_min_us) perf->rtt_min_us = us;
+    if (us > perf->rtt_max_us) perf->rtt_max_us = us;
+    perf->rtt_sum_us += us;
+    perf->rtt_samples++;
+    histogram_add(&analyzer->rtt, us);
+}
+
+static void track_handshake(TcpAnalyzer* analyzer, TcpFlowState* state, FlowRecord* record,
+                            int dir, uint8_t flags, uint64_t ts) {
+    uint8_t kind = flags & (TCP_FLAG_SYN | TCP_FLAG_ACK | TCP_FLAG_RST);
+
+    if (kind == TCP_FLAG_SYN && dir == 0) {
+        if (!state->syn_ns) state->syn_ns = ts;  // Retransmitted SYNs count towards the latency
+    } else if (kind == (TCP_FLAG_SYN | TCP_FLAG_ACK) && dir == 1 && state->syn_ns) {
+        if (!state->synack_ns) state->synack_ns = ts;
+    } else if (kind == TCP_FLAG_ACK && dir == 0 && state->synack_ns) {
+        record->tcp.syn_rtt_us = (uint32_t)((state->synack_ns - state->syn_ns) / 1000);
+        record->tcp.ack_rtt_us = (uint32_t)((ts - state->synack_ns) / 1000);
+        histogram_add(&analyzer->handshake, (ts - state->syn_ns) / 1000);
+        state->handshake_done = 1;
+    } else if (kind & TCP_FLAG_RST) {
+        state->handshake_done = 1; // Refused or aborted: nothing to measure
+    }
+}
+
+static void track_sequence(TcpAnalyzer* analyzer, TcpFlowState* state, FlowRecord* record,
+                           int dir, const PacketMetadata* meta, uint64_t ts) {
+    uint8_t flags = meta->tcp_flags;
+    uint8_t bit = (uint8_t)(1 << dir);
+
+    // SYN and FIN occupy one sequence number each
+    uint32_t seg_len = meta->payload_wire_len + ((flags & TCP_FLAG_SYN) ? 1 : 0) + ((flags & TCP_FLAG_FIN) ? 1 : 0);
+    if (seg_len == 0 || (flags & TCP_FLAG_RST)) return;
+
+    uint32_t seq = meta->tcp_seq;
+    uint32_t end = seq + seg_len;
+
+    if (!(state->seq_valid & bit)) {
+        state->snd_high[dir] = end;
+        state->high_ns[dir] = ts;
+        state->seq_valid |= bit;
+    } else if (seq_diff(end, state->snd_high[dir]) > 0) {
+        // New data, possibly resending part of the old
+        if (seq_diff(seq, state->snd_high[dir]) < 0) {
+            record->tcp.retransmissions[dir]++;
+            analyzer->retransmissions++;
+            if ((state->rtt_pending & bit) && seq_diff(seq, state->rtt_ack[dir]) < 0) state->rtt_pending &= (uint8_t)~bit;
+        }
+        state->snd_high[dir] = end;
+        state->high_ns[dir] = ts;
+    } else {
+        // Keep-alives resend the last byte: not a loss signal
+        if (seg_len <= 1 && seq == state->snd_high[dir] - 1 && !(flags & (TCP_FLAG_SYN | TCP_FLAG_FIN))) return;
+
+        // Nothing new: reordered in the network if it shows up within the threshold, resent otherwise
+        uint64_t threshold = record->tcp.rtt_samples ? (uint64_t)record->tcp.rtt_min_us * 1000 : REORDER_THRESHOLD_NS;
+        if (ts && ts - state->high_ns[dir] < threshold) {
+            record->tcp.out_of_order[dir]++;
+            analyzer->out_of_order++;
+        } else {
+            record->tcp.retransmissions[dir]++;
+            analyzer->retransmissions++;
+        }
+
+        // Karn: an ACK could now be for either copy
+        if ((state->rtt_pending & bit) && seq_diff(seq, state->rtt_ack[dir]) < 0) state->rtt_pending &= (uint8_t)~bit;
+        return;
+    }
+
+    // Time this segment unless one is already in flight
+    if (ts && !(state->rtt_pending & bit)) {
+        state->rtt_ack[dir] = end;
+        state->rtt_start_ns[dir] = ts;
+        state->rtt_pending |= bit;
+    }
+}
+
+void tcp_analyzer_reset(TcpAnalyzer* analyzer) {
+    memset(analyzer, 0, sizeof(*analyzer));
+}
+
+void tcp_analyzer_update(TcpAnalyzer* analyzer, TcpFlowState* state, FlowRecord* record,
+                         int dir, const PacketMetadata* meta) {
+    uint64_t ts = meta->timestamp_ns;
+    uint8_t flags = meta->tcp_flags;
+    int peer = dir ^ 1;
+
+    if ((flags & TCP_FLAG_SYN) && (meta->tcp_opts.present & TCP_OPT_MSS)) {
+        record->tcp_mss[dir] = meta->tcp_opts.mss;
+    }
+
+    if (ts && !state->handshake_done) {
+        track_handshake(analyzer, state, record, dir, flags, ts);
+    }
+
+    // An ACK from this side completes the peer's timed segment
+    if ((flags & TCP_FLAG_ACK) && (state->rtt_pending & (1 << peer)) &&
+        seq_diff(meta->tcp_ack, state->rtt_ack[peer]) >= 0) {
+        state->rtt_pending &= (uint8_t)~(1 << peer);
+        if (ts > state->rtt_start_ns[peer]) add_rtt_sample(analyzer, record, ts - state->rtt_start_ns[peer]);
+    }
+
+    track_sequence(analyzer, state, record, dir, meta, ts);
+
+    // Zero window: count the transition, not every probe ACK while it stays closed
+    if ((flags & TCP_FLAG_ACK) && !(flags & (TCP_FLAG_SYN | TCP_FLAG_RST))) {
+        uint8_t bit = (uint8_t)(1 << dir);
+        if (meta->tcp_window == 0) {
+            if (!(state->window_closed & bit)) {
+                state->window_closed |= bit;
+                record->tcp.zero_window[dir]++;
+                analyzer->zero_window++;
+            }
+        } else {
+            state->window_closed &= (uint8_t)~bit;
+        }
+    }
+}
+
+void tcp_analyzer_publish(TcpAnalyzer* analyzer, int if_id) {
+    if (analyzer->handshake.count == 0 && analyzer->rtt.count == 0 && analyzer->retransmissions == 0 &&
+        analyzer->out_of_order == 0 && analyzer->zero_window == 0) {
+        return;
+    }
+
+    char json[1536];
+    int pos = snprintf(json, sizeof(json),
+        "{\"event\": \"tcp_perf\","
+        "\"if_id\": %d,"
+        "\"retransmissions\": %llu,"
+        "\"out_of_order\": %llu,"
+        "\"zero_window\": %llu",
+        if_id,
+        (unsigned long long)analyzer->retransmissions,
+        (unsigned long long)analyzer->out_of_order,
+        (unsigned long long)analyzer->zero_window);
+
+    pos = histogram_append_json(json, sizeof(json), pos, "handshake", &analyzer->handshake);
+    pos = histogram_append_json(json, sizeof(json), pos, "rtt", &analyzer->rtt);
+
+    if (pos < (int)sizeof(json) - 2) {
+        snprintf(json + pos, sizeof(json) - pos, "}");
+        log_event(json);
+    }
+
+    tcp_analyzer_reset(analyzer);
+}
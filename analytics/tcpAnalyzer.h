@@ -0,0 +1,74 @@
+/**
+ * @file tcpAnalyzer.h
+ * @brief Passive TCP performance analysis: handshake latency, RTT, loss and stalls.
+ *
+ * Every tracked TCP flow carries a small TcpFlowState next to its record. Each
+ * packet updates the flow's TcpPerf fields, which are exported with the flow:
+ * - handshake latency, split at the capture point (SYN -> SYN/ACK -> ACK),
+ * - data -> ACK RTT samples, one outstanding per direction (Karn's rule),
+ * - retransmissions and out-of-order segments,
+ * - zero-window events.
+ * The worker also keeps log2 histograms of handshake and RTT times across flows,
+ * published periodically as a {"event": "tcp_perf"} record.
+ *
+ * Like the flow table, an analyzer belongs to one capture worker and takes no locks.
+ */
+
+#ifndef TCP_ANALYZER_H
+#define TCP_ANALYZER_H
+
+#include <stdint.h>
+#include "Types.h"
+#include "histogram.h"
+
+/**
+ * @brief Analyzer state of one flow (lives in the flow table entry).
+ */
+typedef struct {
+    uint64_t syn_ns;            // Initiator's first SYN (0 = not seen)
+    uint64_t synack_ns;         // Responder's first SYN/ACK
+    uint64_t high_ns[2];        // When snd_high last advanced
+    uint64_t rtt_start_ns[2];   // Send time of the timed segment
+    uint32_t snd_high[2];       // Highest sequence number sent, plus one
+    uint32_t rtt_ack[2];        // Acknowledgment number that completes the timed segment
+    uint8_t seq_valid;          // Bit per direction: snd_high is valid
+    uint8_t rtt_pending;        // Bit per direction: a segment is being timed
+    uint8_t window_closed;      // Bit per direction: last advertised window was zero
+    uint8_t handshake_done;
+} TcpFlowState;
+
+/**
+ * @brief Per-worker aggregate for the current publish interval.
+ */
+typedef struct {
+    Histogram handshake;        // SYN -> ACK, as seen at the capture point (µs)
+    Histogram rtt;              // µs
+    uint64_t retransmissions;
+    uint64_t out_of_order;
+    uint64_t zero_window;
+} TcpAnalyzer;
+
+/**
+ * @brief Clears the aggregate.
+ */
+void tcp_analyzer_reset(TcpAnalyzer* analyzer);
+
+/**
+ * @brief Accounts one TCP packet of a tracked flow.
+ *
+ * @param analyzer The worker's aggregate.
+ * @param state The flow's analyzer state.
+ * @param record The flow's record, whose TcpPerf fields are updated.
+ * @param dir Direction returned by flow_table_update().
+ * @param meta Parsed packet. Timing needs a capture timestamp.
+ */
+void tcp_analyzer_update(TcpAnalyzer* analyzer, TcpFlowState* state, FlowRecord* record,
+                         int dir, const PacketMetadata* meta);
+
+/**
+ * @brief Exports the aggregate as a {"event": "tcp_perf"} record and clears it.
+ * Nothing is sent for an interval without TCP activity.
+ */
+void tcp_analyzer_publish(TcpAnalyzer* analyzer, int if_id);
+
+#endif // TCP_ANALYZER_H
@@ -0,0 +1,402 @@
+/**
+ * @file threatDetector.c
+ * @brief Implementation of the sliding-window flood, scan and deauth storm detectors.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <arpa/inet.h>
+#include "threatDetector.h"
+#include "hash.h"
+#include "clock.h"
+#include "logger.h"
+
+#define DETECT_WAYS         4
+#define DETECT_SEED         0x44455443u
+#define TCP_FLAG_SYN        0x02
+#define TCP_FLAG_ACK        0x10
+#define ICMP_ECHO_REQUEST   8
+#define ICMPV6_ECHO_REQUEST 128
+#define WLAN_TYPE_MGMT      0
+#define WLAN_DISASSOC       10
+#define WLAN_DEAUTH         12
+
+typedef enum {
+    DETECT_SYN_FLOOD,
+    DETECT_ICMP_FLOOD,
+    DETECT_HORIZONTAL_SCAN,
+    DETECT_VERTICAL_SCAN,
+    DETECT_DEAUTH_STORM,
+    DETECT_KINDS
+} DetectKind;
+
+static const char* const kind_names[DETECT_KINDS] = {
+    "syn_flood", "icmp_flood", "horizontal_scan", "vertical_scan", "deauth_storm"
+};
+
+/**
+ * @brief What a window counts: a host, a (source, port), a (source, host) or a transmitter.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t kind;
+    uint8_t ip_version;         // 0 for MAC keys
+    uint16_t port;
+    uint8_t addr[16];           // Target, source or transmitter (MAC in the first 6 bytes)
+    uint8_t peer[16];           // Vertical scan: the probed host
+} DetectKey;
+
+typedef struct {
+    uint64_t hash;              // 0 = empty slot
+    DetectKey key;
+    uint32_t second;            // Second of the newest bucket
+    uint32_t alerted;           // Second of the last alert (0 = never)
+    uint32_t total;             // Sum of the buckets
+    uint32_t counts[DETECT_BUCKETS];
+    uint64_t sketch[DETECT_BUCKETS];
+} DetectEntry;
+
+struct ThreatDetector {
+    DetectorConfig config;
+    int if_id;
+
+    DetectEntry* entries;
+    uint32_t set_mask;
+    uint32_t used;
+
+    // Alert budget of the current second
+    uint32_t alert_second;
+    uint32_t alerts_in_second;
+
+    // Interval counters
+    uint64_t evictions;
+    uint64_t alerts;
+    uint64_t alerts_suppressed;
+};
+
+void detector_config_defaults(DetectorConfig* config) {
+    config->syn_pps = 1000;
+    config->icmp_pps = 500;
+    config->scan_hosts = 32;
+    config->scan_ports = 32;
+    config->deauth_pps = 10;
+    config->holdoff_sec = 60;
+    config->table_entries = 8192;
+}
+
+ThreatDetector* threat_detector_create(const DetectorConfig* config, int if_id) {
+    ThreatDetector* detector = (ThreatDetector*)calloc(1, sizeof(ThreatDetector));
+    if (!detector) return NULL;
+    detector->config = *config;
+    detector->if_id = if_id;
+
+    uint32_t entries = DETECT_WAYS;
+    while (entries < config->table_entries) entries <<= 1;
+    detector->config.table_entries = entries;
+    detector->set_mask = entries / DETECT_WAYS - 1;
+
+    // Past this the sketches saturate
+    if (detector->config.scan_hosts > DETECT_MAX_DISTINCT) detector->config.scan_hosts = DETECT_MAX_DISTINCT;
+    if (detector->config.scan_ports > DETECT_MAX_DISTINCT) detector->config.scan_ports = DETECT_MAX_DISTINCT;
+
+    detector->entries = (DetectEntry*)calloc(entries, sizeof(DetectEntry));
+    if (!detector->entries) {
+        free(detector);
+        return NULL;
+    }
+    return detector;
+}
+
+void threat_detector_destroy(ThreatDetector* detector) {
+    if (!detector) return;
+    free(detector->entries);
+    free(detector);
+}
+
+// --- Windows ---
+
+// Moves the window to @p now, clearing the buckets it passes
+static void advance(DetectEntry* entry, uint32_t now) {
+    if (now <= entry->second) return; // Late packets count in the newest bucket
+    uint32_t gap = now - entry->second;
+    if (gap > DETECT_BUCKETS) gap = DETECT_BUCKETS;
+    for (uint32_t i = 1; i <= gap; i++) {
+        uint32_t idx = (entry->second + i) % DETECT_BUCKETS;
+        entry->total -= entry->counts[idx];
+        entry->counts[idx] = 0;
+        entry->sketch[idx] = 0;
+    }
+    entry->second = now;
+}
+
+static double window_distinct(const DetectEntry* entry) {
+    uint64_t bits = 0;
+    for (int i = 0; i < DETECT_BUCKETS; i++) bits |= entry->sketch[i];
+    int zeros = 64 - __builtin_popcountll(bits);
+    if (zeros == 0) zeros = 1; // Saturated: report the estimate's ceiling
+    return -64.0 * log((double)zeros / 64.0);
+}
+
+/**
+ * @brief Finds the key's entry, or takes over the least active one of its set.
+ */
+static DetectEntry* lookup(ThreatDetector* detector, const DetectKey* key, uint32_t now) {
+    uint64_t hash = hash_bytes(key, sizeof(*key), DETECT_SEED);
+    if (hash == 0) hash = 1;
+
+    DetectEntry* set = &detector->entries[(size_t)(hash & detector->set_mask) * DETECT_WAYS];
+    DetectEntry* victim = NULL;
+    uint32_t victim_total = UINT32_MAX;
+
+    for (int way = 0; way < DETECT_WAYS; way++) {
+        DetectEntry* entry = &set[way];
+        if (entry->hash == hash && memcmp(&entry->key, key, sizeof(*key)) == 0) {
+            advance(entry, now);
+            return entry;
+        }
+        if (entry->hash == 0) {
+            if (victim_total > 0) {
+                victim = entry;
+                victim_total = 0;
+            }
+            continue;
+        }
+        advance(entry, now);
+        if (entry->total < victim_total) {
+            victim = entry;
+            victim_total = entry->total;
+        }
+    }
+
+    if (victim->hash) {
+        detector->evictions++;
+    } else {
+        detector->used++;
+    }
+    memset(victim, 0, sizeof(*victim));
+    victim->hash = hash;
+    victim->key = *key;
+    victim->second = now;
+    return victim;
+}
+
+// Counts a packet in the newest bucket (the entry's window was advanced to the packet's second)
+static void count(DetectEntry* entry) {
+    entry->counts[entry->second % DETECT_BUCKETS]++;
+    entry->total++;
+}
+
+// Counts a probe and marks its target in the bucket's sketch
+static void count_distinct(DetectEntry* entry, uint64_t target_hash) {
+    count(entry);
+    entry->sketch[entry->second % DETECT_BUCKETS] |= 1ULL << (target_hash & 63);
+}
+
+// --- Alerts ---
+
+static void format_addr(const DetectKey* key, const uint8_t* addr, char* out, size_t len) {
+    if (key->ip_version == 4) {
+        inet_ntop(AF_INET, addr, out, (socklen_t)len);
+    } else if (key->ip_version == 6) {
+        inet_ntop(AF_INET6, addr, out, (socklen_t)len);
+    } else if (key->kind == DETECT_DEAUTH_STORM && memcmp(addr, "\0\0\0\0\0\0", 6) == 0) {
+        snprintf(out, len, "*"); // All transmitters together
+    } else {
+        snprintf(out, len, "%02x:%02x:%02x:%02x:%02x:%02x", addr[0], addr[1], addr[2], addr[3], addr[4], addr[5]);
+    }
+}
+
+// Holdoff per key, then the per-source budget; only an alert actually sent starts the holdoff
+static int may_alert(ThreatDetector* detector, DetectEntry* entry, uint32_t now) {
+    if (entry->alerted && now - entry->alerted < detector->config.holdoff_sec) return 0;
+
+    if (detector->alert_second != now) {
+        detector->alert_second = now;
+        detector->alerts_in_second = 0;
+    }
+    if (detector->alerts_in_second >= DETECT_ALERTS_PER_SEC) {
+        detector->alerts_suppressed++;
+        return 0;
+    }
+    detector->alerts_in_second++;
+    detector->alerts++;
+    entry->alerted = now;
+    return 1;
+}
+
+static void raise_alert(ThreatDetector* detector, const DetectEntry* entry, uint32_t now, double value,
+                        uint32_t threshold) {
+    const DetectKey* key = &entry->key;
+    char addr[INET6_ADDRSTRLEN];
+    char peer[INET6_ADDRSTRLEN];
+    char json[512];
+
+    format_addr(key, key->addr, addr, sizeof(addr));
+    format_addr(key, key->peer, peer, sizeof(peer));
+
+    switch ((DetectKind)key->kind) {
+        case DETECT_SYN_FLOOD:
+        case DETECT_ICMP_FLOOD:
+            snprintf(json, sizeof(json),
+                "{\"event\": \"alert\", \"type\": \"%s\", \"if_id\": %d, \"ts\": %u, \"target\": \"%s\","
+                "\"rate_pps\": %.1f, \"threshold_pps\": %u, \"packets\": %u, \"window_s\": %d}",
+                kind_names[key->kind], detector->if_id, now, addr, value, threshold, entry->total, DETECT_BUCKETS);
+            log_message("[WARN] Alert (ID %d): %s to %s, %.0f/s over %d s\n", detector->if_id,
+                        kind_names[key->kind], addr, value, DETECT_BUCKETS);
+            break;
+        case DETECT_HORIZONTAL_SCAN:
+            snprintf(json, sizeof(json),
+                "{\"event\": \"alert\", \"type\": \"%s\", \"if_id\": %d, \"ts\": %u, \"source\": \"%s\","
+                "\"port\": %u, \"hosts\": %.0f, \"threshold\": %u, \"probes\": %u, \"window_s\": %d}",
+                kind_names[key->kind], detector->if_id, now, addr, key->port, value, threshold, entry->total,
+                DETECT_BUCKETS);
+            log_message("[WARN] Alert (ID %d): %s from %s, ~%.0f hosts on port %u\n", detector->if_id,
+                        kind_names[key->kind], addr, value, key->port);
+            break;
+        case DETECT_VERTICAL_SCAN:
+            snprintf(json, sizeof(json),
+                "{\"event\": \"alert\", \"type\": \"%s\", \"if_id\": %d, \"ts\": %u, \"source\": \"%s\","
+                "\"target\": \"%s\", \"ports\": %.0f, \"threshold\": %u, \"probes\": %u, \"window_s\": %d}",
+                kind_names[key->kind], detector->if_id, now, addr, peer, value, threshold, entry->total,
+                DETECT_BUCKETS);
+            log_message("[WARN] Alert (ID %d): %s from %s, ~%.0f ports on %s\n", detector->if_id,
+                        kind_names[key->kind], addr, value, peer);
+            break;
+        case DETECT_DEAUTH_STORM:
+            snprintf(json, sizeof(json),
+                "{\"event\": \"alert\", \"type\": \"%s\", \"if_id\": %d, \"ts\": %u, \"transmitter\": \"%s\","
+                "\"rate_pps\": %.1f, \"threshold_pps\": %u, \"frames\": %u, \"window_s\": %d}",
+                kind_names[key->kind], detector->if_id, now, addr, value, threshold, entry->total, DETECT_BUCKETS);
+            log_message("[WARN] Alert (ID %d): %s from %s, %.0f frames/s over %d s\n", detector->if_id,
+                        kind_names[key->kind], addr, value, DETECT_BUCKETS);
+            break;
+        default:
+            return;
+    }
+    log_event(json);
+}
+
+// Rate detectors: the window's average must reach the threshold
+static void check_rate(ThreatDetector* detector, DetectEntry* entry, uint32_t now, uint32_t threshold_pps) {
+    if (entry->total < threshold_pps * DETECT_BUCKETS) return;
+    if (!may_alert(detector, entry, now)) return;
+    raise_alert(detector, entry, now, (double)entry->total / DETECT_BUCKETS, threshold_pps);
+}
+
+static void check_distinct(ThreatDetector* detector, DetectEntry* entry, uint32_t now, uint32_t threshold) {
+    if (entry->total < threshold) return; // Cannot have seen enough targets yet
+    double distinct = window_distinct(entry);
+    if (distinct > entry->total) distinct = entry->total; // The sketch can only overestimate past this
+    if (distinct < threshold) return;
+    if (!may_alert(detector, entry, now)) return;
+    raise_alert(detector, entry, now, distinct, threshold);
+}
+
+// --- Packet path ---
+
+static void track_syn(ThreatDetector* detector, const PacketMetadata* meta, uint32_t now) {
+    DetectKey key;
+    DetectEntry* entry;
+    size_t addr_len = meta->ip_version == 4 ? 4 : 16;
+
+    // Flood: keyed by the victim, whatever the (spoofed) sources
+    memset(&key, 0, sizeof(key));
+    key.kind = DETECT_SYN_FLOOD;
+    key.ip_version = meta->ip_version;
+    memcpy(key.addr, meta->dest_addr, addr_len);
+    entry = lookup(detector, &key, now);
+    count(entry);
+    check_rate(detector, entry, now, detector->config.syn_pps);
+
+    // Horizontal scan: one source, one port, many hosts
+    memset(&key, 0, sizeof(key));
+    key.kind = DETECT_HORIZONTAL_SCAN;
+    key.ip_version = meta->ip_version;
+    key.port = meta->dest_port;
+    memcpy(key.addr, meta->src_addr, addr_len);
+    entry = lookup(detector, &key, now);
+    count_distinct(entry, hash_bytes(meta->dest_addr, addr_len, DETECT_SEED));
+    check_distinct(detector, entry, now, detector->config.scan_hosts);
+
+    // Vertical scan: one source, one host, many ports
+    memset(&key, 0, sizeof(key));
+    key.kind = DETECT_VERTICAL_SCAN;
+    key.ip_version = meta->ip_version;
+    memcpy(key.addr, meta->src_addr, addr_len);
+    memcpy(key.peer, meta->dest_addr, addr_len);
+    entry = lookup(detector, &key, now);
+    count_distinct(entry, hash_mix64((uint64_t)meta->dest_port ^ DETECT_SEED));
+    check_distinct(detector, entry, now, detector->config.scan_ports);
+}
+
+static void track_echo(ThreatDetector* detector, const PacketMetadata* meta, uint32_t now) {
+    DetectKey key;
+    memset(&key, 0, sizeof(key));
+    key.kind = DETECT_ICMP_FLOOD;
+    key.ip_version = meta->ip_version;
+    memcpy(key.addr, meta->dest_addr, meta->ip_version == 4 ? 4 : 16);
+
+    DetectEntry* entry = lookup(detector, &key, now);
+    count(entry);
+    check_rate(detector, entry, now, detector->config.icmp_pps);
+}
+
+static void track_deauth(ThreatDetector* detector, const PacketMetadata* meta, uint32_t now) {
+    DetectKey key;
+    memset(&key, 0, sizeof(key));
+    key.kind = DETECT_DEAUTH_STORM;
+
+    // Attackers rotate spoofed transmitters: the all-zero key sums them
+    DetectEntry* entry = lookup(detector, &key, now);
+    count(entry);
+    check_rate(detector, entry, now, detector->config.deauth_pps);
+
+    memcpy(key.addr, meta->src_mac, 6);
+    entry = lookup(detector, &key, now);
+    count(entry);
+    check_rate(detector, entry, now, detector->config.deauth_pps);
+}
+
+void threat_detector_process(ThreatDetector* detector, const PacketMetadata* meta) {
+    uint32_t now = meta->timestamp_ns ? (uint32_t)(meta->timestamp_ns / 1000000000ULL)
+                                      : (uint32_t)(clock_realtime_ms() / 1000);
+
+    if (meta->is_monitor_mode) {
+        if (meta->wlan_type == WLAN_TYPE_MGMT &&
+            (meta->wlan_subtype == WLAN_DEAUTH || meta->wlan_subtype == WLAN_DISASSOC)) {
+            track_deauth(detector, meta, now);
+        }
+        return;
+    }
+
+    if (meta->ip_version != 4 && meta->ip_version != 6) return;
+
+    if (meta->l3_protocol == IPPROTO_TCP && meta->l4_offset &&
+        (meta->tcp_flags & (TCP_FLAG_SYN | TCP_FLAG_ACK)) == TCP_FLAG_SYN) {
+        track_syn(detector, meta, now);
+    } else if ((meta->l3_protocol == IPPROTO_ICMP && meta->icmp_type == ICMP_ECHO_REQUEST) ||
+               (meta->l3_protocol == IPPROTO_ICMPV6 && meta->icmp_type == ICMPV6_ECHO_REQUEST)) {
+        track_echo(detector, meta, now);
+    }
+}
+
+void threat_detector_publish(ThreatDetector* detector) {
+    char json[384];
+    snprintf(json, sizeof(json),
+        "{\"event\": \"detector\","
+        "\"if_id\": %d,"
+        "\"entries\": %u,"
+        "\"capacity\": %u,"
+        "\"evictions\": %llu,"
+        "\"alerts\": %llu,"
+        "\"alerts_suppressed\": %llu}",
+        detector->if_id, detector->used, detector->config.table_entries,
+        (unsigned long long)detector->evictions, (unsigned long long)detector->alerts,
+        (unsigned long long)detector->alerts_suppressed);
+    log_event(json);
+
+    detector->evictions = 0;
+    detector->alerts = 0;
+    detector->alerts_suppressed = 0;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file threatDetector.h
+ * @brief Flood, scan and deauthentication storm detection on parsed metadata.
+ *
+ * Every key counts its activity over a sliding window of DETECT_BUCKETS
+ * one-second buckets: a ring indexed by the second, whose stale buckets are
+ * cleared as the window moves on. Keys live in a fixed-size, 4-way
+ * set-associative table. When a set is full the least active entry is
+ * replaced, so spoofed sources churn through the cold entries while the heavy
+ * hitters stay; memory never grows.
+ *
+ *   syn_flood        TCP SYNs (no ACK) to one host            average rate over the window
+ *   icmp_flood       ICMP / ICMPv6 echo requests to one host  average rate over the window
+ *   horizontal_scan  SYNs from one source to one port         distinct hosts in the window
+ *   vertical_scan    SYNs from one source to one host         distinct ports in the window
+ *   deauth_storm     802.11 deauth / disassoc frames          average rate, per transmitter and overall
+ *
+ * Distinct counts come from a 64-bit linear-counting sketch per bucket; the
+ * window's sketches are OR-ed. A key raises one {"event": "alert"} record per
+ * holdoff period, and a source sends at most DETECT_ALERTS_PER_SEC of them a
+ * second. A {"event": "detector"} record per stats interval reports the table.
+ *
+ * Each capture source owns its detector, so no locks are taken.
+ */
+
+#ifndef THREAT_DETECTOR_H
+#define THREAT_DETECTOR_H
+
+#include <stdint.h>
+#include "Types.h"
+
+#define DETECT_BUCKETS          10      // Window length in seconds
+#define DETECT_ALERTS_PER_SEC   5
+#define DETECT_MAX_DISTINCT     128     // Largest scan threshold the 64-bit sketches resolve
+
+/**
+ * @brief Detection thresholds.
+ */
+typedef struct {
+    uint32_t syn_pps;           // SYNs per second to one host, averaged over the window
+    uint32_t icmp_pps;          // Echo requests per second to one host
+    uint32_t scan_hosts;        // Hosts probed on one port by one source within the window
+    uint32_t scan_ports;        // Ports probed on one host by one source within the window
+    uint32_t deauth_pps;        // Deauth / disassoc frames per second
+    uint32_t holdoff_sec;       // A key alerts again at most this often
+    uint32_t table_entries;     // Keys tracked per source (power of two)
+} DetectorConfig;
+
+typedef struct ThreatDetector ThreatDetector;
+
+/**
+ * @brief Fills @p config with the defaults (1000 SYN/s, 500 echo/s, 32 hosts, 32 ports, 10 deauth/s, 60 s).
+ */
+void detector_config_defaults(DetectorConfig* config);
+
+/**
+ * @brief Allocates the detector of one capture source.
+ * @return ThreatDetector* or NULL on allocation failure.
+ */
+ThreatDetector* threat_detector_create(const DetectorConfig* config, int if_id);
+
+void threat_detector_destroy(ThreatDetector* detector);
+
+/**
+ * @brief Accounts one parsed packet and raises the alerts it completes.
+ */
+void threat_detector_process(ThreatDetector* detector, const PacketMetadata* meta);
+
+/**
+ * @brief Emits {"event": "detector"} (table use, evictions, alerts) and resets the interval counters.
+ */
+void threat_detector_publish(ThreatDetector* detector);
+
+#endif // THREAT_DETECTOR_H
@@ -0,0 +1,226 @@
+/**
+ * @file tlsFingerprint.c
+ * @brief Implementation of per-flow TLS ClientHello inspection.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "tlsFingerprint.h"
+#include "tcpReassembly.h"
+#include "tlsLayer.h"
+#include "quicLayer.h"
+
+// Largest Initial packet decrypted (datagrams carrying them are usually 1200-1500 bytes)
+#define QUIC_MAX_PLAINTEXT 4096
+
+/**
+ * @brief Stream parser state of one TCP flow.
+ */
+typedef struct {
+    TlsInfo info;
+    uint8_t header[TLS_RECORD_HEADER_LEN];
+    uint32_t header_have;       // Bytes of the current record header received
+    uint32_t record_left;       // Body bytes of the current record still to come (0 = reading a header)
+    uint8_t* msg;               // Handshake message collected from the record bodies
+    uint32_t msg_have;
+    uint32_t msg_need;          // Message length, header included (0 = not known yet)
+    uint8_t done;
+} TlsStream;
+
+/**
+ * @brief ClientHello being collected from a QUIC flow's CRYPTO frames.
+ */
+struct QuicHello {
+    QuicInitialKeys keys;       // Derived from the first Initial (later ones may carry another DCID)
+    uint8_t packets;            // Client Initial packets seen
+    uint8_t filled[QUIC_HELLO_MAX / 8];
+    uint8_t data[QUIC_HELLO_MAX];
+};
+
+static void decode_hello(TlsInfo* info, const uint8_t* msg, uint32_t len) {
+    TlsClientHello hello;
+    if (parse_tls_client_hello(msg, len, &hello) == 0) {
+        tls_fill_info(&hello, info);
+    }
+}
+
+// --- TLS over TCP ---
+
+static void* tls_open(void* worker, const FlowRecord* flow) {
+    (void)worker;
+    (void)flow;
+    return calloc(1, sizeof(TlsStream));
+}
+
+static int tls_finish(TlsStream* ts) {
+    free(ts->msg);
+    ts->msg = NULL;
+    ts->done = 1;
+    return 1;
+}
+
+// Adds record body bytes to the handshake message; 1 once the message is complete, -1 to give up
+static int collect_message(TlsStream* ts, const uint8_t* data, uint32_t len) {
+    if (ts->msg_need && len > ts->msg_need - ts->msg_have) len = ts->msg_need - ts->msg_have;
+    if (!ts->msg) {
+        // Sized for the largest message accepted; freed as soon as the hello is decoded
+        if ((ts->msg = (uint8_t*)malloc(TLS_HANDSHAKE_HEADER_LEN + TLS_MAX_RECORD)) == NULL) return -1;
+    }
+    uint32_t room = TLS_HANDSHAKE_HEADER_LEN + TLS_MAX_RECORD - ts->msg_have;
+    if (len > room) len = room;
+    memcpy(ts->msg + ts->msg_have, data, len);
+    ts->msg_have += len;
+
+    if (ts->msg_need == 0 && ts->msg_have >= TLS_HANDSHAKE_HEADER_LEN) {
+        if (ts->msg[0] != TLS_HANDSHAKE_CLIENT_HELLO) return -1;
+        uint32_t length = ((uint32_t)ts->msg[1] << 16) | ((uint32_t)ts->msg[2] << 8) | ts->msg[3];
+        if (length > TLS_MAX_RECORD) return -1;
+        ts->msg_need = TLS_HANDSHAKE_HEADER_LEN + length;
+    }
+    return (ts->msg_need && ts->msg_have >= ts->msg_need) ? 1 : 0;
+}
+
+static int tls_data(void* state, const TcpStreamInfo* info, const uint8_t* data, uint32_t len) {
+    TlsStream* ts = (TlsStream*)state;
+    if (ts->done) return 1;
+    if (info->dir != 0) return 0;   // The client speaks first
+
+    if (ts->header_have == 0 && ts->record_left == 0 && ts->msg_have == 0) {
+        if (data[0] != TLS_CONTENT_HANDSHAKE) return tls_finish(ts);
+
+        // Common case: the whole hello is in one record, and the record in this chunk: decode in place
+        uint32_t length = tls_handshake_record_length(data, len);
+        const uint8_t* msg = data + TLS_RECORD_HEADER_LEN;
+        if (length >= TLS_HANDSHAKE_HEADER_LEN && len >= TLS_RECORD_HEADER_LEN + length &&
+            TLS_HANDSHAKE_HEADER_LEN + (((uint32_t)msg[1] << 16) | ((uint32_t)msg[2] << 8) | msg[3]) <= length) {
+            decode_hello(&ts->info, msg, length);
+            return tls_finish(ts);
+        }
+    }
+
+    // Split hello: records may be cut across segments, and the message across records
+    while (len > 0) {
+        if (ts->record_left == 0) {
+            uint32_t take = TLS_RECORD_HEADER_LEN - ts->header_have;
+            if (take > len) take = len;
+            memcpy(ts->header + ts->header_have, data, take);
+            ts->header_have += take;
+            data += take;
+            len -= take;
+            if (ts->header_have < TLS_RECORD_HEADER_LEN) return 0;
+
+            // Every record up to the end of the hello must be a handshake record
+            ts->record_left = tls_handshake_record_length(ts->header, TLS_RECORD_HEADER_LEN);
+            ts->header_have = 0;
+            if (ts->record_left == 0) return tls_finish(ts);
+            continue;
+        }
+
+        uint32_t take = ts->record_left < len ? ts->record_left : len;
+        int complete = collect_message(ts, data, take);
+        if (complete < 0) return tls_finish(ts);
+        if (complete) {
+            decode_hello(&ts->info, ts->msg, ts->msg_need);
+            return tls_finish(ts);
+        }
+        ts->record_left -= take;
+        data += take;
+        len -= take;
+    }
+    return 0;
+}
+
+static void tls_gap(void* state, const TcpStreamInfo* info, uint32_t len) {
+    (void)len;
+    TlsStream* ts = (TlsStream*)state;
+    if (info->dir == 0 && !ts->done) tls_finish(ts);  // Part of the hello is lost
+}
+
+static void tls_close(void* state, FlowRecord* flow) {
+    TlsStream* ts = (TlsStream*)state;
+    if (ts->info.version) flow->tls = ts->info;
+    free(ts->msg);
+    free(ts);
+}
+
+static const TcpStreamParser tls_stream_parser = {
+    .name = "tls",
+    .open = tls_open,
+    .data = tls_data,
+    .gap = tls_gap,
+    .close = tls_close
+};
+
+void tls_fingerprint_register(void) {
+    tcp_reassembly_register(&tls_stream_parser);
+}
+
+// --- QUIC ---
+
+static void collect_crypto(void* user, uint64_t offset, const uint8_t* data, uint32_t len) {
+    struct QuicHello* qh = (struct QuicHello*)user;
+    if (offset >= QUIC_HELLO_MAX) return;
+    if (len > QUIC_HELLO_MAX - offset) len = (uint32_t)(QUIC_HELLO_MAX - offset);
+
+    memcpy(qh->data + offset, data, len);
+    for (uint32_t i = (uint32_t)offset; i < offset + len; i++) {
+        qh->filled[i >> 3] |= (uint8_t)(1 << (i & 7));
+    }
+}
+
+static int filled_up_to(const struct QuicHello* qh, uint32_t end) {
+    for (uint32_t i = 0; i < end; i++) {
+        if (!(qh->filled[i >> 3] & (1 << (i & 7)))) return 0;
+    }
+    return 1;
+}
+
+// Returns 1 once the hello has been decoded or cannot be
+static int try_decode(FlowEntry* entry, const struct QuicHello* qh) {
+    if (!filled_up_to(qh, TLS_HANDSHAKE_HEADER_LEN)) return 0;
+
+    const uint8_t* msg = qh->data;
+    uint32_t end = TLS_HANDSHAKE_HEADER_LEN + (((uint32_t)msg[1] << 16) | ((uint32_t)msg[2] << 8) | msg[3]);
+    if (msg[0] != TLS_HANDSHAKE_CLIENT_HELLO || end > QUIC_HELLO_MAX) return 1;
+    if (!filled_up_to(qh, end)) return 0;
+
+    decode_hello(&entry->record.tls, msg, end);
+    return 1;
+}
+
+void tls_fingerprint_quic(FlowEntry* entry, int dir, const uint8_t* payload, uint32_t len) {
+    if (entry->quic_done || dir != 0) return;
+
+    if (!quic_is_initial(payload, len)) {
+        // A QUIC client opens with an Initial: anything else is another protocol
+        if (!entry->quic) entry->quic_done = 1;
+        return;
+    }
+
+    struct QuicHello* qh = entry->quic;
+    if (!qh) {
+        qh = (struct QuicHello*)calloc(1, sizeof(struct QuicHello));
+        if (!qh || quic_derive_client_keys(payload, len, &qh->keys) != 0) {
+            free(qh);
+            entry->quic_done = 1;
+            return;
+        }
+        entry->quic = qh;
+    }
+
+    uint8_t plain[QUIC_MAX_PLAINTEXT];
+    int n = quic_decrypt_initial(&qh->keys, payload, len, plain, sizeof(plain));
+    if (n > 0) {
+        quic_crypto_frames(plain, (uint32_t)n, collect_crypto, qh);
+    }
+
+    if (try_decode(entry, qh) || ++qh->packets >= QUIC_HELLO_PACKETS) {
+        tls_fingerprint_release(entry);
+        entry->quic_done = 1;
+    }
+}
+
+void tls_fingerprint_release(FlowEntry* entry) {
+    free(entry->quic);
+    entry->quic = NULL;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file tlsFingerprint.h
+ * @brief Per-flow TLS ClientHello inspection: SNI, ALPN, version and JA3.
+ *
+ * Each flow is decoded once, at its start, and the result lands in the flow
+ * record's TlsInfo, which the flow exporter carries.
+ *
+ * TLS over TCP is read from the reassembled client stream, so a ClientHello
+ * split across segments, or across several handshake records (large key
+ * shares), is handled. The stream parser detaches as soon as the hello has
+ * been decoded, or the stream turns out not to be TLS.
+ *
+ * QUIC carries the ClientHello in CRYPTO frames of the client's first Initial
+ * packets. These are decrypted and the frames collected in a small per-flow
+ * buffer, freed as soon as the hello is complete or after a few packets.
+ */
+
+#ifndef TLS_FINGERPRINT_H
+#define TLS_FINGERPRINT_H
+
+#include <stdint.h>
+#include "flowTable.h"
+
+/**
+ * @brief Largest QUIC ClientHello collected from CRYPTO frames.
+ */
+#define QUIC_HELLO_MAX 4096
+
+/**
+ * @brief Client Initial packets looked at before a QUIC flow is given up on.
+ */
+#define QUIC_HELLO_PACKETS 4
+
+/**
+ * @brief Registers the TLS stream parser with the reassembly engine.
+ * Must be called before the parser contexts are created.
+ */
+void tls_fingerprint_register(void);
+
+/**
+ * @brief Looks at a UDP packet of a flow that may be QUIC.
+ *
+ * Sets entry->quic_done once the flow needs no more attention.
+ *
+ * @param dir Direction returned by flow_table_update(); only the initiator's packets are read.
+ * @param payload UDP payload inside the captured frame.
+ */
+void tls_fingerprint_quic(FlowEntry* entry, int dir, const uint8_t* payload, uint32_t len);
+
+/**
+ * @brief Frees a flow's partial QUIC state, if any.
+ */
+void tls_fingerprint_release(FlowEntry* entry);
+
+#endif // TLS_FINGERPRINT_H
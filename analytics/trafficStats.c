@@ -0,0 +1,269 @@
+/**
+ * @file trafficStats.c
+ * @brief Implementation of the streaming analytics stage and snapshot export.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include "trafficStats.h"
+#include "logger.h"
+#include "clock.h"
+
+// --- Sketch Keys ---
+
+typedef struct __attribute__((packed)) {
+    uint8_t family;         // 4, 6, or 0 for a MAC address (monitor mode)
+    uint8_t addr[16];
+} AddressKey;
+
+typedef struct __attribute__((packed)) {
+    uint8_t proto;
+    uint16_t port;
+} PortKey;
+
+typedef struct __attribute__((packed)) {
+    AddressKey a;           // Lower endpoint (so both directions map to one key)
+    AddressKey b;
+    uint16_t port_a;
+    uint16_t port_b;
+    uint8_t proto;
+} ConversationKey;
+
+// --- Shared Aggregate ---
+
+static TrafficStats* global_stats = NULL;
+static pthread_mutex_t global_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t last_report_ms = 0;
+static uint64_t since_ms = 0;           // Wall-clock start of the aggregate (it is never reset)
+static int report_interval_ms = 1000;
+
+// --- Helpers ---
+
+static void make_address_key(AddressKey* key, const PacketMetadata* meta, int source) {
+    memset(key, 0, sizeof(*key));
+    if (meta->is_monitor_mode) {
+        key->family = 0;
+        memcpy(key->addr, source ? meta->src_mac : meta->dest_mac, 6);
+    } else {
+        key->family = meta->ip_version;
+        memcpy(key->addr, source ? meta->src_addr : meta->dest_addr, 16);
+    }
+}
+
+static const char* proto_name(uint8_t proto) {
+    switch (proto) {
+        case IPPROTO_TCP:    return "TCP";
+        case IPPROTO_UDP:    return "UDP";
+        case IPPROTO_ICMP:   return "ICMP";
+        case IPPROTO_ICMPV6: return "ICMPv6";
+        default:             return "IP";
+    }
+}
+
+static void format_address_key(const AddressKey* key, char* out, size_t len) {
+    if (key->family == 4) {
+        inet_ntop(AF_INET, key->addr, out, len);
+    } else if (key->family == 6) {
+        inet_ntop(AF_INET6, key->addr, out, len);
+    } else {
+        snprintf(out, len, "%02X:%02X:%02X:%02X:%02X:%02X",
+                 key->addr[0], key->addr[1], key->addr[2],
+                 key->addr[3], key->addr[4], key->addr[5]);
+    }
+}
+
+// --- Per-Worker API ---
+
+TrafficStats* traffic_stats_create(void) {
+    TrafficStats* stats = (TrafficStats*)malloc(sizeof(TrafficStats));
+    if (!stats) return NULL;
+
+    ss_init(&stats->top_src, sizeof(AddressKey));
+    ss_init(&stats->top_dst, sizeof(AddressKey));
+    ss_init(&stats->top_ports, sizeof(PortKey));
+    ss_init(&stats->top_conv, sizeof(ConversationKey));
+    traffic_stats_reset(stats);
+    return stats;
+}
+
+void traffic_stats_destroy(TrafficStats* stats) {
+    free(stats);
+}
+
+void traffic_stats_reset(TrafficStats* stats) {
+    ss_reset(&stats->top_src);
+    ss_reset(&stats->top_dst);
+    ss_reset(&stats->top_ports);
+    ss_reset(&stats->top_conv);
+    hll_reset(&stats->distinct_src);
+    hll_reset(&stats->distinct_dst);
+    hll_reset(&stats->distinct_conv);
+    stats->packets = 0;
+    stats->bytes = 0;
+}
+
+void traffic_stats_update(TrafficStats* stats, const PacketMetadata* meta) {
+    stats->packets++;
+    stats->bytes += meta->packet_size;
+
+    // Only addressable traffic (IP, or 802.11 in monitor mode) is ranked
+    if (!meta->is_monitor_mode && meta->ip_version == 0) return;
+
+    AddressKey src, dst;
+    make_address_key(&src, meta, 1);
+    make_address_key(&dst, meta, 0);
+
+    ss_add(&stats->top_src, &src, 1);
+    ss_add(&stats->top_dst, &dst, 1);
+    hll_add(&stats->distinct_src, &src, sizeof(src));
+    hll_add(&stats->distinct_dst, &dst, sizeof(dst));
+
+    if (meta->is_monitor_mode) return;
+
+    uint8_t proto = meta->l3_protocol;
+    if (proto == IPPROTO_TCP || proto == IPPROTO_UDP) {
+        PortKey port;
+        port.proto = proto;
+        port.port = meta->dest_port;
+        ss_add(&stats->top_ports, &port, 1);
+    }
+
+    // Direction-less conversation key: order endpoints canonically
+    ConversationKey conv;
+    memset(&conv, 0, sizeof(conv));
+    conv.proto = proto;
+    int cmp = memcmp(&src, &dst, sizeof(AddressKey));
+    if (cmp < 0 || (cmp == 0 && meta->src_port <= meta->dest_port)) {
+        conv.a = src; conv.port_a = meta->src_port;
+        conv.b = dst; conv.port_b = meta->dest_port;
+    } else {
+        conv.a = dst; conv.port_a = meta->dest_port;
+        conv.b = src; conv.port_b = meta->src_port;
+    }
+    ss_add(&stats->top_conv, &conv, 1);
+    hll_add(&stats->distinct_conv, &conv, sizeof(conv));
+}
+
+void traffic_stats_merge(TrafficStats* dst, const TrafficStats* src) {
+    ss_merge(&dst->top_src, &src->top_src);
+    ss_merge(&dst->top_dst, &src->top_dst);
+    ss_merge(&dst->top_ports, &src->top_ports);
+    ss_merge(&dst->top_conv, &src->top_conv);
+    hll_merge(&dst->distinct_src, &src->distinct_src);
+    hll_merge(&dst->distinct_dst, &src->distinct_dst);
+    hll_merge(&dst->distinct_conv, &src->distinct_conv);
+    dst->packets += src->packets;
+    dst->bytes += src->bytes;
+}
+
+// --- Snapshot Export ---
+
+static int append_top_list(char* buf, size_t cap, int pos, const char* name,
+                           const SpaceSaving* ss, int kind) {
+    SpaceSavingEntry top[STATS_TOP_K];
+    int n = ss_top(ss, top, STATS_TOP_K);
+
+    pos += snprintf(buf + pos, cap - pos, ",\"%s\": [", name);
+    for (int i = 0; i < n && pos < (int)cap; i++) {
+        char label[128];
+
+        if (kind == 0) {
+            format_address_key((const AddressKey*)top[i].key, label, sizeof(label));
+        } else if (kind == 1) {
+            PortKey port;
+            memcpy(&port, top[i].key, sizeof(port));
+            snprintf(label, sizeof(label), "%s/%u", proto_name(port.proto), port.port);
+        } else {
+            ConversationKey conv;
+            char a[INET6_ADDRSTRLEN], b[INET6_ADDRSTRLEN];
+            memcpy(&conv, top[i].key, sizeof(conv));
+            format_address_key(&conv.a, a, sizeof(a));
+            format_address_key(&conv.b, b, sizeof(b));
+            snprintf(label, sizeof(label), "%s:%u <-> %s:%u %s",
+                     a, conv.port_a, b, conv.port_b, proto_name(conv.proto));
+        }
+
+        pos += snprintf(buf + pos, cap - pos, "%s[\"%s\", %llu]",
+                        i ? ", " : "", label, (unsigned long long)top[i].count);
+    }
+    pos += snprintf(buf + pos, cap - pos, "]");
+    return pos;
+}
+
+// Must be called with global_mutex held
+static void emit_snapshot(uint64_t now_ms) {
+    char json[16384];
+    int pos = snprintf(json, sizeof(json),
+        "{\"event\": \"stats\","
+        "\"cumulative\": true,"
+        "\"since_ms\": %llu,"
+        "\"report_interval_ms\": %d,"
+        "\"packets\": %llu,"
+        "\"bytes\": %llu,"
+        "\"distinct_src\": %llu,"
+        "\"distinct_dst\": %llu,"
+        "\"distinct_conv\": %llu",
+        (unsigned long long)since_ms,
+        report_interval_ms,
+        (unsigned long long)global_stats->packets,
+        (unsigned long long)global_stats->bytes,
+        (unsigned long long)hll_estimate(&global_stats->distinct_src),
+        (unsigned long long)hll_estimate(&global_stats->distinct_dst),
+        (unsigned long long)hll_estimate(&global_stats->distinct_conv));
+
+    pos = append_top_list(json, sizeof(json), pos, "top_src", &global_stats->top_src, 0);
+    pos = append_top_list(json, sizeof(json), pos, "top_dst", &global_stats->top_dst, 0);
+    pos = append_top_list(json, sizeof(json), pos, "top_ports", &global_stats->top_ports, 1);
+    pos = append_top_list(json, sizeof(json), pos, "top_conv", &global_stats->top_conv, 2);
+
+    if (pos < (int)sizeof(json) - 2) {
+        snprintf(json + pos, sizeof(json) - pos, "}");
+        log_event(json);
+    }
+
+    last_report_ms = now_ms;
+}
+
+void init_traffic_stats(int interval_ms) {
+    pthread_mutex_lock(&global_mutex);
+    if (!global_stats) {
+        global_stats = traffic_stats_create();
+        since_ms = clock_realtime_ms();
+    }
+    report_interval_ms = interval_ms > 0 ? interval_ms : 1000;
+    last_report_ms = clock_coarse_ms();
+    pthread_mutex_unlock(&global_mutex);
+}
+
+void cleanup_traffic_stats(void) {
+    pthread_mutex_lock(&global_mutex);
+    if (global_stats) {
+        emit_snapshot(clock_coarse_ms());
+        traffic_stats_destroy(global_stats);
+        global_stats = NULL;
+    }
+    pthread_mutex_unlock(&global_mutex);
+}
+
+void traffic_stats_publish(TrafficStats* local) {
+    uint64_t now = clock_coarse_ms();
+
+    pthread_mutex_lock(&global_mutex);
+    if (global_stats) {
+        traffic_stats_merge(global_stats, local);
+        if (now - last_report_ms >= (uint64_t)report_interval_ms) {
+            emit_snapshot(now);
+        }
+    }
+    pthread_mutex_unlock(&global_mutex);
+
+    traffic_stats_reset(local);
+}
+
+int traffic_stats_interval_ms(void) {
+    return report_interval_ms;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file trafficStats.h
+ * @brief Streaming traffic analytics: heavy hitters and distinct counts.
+ *
+ * Every capture source owns a TrafficStats instance that is only touched by the
+ * thread servicing its ring, so updates need no locking. Periodically each worker
+ * publishes (merges) its local sketches into a shared aggregate and starts over;
+ * the aggregate is exported as a compact snapshot event instead of making the
+ * dashboard count every packet itself. The aggregate is cumulative since
+ * startup: a snapshot carries "cumulative": true and "since_ms", and
+ * "report_interval_ms" is only how often it is sent.
+ */
+
+#ifndef TRAFFIC_STATS_H
+#define TRAFFIC_STATS_H
+
+#include <stdint.h>
+#include "Types.h"
+#include "spaceSaving.h"
+#include "hyperLogLog.h"
+
+/**
+ * @brief Number of entries per top-K list in an exported snapshot.
+ */
+#define STATS_TOP_K 10
+
+/**
+ * @brief Mergeable set of sketches for one worker (or for the global aggregate).
+ */
+typedef struct {
+    SpaceSaving top_src;        // Sources (IP, or MAC in monitor mode)
+    SpaceSaving top_dst;        // Destinations
+    SpaceSaving top_ports;      // Destination (protocol, port)
+    SpaceSaving top_conv;       // Conversations (direction-less 5-tuple)
+
+    HyperLogLog distinct_src;
+    HyperLogLog distinct_dst;
+    HyperLogLog distinct_conv;
+
+    uint64_t packets;
+    uint64_t bytes;
+} TrafficStats;
+
+/**
+ * @brief Initializes the shared aggregate and the snapshot timer.
+ * @param interval_ms Snapshot (and worker publish) interval.
+ */
+void init_traffic_stats(int interval_ms);
+
+/**
+ * @brief Emits a final snapshot and frees the shared aggregate.
+ */
+void cleanup_traffic_stats(void);
+
+/**
+ * @brief Allocates an empty per-worker instance.
+ * @return TrafficStats* or NULL on allocation failure.
+ */
+TrafficStats* traffic_stats_create(void);
+
+/**
+ * @brief Frees a per-worker instance.
+ */
+void traffic_stats_destroy(TrafficStats* stats);
+
+/**
+ * @brief Clears all sketches and counters.
+ */
+void traffic_stats_reset(TrafficStats* stats);
+
+/**
+ * @brief Accounts one parsed packet.
+ */
+void traffic_stats_update(TrafficStats* stats, const PacketMetadata* meta);
+
+/**
+ * @brief Merges @p src into @p dst.
+ */
+void traffic_stats_merge(TrafficStats* dst, const TrafficStats* src);
+
+/**
+ * @brief Merges a worker's local sketches into the shared aggregate and resets them.
+ *
+ * Emits a snapshot event if the snapshot interval has elapsed.
+ *
+ * @param local The worker's instance.
+ */
+void traffic_stats_publish(TrafficStats* local);
+
+/**
+ * @brief Returns the configured publish interval in milliseconds.
+ */
+int traffic_stats_interval_ms(void);
+
+#endif // TRAFFIC_STATS_H
@@ -4,6 +4,8 @@
 
 # Default interface
 BASE_INTERFACE=${1:-wlp2s0}
+# Optional extra interfaces captured by the same process (e.g. a wired uplink)
+EXTRA_INTERFACES="${@:2}"
 SNIFFER_PID=""
 HOPPER_PID=""  # Initialize variable
 
@@ -109,11 +111,11 @@ fi
 
 # --- Step 4: Run Application ---
 
-echo "Starting Sniffer on $CURRENT_INTERFACE..."
+echo "Starting Sniffer on $CURRENT_INTERFACE $EXTRA_INTERFACES..."
 echo "Logs -> sniffer.log"
 
 # Run Sniffer with Output Redirection
-sudo ./build/Sniffer $CURRENT_INTERFACE > sniffer.log 2>&1 &
+sudo ./build/Sniffer --record-format binary $CURRENT_INTERFACE $EXTRA_INTERFACES > sniffer.log 2>&1 &
 SNIFFER_PID=$!
 
 echo "Starting Dashboard..."
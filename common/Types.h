@@ -16,6 +16,36 @@
  */
 #define BUFFER_SIZE 65536
 
+/**
+ * @brief TCP option bits (TcpOptions.present).
+ */
+#define TCP_OPT_MSS        0x01
+#define TCP_OPT_WSCALE     0x02
+#define TCP_OPT_SACK_PERM  0x04
+#define TCP_OPT_SACK       0x08
+#define TCP_OPT_TIMESTAMP  0x10
+
+/**
+ * @brief Checksum verification results (PacketMetadata.csum_flags, 0 = not checked).
+ */
+#define CSUM_IP_OK        0x01
+#define CSUM_IP_BAD       0x02
+#define CSUM_L4_OK        0x04    // Computed, or already verified by the kernel / NIC
+#define CSUM_L4_BAD       0x08
+#define CSUM_L4_SKIPPED   0x10    // Not verifiable: truncated, fragment, no checksum, or left to the NIC
+
+/**
+ * @brief Decoded TCP options.
+ */
+typedef struct {
+    uint8_t present;          // TCP_OPT_* bits
+    uint8_t wscale;           // Window scale shift (SYN only)
+    uint8_t sack_blocks;      // SACK blocks carried
+    uint16_t mss;             // Maximum segment size (SYN only)
+    uint32_t ts_val;          // Timestamp value
+    uint32_t ts_ecr;          // Timestamp echo reply
+} TcpOptions;
+
 /**
  * @brief Structure to hold metadata from all layers.
  */
@@ -29,23 +59,127 @@ typedef struct {
     uint8_t ip_version;       // 4 or 6
     char src_ip[INET6_ADDRSTRLEN];
     char dest_ip[INET6_ADDRSTRLEN];
+    uint8_t src_addr[16];     // Raw source address (IPv4 uses the first 4 bytes)
+    uint8_t dest_addr[16];    // Raw destination address
     uint8_t l3_protocol;      // IP Protocol or IPv6 Next Header
+    uint16_t ip_length;       // Datagram length from the IP header (excludes L2 padding)
 
     // Layer 4 (Transport)
     uint16_t src_port;
     uint16_t dest_port;
-    uint8_t tcp_flags;        // For TCP
+    uint8_t tcp_flags;        // For TCP: all eight flag bits (CWR .. FIN)
+    uint32_t tcp_seq;         // For TCP: sequence number
+    uint32_t tcp_ack;         // For TCP: acknowledgment number
+    uint16_t tcp_window;      // For TCP: advertised window (unscaled)
+    TcpOptions tcp_opts;      // For TCP
     uint8_t icmp_type;        // For ICMP/ICMPv6
     uint8_t icmp_code;        // For ICMP/ICMPv6
+
+    // Payload location (offsets from the start of the captured frame)
+    uint16_t l3_offset;       // Network header
+    uint16_t l4_offset;       // Transport header (0 if none)
+    uint16_t payload_offset;  // Transport payload
+    uint16_t payload_len;     // Transport payload bytes present in the frame
+    uint16_t payload_wire_len; // Transport payload bytes on the wire (more than payload_len if truncated)
     
     // Metadata
-    int packet_size;
+    int packet_size;          // Frame length on the wire (the capture may be shorter)
+    uint64_t timestamp_ns;    // Capture time (kernel timestamp, ns since epoch)
+    uint8_t if_id;            // Capture source (interface) the packet came from
+    uint32_t sampling_rate;   // 1-in-N export sampling rate in effect for this record
+    uint8_t csum_flags;       // CSUM_* verification results (0 when verification is off)
+    uint8_t is_eapol;         // 802.1X EAPOL frame (wired, or a WPA handshake in monitor mode)
 
     // Monitor Mode / 802.11
     int is_monitor_mode;      // 1 if Radiotap/802.11, 0 otherwise
     int8_t signal_dbm;        // Signal strength in dBm
     int channel;              // Frequency/Channel
     char ssid[33];            // SSID (if available, e.g., Beacon frames)
+    uint8_t wlan_type;        // 802.11 frame control type (0 = management, 1 = control, 2 = data)
+    uint8_t wlan_subtype;     // 802.11 frame control subtype (e.g. 12 = deauthentication)
 } PacketMetadata;
 
+/**
+ * @brief Bidirectional flow key.
+ *
+ * Endpoint A is the initiator (the sender of the first packet seen), so
+ * the same key matches both directions of a conversation.
+ */
+typedef struct {
+    uint8_t ip_version;       // 4 or 6
+    uint8_t protocol;         // IP Protocol
+    uint16_t port_a;
+    uint16_t port_b;
+    uint8_t addr_a[16];       // IPv4 uses the first 4 bytes
+    uint8_t addr_b[16];
+} FlowKey;
+
+/**
+ * @brief Why a flow record was exported (IPFIX flowEndReason values).
+ */
+typedef enum {
+    FLOW_END_IDLE      = 1,   // Idle timeout
+    FLOW_END_ACTIVE    = 2,   // Active timeout (long-lived flow, record split)
+    FLOW_END_OF_FLOW   = 3,   // TCP FIN in both directions or RST
+    FLOW_END_FORCED    = 4,   // Shutdown
+    FLOW_END_RESOURCES = 5    // Evicted because the table was full
+} FlowEndReason;
+
+/**
+ * @brief TCP performance measured at the capture point, per flow record.
+ *
+ * Times are split at the capture point: syn_rtt_us is the round trip towards
+ * the responder, ack_rtt_us the one towards the initiator.
+ */
+typedef struct {
+    uint32_t syn_rtt_us;          // SYN -> SYN/ACK
+    uint32_t ack_rtt_us;          // SYN/ACK -> ACK
+    uint32_t rtt_min_us;          // Data -> ACK samples, both directions
+    uint32_t rtt_max_us;
+    uint64_t rtt_sum_us;
+    uint32_t rtt_samples;
+    uint32_t retransmissions[2];
+    uint32_t out_of_order[2];
+    uint32_t zero_window[2];      // Receive window closed by the sender of this direction
+} TcpPerf;
+
+/**
+ * @brief Sizes of the TLS strings kept per flow (longer values are truncated).
+ */
+#define TLS_SNI_LEN  64
+#define TLS_ALPN_LEN 16
+#define TLS_CIPHERS_MAX    32     // Cipher suites kept per ClientHello
+#define TLS_EXTENSIONS_MAX 24     // Extension types kept per ClientHello
+
+/**
+ * @brief ClientHello summary of a flow (TLS over TCP, or QUIC's Initial packets).
+ */
+typedef struct {
+    uint16_t version;             // Highest version offered (0 = no ClientHello decoded)
+    char sni[TLS_SNI_LEN];        // server_name, NUL-padded
+    char alpn[TLS_ALPN_LEN];      // First ALPN protocol offered
+    uint8_t ja3[16];              // MD5 of the JA3 fingerprint string
+    uint8_t cipher_count;         // Entries of ciphers[] used
+    uint8_t extension_count;      // Entries of extensions[] used
+    uint16_t ciphers[TLS_CIPHERS_MAX];        // Cipher suites in the order offered, GREASE left out
+    uint16_t extensions[TLS_EXTENSIONS_MAX];  // Extension types in the order sent, GREASE left out
+} TlsInfo;
+
+/**
+ * @brief Exported flow record. Direction 0 is A -> B, direction 1 is B -> A.
+ */
+typedef struct {
+    FlowKey key;
+    uint8_t if_id;            // Capture source
+    uint8_t end_reason;       // FlowEndReason
+    uint8_t tcp_flags[2];     // OR of all TCP flags seen, per direction
+    uint64_t start_ms;        // First packet (ms since epoch)
+    uint64_t end_ms;          // Last packet (ms since epoch)
+    uint64_t packets[2];
+    uint64_t bytes[2];
+    uint16_t tcp_mss[2];      // MSS announced in each direction's SYN (0 if unseen)
+    TcpPerf tcp;              // Zero for non-TCP flows
+    TlsInfo tls;              // Zero unless a ClientHello was decoded
+} FlowRecord;
+
 #endif // TYPES_H
@@ -0,0 +1,116 @@
+/**
+ * @file checksum.c
+ * @brief Implementation of the Internet checksum summation loops.
+ */
+
+#include <string.h>
+#include "checksum.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CSUM_HAVE_X86 1
+#endif
+
+typedef uint64_t (*CsumLoop)(const uint8_t* p, size_t len, uint64_t acc);
+
+static uint64_t sum_scalar(const uint8_t* p, size_t len, uint64_t acc) {
+    while (len >= 4) {
+        uint32_t w;
+        memcpy(&w, p, 4);
+        acc += w;
+        p += 4;
+        len -= 4;
+    }
+    if (len >= 2) {
+        uint16_t w;
+        memcpy(&w, p, 2);
+        acc += w;
+        p += 2;
+        len -= 2;
+    }
+    if (len) {
+        // The odd byte is the high-order byte of a zero-padded word, wherever that lands natively
+        uint8_t pad[2] = { p[0], 0 };
+        uint16_t w;
+        memcpy(&w, pad, 2);
+        acc += w;
+    }
+    return acc;
+}
+
+#ifdef CSUM_HAVE_X86
+
+// Each 32-bit word is widened into a 64-bit lane, so lanes cannot overflow for any packet size
+
+__attribute__((target("sse2")))
+static uint64_t sum_sse2(const uint8_t* p, size_t len, uint64_t acc) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sum = _mm_setzero_si128();
+
+    while (len >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(v, zero));
+        sum = _mm_add_epi64(sum, _mm_unpackhi_epi32(v, zero));
+        p += 16;
+        len -= 16;
+    }
+
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, sum);
+    return sum_scalar(p, len, acc + lanes[0] + lanes[1]);
+}
+
+__attribute__((target("avx2")))
+static uint64_t sum_avx2(const uint8_t* p, size_t len, uint64_t acc) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i sum = _mm256_setzero_si256();
+
+    while (len >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        sum = _mm256_add_epi64(sum, _mm256_unpacklo_epi32(v, zero));
+        sum = _mm256_add_epi64(sum, _mm256_unpackhi_epi32(v, zero));
+        p += 32;
+        len -= 32;
+    }
+
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, sum);
+    return sum_sse2(p, len, acc + lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+
+#endif
+
+static CsumLoop select_loop(const char** name) {
+#ifdef CSUM_HAVE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "avx2";
+        return sum_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        *name = "sse2";
+        return sum_sse2;
+    }
+#endif
+    *name = "scalar";
+    return sum_scalar;
+}
+
+// Resolved on first use; racing workers all store the same values
+static CsumLoop g_loop = NULL;
+
+uint64_t csum_partial(const void* data, size_t len, uint64_t acc) {
+    CsumLoop loop = __atomic_load_n(&g_loop, __ATOMIC_RELAXED);
+    if (!loop) {
+        const char* name;
+        loop = select_loop(&name);
+        __atomic_store_n(&g_loop, loop, __ATOMIC_RELAXED);
+    }
+    return loop((const uint8_t*)data, len, acc);
+}
+
+const char* csum_implementation(void) {
+    const char* name;
+    select_loop(&name);
+    return name;
+}
@@ -0,0 +1,49 @@
+/**
+ * @file checksum.h
+ * @brief Internet checksum (RFC 1071) summation, vectorized where the CPU allows.
+ *
+ * The one's complement sum does not depend on byte order, so buffers are summed
+ * as native 32-bit words into a 64-bit accumulator and only folded at the end.
+ * On x86 the bulk is summed 32 bytes at a time with AVX2 or 16 at a time with
+ * SSE2, picked once at run time; other CPUs use the scalar loop.
+ */
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Adds @p len bytes to a running sum.
+ *
+ * Sums may be chained as long as every buffer but the last has an even length
+ * (an odd trailing byte is padded with zero, as on the wire).
+ *
+ * @param data Bytes to add.
+ * @param len Number of bytes.
+ * @param acc Running sum (0 to start).
+ * @return uint64_t Updated sum.
+ */
+uint64_t csum_partial(const void* data, size_t len, uint64_t acc);
+
+/**
+ * @brief Folds a running sum to 16 bits with end-around carries.
+ *
+ * A buffer holding a correct checksum folds to 0xFFFF.
+ */
+static inline uint16_t csum_fold(uint64_t acc) {
+    acc = (acc & 0xFFFFFFFFULL) + (acc >> 32);
+    acc = (acc & 0xFFFFFFFFULL) + (acc >> 32);
+    acc = (acc & 0xFFFF) + (acc >> 16);
+    acc = (acc & 0xFFFF) + (acc >> 16);
+    acc = (acc & 0xFFFF) + (acc >> 16);
+    return (uint16_t)acc;
+}
+
+/**
+ * @brief Name of the summation loop in use ("avx2", "sse2" or "scalar").
+ */
+const char* csum_implementation(void);
+
+#endif // CHECKSUM_H
@@ -0,0 +1,54 @@
+/**
+ * @file clock.h
+ * @brief Cheap monotonic time helpers for timers and housekeeping.
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief Monotonic time in nanoseconds (precise).
+ */
+static inline uint64_t clock_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Monotonic time in milliseconds (coarse, vDSO-only, a few ms resolution).
+ *
+ * Good enough for periodic housekeeping in the capture loop.
+ */
+static inline uint64_t clock_coarse_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+/**
+ * @brief Wall-clock time in milliseconds since the epoch (coarse).
+ *
+ * Same time base as the kernel packet timestamps, used for flow timeouts.
+ */
+static inline uint64_t clock_realtime_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+/**
+ * @brief Wall-clock time in nanoseconds since the epoch (precise).
+ *
+ * Stands in for a packet timestamp when the backend has none.
+ */
+static inline uint64_t clock_realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#endif // CLOCK_H
@@ -0,0 +1,556 @@
+/**
+ * @file columnar.c
+ * @brief Implementation of the columnar archive encoders, writer and reader.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#include "columnar.h"
+#include "hash.h"
+
+#define DICT_MAX_ENTRIES 65536
+
+// --- Bit packing (LSB first) ---
+
+typedef struct {
+    uint8_t* out;
+    uint64_t acc;
+    uint32_t fill;
+} BitWriter;
+
+static void put_bits(BitWriter* w, uint64_t value, uint32_t bits) {
+    // At most 32 bits at a time, so the accumulator never overflows
+    if (bits > 32) {
+        put_bits(w, value & 0xFFFFFFFFu, 32);
+        put_bits(w, value >> 32, bits - 32);
+        return;
+    }
+    w->acc |= (value & ((1ULL << bits) - 1)) << w->fill;
+    w->fill += bits;
+    while (w->fill >= 8) {
+        *w->out++ = (uint8_t)w->acc;
+        w->acc >>= 8;
+        w->fill -= 8;
+    }
+}
+
+static void flush_bits(BitWriter* w) {
+    if (w->fill) *w->out++ = (uint8_t)w->acc;
+    w->acc = 0;
+    w->fill = 0;
+}
+
+typedef struct {
+    const uint8_t* in;
+    const uint8_t* end;
+    uint64_t acc;
+    uint32_t fill;
+} BitReader;
+
+static uint64_t get_bits(BitReader* r, uint32_t bits) {
+    if (bits > 32) {
+        uint64_t low = get_bits(r, 32);
+        return low | (get_bits(r, bits - 32) << 32);
+    }
+    while (r->fill < bits) {
+        uint64_t byte = r->in < r->end ? *r->in++ : 0;
+        r->acc |= byte << r->fill;
+        r->fill += 8;
+    }
+    uint64_t value = r->acc & ((1ULL << bits) - 1);
+    r->acc >>= bits;
+    r->fill -= bits;
+    return value;
+}
+
+static uint8_t bit_width(uint64_t range) {
+    return range ? (uint8_t)(64 - __builtin_clzll(range)) : 0;
+}
+
+static size_t packed_size(uint32_t count, uint8_t bits) {
+    return (size_t)(((uint64_t)count * bits + 7) / 8);
+}
+
+static uint8_t* pack(uint8_t* out, const uint64_t* values, uint32_t count, uint64_t base, uint8_t bits) {
+    if (bits == 0) return out;
+    BitWriter w = { out, 0, 0 };
+    for (uint32_t i = 0; i < count; i++) put_bits(&w, values[i] - base, bits);
+    flush_bits(&w);
+    return w.out;
+}
+
+// --- Encoders ---
+
+/**
+ * @brief Scratch space of one writer (grown to the largest chunk).
+ */
+typedef struct {
+    uint64_t* values;       // Deltas / dictionary indexes
+    uint32_t* table;        // Dictionary hash table (index + 1, 0 = empty)
+    uint8_t* encoded;
+    size_t capacity;        // Rows
+    size_t encoded_capacity;
+} Scratch;
+
+static int scratch_reserve(Scratch* s, uint32_t rows, size_t encoded_bytes) {
+    if (rows > s->capacity) {
+        uint64_t* v = (uint64_t*)realloc(s->values, (size_t)rows * sizeof(uint64_t));
+        if (!v) return -1;
+        s->values = v;
+        s->capacity = rows;
+    }
+    if (encoded_bytes > s->encoded_capacity) {
+        uint8_t* e = (uint8_t*)realloc(s->encoded, encoded_bytes);
+        if (!e) return -1;
+        s->encoded = e;
+        s->encoded_capacity = encoded_bytes;
+    }
+    if (!s->table) {
+        s->table = (uint32_t*)malloc(2 * DICT_MAX_ENTRIES * sizeof(uint32_t));
+        if (!s->table) return -1;
+    }
+    return 0;
+}
+
+// Builds a dictionary of up to @p limit entries; returns the entry count, or 0 if there are more
+static uint32_t build_dict(Scratch* s, const uint8_t* values, uint32_t rows, uint16_t width, int is_int,
+                           uint32_t limit, uint8_t* dict) {
+    const uint32_t mask = 2 * DICT_MAX_ENTRIES - 1;
+    uint32_t count = 0;
+    size_t stride = is_int ? sizeof(uint64_t) : width;
+    size_t size = is_int ? sizeof(uint64_t) : width;
+
+    memset(s->table, 0, 2 * DICT_MAX_ENTRIES * sizeof(uint32_t));
+    for (uint32_t i = 0; i < rows; i++) {
+        const uint8_t* v = values + (size_t)i * stride;
+        uint32_t slot = (uint32_t)hash_bytes(v, size, 0) & mask;
+
+        while (s->table[slot] && memcmp(dict + (size_t)(s->table[slot] - 1) * size, v, size) != 0) {
+            slot = (slot + 1) & mask;
+        }
+        if (!s->table[slot]) {
+            if (count == limit) return 0;
+            memcpy(dict + (size_t)count * size, v, size);
+            s->table[slot] = ++count;
+        }
+        s->values[i] = s->table[slot] - 1;
+    }
+    return count;
+}
+
+static size_t encode_int(Scratch* s, const uint64_t* v, uint32_t rows, ColumnChunkStats* st) {
+    uint64_t min = v[0], max = v[0];
+    for (uint32_t i = 1; i < rows; i++) {
+        if (v[i] < min) min = v[i];
+        if (v[i] > max) max = v[i];
+    }
+    memcpy(st->min, &min, 8);
+    memcpy(st->max, &max, 8);
+
+    // Candidate sizes: frame of reference, delta, dictionary
+    uint8_t bits_for = bit_width(max - min);
+    size_t size_for = 8 + packed_size(rows, bits_for);
+
+    int64_t dmin = 0, dmax = 0;
+    for (uint32_t i = 1; i < rows; i++) {
+        int64_t d = (int64_t)(v[i] - v[i - 1]);
+        if (i == 1 || d < dmin) dmin = d;
+        if (i == 1 || d > dmax) dmax = d;
+    }
+    uint8_t bits_delta = bit_width((uint64_t)dmax - (uint64_t)dmin);
+    size_t size_delta = rows > 1 ? 16 + packed_size(rows - 1, bits_delta) : SIZE_MAX;
+
+    uint8_t* out = s->encoded;
+    uint32_t limit = rows / 4 < DICT_MAX_ENTRIES ? rows / 4 : DICT_MAX_ENTRIES;
+    uint32_t distinct = (bits_for > 8 && limit > 1) ?
+        build_dict(s, (const uint8_t*)v, rows, 8, 1, limit, out + 4) : 0;
+    uint8_t bits_dict = distinct ? bit_width(distinct - 1) : 0;
+    size_t size_dict = distinct ? 4 + (size_t)distinct * 8 + packed_size(rows, bits_dict) : SIZE_MAX;
+
+    if (size_dict < size_for && size_dict < size_delta) {
+        memcpy(out, &distinct, 4);
+        st->encoding = ENC_DICT;
+        st->bits = bits_dict;
+        st->distinct = distinct;
+        return (size_t)(pack(out + 4 + (size_t)distinct * 8, s->values, rows, 0, bits_dict) - out);
+    }
+    if (size_delta < size_for) {
+        for (uint32_t i = 1; i < rows; i++) s->values[i - 1] = v[i] - v[i - 1];
+        memcpy(out, &v[0], 8);
+        memcpy(out + 8, &dmin, 8);
+        st->encoding = ENC_DELTA;
+        st->bits = bits_delta;
+        return (size_t)(pack(out + 16, s->values, rows - 1, (uint64_t)dmin, bits_delta) - out);
+    }
+    memcpy(out, &min, 8);
+    st->encoding = ENC_BITPACK;
+    st->bits = bits_for;
+    return (size_t)(pack(out + 8, v, rows, min, bits_for) - out);
+}
+
+static size_t encode_bytes(Scratch* s, const uint8_t* v, uint32_t rows, uint16_t width, ColumnChunkStats* st) {
+    const uint8_t* min = v;
+    const uint8_t* max = v;
+    for (uint32_t i = 1; i < rows; i++) {
+        const uint8_t* p = v + (size_t)i * width;
+        if (memcmp(p, min, width) < 0) min = p;
+        if (memcmp(p, max, width) > 0) max = p;
+    }
+    memcpy(st->min, min, width < 16 ? width : 16);
+    memcpy(st->max, max, width < 16 ? width : 16);
+
+    uint8_t* out = s->encoded;
+    uint32_t limit = rows / 2 < DICT_MAX_ENTRIES ? rows / 2 : DICT_MAX_ENTRIES;
+    uint32_t distinct = limit > 1 ? build_dict(s, v, rows, width, 0, limit, out + 4) : 0;
+
+    if (!distinct) {
+        memcpy(out, v, (size_t)rows * width);
+        st->encoding = ENC_PLAIN;
+        return (size_t)rows * width;
+    }
+    memcpy(out, &distinct, 4);
+    st->encoding = ENC_DICT;
+    st->bits = bit_width(distinct - 1);
+    st->distinct = distinct;
+    return (size_t)(pack(out + 4 + (size_t)distinct * width, s->values, rows, 0, st->bits) - out);
+}
+
+// --- Writer ---
+
+struct ColumnarWriter {
+    FILE* fp;
+    uint32_t count;
+    ColumnDesc columns[COLUMNAR_MAX_COLUMNS];
+    Scratch scratch;
+    uint8_t* chunk;
+    size_t chunk_capacity;
+    int failed;
+};
+
+const char* columnar_codec_name(void) {
+#ifdef HAVE_ZLIB
+    return "deflate";
+#else
+    return "none";
+#endif
+}
+
+ColumnarWriter* columnar_writer_open(const char* path, const char* schema, const ColumnDesc* columns,
+                                     uint32_t count) {
+    if (count == 0 || count > COLUMNAR_MAX_COLUMNS) return NULL;
+
+    ColumnarWriter* w = (ColumnarWriter*)calloc(1, sizeof(ColumnarWriter));
+    if (!w) return NULL;
+    w->count = count;
+    memcpy(w->columns, columns, count * sizeof(ColumnDesc));
+
+    w->fp = fopen(path, "wb");
+    if (!w->fp) {
+        free(w);
+        return NULL;
+    }
+
+    ColumnarFileHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, COLUMNAR_MAGIC, sizeof(hdr.magic));
+    hdr.version = COLUMNAR_VERSION;
+    hdr.columns = count;
+    snprintf(hdr.schema, sizeof(hdr.schema), "%s", schema);
+
+    if (fwrite(&hdr, sizeof(hdr), 1, w->fp) != 1 || fwrite(columns, sizeof(ColumnDesc), count, w->fp) != count) {
+        fclose(w->fp);
+        free(w);
+        return NULL;
+    }
+    return w;
+}
+
+long columnar_writer_append(ColumnarWriter* w, const ColumnBatch* batch) {
+    uint32_t rows = batch->rows;
+    if (rows == 0 || rows > COLUMNAR_MAX_ROWS) return rows == 0 ? 0 : -1;
+
+    // Upper bound of one encoded column: a plain copy, or a full dictionary plus 64-bit indexes
+    size_t widest = 8;
+    for (uint32_t c = 0; c < w->count; c++) {
+        if (w->columns[c].type == COL_BYTES && w->columns[c].width > widest) widest = w->columns[c].width;
+    }
+    size_t column_bound = 16 + (size_t)rows * (widest + 8);
+#ifdef HAVE_ZLIB
+    size_t stored_bound = compressBound((uLong)column_bound);
+    if (stored_bound < column_bound) stored_bound = column_bound;
+#else
+    size_t stored_bound = column_bound;
+#endif
+    size_t footer_len = w->count * sizeof(ColumnChunkStats);
+    size_t chunk_bound = sizeof(ColumnarChunkHeader) + w->count * stored_bound + footer_len;
+
+    if (scratch_reserve(&w->scratch, rows, column_bound) != 0) return -1;
+    if (chunk_bound > w->chunk_capacity) {
+        uint8_t* p = (uint8_t*)realloc(w->chunk, chunk_bound);
+        if (!p) return -1;
+        w->chunk = p;
+        w->chunk_capacity = chunk_bound;
+    }
+
+    ColumnChunkStats stats[COLUMNAR_MAX_COLUMNS];
+    memset(stats, 0, sizeof(stats));
+    uint8_t* data = w->chunk + sizeof(ColumnarChunkHeader);
+    size_t used = 0;
+
+    for (uint32_t c = 0; c < w->count; c++) {
+        ColumnChunkStats* st = &stats[c];
+        size_t raw = (w->columns[c].type == COL_INT) ?
+            encode_int(&w->scratch, (const uint64_t*)batch->values[c], rows, st) :
+            encode_bytes(&w->scratch, (const uint8_t*)batch->values[c], rows, w->columns[c].width, st);
+
+        st->offset = (uint32_t)used;
+        st->raw_len = (uint32_t)raw;
+        st->codec = CODEC_NONE;
+        st->stored_len = (uint32_t)raw;
+#ifdef HAVE_ZLIB
+        // Small blocks rarely shrink enough to pay for the inflate
+        uLongf packed = (uLongf)stored_bound;
+        if (raw >= 64 && compress2(data + used, &packed, w->scratch.encoded, (uLong)raw, Z_BEST_SPEED) == Z_OK &&
+            packed < raw) {
+            st->codec = CODEC_DEFLATE;
+            st->stored_len = (uint32_t)packed;
+        }
+#endif
+        if (st->codec == CODEC_NONE) memcpy(data + used, w->scratch.encoded, raw);
+        used += st->stored_len;
+    }
+
+    ColumnarChunkHeader* hdr = (ColumnarChunkHeader*)w->chunk;
+    hdr->magic = COLUMNAR_CHUNK_MAGIC;
+    hdr->rows = rows;
+    hdr->data_len = (uint32_t)used;
+    hdr->footer_len = (uint32_t)footer_len;
+    memcpy(data + used, stats, footer_len);
+
+    size_t total = sizeof(ColumnarChunkHeader) + used + footer_len;
+    if (fwrite(w->chunk, 1, total, w->fp) != total) {
+        w->failed = 1;
+        return -1;
+    }
+    return (long)total;
+}
+
+int columnar_writer_close(ColumnarWriter* w) {
+    if (!w) return 0;
+    int status = (fclose(w->fp) == 0 && !w->failed) ? 0 : -1;
+    free(w->scratch.values);
+    free(w->scratch.table);
+    free(w->scratch.encoded);
+    free(w->chunk);
+    free(w);
+    return status;
+}
+
+// --- Reader ---
+
+struct ColumnarReader {
+    int fd;
+    uint64_t size;
+    uint64_t pos;           // Next chunk
+    ColumnarFileHeader header;
+    ColumnDesc columns[COLUMNAR_MAX_COLUMNS];
+    ColumnChunkStats stats[COLUMNAR_MAX_COLUMNS];
+    uint8_t* stored;        // Column block as read
+    uint8_t* raw;           // After inflating
+    size_t stored_capacity;
+    size_t raw_capacity;
+};
+
+ColumnarReader* columnar_open(const char* path) {
+    ColumnarReader* r = (ColumnarReader*)calloc(1, sizeof(ColumnarReader));
+    if (!r) return NULL;
+
+    r->fd = open(path, O_RDONLY);
+    struct stat st;
+    if (r->fd < 0 || fstat(r->fd, &st) != 0 ||
+        pread(r->fd, &r->header, sizeof(r->header), 0) != (ssize_t)sizeof(r->header) ||
+        memcmp(r->header.magic, COLUMNAR_MAGIC, sizeof(r->header.magic)) != 0 ||
+        r->header.version != COLUMNAR_VERSION ||
+        r->header.columns == 0 || r->header.columns > COLUMNAR_MAX_COLUMNS) {
+        columnar_close(r);
+        return NULL;
+    }
+
+    size_t desc_len = r->header.columns * sizeof(ColumnDesc);
+    if (pread(r->fd, r->columns, desc_len, sizeof(r->header)) != (ssize_t)desc_len) {
+        columnar_close(r);
+        return NULL;
+    }
+    r->header.schema[sizeof(r->header.schema) - 1] = '\0';
+    r->size = (uint64_t)st.st_size;
+    r->pos = sizeof(r->header) + desc_len;
+    return r;
+}
+
+void columnar_close(ColumnarReader* r) {
+    if (!r) return;
+    if (r->fd >= 0) close(r->fd);
+    free(r->stored);
+    free(r->raw);
+    free(r);
+}
+
+const char* columnar_schema(const ColumnarReader* r) { return r->header.schema; }
+uint32_t columnar_column_count(const ColumnarReader* r) { return r->header.columns; }
+const ColumnDesc* columnar_column(const ColumnarReader* r, uint32_t index) { return &r->columns[index]; }
+
+int columnar_find_column(const ColumnarReader* r, const char* name) {
+    for (uint32_t i = 0; i < r->header.columns; i++) {
+        if (strncmp(r->columns[i].name, name, COLUMNAR_NAME_LEN) == 0) return (int)i;
+    }
+    return -1;
+}
+
+int columnar_next_chunk(ColumnarReader* r, ColumnarChunk* chunk) {
+    ColumnarChunkHeader hdr;
+    if (r->pos + sizeof(hdr) > r->size) return 0;
+    if (pread(r->fd, &hdr, sizeof(hdr), (off_t)r->pos) != (ssize_t)sizeof(hdr)) return -1;
+    if (hdr.magic != COLUMNAR_CHUNK_MAGIC || hdr.rows == 0 || hdr.rows > COLUMNAR_MAX_ROWS ||
+        hdr.footer_len != r->header.columns * sizeof(ColumnChunkStats)) {
+        return -1;
+    }
+
+    // A crash can leave the last chunk incomplete
+    uint64_t end = r->pos + sizeof(hdr) + hdr.data_len + hdr.footer_len;
+    if (end > r->size) return 0;
+
+    if (pread(r->fd, r->stats, hdr.footer_len, (off_t)(end - hdr.footer_len)) != (ssize_t)hdr.footer_len) return -1;
+    for (uint32_t c = 0; c < r->header.columns; c++) {
+        if ((uint64_t)r->stats[c].offset + r->stats[c].stored_len > hdr.data_len) return -1;
+    }
+
+    chunk->rows = hdr.rows;
+    chunk->stats = r->stats;
+    chunk->data_offset = r->pos + sizeof(hdr);
+    r->pos = end;
+    return 1;
+}
+
+static int grow_buffer(uint8_t** buf, size_t* capacity, size_t need) {
+    if (need <= *capacity) return 0;
+    uint8_t* p = (uint8_t*)realloc(*buf, need);
+    if (!p) return -1;
+    *buf = p;
+    *capacity = need;
+    return 0;
+}
+
+static int unpack(const uint8_t* in, size_t len, uint32_t count, uint8_t bits, uint64_t base, uint64_t* out) {
+    if (packed_size(count, bits) > len) return -1;
+    BitReader br = { in, in + len, 0, 0 };
+    for (uint32_t i = 0; i < count; i++) out[i] = base + (bits ? get_bits(&br, bits) : 0);
+    return 0;
+}
+
+int columnar_read_column(ColumnarReader* r, const ColumnarChunk* chunk, uint32_t index, void* out) {
+    const ColumnChunkStats* st = &chunk->stats[index];
+    const ColumnDesc* desc = &r->columns[index];
+    uint32_t rows = chunk->rows;
+    if (st->bits > 64) return -1;
+
+    if (grow_buffer(&r->stored, &r->stored_capacity, st->stored_len + 1) != 0 ||
+        pread(r->fd, r->stored, st->stored_len, (off_t)(chunk->data_offset + st->offset)) != (ssize_t)st->stored_len) {
+        return -1;
+    }
+
+    const uint8_t* raw = r->stored;
+    size_t len = st->stored_len;
+    if (st->codec == CODEC_DEFLATE) {
+#ifdef HAVE_ZLIB
+        if (grow_buffer(&r->raw, &r->raw_capacity, st->raw_len + 1) != 0) return -1;
+        uLongf inflated = st->raw_len;
+        if (uncompress(r->raw, &inflated, r->stored, st->stored_len) != Z_OK || inflated != st->raw_len) return -1;
+        raw = r->raw;
+        len = inflated;
+#else
+        return -1;
+#endif
+    } else if (st->codec != CODEC_NONE) {
+        return -1;
+    }
+
+    if (desc->type == COL_INT) {
+        uint64_t* values = (uint64_t*)out;
+        uint64_t first, base;
+        uint32_t n;
+
+        switch (st->encoding) {
+            case ENC_BITPACK:
+                if (len < 8) return -1;
+                memcpy(&base, raw, 8);
+                return unpack(raw + 8, len - 8, rows, st->bits, base, values);
+            case ENC_DELTA:
+                if (len < 16) return -1;
+                memcpy(&first, raw, 8);
+                memcpy(&base, raw + 8, 8);
+                if (unpack(raw + 16, len - 16, rows - 1, st->bits, base, values + 1) != 0) return -1;
+                values[0] = first;
+                for (uint32_t i = 1; i < rows; i++) values[i] += values[i - 1];
+                return 0;
+            case ENC_DICT: {
+                if (len < 4) return -1;
+                memcpy(&n, raw, 4);
+                if (n == 0 || 4 + (uint64_t)n * 8 > len) return -1;
+                const uint8_t* dict = raw + 4;
+                if (unpack(dict + (size_t)n * 8, len - 4 - (size_t)n * 8, rows, st->bits, 0, values) != 0) return -1;
+                for (uint32_t i = 0; i < rows; i++) {
+                    if (values[i] >= n) return -1;
+                    memcpy(&values[i], dict + values[i] * 8, 8);
+                }
+                return 0;
+            }
+            default:
+                return -1;
+        }
+    }
+
+    uint8_t* bytes = (uint8_t*)out;
+    size_t width = desc->width;
+    if (st->encoding == ENC_PLAIN) {
+        if (len < (size_t)rows * width) return -1;
+        memcpy(bytes, raw, (size_t)rows * width);
+        return 0;
+    }
+    if (st->encoding != ENC_DICT || len < 4) return -1;
+
+    uint32_t n;
+    memcpy(&n, raw, 4);
+    if (n == 0 || 4 + (uint64_t)n * width > len) return -1;
+    const uint8_t* dict = raw + 4;
+    const uint8_t* packed = dict + (size_t)n * width;
+    size_t packed_len = len - 4 - (size_t)n * width;
+    if (packed_size(rows, st->bits) > packed_len) return -1;
+
+    BitReader br = { packed, packed + packed_len, 0, 0 };
+    for (uint32_t i = 0; i < rows; i++) {
+        uint64_t idx = st->bits ? get_bits(&br, st->bits) : 0;
+        if (idx >= n) return -1;
+        memcpy(bytes + (size_t)i * width, dict + idx * width, width);
+    }
+    return 0;
+}
+
+uint64_t columnar_stats_min(const ColumnChunkStats* st) {
+    uint64_t v;
+    memcpy(&v, st->min, 8);
+    return v;
+}
+
+uint64_t columnar_stats_max(const ColumnChunkStats* st) {
+    uint64_t v;
+    memcpy(&v, st->max, 8);
+    return v;
+}
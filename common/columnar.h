@@ -0,0 +1,176 @@
+/**
+ * @file columnar.h
+ * @brief Compressed columnar archive format: chunk encoders, file writer and reader.
+ *
+ * An archive is a header naming the schema and its columns, then chunks:
+ *
+ *   ColumnarChunkHeader
+ *   column data (one block per column, in schema order)
+ *   ColumnChunkStats[columns]          Footer: encoding, location and min/max per column
+ *
+ * Each column block is encoded with whichever of bit-packing (frame of
+ * reference), delta or dictionary encoding is smallest for that chunk, then
+ * compressed with deflate (level 1) when that helps. A reader decides from the
+ * footer alone whether a chunk can match, and decodes only the columns it needs.
+ * A chunk is self-contained, so a file cut short by a crash loses at most its
+ * last chunk. All integers are little-endian.
+ */
+
+#ifndef COLUMNAR_H
+#define COLUMNAR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define COLUMNAR_MAGIC        "SNIFCOL1"
+#define COLUMNAR_VERSION      1
+#define COLUMNAR_CHUNK_MAGIC  0x314B4843u   // "CHK1"
+#define COLUMNAR_MAX_COLUMNS  32
+#define COLUMNAR_NAME_LEN     16
+#define COLUMNAR_MAX_ROWS     (1u << 20)    // Per chunk
+
+typedef enum {
+    COL_INT   = 1,          // Unsigned integer, up to 64 bits (values are passed as uint64_t)
+    COL_BYTES = 2           // Fixed-width bytes: addresses, NUL-padded strings
+} ColumnType;
+
+typedef enum {
+    ENC_PLAIN   = 0,        // Values as is
+    ENC_BITPACK = 1,        // value - min, packed at the width of max - min
+    ENC_DELTA   = 2,        // First value, then deltas (frame of reference, packed)
+    ENC_DICT    = 3         // Distinct values, then packed indexes
+} ColumnEncoding;
+
+typedef enum {
+    CODEC_NONE    = 0,
+    CODEC_DEFLATE = 1
+} ColumnCodec;
+
+typedef struct {
+    char name[COLUMNAR_NAME_LEN];
+    uint8_t type;           // ColumnType
+    uint8_t reserved;
+    uint16_t width;         // Bytes per value (informational for COL_INT)
+} ColumnDesc;
+
+typedef struct {
+    char magic[8];          // COLUMNAR_MAGIC
+    uint32_t version;
+    uint32_t columns;
+    char schema[16];        // "packets", "flows"
+} ColumnarFileHeader;       // Followed by ColumnDesc[columns]
+
+typedef struct {
+    uint32_t magic;         // COLUMNAR_CHUNK_MAGIC
+    uint32_t rows;
+    uint32_t data_len;      // Column blocks
+    uint32_t footer_len;    // ColumnChunkStats[columns]
+} ColumnarChunkHeader;
+
+/**
+ * @brief Footer entry of one column in one chunk.
+ *
+ * min / max hold a little-endian uint64_t for COL_INT, the smallest and
+ * largest value's first 16 bytes (memcmp order) for COL_BYTES.
+ */
+typedef struct {
+    uint8_t encoding;       // ColumnEncoding
+    uint8_t codec;          // ColumnCodec
+    uint8_t bits;           // Packed width
+    uint8_t reserved;
+    uint32_t offset;        // In the chunk's column data
+    uint32_t stored_len;    // Bytes on disk
+    uint32_t raw_len;       // Encoded bytes before compression
+    uint32_t distinct;      // Dictionary entries (ENC_DICT)
+    uint32_t reserved2;
+    uint8_t min[16];
+    uint8_t max[16];
+} ColumnChunkStats;
+
+/**
+ * @brief Rows of one chunk, column by column (uint64_t[] for COL_INT, rows x width bytes otherwise).
+ */
+typedef struct {
+    uint32_t rows;
+    void* values[COLUMNAR_MAX_COLUMNS];
+} ColumnBatch;
+
+// --- Writer ---
+
+typedef struct ColumnarWriter ColumnarWriter;
+
+/**
+ * @brief Creates an archive file and writes its header.
+ * @return ColumnarWriter* or NULL on failure.
+ */
+ColumnarWriter* columnar_writer_open(const char* path, const char* schema, const ColumnDesc* columns,
+                                     uint32_t count);
+
+/**
+ * @brief Encodes, compresses and appends one chunk.
+ * @return Bytes written, or -1 on failure.
+ */
+long columnar_writer_append(ColumnarWriter* writer, const ColumnBatch* batch);
+
+/**
+ * @brief Flushes and closes the file.
+ * @return 0 on success, -1 if a write failed.
+ */
+int columnar_writer_close(ColumnarWriter* writer);
+
+/**
+ * @brief Name of the general-purpose codec compiled in ("deflate" or "none").
+ */
+const char* columnar_codec_name(void);
+
+// --- Reader ---
+
+typedef struct ColumnarReader ColumnarReader;
+
+/**
+ * @brief One chunk as seen by a reader: its footer is loaded, its data is not.
+ */
+typedef struct {
+    uint32_t rows;
+    const ColumnChunkStats* stats;  // [columns], valid until the next columnar_next_chunk()
+    uint64_t data_offset;           // File offset of the column data
+} ColumnarChunk;
+
+/**
+ * @brief Opens an archive and reads its schema.
+ * @return ColumnarReader* or NULL if the file is missing or not an archive.
+ */
+ColumnarReader* columnar_open(const char* path);
+
+void columnar_close(ColumnarReader* reader);
+
+const char* columnar_schema(const ColumnarReader* reader);
+uint32_t columnar_column_count(const ColumnarReader* reader);
+const ColumnDesc* columnar_column(const ColumnarReader* reader, uint32_t index);
+
+/**
+ * @return Index of the column called @p name, or -1.
+ */
+int columnar_find_column(const ColumnarReader* reader, const char* name);
+
+/**
+ * @brief Loads the header and footer of the next chunk.
+ * @return 1 if a chunk was loaded, 0 at the end (or a truncated last chunk), -1 on a corrupt file.
+ */
+int columnar_next_chunk(ColumnarReader* reader, ColumnarChunk* chunk);
+
+/**
+ * @brief Reads and decodes one column of the current chunk.
+ *
+ * @param out uint64_t[rows] for COL_INT, rows x width bytes for COL_BYTES.
+ * @return 0 on success, -1 on a corrupt block.
+ */
+int columnar_read_column(ColumnarReader* reader, const ColumnarChunk* chunk, uint32_t index, void* out);
+
+/**
+ * @brief Integer bounds of a COL_INT column in a chunk footer.
+ */
+uint64_t columnar_stats_min(const ColumnChunkStats* stats);
+uint64_t columnar_stats_max(const ColumnChunkStats* stats);
+
+#endif // COLUMNAR_H
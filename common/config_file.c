@@ -0,0 +1,69 @@
+/**
+ * @file config_file.c
+ * @brief Implementation of the "key = value" configuration file reader.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <ctype.h>
+#include "config_file.h"
+
+static char* trim(char* text) {
+    while (isspace((unsigned char)*text)) text++;
+    char* end = text + strlen(text);
+    while (end > text && isspace((unsigned char)end[-1])) end--;
+    *end = '\0';
+    return text;
+}
+
+int config_file_read(const char* path, ConfigEntryFn fn, void* user) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "[ERROR] Cannot read config file %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    char line[CONFIG_MAX_LINE];
+    int number = 0;
+    int status = 0;
+
+    while (fgets(line, sizeof(line), fp)) {
+        number++;
+        if (!strchr(line, '\n') && !feof(fp)) {
+            fprintf(stderr, "[ERROR] %s:%d: line longer than %d bytes\n", path, number, CONFIG_MAX_LINE - 2);
+            status = -1;
+            break;
+        }
+
+        char* key = trim(line);
+        if (*key == '\0' || *key == '#') continue;
+
+        char* value = NULL;
+        char* equals = strchr(key, '=');
+        if (equals) {
+            *equals = '\0';
+            value = trim(equals + 1);
+            key = trim(key);
+            size_t len = strlen(value);
+            if (len >= 2 && value[0] == '"' && value[len - 1] == '"') {
+                value[len - 1] = '\0';
+                value++;
+            }
+        }
+
+        if (*key == '\0') {
+            fprintf(stderr, "[ERROR] %s:%d: missing key\n", path, number);
+            status = -1;
+            continue;
+        }
+        if (fn(key, value, user) != 0) {
+            fprintf(stderr, "[ERROR] %s:%d: invalid setting '%s'\n", path, number, key);
+            status = -1;
+        }
+    }
+
+    fclose(fp);
+    return status;
+}
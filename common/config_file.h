@@ -0,0 +1,29 @@
+/**
+ * @file config_file.h
+ * @brief Reader for "key = value" configuration files.
+ *
+ * One setting per line; blank lines and lines starting with '#' are skipped.
+ * Whitespace around keys and values is trimmed and a value may be wrapped in
+ * double quotes. A line with only a key (a flag) has a NULL value.
+ */
+
+#ifndef CONFIG_FILE_H
+#define CONFIG_FILE_H
+
+#define CONFIG_MAX_LINE 1024
+
+/**
+ * @brief Called for each setting.
+ * @return 0 to go on, -1 if the setting is invalid.
+ */
+typedef int (*ConfigEntryFn)(const char* key, const char* value, void* user);
+
+/**
+ * @brief Reads @p path and passes every setting to @p fn, in file order.
+ *
+ * Problems are reported on stderr as "path:line: ...".
+ * @return 0 if every setting was accepted, -1 if the file could not be read or a setting failed.
+ */
+int config_file_read(const char* path, ConfigEntryFn fn, void* user);
+
+#endif // CONFIG_FILE_H
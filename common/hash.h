@@ -0,0 +1,97 @@
+/**
+ * @file hash.h
+ * @brief Small, fast non-cryptographic hash used by the in-memory tables and sketches.
+ */
+
+#ifndef HASH_H
+#define HASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @brief Final avalanche step (from MurmurHash3's fmix64).
+ */
+static inline uint64_t hash_mix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/**
+ * @brief Hashes an arbitrary byte string, 8 bytes at a time.
+ *
+ * @param data Bytes to hash.
+ * @param len Number of bytes.
+ * @param seed Seed (use different seeds for independent hash functions).
+ * @return uint64_t Well-mixed 64-bit hash.
+ */
+static inline uint64_t hash_bytes(const void* data, size_t len, uint64_t seed) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint64_t h = seed ^ (len * 0x9e3779b97f4a7c15ULL);
+
+    while (len >= 8) {
+        uint64_t k;
+        memcpy(&k, p, 8);
+        h = (h ^ hash_mix64(k)) * 0x9e3779b97f4a7c15ULL;
+        p += 8;
+        len -= 8;
+    }
+
+    uint64_t tail = 0;
+    memcpy(&tail, p, len);
+    h ^= hash_mix64(tail ^ len);
+
+    return hash_mix64(h);
+}
+
+/**
+ * @brief Hashes a 5-tuple in canonical endpoint order, so both directions of a flow match.
+ *
+ * @param ip_version 4 or 6.
+ * @param protocol IP protocol.
+ * @param addr_a One endpoint's address (16 bytes, IPv4 in the first 4).
+ * @param port_a Its port.
+ * @param addr_b The other endpoint's address.
+ * @param port_b Its port.
+ * @param seed Seed (tables keyed by flow use their own).
+ * @return uint64_t Hash, never 0.
+ */
+static inline uint64_t hash_flow_key(uint8_t ip_version, uint8_t protocol,
+                                     const uint8_t* addr_a, uint16_t port_a,
+                                     const uint8_t* addr_b, uint16_t port_b, uint64_t seed) {
+    struct __attribute__((packed)) {
+        uint8_t ip_version;
+        uint8_t protocol;
+        uint16_t port_lo;
+        uint16_t port_hi;
+        uint8_t addr_lo[16];
+        uint8_t addr_hi[16];
+    } key;
+
+    memset(&key, 0, sizeof(key));
+    key.ip_version = ip_version;
+    key.protocol = protocol;
+
+    int cmp = memcmp(addr_a, addr_b, 16);
+    if (cmp < 0 || (cmp == 0 && port_a <= port_b)) {
+        memcpy(key.addr_lo, addr_a, 16);
+        memcpy(key.addr_hi, addr_b, 16);
+        key.port_lo = port_a;
+        key.port_hi = port_b;
+    } else {
+        memcpy(key.addr_lo, addr_b, 16);
+        memcpy(key.addr_hi, addr_a, 16);
+        key.port_lo = port_b;
+        key.port_hi = port_a;
+    }
+
+    uint64_t h = hash_bytes(&key, sizeof(key), seed);
+    return h ? h : 1;
+}
+
+#endif // HASH_H
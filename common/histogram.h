@@ -0,0 +1,73 @@
+/**
+ * @file histogram.h
+ * @brief Fixed-size log2 histogram for latencies (single writer, no locking).
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * @brief Buckets: bucket i holds values in [2^i, 2^(i+1)), the last one everything above.
+ */
+#define HIST_BUCKETS 24
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t buckets[HIST_BUCKETS];
+} Histogram;
+
+static inline void histogram_add(Histogram* hist, uint64_t value) {
+    int bucket = value ? 63 - __builtin_clzll(value) : 0;
+    if (bucket >= HIST_BUCKETS) bucket = HIST_BUCKETS - 1;
+
+    hist->count++;
+    hist->sum += value;
+    hist->buckets[bucket]++;
+    if (value > hist->max) hist->max = value;
+}
+
+/**
+ * @brief Upper bound of the bucket holding the given percentile, capped at the max.
+ */
+static inline uint64_t histogram_percentile(const Histogram* hist, double pct) {
+    uint64_t target = (uint64_t)(hist->count * pct / 100.0);
+    uint64_t seen = 0;
+    uint64_t bound = hist->max;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen > target) {
+            if ((1ULL << (i + 1)) < bound) bound = 1ULL << (i + 1);
+            break;
+        }
+    }
+    return bound;
+}
+
+/**
+ * @brief Appends ,"<name>_count", "<name>_us_p50/p99/max" and "<name>_us_hist" fields to a JSON object.
+ * Values are taken to be microseconds. Trailing empty buckets are left out.
+ * @return The new write position.
+ */
+static inline int histogram_append_json(char* buf, size_t cap, int pos, const char* name, const Histogram* hist) {
+    pos += snprintf(buf + pos, cap - pos,
+                    ",\"%s_count\": %llu,\"%s_us_p50\": %llu,\"%s_us_p99\": %llu,\"%s_us_max\": %llu,\"%s_us_hist\": [",
+                    name, (unsigned long long)hist->count,
+                    name, (unsigned long long)histogram_percentile(hist, 50.0),
+                    name, (unsigned long long)histogram_percentile(hist, 99.0),
+                    name, (unsigned long long)hist->max, name);
+
+    int last = HIST_BUCKETS - 1;
+    while (last >= 0 && hist->buckets[last] == 0) last--;
+    for (int i = 0; i <= last; i++) {
+        pos += snprintf(buf + pos, cap - pos, "%s%llu", i ? ", " : "", (unsigned long long)hist->buckets[i]);
+    }
+    pos += snprintf(buf + pos, cap - pos, "]");
+    return pos;
+}
+
+#endif // HISTOGRAM_H
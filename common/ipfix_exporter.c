@@ -0,0 +1,450 @@
+/**
+ * @file ipfix_exporter.c
+ * @brief Implementation of the IPFIX / NetFlow v9 exporter.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "ipfix_exporter.h"
+
+#define IPFIX_VERSION            10
+#define NETFLOW_V9_VERSION       9
+#define IPFIX_TEMPLATE_SET_ID    2
+#define NETFLOW_V9_TEMPLATE_ID   0
+#define TEMPLATE_ID_BASE         256     // + 1 for IPv6, + 2 * the extension bits below (IPFIX only)
+#define TEMPLATE_EXT_TCP         0x01    // TCP performance fields
+#define TEMPLATE_EXT_TLS         0x02    // TLS ClientHello fields
+#define TEMPLATE_EXTENSIONS      4       // Combinations of the extension bits
+#define REVERSE_PEN              29305   // RFC 5103 reverse information elements
+#define SNIFFER_PEN              32473   // Enterprise elements below (RFC 5612 example PEN: replace with your own)
+#define OBSERVATION_DOMAIN_ID    1
+
+/**
+ * @brief One field of a template.
+ */
+typedef struct {
+    uint16_t id;
+    uint16_t length;
+    uint32_t pen;           // IPFIX: enterprise number (0 = IANA element, REVERSE_PEN = RFC 5103 reverse)
+} TemplateField;
+
+// Fields that differ between the IPv4 and IPv6 templates come first
+static const TemplateField ipfix_v4_fields[] = {
+    {8, 4, 0}, {12, 4, 0},                       // source/destinationIPv4Address
+    {7, 2, 0}, {11, 2, 0}, {4, 1, 0},            // ports, protocolIdentifier
+    {6, 2, 0}, {6, 2, REVERSE_PEN},              // tcpControlBits (+ reverse)
+    {10, 4, 0},                                  // ingressInterface
+    {152, 8, 0}, {153, 8, 0},                    // flowStart/EndMilliseconds
+    {1, 8, 0}, {2, 8, 0},                        // octetDeltaCount, packetDeltaCount
+    {1, 8, REVERSE_PEN}, {2, 8, REVERSE_PEN},    // reverse counters
+    {136, 1, 0}                                  // flowEndReason
+};
+
+static const TemplateField ipfix_v6_fields[] = {
+    {27, 16, 0}, {28, 16, 0},                    // source/destinationIPv6Address
+    {7, 2, 0}, {11, 2, 0}, {4, 1, 0},
+    {6, 2, 0}, {6, 2, REVERSE_PEN},
+    {10, 4, 0},
+    {152, 8, 0}, {153, 8, 0},
+    {1, 8, 0}, {2, 8, 0},
+    {1, 8, REVERSE_PEN}, {2, 8, REVERSE_PEN},
+    {136, 1, 0}
+};
+
+// Appended for TCP flows (no standard elements exist for these measurements)
+static const TemplateField ipfix_tcp_fields[] = {
+    {1, 4, SNIFFER_PEN}, {2, 4, SNIFFER_PEN},    // handshake SYN -> SYN/ACK, SYN/ACK -> ACK (µs)
+    {3, 4, SNIFFER_PEN}, {4, 4, SNIFFER_PEN},    // RTT min, avg (µs)
+    {5, 4, SNIFFER_PEN}, {6, 4, SNIFFER_PEN},    // RTT max (µs), RTT samples
+    {7, 4, SNIFFER_PEN}, {8, 4, SNIFFER_PEN},    // retransmissions A -> B, B -> A
+    {9, 4, SNIFFER_PEN}, {10, 4, SNIFFER_PEN},   // out-of-order segments
+    {11, 4, SNIFFER_PEN}, {12, 4, SNIFFER_PEN},  // zero-window events
+    {13, 2, SNIFFER_PEN}, {14, 2, SNIFFER_PEN}   // MSS announced by A, B
+};
+
+// Appended for flows whose ClientHello was decoded (TCP or QUIC)
+static const TemplateField ipfix_tls_fields[] = {
+    {15, 2, SNIFFER_PEN},                        // highest TLS version offered
+    {16, TLS_SNI_LEN, SNIFFER_PEN},              // server name (string, NUL-padded)
+    {17, TLS_ALPN_LEN, SNIFFER_PEN},             // first ALPN protocol (string, NUL-padded)
+    {18, 16, SNIFFER_PEN},                       // JA3 MD5
+    {19, 1, SNIFFER_PEN},                        // cipher suites offered (entries used below)
+    {20, TLS_CIPHERS_MAX * 2, SNIFFER_PEN},      // cipher suites, two bytes each, zero-padded
+    {21, 1, SNIFFER_PEN},                        // extension types sent (entries used below)
+    {22, TLS_EXTENSIONS_MAX * 2, SNIFFER_PEN}    // extension types, two bytes each, zero-padded
+};
+
+static const TemplateField v9_v4_fields[] = {
+    {8, 4, 0}, {12, 4, 0},                       // IPV4_SRC_ADDR, IPV4_DST_ADDR
+    {7, 2, 0}, {11, 2, 0}, {4, 1, 0},            // L4 ports, PROTOCOL
+    {6, 1, 0},                                   // TCP_FLAGS
+    {10, 4, 0},                                  // INPUT_SNMP
+    {22, 4, 0}, {21, 4, 0},                      // FIRST/LAST_SWITCHED (sysUptime ms)
+    {1, 8, 0}, {2, 8, 0},                        // IN_BYTES, IN_PKTS
+    {23, 8, 0}, {24, 8, 0}                       // OUT_BYTES, OUT_PKTS (reverse direction)
+};
+
+static const TemplateField v9_v6_fields[] = {
+    {27, 16, 0}, {28, 16, 0},                    // IPV6_SRC_ADDR, IPV6_DST_ADDR
+    {7, 2, 0}, {11, 2, 0}, {4, 1, 0},
+    {6, 1, 0},
+    {10, 4, 0},
+    {22, 4, 0}, {21, 4, 0},
+    {1, 8, 0}, {2, 8, 0},
+    {23, 8, 0}, {24, 8, 0}
+};
+
+#define FIELD_COUNT(arr) ((int)(sizeof(arr) / sizeof((arr)[0])))
+
+// --- Exporter State (logger thread only) ---
+
+static struct {
+    int sockfd;
+    struct sockaddr_in collector;
+    FlowExportFormat format;
+
+    uint8_t buf[IPFIX_MAX_MESSAGE];
+    int len;                    // 0 = no message open
+    int set_offset;             // Offset of the open data set header (-1 = none)
+    uint16_t set_id;
+    uint16_t records;           // Records in the message (v9 header count)
+    uint32_t data_records;      // Data records in the message
+
+    uint32_t sequence;          // IPFIX: data records sent; v9: packets sent
+    time_t last_template;
+    time_t message_opened;
+    uint64_t start_ms;          // v9 sysUptime origin
+} exporter = { .sockfd = -1, .set_offset = -1 };
+
+// --- Encoding Helpers ---
+
+static void put8(uint8_t** p, uint8_t v) { *(*p)++ = v; }
+static void put16(uint8_t** p, uint16_t v) { v = htons(v); memcpy(*p, &v, 2); *p += 2; }
+static void put32(uint8_t** p, uint32_t v) { v = htonl(v); memcpy(*p, &v, 4); *p += 4; }
+static void put64(uint8_t** p, uint64_t v) {
+    put32(p, (uint32_t)(v >> 32));
+    put32(p, (uint32_t)v);
+}
+
+// Count, then a fixed-size array of big-endian values, zero-padded
+static void put_list(uint8_t** p, const uint16_t* values, uint8_t count, int cap) {
+    put8(p, count);
+    for (int i = 0; i < cap; i++) put16(p, i < count ? values[i] : 0);
+}
+
+static void fields_for(int ipv6, const TemplateField** fields, int* count) {
+    if (exporter.format == FLOW_EXPORT_IPFIX) {
+        *fields = ipv6 ? ipfix_v6_fields : ipfix_v4_fields;
+        *count = ipv6 ? FIELD_COUNT(ipfix_v6_fields) : FIELD_COUNT(ipfix_v4_fields);
+    } else {
+        *fields = ipv6 ? v9_v6_fields : v9_v4_fields;
+        *count = ipv6 ? FIELD_COUNT(v9_v6_fields) : FIELD_COUNT(v9_v4_fields);
+    }
+}
+
+// Extension fields a record carries (IPFIX only: v9 has no enterprise elements)
+static int template_extensions(const FlowRecord* rec) {
+    if (exporter.format != FLOW_EXPORT_IPFIX) return 0;
+    return (rec->key.protocol == IPPROTO_TCP ? TEMPLATE_EXT_TCP : 0) |
+           (rec->tls.version ? TEMPLATE_EXT_TLS : 0);
+}
+
+static int fields_length(const TemplateField* fields, int count) {
+    int total = 0;
+    for (int i = 0; i < count; i++) total += fields[i].length;
+    return total;
+}
+
+static int record_length(int ipv6, int ext) {
+    const TemplateField* fields;
+    int count;
+    fields_for(ipv6, &fields, &count);
+
+    int total = fields_length(fields, count);
+    if (ext & TEMPLATE_EXT_TCP) total += fields_length(ipfix_tcp_fields, FIELD_COUNT(ipfix_tcp_fields));
+    if (ext & TEMPLATE_EXT_TLS) total += fields_length(ipfix_tls_fields, FIELD_COUNT(ipfix_tls_fields));
+    return total;
+}
+
+static int header_length(void) {
+    return exporter.format == FLOW_EXPORT_IPFIX ? 16 : 20;
+}
+
+// --- Message Assembly ---
+
+static void close_set(void) {
+    if (exporter.set_offset < 0) return;
+
+    // Pad to a 4-byte boundary (mandatory for v9, allowed for IPFIX)
+    while ((exporter.len - exporter.set_offset) % 4 != 0) {
+        exporter.buf[exporter.len++] = 0;
+    }
+
+    uint8_t* p = exporter.buf + exporter.set_offset + 2;
+    put16(&p, (uint16_t)(exporter.len - exporter.set_offset));
+    exporter.set_offset = -1;
+}
+
+static void write_fields(uint8_t** p, const TemplateField* fields, int count) {
+    for (int i = 0; i < count; i++) {
+        if (fields[i].pen) {
+            put16(p, (uint16_t)(0x8000 | fields[i].id));
+            put16(p, fields[i].length);
+            put32(p, fields[i].pen);
+        } else {
+            put16(p, fields[i].id);
+            put16(p, fields[i].length);
+        }
+    }
+}
+
+static void write_templates(void) {
+    uint8_t* start = exporter.buf + exporter.len;
+    uint8_t* p = start;
+
+    put16(&p, exporter.format == FLOW_EXPORT_IPFIX ? IPFIX_TEMPLATE_SET_ID : NETFLOW_V9_TEMPLATE_ID);
+    put16(&p, 0); // Length, patched below
+
+    int variants = (exporter.format == FLOW_EXPORT_IPFIX) ? TEMPLATE_EXTENSIONS : 1;
+    for (int ext = 0; ext < variants; ext++) {
+        for (int ipv6 = 0; ipv6 <= 1; ipv6++) {
+            const TemplateField* fields;
+            int count;
+            fields_for(ipv6, &fields, &count);
+
+            int total = count;
+            if (ext & TEMPLATE_EXT_TCP) total += FIELD_COUNT(ipfix_tcp_fields);
+            if (ext & TEMPLATE_EXT_TLS) total += FIELD_COUNT(ipfix_tls_fields);
+
+            put16(&p, (uint16_t)(TEMPLATE_ID_BASE + 2 * ext + ipv6));
+            put16(&p, (uint16_t)total);
+            write_fields(&p, fields, count);
+            if (ext & TEMPLATE_EXT_TCP) write_fields(&p, ipfix_tcp_fields, FIELD_COUNT(ipfix_tcp_fields));
+            if (ext & TEMPLATE_EXT_TLS) write_fields(&p, ipfix_tls_fields, FIELD_COUNT(ipfix_tls_fields));
+            exporter.records++;
+        }
+    }
+
+    uint16_t set_len = (uint16_t)(p - start);
+    uint8_t* len_ptr = start + 2;
+    put16(&len_ptr, set_len);
+
+    exporter.len += set_len;
+    exporter.last_template = time(NULL);
+}
+
+static void open_message(void) {
+    exporter.len = header_length();
+    exporter.set_offset = -1;
+    exporter.set_id = 0;
+    exporter.records = 0;
+    exporter.data_records = 0;
+    exporter.message_opened = time(NULL);
+
+    if (exporter.last_template == 0 || time(NULL) - exporter.last_template >= IPFIX_TEMPLATE_REFRESH_SEC) {
+        write_templates();
+    }
+}
+
+void flow_exporter_flush(void) {
+    if (exporter.sockfd < 0 || exporter.len == 0) return;
+
+    close_set();
+
+    time_t now = time(NULL);
+    uint8_t* p = exporter.buf;
+
+    if (exporter.format == FLOW_EXPORT_IPFIX) {
+        put16(&p, IPFIX_VERSION);
+        put16(&p, (uint16_t)exporter.len);
+        put32(&p, (uint32_t)now);
+        put32(&p, exporter.sequence);              // Data records sent before this message
+        put32(&p, OBSERVATION_DOMAIN_ID);
+        exporter.sequence += exporter.data_records;
+    } else {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        uint64_t now_ms = (uint64_t)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000ULL;
+
+        put16(&p, NETFLOW_V9_VERSION);
+        put16(&p, exporter.records);
+        put32(&p, (uint32_t)(now_ms - exporter.start_ms)); // sysUptime
+        put32(&p, (uint32_t)now);
+        put32(&p, exporter.sequence);              // Export packets sent before this one
+        put32(&p, OBSERVATION_DOMAIN_ID);
+        exporter.sequence++;
+    }
+
+    sendto(exporter.sockfd, exporter.buf, exporter.len, 0,
+           (const struct sockaddr*)&exporter.collector, sizeof(exporter.collector));
+
+    exporter.len = 0;
+}
+
+static void write_record(uint8_t** p, const FlowRecord* rec, int ipv6, int ext) {
+    int addr_len = ipv6 ? 16 : 4;
+    memcpy(*p, rec->key.addr_a, addr_len); *p += addr_len;
+    memcpy(*p, rec->key.addr_b, addr_len); *p += addr_len;
+    put16(p, rec->key.port_a);
+    put16(p, rec->key.port_b);
+    put8(p, rec->key.protocol);
+
+    if (exporter.format == FLOW_EXPORT_IPFIX) {
+        put16(p, rec->tcp_flags[0]);
+        put16(p, rec->tcp_flags[1]);
+        put32(p, rec->if_id);
+        put64(p, rec->start_ms);
+        put64(p, rec->end_ms);
+        put64(p, rec->bytes[0]);
+        put64(p, rec->packets[0]);
+        put64(p, rec->bytes[1]);
+        put64(p, rec->packets[1]);
+        put8(p, rec->end_reason);
+
+        if (ext & TEMPLATE_EXT_TCP) {
+            const TcpPerf* tcp = &rec->tcp;
+            put32(p, tcp->syn_rtt_us);
+            put32(p, tcp->ack_rtt_us);
+            put32(p, tcp->rtt_min_us);
+            put32(p, tcp->rtt_samples ? (uint32_t)(tcp->rtt_sum_us / tcp->rtt_samples) : 0);
+            put32(p, tcp->rtt_max_us);
+            put32(p, tcp->rtt_samples);
+            put32(p, tcp->retransmissions[0]);
+            put32(p, tcp->retransmissions[1]);
+            put32(p, tcp->out_of_order[0]);
+            put32(p, tcp->out_of_order[1]);
+            put32(p, tcp->zero_window[0]);
+            put32(p, tcp->zero_window[1]);
+            put16(p, rec->tcp_mss[0]);
+            put16(p, rec->tcp_mss[1]);
+        }
+
+        if (ext & TEMPLATE_EXT_TLS) {
+            put16(p, rec->tls.version);
+            memcpy(*p, rec->tls.sni, TLS_SNI_LEN); *p += TLS_SNI_LEN;
+            memcpy(*p, rec->tls.alpn, TLS_ALPN_LEN); *p += TLS_ALPN_LEN;
+            memcpy(*p, rec->tls.ja3, sizeof(rec->tls.ja3)); *p += sizeof(rec->tls.ja3);
+            put_list(p, rec->tls.ciphers, rec->tls.cipher_count, TLS_CIPHERS_MAX);
+            put_list(p, rec->tls.extensions, rec->tls.extension_count, TLS_EXTENSIONS_MAX);
+        }
+    } else {
+        put8(p, (uint8_t)(rec->tcp_flags[0] | rec->tcp_flags[1]));
+        put32(p, rec->if_id);
+        put32(p, (uint32_t)(rec->start_ms > exporter.start_ms ? rec->start_ms - exporter.start_ms : 0));
+        put32(p, (uint32_t)(rec->end_ms > exporter.start_ms ? rec->end_ms - exporter.start_ms : 0));
+        put64(p, rec->bytes[0]);
+        put64(p, rec->packets[0]);
+        put64(p, rec->bytes[1]);
+        put64(p, rec->packets[1]);
+    }
+}
+
+// --- Public API ---
+
+int init_flow_exporter(const char* ip, int port, FlowExportFormat format) {
+    if ((exporter.sockfd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
+        perror("Flow exporter socket creation failed");
+        return -1;
+    }
+
+    memset(&exporter.collector, 0, sizeof(exporter.collector));
+    exporter.collector.sin_family = AF_INET;
+    exporter.collector.sin_port = htons(port);
+
+    if (inet_pton(AF_INET, ip, &exporter.collector.sin_addr) <= 0) {
+        perror("Invalid collector address");
+        close(exporter.sockfd);
+        exporter.sockfd = -1;
+        return -1;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    exporter.start_ms = (uint64_t)ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000ULL;
+    exporter.format = format;
+    exporter.sequence = 0;
+    exporter.last_template = 0;
+    exporter.len = 0;
+    return 0;
+}
+
+int flow_exporter_enabled(void) {
+    return exporter.sockfd >= 0;
+}
+
+int flow_exporter_set_collector(const char* ip, int port) {
+    if (exporter.sockfd < 0) return -1;
+
+    struct sockaddr_in collector;
+    memset(&collector, 0, sizeof(collector));
+    collector.sin_family = AF_INET;
+    collector.sin_port = htons(port);
+    if (inet_pton(AF_INET, ip, &collector.sin_addr) <= 0) return -1;
+
+    flow_exporter_flush();
+    exporter.collector = collector;
+    exporter.last_template = 0;
+    return 0;
+}
+
+void flow_exporter_add(const FlowRecord* rec) {
+    if (exporter.sockfd < 0) return;
+    if (rec->key.ip_version != 4 && rec->key.ip_version != 6) return;
+
+    int ipv6 = (rec->key.ip_version == 6);
+    int ext = template_extensions(rec);
+    uint16_t template_id = (uint16_t)(TEMPLATE_ID_BASE + 2 * ext + ipv6);
+    int rec_len = record_length(ipv6, ext);
+
+    if (exporter.len == 0) open_message();
+
+    // Room for the record, a new set header if needed, and worst-case padding
+    int needed = rec_len + 3 + ((exporter.set_offset >= 0 && exporter.set_id == template_id) ? 0 : 4);
+    if (exporter.len + needed > IPFIX_MAX_MESSAGE) {
+        flow_exporter_flush();
+        open_message();
+    }
+
+    if (exporter.set_offset < 0 || exporter.set_id != template_id) {
+        close_set();
+        exporter.set_offset = exporter.len;
+        exporter.set_id = template_id;
+        uint8_t* p = exporter.buf + exporter.len;
+        put16(&p, template_id);
+        put16(&p, 0); // Length, patched by close_set()
+        exporter.len += 4;
+    }
+
+    uint8_t* p = exporter.buf + exporter.len;
+    write_record(&p, rec, ipv6, ext);
+    exporter.len = (int)(p - exporter.buf);
+    exporter.records++;
+    exporter.data_records++;
+}
+
+void flow_exporter_tick(void) {
+    if (exporter.sockfd < 0) return;
+
+    time_t now = time(NULL);
+    if (exporter.len > 0 && now - exporter.message_opened >= IPFIX_FLUSH_SEC) {
+        flow_exporter_flush();
+    }
+    // Keep templates alive at the collector even when no flows expire
+    if (exporter.last_template != 0 && now - exporter.last_template >= IPFIX_TEMPLATE_REFRESH_SEC && exporter.len == 0) {
+        open_message();
+        flow_exporter_flush();
+    }
+}
+
+void close_flow_exporter(void) {
+    if (exporter.sockfd >= 0) {
+        flow_exporter_flush();
+        close(exporter.sockfd);
+        exporter.sockfd = -1;
+    }
+}
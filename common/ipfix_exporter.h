@@ -0,0 +1,84 @@
+/**
+ * @file ipfix_exporter.h
+ * @brief IPFIX (RFC 7011) / NetFlow v9 (RFC 3954) flow record exporter over UDP.
+ *
+ * Expired flow records are packed into messages of up to IPFIX_MAX_MESSAGE bytes,
+ * templates are (re)sent periodically as UDP requires, and sequence numbers follow
+ * each protocol's rules. Bidirectional counters use the RFC 5103 reverse elements.
+ *
+ * All functions except init/close are called from the logger thread only,
+ * so the exporter keeps no locks.
+ */
+
+#ifndef IPFIX_EXPORTER_H
+#define IPFIX_EXPORTER_H
+
+#include "Types.h"
+
+/**
+ * @brief Largest message sent, kept below a typical path MTU.
+ */
+#define IPFIX_MAX_MESSAGE 1400
+
+/**
+ * @brief Seconds between template retransmissions.
+ */
+#define IPFIX_TEMPLATE_REFRESH_SEC 30
+
+/**
+ * @brief Seconds a partially filled message may wait before it is sent.
+ */
+#define IPFIX_FLUSH_SEC 1
+
+/**
+ * @brief Wire format of the exporter.
+ */
+typedef enum {
+    FLOW_EXPORT_IPFIX,
+    FLOW_EXPORT_NETFLOW_V9
+} FlowExportFormat;
+
+/**
+ * @brief Opens the exporter socket towards a collector.
+ *
+ * @param ip Collector IP address.
+ * @param port Collector UDP port (4739 for IPFIX, commonly 2055 for v9).
+ * @param format Wire format.
+ * @return int 0 on success, -1 on failure.
+ */
+int init_flow_exporter(const char* ip, int port, FlowExportFormat format);
+
+/**
+ * @brief Returns 1 if an exporter has been initialized.
+ */
+int flow_exporter_enabled(void);
+
+/**
+ * @brief Sends the pending message to the old collector, then switches to a new one.
+ *
+ * Templates go out with the next message, so the new collector can decode it.
+ * @return int 0 on success, -1 on an invalid address (the old collector is kept).
+ */
+int flow_exporter_set_collector(const char* ip, int port);
+
+/**
+ * @brief Appends a flow record to the current message, sending it when full.
+ */
+void flow_exporter_add(const FlowRecord* record);
+
+/**
+ * @brief Periodic work: sends stale partial messages.
+ */
+void flow_exporter_tick(void);
+
+/**
+ * @brief Sends the pending message, if any.
+ */
+void flow_exporter_flush(void);
+
+/**
+ * @brief Flushes and closes the exporter socket.
+ */
+void close_flow_exporter(void);
+
+#endif // IPFIX_EXPORTER_H
@@ -7,23 +7,66 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <string.h>
 #include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <arpa/inet.h>
 #include "logger.h"
 #include "udp_sender.h"
+#include "ipfix_exporter.h"
+#include "mem_pool.h"
+
+// Preallocated queue nodes; bursts beyond this fall back to malloc()
+#define LOGGER_POOL_NODES 16384
 
 // --- Queue Structure ---
 typedef enum {
     LOG_TYPE_TEXT,
-    LOG_TYPE_PACKET
+    LOG_TYPE_PACKET,
+    LOG_TYPE_EVENT,
+    LOG_TYPE_FLOW,
+    LOG_TYPE_TARGET,
+    LOG_TYPE_RECORD,
+    LOG_TYPE_SUPPRESSED
 } LogType;
 
+/**
+ * @brief A new export destination, applied in queue order.
+ */
+typedef struct {
+    int flows;                  // 1 = flow collector, 0 = event target
+    char ip[64];
+    int port;
+} TargetChange;
+
+/**
+ * @brief A text message captured for formatting on the logger thread.
+ */
+typedef struct {
+    const LogSite* site;        // Format string and argument types
+    uint64_t args[LOG_MAX_ARGS]; // Integers, pointers and double bits; string offsets
+    uint16_t strings_used;
+    char strings[118];          // Copied %s arguments
+} LogRecord;
+
 typedef struct LogNode {
     LogType type;
-    char* message;          // For standard text messages
-    PacketMetadata packet;  // For network packet metadata
+    char* message;              // For standard text messages and JSON events
+    union {
+        PacketMetadata packet;  // For network packet metadata
+        FlowRecord flow;        // For expired flow records
+        TargetChange target;    // For destination changes
+        LogRecord record;       // For deferred text messages and suppression counts
+    };
     struct LogNode* next;
 } LogNode;
 
+// A deferred record must not grow the queue nodes
+_Static_assert(sizeof(LogRecord) <= sizeof(PacketMetadata), "LogRecord larger than a packet record");
+
 static LogNode* head = NULL;
 static LogNode* tail = NULL;
 
@@ -32,6 +75,70 @@ static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t queue_cond = PTHREAD_COND_INITIALIZER;
 static pthread_t logger_thread;
 static volatile int logger_running = 0;
+static atomic_size_t queue_depth = 0;
+
+// --- Node Pool (hugepage-backed, on the capture NIC's NUMA node) ---
+static MemPool node_pool;
+
+// --- Settings ---
+static int log_level = LOG_LEVEL_INFO;
+static char event_target[80] = LOGGER_DEFAULT_EVENT_IP ":5005";
+static char event_ip[64] = LOGGER_DEFAULT_EVENT_IP;
+static int event_port = LOGGER_DEFAULT_EVENT_PORT;
+static char collector_target[80] = "";
+
+// --- Call Sites ---
+
+#define SUMMARY_INTERVAL_NS 1000000000ULL
+
+enum {
+    SITE_NEW,
+    SITE_RESOLVING,             // First call in progress on another thread
+    SITE_DEFERRED,              // Arguments captured, formatted by the logger thread
+    SITE_EAGER                  // Formatted at the call site
+};
+
+typedef enum {
+    ARG_INT,
+    ARG_LONG,
+    ARG_LLONG,
+    ARG_SIZE,
+    ARG_INTMAX,
+    ARG_PTRDIFF,
+    ARG_DOUBLE,
+    ARG_PTR,
+    ARG_STRING
+} ArgType;
+
+static LogSite* sites = NULL;   // Every resolved site, for suppression summaries
+static uint64_t next_summary_ns = 0;   // Logger thread only
+
+static void print_record(const LogRecord* record);
+static void print_suppressed(const LogSite* site, uint64_t count);
+static void summarize_suppressed(void);
+
+static void enqueue(LogNode* node) {
+    pthread_mutex_lock(&queue_mutex);
+    if (tail) {
+        tail->next = node;
+        tail = node;
+    } else {
+        head = tail = node;
+    }
+    atomic_fetch_add_explicit(&queue_depth, 1, memory_order_relaxed);
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_mutex);
+}
+
+static void apply_target(const TargetChange* change) {
+    if (change->flows) {
+        flow_exporter_set_collector(change->ip, change->port);
+    } else {
+        udp_sender_set_target(change->ip, change->port);
+    }
+    printf("[INFO] %s now sent to %s:%d\n", change->flows ? "Flow records" : "Packet records and events",
+           change->ip, change->port);
+}
 
 /**
  * @brief Main loop of the Logger Thread.
@@ -41,9 +148,17 @@ static void* logger_worker(void* arg) {
     while (1) {
         pthread_mutex_lock(&queue_mutex);
 
-        // Wait for data or shutdown signal
+        // Wait for data or shutdown signal, waking up periodically for exporter timers
         while (head == NULL && logger_running) {
-            pthread_cond_wait(&queue_cond, &queue_mutex);
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += 1;
+            if (pthread_cond_timedwait(&queue_cond, &queue_mutex, &deadline) != 0) {
+                pthread_mutex_unlock(&queue_mutex);
+                flow_exporter_tick();
+                summarize_suppressed();
+                pthread_mutex_lock(&queue_mutex);
+            }
         }
 
         // Exit if shutdown requested and queue is empty
@@ -58,6 +173,7 @@ static void* logger_worker(void* arg) {
         if (head == NULL) {
             tail = NULL;
         }
+        atomic_fetch_sub_explicit(&queue_depth, 1, memory_order_relaxed);
 
         pthread_mutex_unlock(&queue_mutex);
 
@@ -69,8 +185,24 @@ static void* logger_worker(void* arg) {
             } else if (node->type == LOG_TYPE_PACKET) {
                 // Call function from udp_sender.c
                 send_udp_metadata(&node->packet);
+            } else if (node->type == LOG_TYPE_EVENT) {
+                send_udp_json(node->message);
+                free(node->message);
+            } else if (node->type == LOG_TYPE_FLOW) {
+                flow_exporter_add(&node->flow);
+            } else if (node->type == LOG_TYPE_TARGET) {
+                apply_target(&node->target);
+            } else if (node->type == LOG_TYPE_RECORD) {
+                print_record(&node->record);
+            } else if (node->type == LOG_TYPE_SUPPRESSED) {
+                print_suppressed(node->record.site, node->record.args[0]);
             }
-            free(node);
+            mem_pool_free(&node_pool, node);
+        }
+        if (logger_queue_depth() == 0) {
+            // Caught up: send the partial batch rather than hold records back
+            udp_sender_flush();
+            summarize_suppressed();
         }
     }
     return NULL;
@@ -80,13 +212,21 @@ void init_logger() {
     if (logger_running) return;
     
     // Initialize UDP sender
-    init_udp_sender("127.0.0.1", 5005);
+    init_udp_sender(event_ip, event_port);
+
+    int pooled = (mem_pool_init(&node_pool, sizeof(LogNode), LOGGER_POOL_NODES, numa_default_node()) == 0);
 
     logger_running = 1;
     if (pthread_create(&logger_thread, NULL, logger_worker, NULL) != 0) {
         perror("Failed to create logger thread");
         exit(1);
     }
+
+    if (pooled) {
+        char placement[128];
+        log_message("[INFO] Logger node pool: %zu nodes, %s\n", node_pool.capacity,
+                    mem_region_describe(&node_pool.region, placement, sizeof(placement)));
+    }
 }
 
 void cleanup_logger() {
@@ -96,30 +236,271 @@ void cleanup_logger() {
     pthread_mutex_unlock(&queue_mutex);
 
     pthread_join(logger_thread, NULL);
+    next_summary_ns = 0;
+    summarize_suppressed();
     close_udp_sender();
+    close_flow_exporter(); // Flushes the last partial message
+    mem_pool_destroy(&node_pool);
+
 }
 
-void log_message(const char* fmt, ...) {
-    if (!logger_running) return;
+// --- Levels ---
 
-    va_list args;
-    
-    // Calculate message size
-    va_start(args, fmt);
-    int size = vsnprintf(NULL, 0, fmt, args);
-    va_end(args);
+static const char* const level_names[] = { "error", "warn", "info", "debug" };
+
+int parse_log_level(const char* name, LogLevel* level) {
+    for (int i = 0; i <= LOG_LEVEL_DEBUG; i++) {
+        if (strcmp(name, level_names[i]) == 0) {
+            *level = (LogLevel)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char* log_level_name(LogLevel level) {
+    return (level >= LOG_LEVEL_ERROR && level <= LOG_LEVEL_DEBUG) ? level_names[level] : "?";
+}
+
+void logger_set_level(LogLevel level) {
+    __atomic_store_n(&log_level, (int)level, __ATOMIC_RELAXED);
+}
+
+LogLevel logger_level(void) {
+    return (LogLevel)__atomic_load_n(&log_level, __ATOMIC_RELAXED);
+}
+
+// --- Destinations ---
+
+static int queue_target(int flows, const char* ip, int port) {
+    struct in_addr addr;
+    if (port <= 0 || port > 65535 || strlen(ip) >= sizeof(((TargetChange*)0)->ip) ||
+        inet_pton(AF_INET, ip, &addr) != 1) {
+        return -1;
+    }
+
+    char* target = flows ? collector_target : event_target;
+    snprintf(target, sizeof(event_target), "%s:%d", ip, port);
+    if (!logger_running) {
+        if (!flows) {
+            snprintf(event_ip, sizeof(event_ip), "%s", ip);
+            event_port = port;
+        }
+        return 0;
+    }
+
+    LogNode* node = (LogNode*)mem_pool_alloc(&node_pool);
+    if (!node) return -1;
+    node->type = LOG_TYPE_TARGET;
+    node->message = NULL;
+    node->next = NULL;
+    node->target.flows = flows;
+    snprintf(node->target.ip, sizeof(node->target.ip), "%s", ip);
+    node->target.port = port;
+    enqueue(node);
+    return 0;
+}
+
+int logger_set_event_target(const char* ip, int port) {
+    return queue_target(0, ip, port);
+}
+
+int logger_set_flow_collector(const char* ip, int port) {
+    return queue_target(1, ip, port);
+}
+
+void logger_targets(char* events, size_t events_len, char* collector, size_t collector_len) {
+    snprintf(events, events_len, "%s", event_target);
+    snprintf(collector, collector_len, "%s", collector_target);
+}
+
+// --- Producers ---
 
+static uint64_t coarse_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Lists the arguments a format consumes.
+ * @return Argument count, or -1 if the format cannot be deferred.
+ */
+static int scan_format(const char* fmt, uint8_t* types) {
+    int count = 0;
+    for (const char* p = fmt; *p; p++) {
+        if (*p != '%') continue;
+        p++;
+        if (*p == '%') continue;
+
+        while (*p && strchr("-+ #0'", *p)) p++;
+        if (*p == '*') {
+            if (count == LOG_MAX_ARGS) return -1;
+            types[count++] = ARG_INT;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9') p++;
+        if (*p == '.') {
+            p++;
+            if (*p == '*') {
+                if (count == LOG_MAX_ARGS) return -1;
+                types[count++] = ARG_INT;
+                p++;
+            }
+            while (*p >= '0' && *p <= '9') p++;
+        }
+
+        ArgType integer = ARG_INT;
+        int long_double = 0, wide = 0;
+        if (*p == 'h') {
+            p += (p[1] == 'h') ? 2 : 1;
+        } else if (*p == 'l') {
+            integer = (p[1] == 'l') ? ARG_LLONG : ARG_LONG;
+            wide = (p[1] != 'l');
+            p += (p[1] == 'l') ? 2 : 1;
+        } else if (*p == 'z') {
+            integer = ARG_SIZE;
+            p++;
+        } else if (*p == 'j') {
+            integer = ARG_INTMAX;
+            p++;
+        } else if (*p == 't') {
+            integer = ARG_PTRDIFF;
+            p++;
+        } else if (*p == 'L' || *p == 'q') {
+            integer = ARG_LLONG;
+            long_double = 1;
+            p++;
+        }
+
+        if (count == LOG_MAX_ARGS || *p == '\0') return -1;
+        switch (*p) {
+            case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+                types[count++] = integer;
+                break;
+            case 'c':
+                if (wide) return -1;
+                types[count++] = ARG_INT;
+                break;
+            case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+                if (long_double) return -1;
+                types[count++] = ARG_DOUBLE;
+                break;
+            case 's':
+                if (wide) return -1;
+                types[count++] = ARG_STRING;
+                break;
+            case 'p':
+                types[count++] = ARG_PTR;
+                break;
+            default:
+                return -1;      // %n, %m, wide characters, unknown
+        }
+    }
+    return count;
+}
+
+// The tag at the start of the format string is the level
+static LogLevel message_level(const char* fmt) {
+    if (fmt[0] != '[') return LOG_LEVEL_INFO;
+    if (strncmp(fmt, "[ERROR]", 7) == 0) return LOG_LEVEL_ERROR;
+    if (strncmp(fmt, "[WARN]", 6) == 0) return LOG_LEVEL_WARN;
+    if (strncmp(fmt, "[DEBUG]", 7) == 0 || strncmp(fmt, "[HEX]", 5) == 0) return LOG_LEVEL_DEBUG;
+    return LOG_LEVEL_INFO;
+}
+
+// First call of a site: one thread parses the format and registers the site
+static int resolve_site(LogSite* site, const char* fmt) {
+    int state = __atomic_load_n(&site->state, __ATOMIC_ACQUIRE);
+    if (state != SITE_NEW) return state;
+
+    int expected = SITE_NEW;
+    if (!__atomic_compare_exchange_n(&site->state, &expected, SITE_RESOLVING, 0, __ATOMIC_ACQ_REL,
+                                     __ATOMIC_ACQUIRE)) {
+        return expected;
+    }
+
+    site->fmt = fmt;
+    if (site->level == LOG_LEVEL_TAGGED) {
+        __atomic_store_n(&site->level, (int)message_level(fmt), __ATOMIC_RELAXED);
+    }
+    int count = scan_format(fmt, site->arg_types);
+    site->arg_count = (uint8_t)(count < 0 ? 0 : count);
+
+    site->next = __atomic_load_n(&sites, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&sites, &site->next, site, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+
+    state = (count < 0) ? SITE_EAGER : SITE_DEFERRED;
+    __atomic_store_n(&site->state, state, __ATOMIC_RELEASE);
+    return state;
+}
+
+// Token bucket as GCRA: one CAS on the theoretical arrival time of the next message
+static int site_admit(LogSite* site) {
+    if (site->per_sec == 0) return 1;
+
+    uint64_t now = coarse_now_ns();
+    uint64_t interval = 1000000000ULL / site->per_sec;
+    uint64_t tolerance = interval * (site->burst ? site->burst : 1);
+    uint64_t tat = __atomic_load_n(&site->tat_ns, __ATOMIC_RELAXED);
+    uint64_t next;
+    do {
+        uint64_t base = (tat > now) ? tat : now;
+        if (base + interval > now + tolerance) {
+            __atomic_fetch_add(&site->suppressed, 1, __ATOMIC_RELAXED);
+            return 0;
+        }
+        next = base + interval;
+    } while (!__atomic_compare_exchange_n(&site->tat_ns, &tat, next, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return 1;
+}
+
+// Copies the arguments into a record; 0 if a string does not fit
+static int capture_args(const LogSite* site, LogRecord* record, va_list args) {
+    record->site = site;
+    record->strings_used = 0;
+    for (int i = 0; i < site->arg_count; i++) {
+        switch (site->arg_types[i]) {
+            case ARG_INT:     record->args[i] = (uint64_t)(int64_t)va_arg(args, int); break;
+            case ARG_LONG:    record->args[i] = (uint64_t)va_arg(args, long); break;
+            case ARG_LLONG:   record->args[i] = (uint64_t)va_arg(args, long long); break;
+            case ARG_SIZE:    record->args[i] = (uint64_t)va_arg(args, size_t); break;
+            case ARG_INTMAX:  record->args[i] = (uint64_t)va_arg(args, intmax_t); break;
+            case ARG_PTRDIFF: record->args[i] = (uint64_t)va_arg(args, ptrdiff_t); break;
+            case ARG_PTR:     record->args[i] = (uint64_t)(uintptr_t)va_arg(args, void*); break;
+            case ARG_DOUBLE: {
+                double value = va_arg(args, double);
+                memcpy(&record->args[i], &value, sizeof(value));
+                break;
+            }
+            case ARG_STRING: {
+                const char* str = va_arg(args, const char*);
+                if (!str) str = "(null)";
+                size_t len = strlen(str) + 1;
+                if (record->strings_used + len > sizeof(record->strings)) return 0;
+                memcpy(record->strings + record->strings_used, str, len);
+                record->args[i] = record->strings_used;
+                record->strings_used += (uint16_t)len;
+                break;
+            }
+        }
+    }
+    return 1;
+}
+
+static void queue_text(const char* fmt, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    int size = vsnprintf(NULL, 0, fmt, copy);
+    va_end(copy);
     if (size < 0) return;
 
     char* buffer = (char*)malloc(size + 1);
     if (!buffer) return;
-
-    va_start(args, fmt);
     vsnprintf(buffer, size + 1, fmt, args);
-    va_end(args);
 
-    // Create new node
-    LogNode* node = (LogNode*)malloc(sizeof(LogNode));
+    LogNode* node = (LogNode*)mem_pool_alloc(&node_pool);
     if (!node) {
         free(buffer);
         return;
@@ -128,22 +509,169 @@ void log_message(const char* fmt, ...) {
     node->message = buffer;
     node->next = NULL;
 
-    // Add to queue
-    pthread_mutex_lock(&queue_mutex);
-    if (tail) {
-        tail->next = node;
-        tail = node;
-    } else {
-        head = tail = node;
+    enqueue(node);
+}
+
+// Reports what the bucket dropped ahead of the next admitted message
+static void queue_suppressed(LogSite* site) {
+    uint64_t count = __atomic_exchange_n(&site->suppressed, 0, __ATOMIC_RELAXED);
+    if (count == 0) return;
+
+    LogNode* node = (LogNode*)mem_pool_alloc(&node_pool);
+    if (!node) {
+        __atomic_fetch_add(&site->suppressed, count, __ATOMIC_RELAXED);
+        return;
+    }
+    node->type = LOG_TYPE_SUPPRESSED;
+    node->message = NULL;
+    node->next = NULL;
+    node->record.site = site;
+    node->record.args[0] = count;
+    enqueue(node);
+}
+
+void log_site_message(LogSite* site, const char* fmt, ...) {
+    if (!logger_running) {
+        // Before init_logger() (flow exporter, runtime config) or after cleanup: print at once
+        int level = __atomic_load_n(&site->level, __ATOMIC_RELAXED);
+        if (level == LOG_LEVEL_TAGGED) level = (int)message_level(fmt);
+        if (level > LOG_COMPILE_LEVEL || level > (int)logger_level()) return;
+        va_list args;
+        va_start(args, fmt);
+        vfprintf(stderr, fmt, args);
+        va_end(args);
+        return;
+    }
+
+    int state = resolve_site(site, fmt);
+    int level = __atomic_load_n(&site->level, __ATOMIC_RELAXED);
+    if (level == LOG_LEVEL_TAGGED) level = (int)message_level(fmt);   // Still resolving
+    if (level > LOG_COMPILE_LEVEL || level > (int)logger_level()) return;
+    if (state == SITE_RESOLVING) {
+        state = SITE_EAGER;
+    } else if (!site_admit(site)) {
+        return;
+    } else if (__atomic_load_n(&site->suppressed, __ATOMIC_RELAXED)) {
+        queue_suppressed(site);
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    if (state == SITE_DEFERRED) {
+        LogNode* node = (LogNode*)mem_pool_alloc(&node_pool);
+        if (!node) {
+            va_end(args);
+            return;
+        }
+        va_list capture;
+        va_copy(capture, args);
+        int captured = capture_args(site, &node->record, capture);
+        va_end(capture);
+        if (captured) {
+            node->type = LOG_TYPE_RECORD;
+            node->message = NULL;
+            node->next = NULL;
+            enqueue(node);
+            va_end(args);
+            return;
+        }
+        mem_pool_free(&node_pool, node);
+    }
+    queue_text(fmt, args);
+    va_end(args);
+}
+
+// --- Deferred Formatting (logger thread) ---
+
+static void print_record(const LogRecord* record) {
+    const LogSite* site = record->site;
+    const char* fmt = site->fmt;
+    char out[2048];
+    size_t used = 0;
+    int arg = 0;
+
+    for (const char* p = fmt; *p && used < sizeof(out) - 1; ) {
+        if (*p != '%' || p[1] == '%') {
+            out[used++] = *p;
+            p += (*p == '%') ? 2 : 1;
+            continue;
+        }
+
+        // Copy one conversion spec and format it with its own arguments
+        const char* start = p++;
+        int stars[2];
+        int star_count = 0;
+        while (*p && !strchr("diouxXcsSeEfFgGaAp", *p)) {
+            if (*p == '*') stars[star_count++] = (int)(int64_t)record->args[arg++];
+            p++;
+        }
+        char spec[32];
+        size_t spec_len = (size_t)(p - start) + 1;
+        if (spec_len >= sizeof(spec)) break;
+        memcpy(spec, start, spec_len);
+        spec[spec_len] = '\0';
+        p++;
+
+        char* dst = out + used;
+        size_t room = sizeof(out) - used;
+        uint64_t raw = record->args[arg];
+        int written = 0;
+
+#define FORMAT_ARG(value) \
+        (star_count == 0 ? snprintf(dst, room, spec, value) : \
+         star_count == 1 ? snprintf(dst, room, spec, stars[0], value) : \
+                           snprintf(dst, room, spec, stars[0], stars[1], value))
+
+        switch (site->arg_types[arg]) {
+            case ARG_INT:     written = FORMAT_ARG((int)(int64_t)raw); break;
+            case ARG_LONG:    written = FORMAT_ARG((long)raw); break;
+            case ARG_LLONG:   written = FORMAT_ARG((long long)raw); break;
+            case ARG_SIZE:    written = FORMAT_ARG((size_t)raw); break;
+            case ARG_INTMAX:  written = FORMAT_ARG((intmax_t)raw); break;
+            case ARG_PTRDIFF: written = FORMAT_ARG((ptrdiff_t)raw); break;
+            case ARG_PTR:     written = FORMAT_ARG((void*)(uintptr_t)raw); break;
+            case ARG_STRING:  written = FORMAT_ARG(record->strings + raw); break;
+            case ARG_DOUBLE: {
+                double value;
+                memcpy(&value, &raw, sizeof(value));
+                written = FORMAT_ARG(value);
+                break;
+            }
+        }
+#undef FORMAT_ARG
+        arg++;
+        if (written < 0) break;
+        used += ((size_t)written < room) ? (size_t)written : room - 1;
+    }
+    out[used] = '\0';
+    printf("%s", out);
+}
+
+static void print_suppressed(const LogSite* site, uint64_t count) {
+    // First line of the format, without leading newlines
+    const char* text = site->fmt;
+    while (*text == '\n') text++;
+    int len = (int)strcspn(text, "\n");
+    printf("[WARN] Log: %llu more \"%.*s\" messages suppressed\n", (unsigned long long)count,
+           len > 80 ? 80 : len, text);
+}
+
+// Once a second with the queue drained: counts of sites that went quiet after being limited
+static void summarize_suppressed(void) {
+    uint64_t now = coarse_now_ns();
+    if (now < next_summary_ns) return;
+    next_summary_ns = now + SUMMARY_INTERVAL_NS;
+
+    for (LogSite* site = __atomic_load_n(&sites, __ATOMIC_ACQUIRE); site; site = site->next) {
+        uint64_t count = __atomic_exchange_n(&site->suppressed, 0, __ATOMIC_RELAXED);
+        if (count) print_suppressed(site, count);
     }
-    pthread_cond_signal(&queue_cond);
-    pthread_mutex_unlock(&queue_mutex);
 }
 
 void log_packet(const PacketMetadata* meta) {
     if (!logger_running) return;
 
-    LogNode* node = (LogNode*)malloc(sizeof(LogNode));
+    LogNode* node = (LogNode*)mem_pool_alloc(&node_pool);
     if (!node) return;
 
     node->type = LOG_TYPE_PACKET;
@@ -151,14 +679,41 @@ void log_packet(const PacketMetadata* meta) {
     node->message = NULL;
     node->next = NULL;
 
-    // Add to queue
-    pthread_mutex_lock(&queue_mutex);
-    if (tail) {
-        tail->next = node;
-        tail = node;
-    } else {
-        head = tail = node;
+    enqueue(node);
+}
+
+void log_event(const char* json) {
+    if (!logger_running) return;
+
+    char* copy = strdup(json);
+    if (!copy) return;
+
+    LogNode* node = (LogNode*)mem_pool_alloc(&node_pool);
+    if (!node) {
+        free(copy);
+        return;
     }
-    pthread_cond_signal(&queue_cond);
-    pthread_mutex_unlock(&queue_mutex);
-}
\ No newline at end of file
+    node->type = LOG_TYPE_EVENT;
+    node->message = copy;
+    node->next = NULL;
+
+    enqueue(node);
+}
+
+size_t logger_queue_depth(void) {
+    return atomic_load_explicit(&queue_depth, memory_order_relaxed);
+}
+
+void log_flow(const FlowRecord* record) {
+    if (!logger_running) return;
+
+    LogNode* node = (LogNode*)mem_pool_alloc(&node_pool);
+    if (!node) return;
+
+    node->type = LOG_TYPE_FLOW;
+    node->flow = *record; // Copy data
+    node->message = NULL;
+    node->next = NULL;
+
+    enqueue(node);
+}
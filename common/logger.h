@@ -6,13 +6,33 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include "Types.h"
 
+/**
+ * @brief Default destination of the packet records and JSON events.
+ */
+#define LOGGER_DEFAULT_EVENT_IP   "127.0.0.1"
+#define LOGGER_DEFAULT_EVENT_PORT 5005
+
+/**
+ * @brief Text log verbosity. A message's level comes from its tag:
+ * "[ERROR]", "[WARN]", "[DEBUG]" / "[HEX]"; anything else is info.
+ */
+typedef enum {
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_DEBUG
+} LogLevel;
+
 /**
  * @brief Initializes the logger thread and UDP sender.
  * 
  * Starts a background thread that consumes messages from the log queue
- * and prints them to stdout. Also initializes UDP sender.
+ * and prints them to stdout. Also initializes UDP sender towards the event
+ * target (LOGGER_DEFAULT_EVENT_IP:PORT unless logger_set_event_target() was called).
  */
 void init_logger();
 
@@ -24,14 +44,145 @@ void init_logger();
 void cleanup_logger();
 
 /**
- * @brief Logs a formatted message to the queue (Text logging).
- * 
- * This function is thread-safe and non-blocking.
- * 
- * @param fmt Format string (printf-style).
+ * @brief Parses "error", "warn", "info" or "debug".
+ * @return 0 on success, -1 on an unknown name.
+ */
+int parse_log_level(const char* name, LogLevel* level);
+
+const char* log_level_name(LogLevel level);
+
+/**
+ * @brief Sets the most verbose level printed (any thread, takes effect at once).
+ */
+void logger_set_level(LogLevel level);
+
+LogLevel logger_level(void);
+
+/**
+ * @brief Points packet records and JSON events at a new UDP destination.
+ *
+ * Before init_logger() this only sets the address it opens. Afterwards the
+ * change is queued behind the records already waiting, so every record goes to
+ * the target that was current when it was logged.
+ *
+ * @return 0 on success, -1 on an invalid address or port.
+ */
+int logger_set_event_target(const char* ip, int port);
+
+/**
+ * @brief Points the flow exporter at a new collector, queued like logger_set_event_target().
+ *
+ * Also records the startup collector when called before init_logger().
+ * @return 0 on success, -1 on an invalid address or port.
+ */
+int logger_set_flow_collector(const char* ip, int port);
+
+/**
+ * @brief Current destinations as "IP:PORT" ("" for no flow collector).
+ *
+ * Only consistent on the thread that sets them (main, then the control thread).
+ */
+void logger_targets(char* events, size_t events_len, char* collector, size_t collector_len);
+
+// --- Text Logging ---
+
+/**
+ * @brief Most verbose level compiled in (set with -DSNIFFER_LOG_FLOOR=...).
+ *
+ * log_at() / log_limited() call sites below it are removed by the compiler.
+ */
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#define LOG_LEVEL_TAGGED    -1      // Level taken from the format string's tag
+#define LOG_MAX_ARGS        16      // More arguments are formatted at the call site
+
+// Default budget of every call site: sustained messages per second and burst
+#define LOG_DEFAULT_RATE    50
+#define LOG_DEFAULT_BURST   200
+
+/**
+ * @brief Per-call-site state, one static instance per log_message() / log_at() / log_limited().
+ *
+ * Holds the site's token bucket and, after the first call, its format string
+ * and the argument types parsed from it. Internal to the logging macros.
+ */
+typedef struct LogSite {
+    int level;                      // LogLevel, or LOG_LEVEL_TAGGED until the first call
+    uint32_t per_sec;               // Token refill rate (0 = unlimited)
+    uint32_t burst;                 // Bucket depth
+    int state;                      // Resolution state (logger.c)
+    const char* fmt;
+    uint8_t arg_count;
+    uint8_t arg_types[LOG_MAX_ARGS];
+    uint64_t tat_ns;                // Token bucket as GCRA theoretical arrival time
+    uint64_t suppressed;            // Dropped by the bucket since the last summary
+    struct LogSite* next;           // Registered sites (summaries)
+} LogSite;
+
+/**
+ * @brief Logs through a call site (use the macros below).
+ *
+ * Thread-safe and non-blocking. Before init_logger() messages go straight to
+ * stderr, so startup errors are not lost. Messages above the current level are dropped
+ * first, then messages beyond the site's rate. The format pointer and the raw
+ * arguments are queued as a fixed binary record (strings copied) and formatted
+ * by the logger thread. Formats with unsupported conversions (%n, long double,
+ * wide strings), more than LOG_MAX_ARGS arguments or long strings are
+ * formatted at the call site instead. Once a second the logger prints how
+ * many messages each site suppressed.
+ *
+ * @param fmt Format string literal (printf-style); it must outlive the logger.
+ */
+void log_site_message(LogSite* site, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Logs at an explicit level and rate: at most @p depth messages at once, @p rate per second sustained.
+ */
+#define log_limited(lvl, rate, depth, ...) do { \
+    if ((lvl) <= LOG_COMPILE_LEVEL) { \
+        static LogSite log_site_ = { .level = (lvl), .per_sec = (rate), .burst = (depth) }; \
+        log_site_message(&log_site_, __VA_ARGS__); \
+    } \
+} while (0)
+
+/**
+ * @brief Logs at an explicit level with the default rate.
+ */
+#define log_at(lvl, ...) log_limited(lvl, LOG_DEFAULT_RATE, LOG_DEFAULT_BURST, __VA_ARGS__)
+
+/**
+ * @brief Level of a format string literal's tag, folded by the compiler (see message_level() in logger.c).
+ */
+#define LOG_TAG_LEVEL(f) \
+    ((f)[0] == '[' && (f)[1] == 'E' && (f)[2] == 'R' && (f)[3] == 'R' && (f)[4] == 'O' && (f)[5] == 'R' && \
+     (f)[6] == ']' ? LOG_LEVEL_ERROR : \
+     (f)[0] == '[' && (f)[1] == 'W' && (f)[2] == 'A' && (f)[3] == 'R' && (f)[4] == 'N' && (f)[5] == ']' \
+     ? LOG_LEVEL_WARN : \
+     (f)[0] == '[' && (f)[1] == 'D' && (f)[2] == 'E' && (f)[3] == 'B' && (f)[4] == 'U' && (f)[5] == 'G' && \
+     (f)[6] == ']' ? LOG_LEVEL_DEBUG : \
+     (f)[0] == '[' && (f)[1] == 'H' && (f)[2] == 'E' && (f)[3] == 'X' && (f)[4] == ']' ? LOG_LEVEL_DEBUG : \
+     LOG_LEVEL_INFO)
+
+#define LOG_FORMAT_(fmt, ...) (fmt)
+
+/**
+ * @brief Logs a formatted message, its level taken from the tag ("[WARN] ...").
+ *
+ * The tag is read at compile time, so messages below the compiled-in floor
+ * are removed like log_at() ones, arguments included.
+ *
+ * @param fmt Format string literal (printf-style).
  * @param ... Arguments for the format string.
  */
-void log_message(const char* fmt, ...);
+#define log_message(...) do { \
+    if (LOG_TAG_LEVEL(LOG_FORMAT_(__VA_ARGS__, 0)) <= LOG_COMPILE_LEVEL) { \
+        static LogSite log_site_ = { .level = LOG_LEVEL_TAGGED, .per_sec = LOG_DEFAULT_RATE, \
+                                     .burst = LOG_DEFAULT_BURST }; \
+        log_site_message(&log_site_, __VA_ARGS__); \
+    } \
+} while (0)
 
 /**
  * @brief Logs a packet metadata struct via UDP.
@@ -44,4 +195,28 @@ void log_message(const char* fmt, ...);
  */
 void log_packet(const PacketMetadata* meta);
 
+/**
+ * @brief Queues a pre-formatted JSON event (stats snapshot, alert, ...) for export.
+ *
+ * Events are low-volume and share the packet export stream, so consumers can
+ * tell them apart by their "event" key.
+ *
+ * @param json NUL-terminated JSON object (copied).
+ */
+void log_event(const char* json);
+
+/**
+ * @brief Queues an expired flow record for the flow exporter (IPFIX / NetFlow v9).
+ *
+ * @param record Pointer to the flow record (copied).
+ */
+void log_flow(const FlowRecord* record);
+
+/**
+ * @brief Returns the number of records waiting in the export queue.
+ *
+ * Lock-free read, used as a back-pressure signal by the capture path.
+ */
+size_t logger_queue_depth(void);
+
 #endif // LOGGER_H
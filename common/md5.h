@@ -0,0 +1,24 @@
+/**
+ * @file md5.h
+ * @brief MD5 (RFC 1321), for fingerprints that are published as MD5 digests (JA3).
+ *
+ * Not for anything security related.
+ */
+
+#ifndef MD5_H
+#define MD5_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    uint32_t state[4];
+    uint64_t length;            // Bytes hashed so far
+    uint8_t block[64];          // Partial block
+} Md5Context;
+
+void md5_init(Md5Context* ctx);
+void md5_update(Md5Context* ctx, const void* data, size_t len);
+void md5_final(Md5Context* ctx, uint8_t digest[16]);
+
+#endif // MD5_H
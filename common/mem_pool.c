@@ -0,0 +1,264 @@
+/**
+ * @file mem_pool.c
+ * @brief Implementation of hugepage regions, NUMA placement and object pools.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include "mem_pool.h"
+
+#define HUGEPAGE_SIZE   (2UL * 1024 * 1024)
+#define MAX_NUMA_NODES  64
+
+static int default_node = NUMA_NODE_ANY;
+
+// --- NUMA Topology ---
+
+static int read_int_file(const char* path, int fallback) {
+    FILE* f = fopen(path, "r");
+    if (!f) return fallback;
+    int value = fallback;
+    if (fscanf(f, "%d", &value) != 1) value = fallback;
+    fclose(f);
+    return value;
+}
+
+int numa_node_count(void) {
+    DIR* dir = opendir("/sys/devices/system/node");
+    if (!dir) return 1;
+
+    int count = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+            count++;
+        }
+    }
+    closedir(dir);
+    return count > 0 ? count : 1;
+}
+
+int numa_node_of_interface(const char* iface_name) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/class/net/%s/device/numa_node", iface_name);
+    int node = read_int_file(path, NUMA_NODE_ANY);
+    return node >= 0 ? node : NUMA_NODE_ANY;
+}
+
+int numa_node_of_address(const void* addr) {
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, NULL, 0, addr, MPOL_F_NODE | MPOL_F_ADDR) != 0) {
+        return -1;
+    }
+    return node;
+}
+
+static int set_thread_policy(int mode, int node) {
+    unsigned long mask = 0;
+    if (node >= 0) {
+        if (node >= MAX_NUMA_NODES) return -1;
+        mask = 1UL << node;
+        return (int)syscall(SYS_set_mempolicy, mode, &mask, MAX_NUMA_NODES + 1);
+    }
+    return (int)syscall(SYS_set_mempolicy, MPOL_DEFAULT, NULL, 0);
+}
+
+void numa_prefer_node(int node) {
+    set_thread_policy(MPOL_PREFERRED, node);
+}
+
+int numa_bind_thread(int node) {
+    if (node < 0) return -1;
+
+    char path[96];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+
+    char list[512];
+    if (!fgets(list, sizeof(list), f)) {
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    // Parse "0-3,8-11"
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    char* save = NULL;
+    for (char* tok = strtok_r(list, ",\n", &save); tok; tok = strtok_r(NULL, ",\n", &save)) {
+        int lo, hi;
+        int n = sscanf(tok, "%d-%d", &lo, &hi);
+        if (n == 1) hi = lo;
+        if (n < 1) continue;
+        for (int cpu = lo; cpu <= hi && cpu < CPU_SETSIZE; cpu++) CPU_SET(cpu, &cpus);
+    }
+
+    if (CPU_COUNT(&cpus) == 0 || sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+        return -1;
+    }
+    return set_thread_policy(MPOL_PREFERRED, node);
+}
+
+void numa_set_default_node(int node) {
+    default_node = node;
+}
+
+int numa_default_node(void) {
+    return default_node;
+}
+
+// --- Regions ---
+
+// AnonHugePages of the mapping holding @p addr: what the kernel actually backed with THP
+static size_t mapping_thp_bytes(const void* addr) {
+    FILE* f = fopen("/proc/self/smaps", "r");
+    if (!f) return 0;
+
+    char line[256];
+    int inside = 0;
+    size_t kb = 0;
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long start, end;
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+            if (inside) break; // Next mapping: the field was missing
+            inside = (uintptr_t)addr >= start && (uintptr_t)addr < end;
+        } else if (inside && sscanf(line, "AnonHugePages: %zu kB", &kb) == 1) {
+            break;
+        }
+    }
+    fclose(f);
+    return kb * 1024;
+}
+
+int mem_region_alloc(MemRegion* region, size_t size, int node) {
+    memset(region, 0, sizeof(*region));
+    size = (size + HUGEPAGE_SIZE - 1) & ~(HUGEPAGE_SIZE - 1);
+
+    // 1. Explicit hugepages (only succeeds if the admin reserved some)
+    void* base = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    region->pages = MEM_PAGES_HUGETLB;
+
+    // 2. Otherwise normal pages, asking for transparent hugepages
+    if (base == MAP_FAILED) {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) return -1;
+        region->pages = (madvise(base, size, MADV_HUGEPAGE) == 0) ? MEM_PAGES_THP_ADVISED : MEM_PAGES_SMALL;
+    }
+
+    // 3. Bind before the first touch so pages are allocated on the right node
+    region->node_requested = NUMA_NODE_ANY;
+    if (node >= 0 && node < MAX_NUMA_NODES) {
+        unsigned long mask = 1UL << node;
+        if (syscall(SYS_mbind, base, size, MPOL_PREFERRED, &mask, MAX_NUMA_NODES + 1, 0) == 0) {
+            region->node_requested = node;
+        }
+    }
+
+    // 4. Prefault so the fast path never takes a page fault
+    long page = sysconf(_SC_PAGESIZE);
+    for (size_t off = 0; off < size; off += (size_t)page) {
+        ((volatile char*)base)[off] = 0;
+    }
+
+    // 5. The advice is only a hint: check what the kernel granted
+    if (region->pages == MEM_PAGES_THP_ADVISED) {
+        region->thp_bytes = mapping_thp_bytes(base);
+        if (region->thp_bytes > size) region->thp_bytes = size; // Merged with a neighbouring mapping
+        if (region->thp_bytes > 0) region->pages = MEM_PAGES_THP;
+    }
+
+    region->base = base;
+    region->size = size;
+    region->node_actual = numa_node_of_address(base);
+    return 0;
+}
+
+void mem_region_free(MemRegion* region) {
+    if (region->base) {
+        munmap(region->base, region->size);
+        region->base = NULL;
+    }
+}
+
+const char* mem_region_describe(const MemRegion* region, char* buf, size_t len) {
+    static const char* kinds[] = { "4 KB pages", "4 KB pages (thp-advised, none granted)",
+                                   "transparent hugepages", "2 MB hugepages" };
+    char granted[48] = "";
+    if (region->pages == MEM_PAGES_THP && region->thp_bytes < region->size) {
+        snprintf(granted, sizeof(granted), " (%zu KB granted)", region->thp_bytes / 1024);
+    }
+    snprintf(buf, len, "%zu KB on %s%s, node %d%s", region->size / 1024, kinds[region->pages], granted,
+             region->node_actual, region->node_requested >= 0 ? " (bound)" : "");
+    return buf;
+}
+
+// --- Object Pools ---
+
+int mem_pool_init(MemPool* pool, size_t obj_size, size_t count, int node) {
+    memset(pool, 0, sizeof(*pool));
+
+    // Keep objects pointer-aligned and large enough to hold the free-list link
+    obj_size = (obj_size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    if (obj_size < sizeof(void*)) obj_size = sizeof(void*);
+
+    // A pool whose region failed still works, as a thin wrapper around malloc()
+    pool->obj_size = obj_size;
+    pthread_mutex_init(&pool->lock, NULL);
+
+    if (mem_region_alloc(&pool->region, obj_size * count, node) != 0) {
+        return -1;
+    }
+    pool->capacity = pool->region.size / obj_size;
+
+    // Thread every slot onto the free list, lowest address first
+    char* base = (char*)pool->region.base;
+    for (size_t i = pool->capacity; i-- > 0;) {
+        void* obj = base + i * obj_size;
+        *(void**)obj = pool->free_list;
+        pool->free_list = obj;
+    }
+    return 0;
+}
+
+void* mem_pool_alloc(MemPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    void* obj = pool->free_list;
+    if (obj) pool->free_list = *(void**)obj;
+    pthread_mutex_unlock(&pool->lock);
+
+    return obj ? obj : malloc(pool->obj_size);
+}
+
+void mem_pool_free(MemPool* pool, void* obj) {
+    if (!obj) return;
+
+    char* base = (char*)pool->region.base;
+    if (!base || (char*)obj < base || (char*)obj >= base + pool->region.size) {
+        free(obj); // Overflow allocation
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    *(void**)obj = pool->free_list;
+    pool->free_list = obj;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void mem_pool_destroy(MemPool* pool) {
+    if (pool->obj_size == 0) return;
+    pthread_mutex_destroy(&pool->lock);
+    mem_region_free(&pool->region);
+    pool->free_list = NULL;
+    pool->obj_size = 0;
+}
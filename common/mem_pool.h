@@ -0,0 +1,124 @@
+/**
+ * @file mem_pool.h
+ * @brief Hugepage-backed, NUMA-aware memory regions and fixed-size object pools.
+ *
+ * Regions try explicit hugepages (hugetlbfs) first, then transparent hugepages,
+ * then normal pages, and are bound to a NUMA node when one is given. The
+ * placement that was actually obtained is recorded so it can be reported;
+ * transparent hugepages count only once /proc/self/smaps shows them.
+ */
+
+#ifndef MEM_POOL_H
+#define MEM_POOL_H
+
+#include <stddef.h>
+#include <pthread.h>
+
+/**
+ * @brief "No preference": allocate wherever the kernel decides.
+ */
+#define NUMA_NODE_ANY (-1)
+
+/**
+ * @brief Kind of pages backing a region.
+ */
+typedef enum {
+    MEM_PAGES_SMALL,        // Base pages (4 KB)
+    MEM_PAGES_THP_ADVISED,  // Transparent hugepages requested with madvise(), none granted
+    MEM_PAGES_THP,          // Transparent hugepages granted (AnonHugePages in smaps)
+    MEM_PAGES_HUGETLB       // Explicit 2 MB hugepages from the reserved pool
+} MemPageKind;
+
+/**
+ * @brief An anonymous memory mapping and where it ended up.
+ */
+typedef struct {
+    void* base;
+    size_t size;
+    MemPageKind pages;
+    size_t thp_bytes;       // Bytes the kernel backed with transparent hugepages
+    int node_requested;     // NUMA_NODE_ANY or the node it was bound to
+    int node_actual;        // Node of the first page after prefaulting (-1 if unknown)
+} MemRegion;
+
+/**
+ * @brief Fixed-size object pool carved from one region.
+ *
+ * Thread-safe. When the pool is empty it falls back to malloc(), and objects
+ * that did not come from the region are released with free().
+ */
+typedef struct {
+    MemRegion region;
+    size_t obj_size;
+    size_t capacity;
+    void* free_list;
+    pthread_mutex_t lock;
+} MemPool;
+
+// --- NUMA Topology ---
+
+/**
+ * @brief Number of online NUMA nodes (1 on non-NUMA systems).
+ */
+int numa_node_count(void);
+
+/**
+ * @brief NUMA node the interface's device is attached to, or NUMA_NODE_ANY (virtual devices).
+ */
+int numa_node_of_interface(const char* iface_name);
+
+/**
+ * @brief NUMA node currently backing the page at @p addr, or -1 if unknown.
+ */
+int numa_node_of_address(const void* addr);
+
+/**
+ * @brief Pins the calling thread to the CPUs of @p node and prefers its memory.
+ * @return 0 on success, -1 on failure.
+ */
+int numa_bind_thread(int node);
+
+/**
+ * @brief Makes the calling thread's future page allocations (including kernel
+ * allocations made on its behalf) prefer @p node. NUMA_NODE_ANY restores the default.
+ */
+void numa_prefer_node(int node);
+
+/**
+ * @brief Process-wide default node for regions and pools (set from the first NIC).
+ */
+void numa_set_default_node(int node);
+int numa_default_node(void);
+
+// --- Regions ---
+
+/**
+ * @brief Maps a zeroed, prefaulted region of at least @p size bytes.
+ * @param node NUMA node to bind to, or NUMA_NODE_ANY.
+ * @return 0 on success, -1 on failure.
+ */
+int mem_region_alloc(MemRegion* region, size_t size, int node);
+
+/**
+ * @brief Unmaps a region (safe on a zeroed, never-allocated region).
+ */
+void mem_region_free(MemRegion* region);
+
+/**
+ * @brief Formats "8 MB on 2 MB hugepages, node 0" into @p buf.
+ */
+const char* mem_region_describe(const MemRegion* region, char* buf, size_t len);
+
+// --- Object Pools ---
+
+/**
+ * @brief Creates a pool of @p count objects of @p obj_size bytes.
+ * @return 0 on success, -1 on failure.
+ */
+int mem_pool_init(MemPool* pool, size_t obj_size, size_t count, int node);
+
+void* mem_pool_alloc(MemPool* pool);
+void mem_pool_free(MemPool* pool, void* obj);
+void mem_pool_destroy(MemPool* pool);
+
+#endif // MEM_POOL_H
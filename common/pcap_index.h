@@ -0,0 +1,82 @@
+/**
+ * @file pcap_index.h
+ * @brief On-disk layout of recorded pcap segments and their sidecar indexes.
+ *
+ * Segments are plain pcap files (nanosecond timestamps), readable by any tool.
+ * When a segment is closed, "<segment>.idx" is written next to it:
+ *
+ *   PcapIndexHeader
+ *   uint32_t bucket_offsets[buckets]   File offset of the first record of each time bucket
+ *   PcapIndexFlow flows[flows]         Sorted by hash
+ *   uint32_t refs[packets]             Record offsets grouped by flow, in capture order
+ *
+ * A time range maps to a starting offset through the bucket table, and a flow
+ * to its own list of record offsets through a binary search, so a query reads
+ * only the records it returns. Offsets are 32-bit: segments stay below 4 GB.
+ * All integers are little-endian (the index is mapped as is on the host).
+ */
+
+#ifndef PCAP_INDEX_H
+#define PCAP_INDEX_H
+
+#include <stdint.h>
+
+// --- pcap ---
+
+#define PCAP_MAGIC_NSEC        0xa1b23c4du
+#define PCAP_LINKTYPE_ETHERNET 1
+#define PCAP_LINKTYPE_RADIOTAP 127
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t linktype;
+} PcapFileHeader;
+
+typedef struct {
+    uint32_t ts_sec;
+    uint32_t ts_nsec;
+    uint32_t incl_len;
+    uint32_t orig_len;
+} PcapRecordHeader;
+
+// --- Index ---
+
+#define PCAP_INDEX_MAGIC      "SNIFIDX1"
+#define PCAP_INDEX_VERSION    1
+#define PCAP_INDEX_SUFFIX     ".idx"
+#define PCAP_INDEX_FLOW_SEED  0x52454344u   // hash_flow_key() seed of PcapIndexFlow.hash
+
+/**
+ * @brief Largest segment the 32-bit offsets can address.
+ */
+#define PCAP_SEGMENT_MAX_BYTES 0xFFFFFFFFull
+
+typedef struct {
+    char magic[8];              // PCAP_INDEX_MAGIC
+    uint32_t version;
+    uint32_t linktype;          // Of the segment
+    uint64_t first_ts_ns;       // Capture times covered
+    uint64_t last_ts_ns;
+    uint64_t base_ts_ns;        // Start of time bucket 0
+    uint32_t bucket_ms;
+    uint32_t buckets;
+    uint32_t flows;
+    uint32_t packets;
+    uint32_t bucket_table;      // File offsets of the tables
+    uint32_t flow_table;
+    uint32_t ref_table;
+    uint32_t reserved;
+} PcapIndexHeader;
+
+typedef struct {
+    uint64_t hash;              // hash_flow_key(..., PCAP_INDEX_FLOW_SEED); 0 = not IP
+    uint32_t first_ref;         // Index into refs[]
+    uint32_t count;
+} PcapIndexFlow;
+
+#endif // PCAP_INDEX_H
@@ -7,6 +7,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <endian.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
 #include "udp_sender.h"
@@ -15,6 +16,38 @@
 static int sockfd = -1;
 static struct sockaddr_in server_addr;
 
+// --- Binary Batches (logger thread only) ---
+static RecordFormat record_format = RECORD_FORMAT_JSON;
+static unsigned char batch[EXPORT_BATCH_MAX];
+static uint16_t batch_count = 0;
+static uint32_t batch_sequence = 0;
+
+#define BATCH_CAPACITY ((EXPORT_BATCH_MAX - sizeof(ExportBatchHeader)) / sizeof(ExportRecord))
+
+// The dashboard decodes these with a fixed numpy dtype
+_Static_assert(sizeof(ExportBatchHeader) == 16 && sizeof(ExportRecord) == 108,
+               "export layout changed: update python/data_listener.py");
+
+static const char* const proto_names[] = {
+    "Other", "802.11", "ARP", "TCP", "UDP", "ICMP", "IGMP", "IPv4", "ICMPv6", "IPv6"
+};
+static const char* const subtype_names[] = { "", "PROBE_REQ", "DATA", "EAPOL", "BEACON" };
+
+int parse_record_format(const char* name, RecordFormat* format) {
+    if (strcmp(name, "json") == 0) {
+        *format = RECORD_FORMAT_JSON;
+    } else if (strcmp(name, "binary") == 0) {
+        *format = RECORD_FORMAT_BINARY;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+void udp_sender_set_format(RecordFormat format) {
+    record_format = format;
+}
+
 int init_udp_sender(const char* ip, int port) 
 {
     if ((sockfd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
@@ -22,11 +55,7 @@ int init_udp_sender(const char* ip, int port)
         return -1;
     }
 
-    memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(port);
-    
-    if (inet_pton(AF_INET, ip, &server_addr.sin_addr) <= 0) {
+    if (udp_sender_set_target(ip, port) != 0) {
         perror("Invalid address/ Address not supported");
         return -1;
     }
@@ -34,49 +63,129 @@ int init_udp_sender(const char* ip, int port)
     return 0;
 }
 
+int udp_sender_set_target(const char* ip, int port)
+{
+    udp_sender_flush();
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+
+    if (inet_pton(AF_INET, ip, &addr.sin_addr) <= 0) {
+        return -1;
+    }
+
+    server_addr = addr;
+    return 0;
+}
+
+static RecordProto record_proto(const PacketMetadata* meta)
+{
+    if (meta->is_monitor_mode) return REC_PROTO_80211;
+
+    switch (meta->ether_type) {
+        case 0x0806:
+            return REC_PROTO_ARP;
+        case 0x0800: // IPv4
+            if (meta->l3_protocol == 6) return REC_PROTO_TCP;
+            if (meta->l3_protocol == 17) return REC_PROTO_UDP;
+            if (meta->l3_protocol == 1) return REC_PROTO_ICMP;
+            if (meta->l3_protocol == 2) return REC_PROTO_IGMP;
+            return REC_PROTO_IPV4;
+        case 0x86DD: // IPv6
+            if (meta->l3_protocol == 6) return REC_PROTO_TCP;
+            if (meta->l3_protocol == 17) return REC_PROTO_UDP;
+            if (meta->l3_protocol == 58) return REC_PROTO_ICMPV6;
+            return REC_PROTO_IPV6;
+        default:
+            return REC_PROTO_OTHER;
+    }
+}
+
+// Determine Subtype based on SSID (simple heuristic based on parser output)
+static RecordSubtype record_subtype(const PacketMetadata* meta)
+{
+    if (!meta->is_monitor_mode) return REC_SUBTYPE_NONE;
+
+    if (strcmp(meta->ssid, "[BROADCAST]") == 0) return REC_SUBTYPE_PROBE_REQ;
+    if (strcmp(meta->ssid, "[Encrypted Data]") == 0) return REC_SUBTYPE_DATA;
+    if (strcmp(meta->ssid, "[HANDSHAKE]") == 0) return REC_SUBTYPE_EAPOL;
+    // Case where SSID is not BROADCAST but it is still PROBE (rare, but for safety)
+    if (strncmp(meta->ssid, "PROBE", 5) == 0) return REC_SUBTYPE_PROBE_REQ;
+    // Default: Beacon
+    return REC_SUBTYPE_BEACON;
+}
+
+void udp_sender_flush(void)
+{
+    if (batch_count == 0) {
+        return;
+    }
+
+    ExportBatchHeader* header = (ExportBatchHeader*)batch;
+    header->magic = htole32(EXPORT_BATCH_MAGIC);
+    header->version = EXPORT_BATCH_VERSION;
+    header->reserved = 0;
+    header->count = htole16(batch_count);
+    header->record_size = htole16(sizeof(ExportRecord));
+    header->reserved2 = 0;
+    header->sequence = htole32(batch_sequence++);
+
+    if (sockfd >= 0) {
+        sendto(sockfd, batch, sizeof(ExportBatchHeader) + batch_count * sizeof(ExportRecord), 0,
+               (const struct sockaddr *)&server_addr, sizeof(server_addr));
+    }
+    batch_count = 0;
+}
+
+static void append_record(const PacketMetadata* meta)
+{
+    ExportRecord* record = (ExportRecord*)(batch + sizeof(ExportBatchHeader)) + batch_count;
+
+    record->timestamp_ns = htole64(meta->timestamp_ns);
+    memcpy(record->src_addr, meta->src_addr, sizeof(record->src_addr));
+    memcpy(record->dest_addr, meta->dest_addr, sizeof(record->dest_addr));
+    memcpy(record->src_mac, meta->src_mac, sizeof(record->src_mac));
+    memcpy(record->dest_mac, meta->dest_mac, sizeof(record->dest_mac));
+    record->size = htole32((uint32_t)meta->packet_size);
+    record->sampling_rate = htole32(meta->sampling_rate);
+    record->src_port = htole16(meta->src_port);
+    record->dest_port = htole16(meta->dest_port);
+    record->ether_type = htole16(meta->ether_type);
+    record->channel = htole16((uint16_t)meta->channel);
+    record->ip_version = meta->ip_version;
+    record->l3_protocol = meta->l3_protocol;
+    record->tcp_flags = meta->tcp_flags;
+    record->csum_flags = meta->csum_flags;
+    record->if_id = meta->if_id;
+    record->proto = (uint8_t)record_proto(meta);
+    record->subtype = (uint8_t)record_subtype(meta);
+    record->signal_dbm = meta->signal_dbm;
+    size_t ssid_len = strnlen(meta->ssid, sizeof(record->ssid));
+    memcpy(record->ssid, meta->ssid, ssid_len);
+    memset(record->ssid + ssid_len, 0, sizeof(record->ssid) - ssid_len);
+
+    if (++batch_count == BATCH_CAPACITY) {
+        udp_sender_flush();
+    }
+}
+
 void send_udp_metadata(const PacketMetadata* meta) 
 {
     if (sockfd < 0){
         return;
     }
 
-    // 1. Determine main protocol
-    const char* proto_str = "Other";
-    char subtype_str[20] = ""; 
-
-    if (meta->is_monitor_mode) {
-        proto_str = "802.11";
-        
-        // Determine Subtype based on SSID (simple heuristic based on parser output)
-        if (strcmp(meta->ssid, "[BROADCAST]") == 0) {
-            strcpy(subtype_str, "PROBE_REQ");
-        } else if (strcmp(meta->ssid, "[Encrypted Data]") == 0) {
-            strcpy(subtype_str, "DATA");
-        } else if (strcmp(meta->ssid, "[HANDSHAKE]") == 0) {
-            strcpy(subtype_str, "EAPOL");
-        } else if (strncmp(meta->ssid, "PROBE", 5) == 0) {
-             // Case where SSID is not BROADCAST but it is still PROBE (rare, but for safety)
-             strcpy(subtype_str, "PROBE_REQ");
-        } else {
-            // Default: Beacon
-            strcpy(subtype_str, "BEACON");
-        }
-
-    } else if (meta->ether_type == 0x0806) {
-        proto_str = "ARP";
-    } else if (meta->ether_type == 0x0800) { // IPv4
-        if (meta->l3_protocol == 6) proto_str = "TCP";
-        else if (meta->l3_protocol == 17) proto_str = "UDP";
-        else if (meta->l3_protocol == 1) proto_str = "ICMP";
-        else if (meta->l3_protocol == 2) proto_str = "IGMP";
-        else proto_str = "IPv4";
-    } else if (meta->ether_type == 0x86DD) { // IPv6
-        if (meta->l3_protocol == 6) proto_str = "TCP";
-        else if (meta->l3_protocol == 17) proto_str = "UDP";
-        else if (meta->l3_protocol == 58) proto_str = "ICMPv6";
-        else proto_str = "IPv6";
+    if (record_format == RECORD_FORMAT_BINARY) {
+        append_record(meta);
+        return;
     }
 
+    // 1. Determine main protocol
+    const char* proto_str = proto_names[record_proto(meta)];
+    const char* subtype_str = subtype_names[record_subtype(meta)];
+
     // 2. Construct JSON
     char json_buffer[4096];
     snprintf(json_buffer, sizeof(json_buffer), 
@@ -94,7 +203,10 @@ void send_udp_metadata(const PacketMetadata* meta)
         "\"is_monitor\": %d,"
         "\"signal_dbm\": %d,"
         "\"channel\": %d,"
-        "\"ssid\": \"%s\""
+        "\"ssid\": \"%s\","
+        "\"if_id\": %d,"
+        "\"sampling_rate\": %u,"
+        "\"csum_flags\": %u"
         "}",
         meta->src_mac[0], meta->src_mac[1], meta->src_mac[2], meta->src_mac[3], meta->src_mac[4], meta->src_mac[5],
         meta->dest_mac[0], meta->dest_mac[1], meta->dest_mac[2], meta->dest_mac[3], meta->dest_mac[4], meta->dest_mac[5],
@@ -109,7 +221,10 @@ void send_udp_metadata(const PacketMetadata* meta)
         meta->is_monitor_mode,
         meta->signal_dbm,
         meta->channel,
-        meta->ssid
+        meta->ssid,
+        meta->if_id,
+        meta->sampling_rate,
+        meta->csum_flags
     );
 
     // 3. Send
@@ -117,8 +232,22 @@ void send_udp_metadata(const PacketMetadata* meta)
            (const struct sockaddr *)&server_addr, sizeof(server_addr));
 }
 
+void send_udp_json(const char* json)
+{
+    if (sockfd < 0){
+        return;
+    }
+
+    // Records logged before the event go out first
+    udp_sender_flush();
+
+    sendto(sockfd, json, strlen(json), 0, 
+           (const struct sockaddr *)&server_addr, sizeof(server_addr));
+}
+
 void close_udp_sender() 
 {
+    udp_sender_flush();
     if (sockfd >= 0) {
         close(sockfd);
         sockfd = -1;
@@ -1,13 +1,107 @@
 /**
  * @file udp_sender.h
  * @brief UDP communication for sending packet metadata.
+ *
+ * Packet records go out as one JSON object per datagram, or as fixed-size
+ * binary records batched into datagrams of up to EXPORT_BATCH_MAX bytes:
+ *
+ *   ExportBatchHeader
+ *   ExportRecord[count]
+ *
+ * A batch is sent when it is full, when the export queue runs empty, and
+ * before any JSON event, so records and events keep their order. All integers
+ * are little-endian. python/data_listener.py mirrors this layout.
  */
 
 #ifndef UDP_SENDER_H
 #define UDP_SENDER_H
 
+#include <stdint.h>
 #include "Types.h"
 
+/**
+ * @brief Wire format of the packet records (events are always JSON).
+ */
+typedef enum {
+    RECORD_FORMAT_JSON,
+    RECORD_FORMAT_BINARY
+} RecordFormat;
+
+#define EXPORT_BATCH_MAGIC    0x31425053u   // "SPB1"
+#define EXPORT_BATCH_VERSION  1
+#define EXPORT_BATCH_MAX      1472          // Largest datagram that fits an Ethernet MTU
+
+/**
+ * @brief Protocol of a record, as named by the JSON "type" key.
+ */
+typedef enum {
+    REC_PROTO_OTHER,
+    REC_PROTO_80211,
+    REC_PROTO_ARP,
+    REC_PROTO_TCP,
+    REC_PROTO_UDP,
+    REC_PROTO_ICMP,
+    REC_PROTO_IGMP,
+    REC_PROTO_IPV4,
+    REC_PROTO_ICMPV6,
+    REC_PROTO_IPV6
+} RecordProto;
+
+/**
+ * @brief 802.11 frame kind, as named by the JSON "subtype" key.
+ */
+typedef enum {
+    REC_SUBTYPE_NONE,
+    REC_SUBTYPE_PROBE_REQ,
+    REC_SUBTYPE_DATA,
+    REC_SUBTYPE_EAPOL,
+    REC_SUBTYPE_BEACON
+} RecordSubtype;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;             // EXPORT_BATCH_MAGIC
+    uint8_t version;            // EXPORT_BATCH_VERSION
+    uint8_t reserved;
+    uint16_t count;             // Records in this datagram
+    uint16_t record_size;       // sizeof(ExportRecord); readers skip fields added later
+    uint16_t reserved2;
+    uint32_t sequence;          // Batch number; a gap is a lost datagram
+} ExportBatchHeader;
+
+typedef struct __attribute__((packed)) {
+    uint64_t timestamp_ns;      // Capture time (ns since epoch)
+    uint8_t src_addr[16];       // IPv4 uses the first 4 bytes
+    uint8_t dest_addr[16];
+    uint8_t src_mac[6];
+    uint8_t dest_mac[6];
+    uint32_t size;              // Frame length on the wire
+    uint32_t sampling_rate;
+    uint16_t src_port;
+    uint16_t dest_port;
+    uint16_t ether_type;
+    uint16_t channel;
+    uint8_t ip_version;         // 4, 6 or 0 (no IP header)
+    uint8_t l3_protocol;
+    uint8_t tcp_flags;
+    uint8_t csum_flags;
+    uint8_t if_id;
+    uint8_t proto;              // RecordProto
+    uint8_t subtype;            // RecordSubtype
+    int8_t signal_dbm;
+    char ssid[32];              // NUL-padded
+} ExportRecord;
+
+/**
+ * @brief Parses "json" or "binary".
+ * @return 0 on success, -1 on an unknown name.
+ */
+int parse_record_format(const char* name, RecordFormat* format);
+
+/**
+ * @brief Selects the packet record format (before init_logger()).
+ */
+void udp_sender_set_format(RecordFormat format);
+
 /**
  * @brief Initializes the UDP socket for sending logs.
  * 
@@ -17,15 +111,38 @@
  */
 int init_udp_sender(const char* ip, int port);
 
+/**
+ * @brief Changes the destination of later sends (logger thread, or before init).
+ *
+ * A pending batch goes to the old destination first.
+ *
+ * @return int 0 on success, -1 on an invalid address.
+ */
+int udp_sender_set_target(const char* ip, int port);
+
 /**
  * @brief Sends the packet metadata struct over UDP.
  * 
+ * In binary format the record is appended to the pending batch.
+ *
  * @param meta Pointer to the metadata struct.
  */
 void send_udp_metadata(const PacketMetadata* meta);
 
 /**
- * @brief Closes the UDP socket.
+ * @brief Sends the pending batch of binary records, if any.
+ */
+void udp_sender_flush(void);
+
+/**
+ * @brief Sends a pre-formatted JSON event over UDP.
+ *
+ * @param json NUL-terminated JSON object.
+ */
+void send_udp_json(const char* json);
+
+/**
+ * @brief Sends the pending batch and closes the UDP socket.
  */
 void close_udp_sender();
 
@@ -0,0 +1,22 @@
+/**
+ * @file captureBackend.c
+ * @brief Registry of the available capture backends.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "captureBackend.h"
+
+static const CaptureBackend* const backends[] = {
+    &mmap_capture_backend,
+    &xdp_capture_backend,
+};
+
+const CaptureBackend* find_capture_backend(const char* name) {
+    for (size_t i = 0; i < sizeof(backends) / sizeof(backends[0]); i++) {
+        if (strcmp(backends[i]->name, name) == 0) {
+            return backends[i];
+        }
+    }
+    return NULL;
+}
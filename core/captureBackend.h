@@ -0,0 +1,64 @@
+/**
+ * @file captureBackend.h
+ * @brief Pluggable capture backends (AF_PACKET mmap ring, AF_XDP).
+ *
+ * A backend owns the socket and its receive ring. The capture loop in
+ * mmapSniffer.c only waits on the backend's file descriptor and asks it to
+ * drain frames, which every backend hands to process_packet() in batches.
+ */
+
+#ifndef CAPTURE_BACKEND_H
+#define CAPTURE_BACKEND_H
+
+#include <stdint.h>
+
+struct CaptureSource;
+
+/**
+ * @brief Operations implemented by a capture backend.
+ */
+typedef struct CaptureBackend {
+    const char* name;
+
+    /**
+     * @brief Opens the source: creates the socket and its ring.
+     * On success src->sock_fd is a pollable descriptor; on failure everything is released.
+     * @return 0 on success, -1 on failure.
+     */
+    int (*open)(struct CaptureSource* src);
+
+    /**
+     * @brief Passes up to @p budget received frames to process_packet().
+     * @param first_ts_ns Output: kernel timestamp of the first frame, or 0 if the backend has none.
+     * @return Number of frames processed.
+     */
+    int (*rx_burst)(struct CaptureSource* src, int budget, uint64_t* first_ts_ns);
+
+    /**
+     * @brief Share of the receive ring holding frames not yet processed.
+     * @return 0-100 (optional: NULL if the backend cannot tell).
+     */
+    int (*occupancy)(struct CaptureSource* src);
+
+    /**
+     * @brief Frames the kernel dropped for this socket since the previous call.
+     * @return Drop count (optional: NULL if the backend cannot tell).
+     */
+    uint64_t (*drops)(struct CaptureSource* src);
+
+    /**
+     * @brief Releases the ring and closes the socket.
+     */
+    void (*close)(struct CaptureSource* src);
+} CaptureBackend;
+
+extern const CaptureBackend mmap_capture_backend;
+extern const CaptureBackend xdp_capture_backend;
+
+/**
+ * @brief Looks a backend up by name ("mmap" or "xdp").
+ * @return The backend, or NULL if unknown.
+ */
+const CaptureBackend* find_capture_backend(const char* name);
+
+#endif // CAPTURE_BACKEND_H
@@ -0,0 +1,131 @@
+/**
+ * @file checksumVerify.c
+ * @brief Implementation of the checksum verification stage.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <netinet/in.h>
+#include "checksumVerify.h"
+#include "checksum.h"
+#include "logger.h"
+
+#define IPV4_FLAG_MF      0x2000
+#define IPV4_FRAG_OFFSET  0x1FFF
+
+// Sum of the pseudo header (RFC 793 / RFC 8200 8.1), chained in front of the segment
+static uint64_t pseudo_header_sum(const PacketMetadata* meta, uint32_t l4_len) {
+    uint8_t tail[8] = { 0 };
+    uint64_t acc;
+
+    if (meta->ip_version == 4) {
+        acc = csum_partial(meta->src_addr, 4, 0);
+        acc = csum_partial(meta->dest_addr, 4, acc);
+        tail[1] = meta->l3_protocol;
+        tail[2] = (uint8_t)(l4_len >> 8);
+        tail[3] = (uint8_t)l4_len;
+        return csum_partial(tail, 4, acc);
+    }
+
+    acc = csum_partial(meta->src_addr, 16, 0);
+    acc = csum_partial(meta->dest_addr, 16, acc);
+    tail[0] = (uint8_t)(l4_len >> 24);
+    tail[1] = (uint8_t)(l4_len >> 16);
+    tail[2] = (uint8_t)(l4_len >> 8);
+    tail[3] = (uint8_t)l4_len;
+    tail[7] = meta->l3_protocol;
+    return csum_partial(tail, 8, acc);
+}
+
+static void verify_transport(ChecksumStats* stats, PacketMetadata* meta, const unsigned char* frame,
+                             int size, uint32_t capture_flags) {
+    int is_tcp = (meta->l3_protocol == IPPROTO_TCP);
+    if (!is_tcp && meta->l3_protocol != IPPROTO_UDP) return;
+
+    if (capture_flags & CAPTURE_CSUM_NOT_READY) {
+        meta->csum_flags |= CSUM_L4_SKIPPED;
+        stats->offload_pending++;
+        return;
+    }
+    if (capture_flags & CAPTURE_CSUM_VALID) {
+        meta->csum_flags |= CSUM_L4_OK;
+        stats->kernel_valid++;
+        return;
+    }
+
+    const unsigned char* ip = frame + meta->l3_offset;
+    uint32_t ip_header_len = (uint32_t)(meta->l4_offset - meta->l3_offset);
+    uint32_t l4_len = meta->ip_length > ip_header_len ? meta->ip_length - ip_header_len : 0;
+    int truncated = meta->l4_offset + l4_len > (uint32_t)size || l4_len < (is_tcp ? 20u : 8u);
+
+    // Fragments are covered by one checksum over the reassembled datagram
+    int fragment = meta->ip_version == 4 && (((ip[6] << 8) | ip[7]) & (IPV4_FLAG_MF | IPV4_FRAG_OFFSET));
+
+    // UDP may omit its checksum (IPv4, and IPv6 tunnels per RFC 6935)
+    const unsigned char* l4 = frame + meta->l4_offset;
+    int no_checksum = !is_tcp && !truncated && l4[6] == 0 && l4[7] == 0;
+
+    if (truncated || fragment || no_checksum) {
+        meta->csum_flags |= CSUM_L4_SKIPPED;
+        stats->unverifiable++;
+        return;
+    }
+
+    uint64_t acc = csum_partial(l4, l4_len, pseudo_header_sum(meta, l4_len));
+    int ok = csum_fold(acc) == 0xFFFF;
+    meta->csum_flags |= ok ? CSUM_L4_OK : CSUM_L4_BAD;
+
+    if (is_tcp) {
+        stats->tcp_checked++;
+        if (!ok) stats->tcp_bad++;
+    } else {
+        stats->udp_checked++;
+        if (!ok) stats->udp_bad++;
+    }
+}
+
+void checksum_verify(ChecksumStats* stats, PacketMetadata* meta, const unsigned char* frame, int size,
+                     uint32_t capture_flags) {
+    if (meta->ip_version != 4 && meta->ip_version != 6) return;
+
+    // IPv6 has no header checksum
+    if (meta->ip_version == 4) {
+        const unsigned char* ip = frame + meta->l3_offset;
+        uint32_t ihl = (uint32_t)(ip[0] & 0x0F) * 4;
+        if (ihl >= 20 && meta->l3_offset + ihl <= (uint32_t)size) {
+            int ok = csum_fold(csum_partial(ip, ihl, 0)) == 0xFFFF;
+            meta->csum_flags |= ok ? CSUM_IP_OK : CSUM_IP_BAD;
+            stats->ip_checked++;
+            if (!ok) stats->ip_bad++;
+        }
+    }
+
+    if (meta->l4_offset) {
+        verify_transport(stats, meta, frame, size, capture_flags);
+    }
+}
+
+void checksum_stats_publish(ChecksumStats* stats, int if_id) {
+    char json[512];
+    snprintf(json, sizeof(json),
+        "{\"event\": \"checksums\","
+        "\"if_id\": %d,"
+        "\"ip_checked\": %llu,"
+        "\"ip_bad\": %llu,"
+        "\"tcp_checked\": %llu,"
+        "\"tcp_bad\": %llu,"
+        "\"udp_checked\": %llu,"
+        "\"udp_bad\": %llu,"
+        "\"kernel_valid\": %llu,"
+        "\"offload_pending\": %llu,"
+        "\"unverifiable\": %llu}",
+        if_id,
+        (unsigned long long)stats->ip_checked, (unsigned long long)stats->ip_bad,
+        (unsigned long long)stats->tcp_checked, (unsigned long long)stats->tcp_bad,
+        (unsigned long long)stats->udp_checked, (unsigned long long)stats->udp_bad,
+        (unsigned long long)stats->kernel_valid, (unsigned long long)stats->offload_pending,
+        (unsigned long long)stats->unverifiable);
+    log_event(json);
+
+    memset(stats, 0, sizeof(*stats));
+}
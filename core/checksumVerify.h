@@ -0,0 +1,54 @@
+/**
+ * @file checksumVerify.h
+ * @brief IPv4 header, TCP and UDP checksum verification stage (runs after parsing).
+ *
+ * Results are stored in PacketMetadata.csum_flags and counted per protocol.
+ * The ring tells us when the answer is already known: frames the kernel or
+ * NIC has verified are accepted without summing, and outgoing frames whose
+ * transport checksum is left to the NIC are not checked (the field only
+ * holds the pseudo-header sum at that point).
+ */
+
+#ifndef CHECKSUM_VERIFY_H
+#define CHECKSUM_VERIFY_H
+
+#include <stdint.h>
+#include "Types.h"
+
+/**
+ * @brief Capture hints a backend passes with each frame (process_packet()).
+ */
+#define CAPTURE_CSUM_NOT_READY  0x01    // Outgoing frame, transport checksum left to the NIC
+#define CAPTURE_CSUM_VALID      0x02    // Transport checksum verified by the kernel / NIC
+
+/**
+ * @brief Per-source verification counters (single writer, reset on publish).
+ */
+typedef struct {
+    uint64_t ip_checked;
+    uint64_t ip_bad;
+    uint64_t tcp_checked;
+    uint64_t tcp_bad;
+    uint64_t udp_checked;
+    uint64_t udp_bad;
+    uint64_t kernel_valid;      // Accepted from CAPTURE_CSUM_VALID without summing
+    uint64_t offload_pending;   // Skipped: CAPTURE_CSUM_NOT_READY
+    uint64_t unverifiable;      // Skipped: truncated, fragment, or UDP without checksum
+} ChecksumStats;
+
+/**
+ * @brief Verifies the checksums of a parsed frame and sets meta->csum_flags.
+ *
+ * @param frame Frame the metadata was parsed from.
+ * @param size Captured length.
+ * @param capture_flags CAPTURE_CSUM_* hints from the backend.
+ */
+void checksum_verify(ChecksumStats* stats, PacketMetadata* meta, const unsigned char* frame, int size,
+                     uint32_t capture_flags);
+
+/**
+ * @brief Emits {"event": "checksums"} with the counters since the last call, then resets them.
+ */
+void checksum_stats_publish(ChecksumStats* stats, int if_id);
+
+#endif // CHECKSUM_VERIFY_H
@@ -0,0 +1,343 @@
+/**
+ * @file controlSocket.c
+ * @brief Implementation of the control thread and its command set.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "controlSocket.h"
+#include "runtimeConfig.h"
+#include "packetParser.h"
+#include "ipfix_exporter.h"
+#include "logger.h"
+
+#define CONTROL_POLL_MS         200     // Stop / reload flag check interval
+#define CONTROL_CLIENT_TIMEOUT  5       // Seconds a client may stay silent
+#define CONTROL_MAX_LINE        512
+#define CONTROL_MAX_REPLY       1024
+
+static struct {
+    pthread_t thread;
+    int started;
+    int stopping;
+    int listen_fd;
+    char path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+    ControlReloadFn reload;
+} g_control = { .listen_fd = -1 };
+
+static volatile sig_atomic_t g_reload_requested = 0;
+
+// --- Settings ---
+
+static void describe_settings(char* out, size_t len) {
+    RuntimeConfig config;
+    runtime_config_get(&config);
+
+    char sample[32], filter[128], tm_filter[128], events[80], collector[80];
+    sampling_describe(&config.sampling, sample, sizeof(sample));
+    packet_filter_describe(&config.export_filter, filter, sizeof(filter));
+    packet_filter_describe(&config.trigger_filter, tm_filter, sizeof(tm_filter));
+    logger_targets(events, sizeof(events), collector, sizeof(collector));
+
+    snprintf(out, len,
+        "\"generation\": %llu,"
+        "\"sample\": \"%s\","
+        "\"adaptive\": %d,"
+        "\"filter\": \"%s\","
+        "\"tm_filter\": \"%s\","
+        "\"log_level\": \"%s\","
+        "\"events\": \"%s\","
+        "\"collector\": \"%s\"",
+        (unsigned long long)config.generation, sample, config.sampling.adaptive, filter, tm_filter,
+        log_level_name(logger_level()), events, collector);
+}
+
+void control_publish(const char* cause) {
+    char settings[CONTROL_MAX_REPLY - 64];
+    char json[CONTROL_MAX_REPLY];
+    describe_settings(settings, sizeof(settings));
+    snprintf(json, sizeof(json), "{\"event\": \"config\",\"cause\": \"%s\",%s}", cause, settings);
+    log_event(json);
+}
+
+// "IP:PORT"
+static int parse_target(const char* arg, char* ip, size_t ip_len, int* port) {
+    const char* colon = strrchr(arg, ':');
+    if (!colon || colon == arg || (size_t)(colon - arg) >= ip_len) return -1;
+    memcpy(ip, arg, (size_t)(colon - arg));
+    ip[colon - arg] = '\0';
+    *port = atoi(colon + 1);
+    return (*port > 0 && *port <= 65535) ? 0 : -1;
+}
+
+// Edits a copy of the current snapshot and republishes it
+static int publish_change(const char* command, const char* arg, char* reply, size_t len) {
+    RuntimeConfig config;
+    runtime_config_get(&config);
+
+    if (strcmp(command, "sample") == 0) {
+        if (parse_sampling_spec(arg, &config.sampling) != 0) {
+            snprintf(reply, len, "ERR invalid sampling spec '%s'", arg);
+            return -1;
+        }
+    } else if (strcmp(command, "adaptive") == 0) {
+        if (strcmp(arg, "on") != 0 && strcmp(arg, "off") != 0) {
+            snprintf(reply, len, "ERR expected on or off");
+            return -1;
+        }
+        config.sampling.adaptive = (strcmp(arg, "on") == 0);
+    } else {
+        PacketFilter* filter = strcmp(command, "filter") == 0 ? &config.export_filter : &config.trigger_filter;
+        if (strcmp(arg, "none") == 0) {
+            memset(filter, 0, sizeof(*filter));
+        } else if (parse_packet_filter(arg, filter) != 0) {
+            snprintf(reply, len, "ERR invalid filter '%s'", arg);
+            return -1;
+        }
+    }
+
+    uint64_t generation = runtime_config_publish(&config);
+    if (generation == 0) {
+        snprintf(reply, len, "ERR out of memory");
+        return -1;
+    }
+    log_message("[INFO] Control: %s %s (generation %llu)\n", command, arg, (unsigned long long)generation);
+    snprintf(reply, len, "OK generation %llu", (unsigned long long)generation);
+    return 0;
+}
+
+static void run_reload(char* reply, size_t len) {
+    char summary[CONTROL_MAX_REPLY - 8];
+    if (!g_control.reload) {
+        snprintf(reply, len, "ERR no config file (start with --config)");
+        return;
+    }
+    if (g_control.reload(summary, sizeof(summary)) != 0) {
+        log_message("[WARN] Reload failed: %s\n", summary);
+        snprintf(reply, len, "ERR %s", summary);
+        return;
+    }
+    log_message("[INFO] Reload: %s\n", summary);
+    control_publish("reload");
+    snprintf(reply, len, "OK %s", summary);
+}
+
+static int is_setting(const char* command) {
+    static const char* const settings[] = {
+        "sample", "adaptive", "filter", "tm-filter", "log-level", "events", "collector"
+    };
+    for (size_t i = 0; i < sizeof(settings) / sizeof(settings[0]); i++) {
+        if (strcmp(command, settings[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+static void handle_command(char* line, char* reply, size_t len) {
+    char* save = NULL;
+    char* command = strtok_r(line, " \t\r", &save);
+    char* arg = strtok_r(NULL, " \t\r", &save);
+
+    if (!command) {
+        snprintf(reply, len, "ERR empty command");
+    } else if (strcmp(command, "show") == 0) {
+        char settings[CONTROL_MAX_REPLY - 8];
+        describe_settings(settings, sizeof(settings));
+        snprintf(reply, len, "OK {%s}", settings);
+    } else if (strcmp(command, "help") == 0) {
+        snprintf(reply, len, "OK show | sample MODE[:N] | adaptive on|off | filter SPEC|none | "
+                 "tm-filter SPEC|none | log-level LEVEL | events IP:PORT | collector IP:PORT | reload");
+    } else if (strcmp(command, "reload") == 0) {
+        run_reload(reply, len);
+    } else if (!is_setting(command)) {
+        snprintf(reply, len, "ERR unknown command '%s' (try help)", command);
+    } else if (!arg) {
+        snprintf(reply, len, "ERR %s needs an argument", command);
+    } else if (strcmp(command, "tm-filter") == 0 && !time_machine_enabled()) {
+        snprintf(reply, len, "ERR time machine disabled (start with --time-machine)");
+    } else if (strcmp(command, "sample") == 0 || strcmp(command, "adaptive") == 0 ||
+               strcmp(command, "filter") == 0 || strcmp(command, "tm-filter") == 0) {
+        if (publish_change(command, arg, reply, len) == 0) control_publish(command);
+    } else if (strcmp(command, "log-level") == 0) {
+        LogLevel level;
+        if (parse_log_level(arg, &level) != 0) {
+            snprintf(reply, len, "ERR unknown level '%s'", arg);
+            return;
+        }
+        logger_set_level(level);
+        log_message("[INFO] Control: log level %s\n", arg);
+        control_publish(command);
+        snprintf(reply, len, "OK");
+    } else if (strcmp(command, "events") == 0 || strcmp(command, "collector") == 0) {
+        char ip[64];
+        int port;
+        int flows = (strcmp(command, "collector") == 0);
+        if (flows && !flow_exporter_enabled()) {
+            snprintf(reply, len, "ERR flow export is off (start with --export-flows)");
+            return;
+        }
+        if (parse_target(arg, ip, sizeof(ip), &port) != 0 ||
+            (flows ? logger_set_flow_collector(ip, port) : logger_set_event_target(ip, port)) != 0) {
+            snprintf(reply, len, "ERR invalid target '%s' (expected IPv4:PORT)", arg);
+            return;
+        }
+        log_message("[INFO] Control: %s %s\n", command, arg);
+        control_publish(command);
+        snprintf(reply, len, "OK");
+    }
+}
+
+// --- Socket ---
+
+static void serve_client(int fd) {
+    struct timeval timeout = { CONTROL_CLIENT_TIMEOUT, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    char buf[CONTROL_MAX_LINE];
+    size_t used = 0;
+
+    while (!__atomic_load_n(&g_control.stopping, __ATOMIC_ACQUIRE)) {
+        ssize_t n = recv(fd, buf + used, sizeof(buf) - 1 - used, 0);
+        if (n <= 0) break;
+        used += (size_t)n;
+        buf[used] = '\0';
+
+        char* line = buf;
+        char* newline;
+        while ((newline = strchr(line, '\n')) != NULL) {
+            *newline = '\0';
+            char reply[CONTROL_MAX_REPLY];
+            handle_command(line, reply, sizeof(reply) - 1);
+            strcat(reply, "\n");
+            if (send(fd, reply, strlen(reply), MSG_NOSIGNAL) < 0) return;
+            line = newline + 1;
+        }
+
+        used = strlen(line);
+        memmove(buf, line, used);
+        if (used == sizeof(buf) - 1) {
+            const char* error = "ERR line too long\n";
+            send(fd, error, strlen(error), MSG_NOSIGNAL);
+            return;
+        }
+    }
+}
+
+static int open_listener(const char* path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "[ERROR] Control socket path too long: %s\n", path);
+        return -1;
+    }
+    memcpy(addr.sun_path, path, strlen(path));
+
+    // Replace a socket left by a previous run, never any other file
+    struct stat st;
+    if (lstat(path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            fprintf(stderr, "[ERROR] %s exists and is not a socket\n", path);
+            return -1;
+        }
+        unlink(path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("[ERROR] Control socket creation failed");
+        return -1;
+    }
+    // Owner only: the socket can redirect the export streams
+    mode_t old_mask = umask(0177);
+    int bound = bind(fd, (struct sockaddr*)&addr, sizeof(addr));
+    umask(old_mask);
+    if (bound < 0 || listen(fd, 4) < 0) {
+        fprintf(stderr, "[ERROR] Cannot listen on %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void* control_main(void* arg) {
+    (void)arg;
+
+    while (!__atomic_load_n(&g_control.stopping, __ATOMIC_ACQUIRE)) {
+        if (g_reload_requested) {
+            g_reload_requested = 0;
+            char reply[CONTROL_MAX_REPLY];
+            run_reload(reply, sizeof(reply));
+        }
+
+        if (g_control.listen_fd < 0) {
+            poll(NULL, 0, CONTROL_POLL_MS);
+            continue;
+        }
+
+        struct pollfd pfd = { .fd = g_control.listen_fd, .events = POLLIN, .revents = 0 };
+        if (poll(&pfd, 1, CONTROL_POLL_MS) <= 0) continue;
+
+        int client = accept4(g_control.listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (client < 0) continue;
+        serve_client(client);
+        close(client);
+    }
+    return NULL;
+}
+
+// --- Public API ---
+
+int control_start(const char* socket_path, ControlReloadFn reload) {
+    g_control.reload = reload;
+    g_control.stopping = 0;
+
+    if (socket_path) {
+        g_control.listen_fd = open_listener(socket_path);
+        if (g_control.listen_fd < 0) return -1;
+        snprintf(g_control.path, sizeof(g_control.path), "%s", socket_path);
+    }
+
+    if (pthread_create(&g_control.thread, NULL, control_main, NULL) != 0) {
+        perror("[ERROR] Failed to create control thread");
+        if (g_control.listen_fd >= 0) {
+            close(g_control.listen_fd);
+            g_control.listen_fd = -1;
+            unlink(g_control.path);
+        }
+        return -1;
+    }
+    g_control.started = 1;
+
+    if (socket_path) {
+        log_message("[INFO] Control socket listening on %s\n", socket_path);
+    }
+    return 0;
+}
+
+void control_stop(void) {
+    if (!g_control.started) return;
+
+    __atomic_store_n(&g_control.stopping, 1, __ATOMIC_RELEASE);
+    pthread_join(g_control.thread, NULL);
+    g_control.started = 0;
+
+    if (g_control.listen_fd >= 0) {
+        close(g_control.listen_fd);
+        g_control.listen_fd = -1;
+        unlink(g_control.path);
+    }
+}
+
+void control_request_reload(void) {
+    g_reload_requested = 1;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file controlSocket.h
+ * @brief Control plane: change runtime settings over a Unix socket or by reloading the config file.
+ *
+ * A control thread accepts connections on a SOCK_STREAM Unix socket and answers
+ * each command line with one line starting with "OK" or "ERR":
+ *
+ *   show                       Current settings as JSON
+ *   sample MODE[:N]            Export sampling (as --sample)
+ *   adaptive on|off            Adaptive sampling
+ *   filter SPEC|none           Export only matching packet records
+ *   tm-filter SPEC|none        Time machine trigger filter
+ *   log-level LEVEL            error, warn, info or debug
+ *   events IP:PORT             Destination of packet records and events
+ *   collector IP:PORT          Flow exporter collector (when --export-flows is on)
+ *   reload                     Re-read the config file (also on SIGHUP)
+ *
+ * Packet-path settings are republished as a runtime config snapshot that the
+ * capture threads pick up between batches (runtimeConfig.h). Destinations and
+ * the log level go to the logger. Every change is logged and published as a
+ * {"event": "config"} record.
+ */
+
+#ifndef CONTROL_SOCKET_H
+#define CONTROL_SOCKET_H
+
+#include <stddef.h>
+
+/**
+ * @brief Re-reads the configuration and applies what can change at run time.
+ *
+ * @param reply Receives a one-line summary (without "OK" / "ERR").
+ * @return 0 if the new settings were applied, -1 if nothing changed.
+ */
+typedef int (*ControlReloadFn)(char* reply, size_t len);
+
+/**
+ * @brief Starts the control thread.
+ *
+ * @param socket_path Unix socket to listen on (NULL: reloads only). An old socket file there is replaced.
+ * @param reload Reload handler (NULL: "reload" and SIGHUP are refused).
+ * @return 0 on success, -1 on failure.
+ */
+int control_start(const char* socket_path, ControlReloadFn reload);
+
+/**
+ * @brief Stops the thread and removes the socket file.
+ */
+void control_stop(void);
+
+/**
+ * @brief Asks the control thread to reload (async-signal-safe, for the SIGHUP handler).
+ */
+void control_request_reload(void);
+
+/**
+ * @brief Emits {"event": "config"} with the current settings (e.g. after a reload).
+ */
+void control_publish(const char* cause);
+
+#endif // CONTROL_SOCKET_H
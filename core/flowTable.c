@@ -0,0 +1,244 @@
+/**
+ * @file flowTable.c
+ * @brief Implementation of the flow table (open addressing, linear probing).
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <netinet/in.h>
+#include "flowTable.h"
+#include "hash.h"
+#include "clock.h"
+#include "mem_pool.h"
+
+#define FLOW_HASH_SEED    0x464c5754u
+#define FLOW_MAX_PROBE    16    // Longest probe sequence before evicting
+#define FLOW_SCAN_PERIOD  100   // ms between incremental expiry scans
+#define FLOW_SCAN_SLICES  10    // Scans per full sweep
+
+// TCP flag bits as packed by parse_tcp()
+#define TCP_FLAG_FIN 0x01
+#define TCP_FLAG_RST 0x04
+
+struct FlowTable {
+    MemRegion region;       // Backing memory of the slots (hugepages when available)
+    FlowEntry* slots;
+    uint32_t mask;
+    uint32_t count;
+    uint32_t scan_cursor;
+    uint64_t next_scan_ms;
+    FlowTimeouts timeouts;
+    FlowExpireCallback on_expire;
+    void* user;
+};
+
+// --- Key Helpers ---
+
+static uint64_t packet_hash(const PacketMetadata* meta) {
+    // 0 marks an empty slot, which the hash never returns
+    return hash_flow_key(meta->ip_version, meta->l3_protocol, meta->src_addr, meta->src_port,
+                         meta->dest_addr, meta->dest_port, FLOW_HASH_SEED);
+}
+
+// Returns 0 (A -> B), 1 (B -> A) or -1 (different flow)
+static int match_direction(const FlowKey* key, const PacketMetadata* meta) {
+    if (key->ip_version != meta->ip_version || key->protocol != meta->l3_protocol) return -1;
+
+    if (key->port_a == meta->src_port && key->port_b == meta->dest_port &&
+        memcmp(key->addr_a, meta->src_addr, 16) == 0 &&
+        memcmp(key->addr_b, meta->dest_addr, 16) == 0) {
+        return 0;
+    }
+    if (key->port_a == meta->dest_port && key->port_b == meta->src_port &&
+        memcmp(key->addr_a, meta->dest_addr, 16) == 0 &&
+        memcmp(key->addr_b, meta->src_addr, 16) == 0) {
+        return 1;
+    }
+    return -1;
+}
+
+// --- Slot Management ---
+
+static void expire_entry(FlowTable* table, FlowEntry* entry, FlowEndReason reason) {
+    entry->record.end_reason = (uint8_t)reason;
+    if (table->on_expire) {
+        table->on_expire(entry, table->user);
+    }
+}
+
+// Backward-shift deletion keeps probe chains intact without tombstones
+static void remove_slot(FlowTable* table, uint32_t slot) {
+    uint32_t hole = slot;
+    uint32_t next = slot;
+
+    while (1) {
+        next = (next + 1) & table->mask;
+        if (table->slots[next].hash == 0) break;
+
+        uint32_t home = (uint32_t)(table->slots[next].hash & table->mask);
+        int in_range = (hole <= next) ? (hole < home && home <= next)
+                                      : (hole < home || home <= next);
+        if (in_range) continue;
+
+        table->slots[hole] = table->slots[next];
+        hole = next;
+    }
+
+    memset(&table->slots[hole], 0, sizeof(FlowEntry));
+    table->count--;
+}
+
+static void init_entry(FlowEntry* entry, const PacketMetadata* meta, uint64_t hash, uint64_t ts_ms) {
+    memset(entry, 0, sizeof(*entry));
+    entry->hash = hash;
+
+    FlowRecord* rec = &entry->record;
+    rec->key.ip_version = meta->ip_version;
+    rec->key.protocol = meta->l3_protocol;
+    rec->key.port_a = meta->src_port;
+    rec->key.port_b = meta->dest_port;
+    memcpy(rec->key.addr_a, meta->src_addr, 16);
+    memcpy(rec->key.addr_b, meta->dest_addr, 16);
+    rec->if_id = meta->if_id;
+    rec->start_ms = ts_ms;
+    rec->end_ms = ts_ms;
+}
+
+// --- Public API ---
+
+FlowTable* flow_table_create(uint32_t capacity, const FlowTimeouts* timeouts,
+                             FlowExpireCallback on_expire, void* user) {
+    uint32_t size = 1024;
+    while (size < capacity) size <<= 1;
+
+    FlowTable* table = (FlowTable*)calloc(1, sizeof(FlowTable));
+    if (!table) return NULL;
+
+    // Slots are probed at random on every packet: hugepages keep them TLB friendly
+    if (mem_region_alloc(&table->region, (size_t)size * sizeof(FlowEntry), numa_default_node()) != 0) {
+        free(table);
+        return NULL;
+    }
+    table->slots = (FlowEntry*)table->region.base;
+
+    table->mask = size - 1;
+    table->timeouts = *timeouts;
+    table->on_expire = on_expire;
+    table->user = user;
+    return table;
+}
+
+void flow_table_destroy(FlowTable* table) {
+    if (!table) return;
+
+    for (uint32_t i = 0; i <= table->mask; i++) {
+        if (table->slots[i].hash != 0) {
+            expire_entry(table, &table->slots[i], FLOW_END_FORCED);
+        }
+    }
+
+    mem_region_free(&table->region);
+    free(table);
+}
+
+FlowEntry* flow_table_update(FlowTable* table, const PacketMetadata* meta, int* direction) {
+    if (meta->ip_version != 4 && meta->ip_version != 6) return NULL;
+
+    uint64_t ts_ms = meta->timestamp_ns ? meta->timestamp_ns / 1000000ULL : clock_realtime_ms();
+    uint64_t hash = packet_hash(meta);
+    uint32_t slot = (uint32_t)(hash & table->mask);
+    FlowEntry* entry = NULL;
+    FlowEntry* oldest = NULL;
+    int dir = 0;
+
+    // 1. Probe for the flow or a free slot
+    for (int probe = 0; probe < FLOW_MAX_PROBE; probe++) {
+        FlowEntry* candidate = &table->slots[(slot + probe) & table->mask];
+
+        if (candidate->hash == 0) {
+            init_entry(candidate, meta, hash, ts_ms);
+            table->count++;
+            entry = candidate;
+            break;
+        }
+        if (candidate->hash == hash && (dir = match_direction(&candidate->record.key, meta)) >= 0) {
+            entry = candidate;
+            break;
+        }
+        if (!oldest || candidate->record.end_ms < oldest->record.end_ms) {
+            oldest = candidate;
+        }
+    }
+
+    // 2. Neighbourhood full: evict the least recently active flow in place
+    if (!entry) {
+        expire_entry(table, oldest, FLOW_END_RESOURCES);
+        init_entry(oldest, meta, hash, ts_ms);
+        entry = oldest;
+        dir = 0;
+    }
+
+    // 3. Account the packet
+    FlowRecord* rec = &entry->record;
+    rec->packets[dir]++;
+    rec->bytes[dir] += meta->packet_size;
+    if (ts_ms > rec->end_ms) rec->end_ms = ts_ms;
+
+    if (meta->l3_protocol == IPPROTO_TCP) {
+        rec->tcp_flags[dir] |= meta->tcp_flags;
+        if (meta->tcp_flags & TCP_FLAG_FIN) entry->fin_seen |= (uint8_t)(1 << dir);
+        if ((meta->tcp_flags & TCP_FLAG_RST) || entry->fin_seen == 0x3) entry->closed = 1;
+    }
+
+    *direction = dir;
+    return entry;
+}
+
+void flow_table_expire(FlowTable* table, uint64_t now_ms) {
+    uint64_t mono = clock_coarse_ms();
+    if (mono < table->next_scan_ms) return;
+    table->next_scan_ms = mono + FLOW_SCAN_PERIOD;
+
+    uint32_t budget = (table->mask + 1) / FLOW_SCAN_SLICES + 1;
+
+    while (budget-- > 0) {
+        uint32_t slot = table->scan_cursor;
+        FlowEntry* entry = &table->slots[slot];
+
+        if (entry->hash != 0) {
+            FlowRecord* rec = &entry->record;
+            int reason = 0;
+
+            if (entry->closed) {
+                reason = FLOW_END_OF_FLOW;
+            } else if (now_ms > rec->end_ms && now_ms - rec->end_ms >= table->timeouts.idle_timeout_ms) {
+                reason = FLOW_END_IDLE;
+            } else if (now_ms > rec->start_ms && now_ms - rec->start_ms >= table->timeouts.active_timeout_ms) {
+                // Long-lived flow: export what we have and keep tracking it
+                expire_entry(table, entry, FLOW_END_ACTIVE);
+                memset(rec->packets, 0, sizeof(rec->packets));
+                memset(rec->bytes, 0, sizeof(rec->bytes));
+                memset(&rec->tcp, 0, sizeof(rec->tcp));
+                rec->start_ms = now_ms;
+                rec->end_reason = 0;
+            }
+
+            if (reason) {
+                expire_entry(table, entry, (FlowEndReason)reason);
+                remove_slot(table, slot);
+                // An entry may have been shifted into this slot: re-check it
+                if (table->slots[slot].hash != 0) continue;
+            }
+        }
+
+        table->scan_cursor = (slot + 1) & table->mask;
+    }
+}
+
+uint32_t flow_table_size(const FlowTable* table) {
+    return table->count;
+}
+
+const char* flow_table_placement(const FlowTable* table, char* buf, size_t len) {
+    return mem_region_describe(&table->region, buf, len);
+}
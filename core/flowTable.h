@@ -0,0 +1,101 @@
+/**
+ * @file flowTable.h
+ * @brief Per-source bidirectional flow table with timeout-based expiry.
+ *
+ * Each capture source owns its own table, touched only by the thread servicing
+ * its ring, so lookups and updates need no locking. Flows are expired on idle
+ * timeout, active timeout, TCP teardown, table pressure or shutdown, and handed
+ * to an expiry callback (e.g. the flow exporter).
+ */
+
+#ifndef FLOW_TABLE_H
+#define FLOW_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Types.h"
+#include "tcpAnalyzer.h"
+
+/**
+ * @brief Default number of slots (power of two).
+ */
+#define FLOW_TABLE_DEFAULT_CAPACITY 32768
+
+/**
+ * @brief Flow timeouts.
+ */
+typedef struct {
+    uint32_t idle_timeout_ms;       // Expire after this long without packets
+    uint32_t active_timeout_ms;     // Split long-lived flows into records of this length
+} FlowTimeouts;
+
+/**
+ * @brief One tracked flow.
+ */
+typedef struct {
+    FlowRecord record;
+    uint64_t hash;                  // Direction-independent key hash (0 = empty slot)
+    uint8_t fin_seen;               // Bit per direction
+    uint8_t closed;                 // RST or FIN in both directions: export at next scan
+    TcpFlowState tcp_state;         // TCP performance analysis
+    uint8_t session_declined;       // No stream parser wanted this flow
+    struct TcpSession* session;     // TCP reassembly state (NULL if none), owned by the parser context
+    uint8_t quic_done;              // QUIC ClientHello decoded or given up on
+    struct QuicHello* quic;         // Partial QUIC ClientHello (NULL if none), owned by the TLS fingerprinter
+} FlowEntry;
+
+/**
+ * @brief Called for every expired flow, right before its slot is reused.
+ * The callback may still annotate the record (e.g. with analyzer results) before exporting it.
+ * For FLOW_END_ACTIVE the flow stays in the table afterwards.
+ */
+typedef void (*FlowExpireCallback)(FlowEntry* entry, void* user);
+
+typedef struct FlowTable FlowTable;
+
+/**
+ * @brief Allocates a flow table.
+ * @param capacity Number of slots (rounded up to a power of two).
+ * @param timeouts Idle / active timeouts.
+ * @param on_expire Expiry callback.
+ * @param user Opaque pointer passed to the callback.
+ * @return FlowTable* or NULL on allocation failure.
+ */
+FlowTable* flow_table_create(uint32_t capacity, const FlowTimeouts* timeouts,
+                             FlowExpireCallback on_expire, void* user);
+
+/**
+ * @brief Expires every remaining flow (FLOW_END_FORCED) and frees the table.
+ */
+void flow_table_destroy(FlowTable* table);
+
+/**
+ * @brief Accounts a parsed IP packet to its flow, creating the flow if needed.
+ *
+ * @param table The source's table.
+ * @param meta Parsed packet (must be IPv4/IPv6).
+ * @param direction Output: 0 if the packet goes A -> B, 1 for B -> A.
+ * @return FlowEntry* The flow, or NULL if the packet is not trackable.
+ */
+FlowEntry* flow_table_update(FlowTable* table, const PacketMetadata* meta, int* direction);
+
+/**
+ * @brief Incrementally scans the table and expires timed-out or closed flows.
+ *
+ * Rate-limited internally: a full sweep takes about one second.
+ *
+ * @param now_ms Wall-clock time in ms since the epoch.
+ */
+void flow_table_expire(FlowTable* table, uint64_t now_ms);
+
+/**
+ * @brief Number of flows currently tracked.
+ */
+uint32_t flow_table_size(const FlowTable* table);
+
+/**
+ * @brief Describes where the slot array was placed (page size, NUMA node).
+ */
+const char* flow_table_placement(const FlowTable* table, char* buf, size_t len);
+
+#endif // FLOW_TABLE_H
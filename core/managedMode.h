@@ -4,21 +4,128 @@
  *
  * This module is responsible for the standard OSI stack parsing:
  * Layer 2 (Ethernet) -> Layer 3 (IP) -> Layer 4 (TCP/UDP).
+ *
+ * The parser is written once as an always-inline template over a constant
+ * feature mask (PARSE_VLAN, PARSE_IPV6). The packet pipelines instantiate it
+ * with the mask they were built for, so a build without VLAN or IPv6 support
+ * carries neither the tests nor the code for them.
  */
 
 #ifndef MANAGEDMODE_H
 #define MANAGEDMODE_H
 
+#include <netinet/in.h>
+#include <net/ethernet.h>
 #include "Types.h"
+#include "ethernetLayer.h"
+#include "networkLayer.h"
+#include "transportLayer.h"
+
+#define PARSE_VLAN  (1u << 0)   // Skip up to two 802.1Q / 802.1ad tags
+#define PARSE_IPV6  (1u << 1)   // Decode IPv6 (off: IPv6 frames stop at layer 2)
+
+#define ETHERTYPE_EAPOL 0x888E  // 802.1X port authentication
+#define ETHERTYPE_QINQ  0x88A8  // 802.1ad service tag
+#define VLAN_TAG_LEN    4
+#define VLAN_MAX_TAGS   2
+
+/**
+ * @brief Parses a standard Ethernet packet with a compile-time feature mask.
+ *
+ * @param features PARSE_* bits; must be a constant so the unused paths fold away.
+ */
+static inline __attribute__((always_inline))
+void parse_managed_frame(const unsigned char* buffer, int size, PacketMetadata* meta, const unsigned features) {
+    // --- Layer 2: Ethernet ---
+    int eth_header_len = 0;
+    uint16_t eth_type = parse_ethernet(buffer, size, &eth_header_len, meta);
+
+    if (features & PARSE_VLAN) {
+        // The tags are skipped; ether_type reports the encapsulated protocol
+        for (int tags = 0; tags < VLAN_MAX_TAGS && (eth_type == ETHERTYPE_VLAN || eth_type == ETHERTYPE_QINQ) &&
+                           eth_header_len + VLAN_TAG_LEN <= size; tags++) {
+            eth_type = (uint16_t)((buffer[eth_header_len + 2] << 8) | buffer[eth_header_len + 3]);
+            eth_header_len += VLAN_TAG_LEN;
+        }
+        meta->ether_type = eth_type;
+    }
+
+    // Filter out non-IP noise (ARP, STP, etc.) to focus on meaningful traffic
+    if (eth_type < 1536) {
+        // 802.3 Frames (Length field instead of Type) are usually not IP
+        return;
+    }
+
+    if (eth_type == ETHERTYPE_EAPOL) {
+        meta->is_eapol = 1;
+        return;
+    }
+
+    // --- Layer 3: Network (IP / IPv6) ---
+    const unsigned char* network_buffer = buffer + eth_header_len;
+    int network_remaining_size = size - eth_header_len;
+    int network_header_len = 0;
+    uint8_t protocol;
+
+    if (eth_type == ETHERTYPE_IP) {
+        meta->l3_offset = (uint16_t)eth_header_len;
+        protocol = (network_remaining_size >= 1 && (*network_buffer >> 4) == 4)
+                   ? parse_ip(network_buffer, network_remaining_size, &network_header_len, meta) : 0;
+    } else if ((features & PARSE_IPV6) && eth_type == ETHERTYPE_IPV6) {
+        meta->l3_offset = (uint16_t)eth_header_len;
+        protocol = (network_remaining_size >= 1 && (*network_buffer >> 4) == 6)
+                   ? parse_ipv6(network_buffer, network_remaining_size, &network_header_len, meta) : 0;
+    } else {
+        return;
+    }
+
+    // Ignore Ethernet padding after the datagram
+    if (meta->ip_length > 0 && meta->ip_length < network_remaining_size) {
+        network_remaining_size = meta->ip_length;
+    }
+
+    // --- Layer 4: Transport (TCP / UDP) ---
+    const unsigned char* transport_buffer = network_buffer + network_header_len;
+    int transport_remaining_size = network_remaining_size - network_header_len;
+    if (transport_remaining_size <= 0) {
+        return;
+    }
+    meta->l4_offset = (uint16_t)(transport_buffer - buffer);
+
+    switch (protocol) {
+        case IPPROTO_TCP:
+            parse_tcp(transport_buffer, transport_remaining_size, meta);
+            break;
+        case IPPROTO_UDP:
+            parse_udp(transport_buffer, transport_remaining_size, meta);
+            break;
+        case IPPROTO_ICMP:
+            parse_icmp(transport_buffer, transport_remaining_size, meta);
+            break;
+        case IPPROTO_ICMPV6:
+            if (features & PARSE_IPV6) parse_icmpv6(transport_buffer, transport_remaining_size, meta);
+            break;
+        default:
+            // Unknown or unhandled protocol
+            break;
+    }
+
+    // A snaplen may have cut the payload short: the IP header still has its real length
+    meta->payload_wire_len = meta->payload_len;
+    if (meta->payload_offset > 0 && meta->ip_length > 0) {
+        int wire = meta->ip_length - network_header_len - (meta->payload_offset - meta->l4_offset);
+        if (wire > meta->payload_len) meta->payload_wire_len = (uint16_t)wire;
+    }
+}
 
 /**
  * @brief Parses a standard Ethernet packet.
  * * Delegates parsing to specific layer handlers (Ethernet, Network, Transport)
- * and populates the metadata structure.
+ * and populates the metadata structure. IPv6 is decoded, VLAN tags are not skipped.
  * * @param buffer Pointer to the raw packet data.
  * @param size Packet size.
  * @param meta Pointer to the metadata structure to fill.
  */
 void parse_managed_packet(const unsigned char* buffer, int size, PacketMetadata* meta);
 
-#endif // MANAGEDMODE_H
\ No newline at end of file
+#endif // MANAGEDMODE_H
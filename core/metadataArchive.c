@@ -0,0 +1,374 @@
+/**
+ * @file metadataArchive.c
+ * @brief Implementation of the columnar packet / flow record archive.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "metadataArchive.h"
+#include "columnar.h"
+#include "logger.h"
+#include "clock.h"
+
+#define WRITER_IDLE_NS  5000000     // Writer sleep when no batch is waiting
+
+// --- Schemas ---
+
+enum {
+    PKT_TS_NS, PKT_IF_ID, PKT_ETHER_TYPE, PKT_IP_VERSION, PKT_PROTOCOL, PKT_SRC_ADDR, PKT_DST_ADDR,
+    PKT_SRC_PORT, PKT_DST_PORT, PKT_WIRE_LEN, PKT_PAYLOAD_LEN, PKT_TCP_FLAGS, PKT_SAMPLING_RATE,
+    PKT_COLUMNS
+};
+
+static const ColumnDesc packet_columns[PKT_COLUMNS] = {
+    { "ts_ns",         COL_INT,   0, 8 },
+    { "if_id",         COL_INT,   0, 1 },
+    { "ether_type",    COL_INT,   0, 2 },
+    { "ip_version",    COL_INT,   0, 1 },
+    { "protocol",      COL_INT,   0, 1 },
+    { "src_addr",      COL_BYTES, 0, 16 },
+    { "dst_addr",      COL_BYTES, 0, 16 },
+    { "src_port",      COL_INT,   0, 2 },
+    { "dst_port",      COL_INT,   0, 2 },
+    { "wire_len",      COL_INT,   0, 4 },
+    { "payload_len",   COL_INT,   0, 2 },
+    { "tcp_flags",     COL_INT,   0, 1 },
+    { "sampling_rate", COL_INT,   0, 4 },
+};
+
+enum {
+    FLOW_START_MS, FLOW_END_MS, FLOW_IF_ID, FLOW_IP_VERSION, FLOW_PROTOCOL, FLOW_ADDR_A, FLOW_ADDR_B,
+    FLOW_PORT_A, FLOW_PORT_B, FLOW_PACKETS_AB, FLOW_PACKETS_BA, FLOW_BYTES_AB, FLOW_BYTES_BA,
+    FLOW_END_REASON, FLOW_TCP_FLAGS_AB, FLOW_TCP_FLAGS_BA, FLOW_SYN_RTT_US, FLOW_RTT_AVG_US,
+    FLOW_RETRANSMISSIONS, FLOW_SNI, FLOW_COLUMNS
+};
+
+static const ColumnDesc flow_columns[FLOW_COLUMNS] = {
+    { "start_ms",        COL_INT,   0, 8 },
+    { "end_ms",          COL_INT,   0, 8 },
+    { "if_id",           COL_INT,   0, 1 },
+    { "ip_version",      COL_INT,   0, 1 },
+    { "protocol",        COL_INT,   0, 1 },
+    { "addr_a",          COL_BYTES, 0, 16 },
+    { "addr_b",          COL_BYTES, 0, 16 },
+    { "port_a",          COL_INT,   0, 2 },
+    { "port_b",          COL_INT,   0, 2 },
+    { "packets_ab",      COL_INT,   0, 8 },
+    { "packets_ba",      COL_INT,   0, 8 },
+    { "bytes_ab",        COL_INT,   0, 8 },
+    { "bytes_ba",        COL_INT,   0, 8 },
+    { "end_reason",      COL_INT,   0, 1 },
+    { "tcp_flags_ab",    COL_INT,   0, 1 },
+    { "tcp_flags_ba",    COL_INT,   0, 1 },
+    { "syn_rtt_us",      COL_INT,   0, 4 },
+    { "rtt_avg_us",      COL_INT,   0, 4 },
+    { "retransmissions", COL_INT,   0, 4 },
+    { "sni",             COL_BYTES, 0, TLS_SNI_LEN },
+};
+
+/**
+ * @brief One record type: two batches, filled by the capture thread in turn.
+ */
+typedef struct {
+    const char* schema;
+    const ColumnDesc* columns;
+    uint32_t count;
+    uint32_t capacity;              // Rows per batch
+
+    ColumnBatch batches[2];
+    int active;                     // Batch the capture thread fills
+    int submitted;                  // Batch handed to the writer, -1 if none (atomic)
+    uint64_t first_row_ms;          // When the active batch got its first row
+
+    // Writer thread
+    ColumnarWriter* writer;
+    uint64_t opened_ms;
+
+    // Capture thread counters, reset on publish
+    uint64_t rows;
+    uint64_t dropped;
+
+    // Writer counters (read with relaxed atomics)
+    uint64_t chunks;
+    uint64_t bytes;
+    uint64_t failures;
+} ArchiveStream;
+
+struct MetadataArchive {
+    ArchiveConfig config;
+    int if_id;
+    ArchiveStream packets;
+    ArchiveStream flows;
+    pthread_t thread;
+    int stopping;
+};
+
+void archive_config_defaults(ArchiveConfig* config) {
+    memset(config, 0, sizeof(*config));
+    snprintf(config->directory, sizeof(config->directory), ".");
+    config->chunk_rows = 65536;
+    config->flush_seconds = 10;
+    config->rotate_seconds = 3600;
+}
+
+// --- Batches ---
+
+static int stream_init(ArchiveStream* s, const char* schema, const ColumnDesc* columns, uint32_t count,
+                       uint32_t capacity) {
+    s->schema = schema;
+    s->columns = columns;
+    s->count = count;
+    s->capacity = capacity;
+    s->submitted = -1;
+
+    for (int b = 0; b < 2; b++) {
+        for (uint32_t c = 0; c < count; c++) {
+            size_t width = columns[c].type == COL_INT ? sizeof(uint64_t) : columns[c].width;
+            s->batches[b].values[c] = calloc(capacity, width);
+            if (!s->batches[b].values[c]) return -1;
+        }
+    }
+    return 0;
+}
+
+static void stream_free(ArchiveStream* s) {
+    for (int b = 0; b < 2; b++) {
+        for (uint32_t c = 0; c < s->count; c++) free(s->batches[b].values[c]);
+    }
+}
+
+static void set_int(ColumnBatch* batch, int column, uint32_t row, uint64_t value) {
+    ((uint64_t*)batch->values[column])[row] = value;
+}
+
+static void set_bytes(ColumnBatch* batch, int column, uint32_t row, const void* value, size_t width) {
+    memcpy((uint8_t*)batch->values[column] + (size_t)row * width, value, width);
+}
+
+// Hands the active batch to the writer; returns -1 if the writer still holds the other one
+static int stream_submit(ArchiveStream* s) {
+    if (__atomic_load_n(&s->submitted, __ATOMIC_ACQUIRE) != -1) return -1;
+    __atomic_store_n(&s->submitted, s->active, __ATOMIC_RELEASE);
+    s->active ^= 1;
+    s->batches[s->active].rows = 0;
+    return 0;
+}
+
+// Row to fill in the active batch, or NULL when the record must be dropped
+static ColumnBatch* stream_row(ArchiveStream* s, uint32_t* row) {
+    ColumnBatch* batch = &s->batches[s->active];
+    if (batch->rows == s->capacity && stream_submit(s) != 0) {
+        s->dropped++;
+        return NULL;
+    }
+    batch = &s->batches[s->active];
+    if (batch->rows == 0) s->first_row_ms = clock_coarse_ms();
+    *row = batch->rows++;
+    s->rows++;
+    return batch;
+}
+
+// --- Writer thread ---
+
+static void write_batch(MetadataArchive* a, ArchiveStream* s, const ColumnBatch* batch) {
+    uint64_t now = clock_coarse_ms();
+
+    if (s->writer && a->config.rotate_seconds &&
+        now - s->opened_ms >= (uint64_t)a->config.rotate_seconds * 1000) {
+        if (columnar_writer_close(s->writer) != 0) __atomic_fetch_add(&s->failures, 1, __ATOMIC_RELAXED);
+        s->writer = NULL;
+    }
+    if (!s->writer) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s-if%d-%llu.scol", a->config.directory, s->schema, a->if_id,
+                 (unsigned long long)(clock_realtime_ms() / 1000));
+        s->writer = columnar_writer_open(path, s->schema, s->columns, s->count);
+        if (!s->writer) {
+            __atomic_fetch_add(&s->failures, 1, __ATOMIC_RELAXED);
+            log_message("[WARN] Archive: cannot create %s\n", path);
+            return;
+        }
+        s->opened_ms = now;
+    }
+
+    long written = columnar_writer_append(s->writer, batch);
+    if (written < 0) {
+        __atomic_fetch_add(&s->failures, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    __atomic_fetch_add(&s->chunks, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&s->bytes, (uint64_t)written, __ATOMIC_RELAXED);
+}
+
+static int service_stream(MetadataArchive* a, ArchiveStream* s) {
+    int index = __atomic_load_n(&s->submitted, __ATOMIC_ACQUIRE);
+    if (index < 0) return 0;
+
+    write_batch(a, s, &s->batches[index]);
+    __atomic_store_n(&s->submitted, -1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+static void* writer_main(void* arg) {
+    MetadataArchive* a = (MetadataArchive*)arg;
+
+    while (1) {
+        int stopping = __atomic_load_n(&a->stopping, __ATOMIC_ACQUIRE);
+        int busy = service_stream(a, &a->packets) + service_stream(a, &a->flows);
+        if (busy) continue;
+        if (stopping) break;
+
+        struct timespec idle = { 0, WRITER_IDLE_NS };
+        nanosleep(&idle, NULL);
+    }
+
+    ArchiveStream* streams[2] = { &a->packets, &a->flows };
+    for (int i = 0; i < 2; i++) {
+        if (streams[i]->writer && columnar_writer_close(streams[i]->writer) != 0) {
+            __atomic_fetch_add(&streams[i]->failures, 1, __ATOMIC_RELAXED);
+        }
+        streams[i]->writer = NULL;
+    }
+    return NULL;
+}
+
+// --- Public API ---
+
+MetadataArchive* archive_create(const ArchiveConfig* config, int if_id) {
+    if (access(config->directory, W_OK | X_OK) != 0) {
+        log_message("[ERROR] Archive: directory %s is not writable\n", config->directory);
+        return NULL;
+    }
+
+    MetadataArchive* a = (MetadataArchive*)calloc(1, sizeof(MetadataArchive));
+    if (!a) return NULL;
+    a->config = *config;
+    a->if_id = if_id;
+
+    uint32_t rows = config->chunk_rows;
+    if (rows < 1024) rows = 1024;
+    if (rows > COLUMNAR_MAX_ROWS) rows = COLUMNAR_MAX_ROWS;
+
+    if (stream_init(&a->packets, "packets", packet_columns, PKT_COLUMNS, rows) != 0 ||
+        stream_init(&a->flows, "flows", flow_columns, FLOW_COLUMNS, rows / 8) != 0 ||
+        pthread_create(&a->thread, NULL, writer_main, a) != 0) {
+        stream_free(&a->packets);
+        stream_free(&a->flows);
+        free(a);
+        return NULL;
+    }
+    return a;
+}
+
+void archive_destroy(MetadataArchive* a) {
+    if (!a) return;
+
+    // Wait for the writer to take the previous batch, then hand over the partial one
+    ArchiveStream* streams[2] = { &a->packets, &a->flows };
+    for (int i = 0; i < 2; i++) {
+        if (streams[i]->batches[streams[i]->active].rows == 0) continue;
+        while (stream_submit(streams[i]) != 0) {
+            struct timespec nap = { 0, WRITER_IDLE_NS };
+            nanosleep(&nap, NULL);
+        }
+    }
+    __atomic_store_n(&a->stopping, 1, __ATOMIC_RELEASE);
+    pthread_join(a->thread, NULL);
+
+    stream_free(&a->packets);
+    stream_free(&a->flows);
+    free(a);
+}
+
+void archive_packet(MetadataArchive* a, const PacketMetadata* meta) {
+    uint32_t row;
+    ColumnBatch* b = stream_row(&a->packets, &row);
+    if (!b) return;
+
+    set_int(b, PKT_TS_NS, row, meta->timestamp_ns ? meta->timestamp_ns : clock_realtime_ns());
+    set_int(b, PKT_IF_ID, row, meta->if_id);
+    set_int(b, PKT_ETHER_TYPE, row, meta->ether_type);
+    set_int(b, PKT_IP_VERSION, row, meta->ip_version);
+    set_int(b, PKT_PROTOCOL, row, meta->l3_protocol);
+    set_bytes(b, PKT_SRC_ADDR, row, meta->src_addr, 16);
+    set_bytes(b, PKT_DST_ADDR, row, meta->dest_addr, 16);
+    set_int(b, PKT_SRC_PORT, row, meta->src_port);
+    set_int(b, PKT_DST_PORT, row, meta->dest_port);
+    set_int(b, PKT_WIRE_LEN, row, (uint64_t)meta->packet_size);
+    set_int(b, PKT_PAYLOAD_LEN, row, meta->payload_wire_len);
+    set_int(b, PKT_TCP_FLAGS, row, meta->tcp_flags);
+    set_int(b, PKT_SAMPLING_RATE, row, meta->sampling_rate);
+
+    if (b->rows == a->packets.capacity) stream_submit(&a->packets);
+}
+
+void archive_flow(MetadataArchive* a, const FlowRecord* r) {
+    uint32_t row;
+    ColumnBatch* b = stream_row(&a->flows, &row);
+    if (!b) return;
+
+    set_int(b, FLOW_START_MS, row, r->start_ms);
+    set_int(b, FLOW_END_MS, row, r->end_ms);
+    set_int(b, FLOW_IF_ID, row, r->if_id);
+    set_int(b, FLOW_IP_VERSION, row, r->key.ip_version);
+    set_int(b, FLOW_PROTOCOL, row, r->key.protocol);
+    set_bytes(b, FLOW_ADDR_A, row, r->key.addr_a, 16);
+    set_bytes(b, FLOW_ADDR_B, row, r->key.addr_b, 16);
+    set_int(b, FLOW_PORT_A, row, r->key.port_a);
+    set_int(b, FLOW_PORT_B, row, r->key.port_b);
+    set_int(b, FLOW_PACKETS_AB, row, r->packets[0]);
+    set_int(b, FLOW_PACKETS_BA, row, r->packets[1]);
+    set_int(b, FLOW_BYTES_AB, row, r->bytes[0]);
+    set_int(b, FLOW_BYTES_BA, row, r->bytes[1]);
+    set_int(b, FLOW_END_REASON, row, r->end_reason);
+    set_int(b, FLOW_TCP_FLAGS_AB, row, r->tcp_flags[0]);
+    set_int(b, FLOW_TCP_FLAGS_BA, row, r->tcp_flags[1]);
+    set_int(b, FLOW_SYN_RTT_US, row, r->tcp.syn_rtt_us);
+    set_int(b, FLOW_RTT_AVG_US, row, r->tcp.rtt_samples ? r->tcp.rtt_sum_us / r->tcp.rtt_samples : 0);
+    set_int(b, FLOW_RETRANSMISSIONS, row, (uint64_t)r->tcp.retransmissions[0] + r->tcp.retransmissions[1]);
+    set_bytes(b, FLOW_SNI, row, r->tls.sni, TLS_SNI_LEN);
+
+    if (b->rows == a->flows.capacity) stream_submit(&a->flows);
+}
+
+void archive_housekeeping(MetadataArchive* a) {
+    uint64_t now = clock_coarse_ms();
+    uint64_t age = (uint64_t)a->config.flush_seconds * 1000;
+    ArchiveStream* streams[2] = { &a->packets, &a->flows };
+
+    for (int i = 0; i < 2; i++) {
+        ArchiveStream* s = streams[i];
+        if (s->batches[s->active].rows > 0 && now - s->first_row_ms >= age) stream_submit(s);
+    }
+}
+
+void archive_publish(MetadataArchive* a) {
+    char json[512];
+    snprintf(json, sizeof(json),
+        "{\"event\": \"archive\","
+        "\"if_id\": %d,"
+        "\"packet_rows\": %llu,"
+        "\"flow_rows\": %llu,"
+        "\"dropped\": %llu,"
+        "\"chunks\": %llu,"
+        "\"bytes\": %llu,"
+        "\"failures\": %llu}",
+        a->if_id,
+        (unsigned long long)a->packets.rows, (unsigned long long)a->flows.rows,
+        (unsigned long long)(a->packets.dropped + a->flows.dropped),
+        (unsigned long long)(__atomic_load_n(&a->packets.chunks, __ATOMIC_RELAXED) +
+                             __atomic_load_n(&a->flows.chunks, __ATOMIC_RELAXED)),
+        (unsigned long long)(__atomic_load_n(&a->packets.bytes, __ATOMIC_RELAXED) +
+                             __atomic_load_n(&a->flows.bytes, __ATOMIC_RELAXED)),
+        (unsigned long long)(__atomic_load_n(&a->packets.failures, __ATOMIC_RELAXED) +
+                             __atomic_load_n(&a->flows.failures, __ATOMIC_RELAXED)));
+    log_event(json);
+
+    a->packets.rows = a->packets.dropped = 0;
+    a->flows.rows = a->flows.dropped = 0;
+}
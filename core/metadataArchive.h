@@ -0,0 +1,68 @@
+/**
+ * @file metadataArchive.h
+ * @brief Long-term archive of exported packet records and flow records in columnar files.
+ *
+ * The capture thread only stores each record's fields into the open column
+ * batch. Full (or old enough) batches are handed to a writer thread per source,
+ * which encodes and compresses them into chunks of
+ * "<dir>/packets-if<ID>-<epoch>.scol" and "<dir>/flows-if<ID>-<epoch>.scol"
+ * (format in columnar.h, read with `SnifferArchive`). If the writer is still
+ * busy with the previous batch when the next one fills, rows are dropped and
+ * counted rather than stalling capture.
+ */
+
+#ifndef METADATA_ARCHIVE_H
+#define METADATA_ARCHIVE_H
+
+#include <stdint.h>
+#include "Types.h"
+
+/**
+ * @brief Archive settings (shared by all sources).
+ */
+typedef struct {
+    char directory[256];
+    uint32_t chunk_rows;        // Packet records per chunk (flow chunks hold an eighth)
+    uint32_t flush_seconds;     // A partial chunk is written once its first row is this old
+    uint32_t rotate_seconds;    // Start new files after this long (0 = never)
+} ArchiveConfig;
+
+typedef struct MetadataArchive MetadataArchive;
+
+/**
+ * @brief Fills @p config with the defaults (65536-row chunks, 10 s flush, hourly files).
+ */
+void archive_config_defaults(ArchiveConfig* config);
+
+/**
+ * @brief Allocates the batches of one source and starts its writer thread.
+ * @return MetadataArchive* or NULL on failure.
+ */
+MetadataArchive* archive_create(const ArchiveConfig* config, int if_id);
+
+/**
+ * @brief Writes the partial batches, then stops the thread and closes the files.
+ */
+void archive_destroy(MetadataArchive* archive);
+
+/**
+ * @brief Archives one exported packet record (capture thread).
+ */
+void archive_packet(MetadataArchive* archive, const PacketMetadata* meta);
+
+/**
+ * @brief Archives one flow record (capture thread).
+ */
+void archive_flow(MetadataArchive* archive, const FlowRecord* record);
+
+/**
+ * @brief Hands partial batches older than flush_seconds to the writer (capture thread).
+ */
+void archive_housekeeping(MetadataArchive* archive);
+
+/**
+ * @brief Emits {"event": "archive"}: rows and drops since the last call, chunk and byte totals.
+ */
+void archive_publish(MetadataArchive* archive);
+
+#endif // METADATA_ARCHIVE_H
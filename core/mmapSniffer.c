@@ -3,9 +3,13 @@
  * @brief Implementation of the Zero-Copy engine.
  */
 
+#define _GNU_SOURCE
 #include "mmapSniffer.h"
 #include "packetParser.h" // The dispatcher we created earlier
 #include "logger.h"
+#include "clock.h"
+#include "rawSocket.h"
+#include "mem_pool.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -14,22 +18,32 @@
 #include <sys/mman.h>
 #include <sys/socket.h>
 #include <linux/if_packet.h>
-#include <poll.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
 #include <errno.h>
 #include <net/if_arp.h>
 #include <sys/ioctl.h>
 #include <net/if.h>
+#include <linux/filter.h>
 
 // Global flag from main.c to control the loop
 extern volatile int keep_running;
 
-// --- Private Context (Encapsulated) ---
-// These variables are static so they are hidden from other files.
-static struct {
-    char *buffer_start;     // The pointer to the shared memory
-    size_t total_size;      // Total size of the ring
-    struct tpacket_req req; // Kernel configuration struct
-} ring_ctx;
+// Frames processed from one ring before moving on to the next one,
+// so a busy interface cannot starve the others in the epoll loop.
+#define RING_BATCH_BUDGET 64
+
+// Interval between capture_loop metric events
+#define METRICS_INTERVAL_MS 1000
+
+// Older libc headers may lack the busy-poll socket options
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46
+#endif
+#ifndef SO_PREFER_BUSY_POLL
+#define SO_PREFER_BUSY_POLL 69
+#endif
 
 
 /**
@@ -58,7 +72,37 @@ int is_interface_monitor_mode(const char* iface_name) {
 }
 
 
-int setup_zero_copy_ring(int sock_fd) {
+static RingConfig ring_config = {
+    .memory_budget = RING_DEFAULT_BUDGET,
+    .block_size = RING_DEFAULT_BLOCK,
+    .frame_size = RING_DEFAULT_FRAME,
+    .snaplen = 0,
+};
+
+void set_ring_config(const RingConfig* config) {
+    ring_config = *config;
+}
+
+/**
+ * @brief Attaches a one-instruction filter accepting every frame, truncated to @p snaplen.
+ */
+static int attach_snaplen_filter(int sock_fd, unsigned int snaplen) {
+    struct sock_filter code[] = {
+        BPF_STMT(BPF_RET | BPF_K, snaplen),
+    };
+    struct sock_fprog prog = { .len = 1, .filter = code };
+
+    if (setsockopt(sock_fd, SOL_SOCKET, SO_ATTACH_FILTER, &prog, sizeof(prog)) < 0) {
+        perror("[ERROR] setsockopt SO_ATTACH_FILTER failed");
+        return -1;
+    }
+    return 0;
+}
+
+int setup_zero_copy_ring(CaptureSource* src) {
+    RingContext *ring = &src->ring;
+    int sock_fd = src->sock_fd;
+
     // 0. Set TPACKET_V2 (required for tpacket2_hdr and tp_mac)
     int version = TPACKET_V2;
     if (setsockopt(sock_fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) {
@@ -66,101 +110,530 @@ int setup_zero_copy_ring(int sock_fd) {
         return -1;
     }
 
-    // 1. Determine optimal block size (Page Aligned)
+    // 1. Derive the geometry from the configuration
+    unsigned int frame_size = TPACKET_ALIGN(ring_config.frame_size);
+
+    // Header-only capture: the filter bounds the copy, the slot only needs to hold it.
+    // The kernel places the network header 16-byte aligned after the tpacket header.
+    unsigned int snaplen = src->parser.is_monitor ? 0 : ring_config.snaplen;
+    if (snaplen > 0) {
+        if (attach_snaplen_filter(sock_fd, snaplen) != 0) return -1;
+        frame_size = TPACKET_ALIGN(TPACKET2_HDRLEN + 16 + snaplen);
+    }
+    if (frame_size < TPACKET_ALIGN(TPACKET2_HDRLEN + 64)) {
+        frame_size = TPACKET_ALIGN(TPACKET2_HDRLEN + 64);
+    }
+
+    // Blocks are page aligned powers of two that hold at least one frame
     unsigned int block_size = getpagesize(); // Typically 4096 bytes
-    unsigned int frame_size = 2048;          // Max packet size + headers
-    
-    // Ensure block size is large enough to hold frames
-    while (block_size < frame_size) {
+    while (block_size < ring_config.block_size || block_size < frame_size) {
         block_size <<= 1;
     }
 
+    unsigned int block_nr = (unsigned int)(ring_config.memory_budget / block_size);
+    if (block_nr == 0) block_nr = 1;
+
     // 2. Configure Ring Buffer Parameters
-    memset(&ring_ctx.req, 0, sizeof(ring_ctx.req));
-    ring_ctx.req.tp_block_size = block_size;
-    ring_ctx.req.tp_frame_size = frame_size;
-    ring_ctx.req.tp_block_nr   = 64; // Number of blocks (Depth of buffer)
+    memset(&ring->req, 0, sizeof(ring->req));
+    ring->req.tp_block_size = block_size;
+    ring->req.tp_frame_size = frame_size;
+    ring->req.tp_block_nr   = block_nr; // Number of blocks (Depth of buffer)
     
-    // Calculate frame count: (BlockSize * BlockCount) / FrameSize
-    ring_ctx.req.tp_frame_nr = (ring_ctx.req.tp_block_size * ring_ctx.req.tp_block_nr) / ring_ctx.req.tp_frame_size;
+    // Calculate frame count: frames never straddle blocks
+    ring->req.tp_frame_nr = (block_size / frame_size) * block_nr;
 
-    // 3. Request the Ring from Kernel
-    if (setsockopt(sock_fd, SOL_PACKET, PACKET_RX_RING, &ring_ctx.req, sizeof(ring_ctx.req)) < 0) {
+    // 3. Request the Ring from Kernel (allocated on the NIC's node while we prefer it)
+    numa_prefer_node(src->numa_node);
+    int ret = setsockopt(sock_fd, SOL_PACKET, PACKET_RX_RING, &ring->req, sizeof(ring->req));
+    numa_prefer_node(NUMA_NODE_ANY);
+    if (ret < 0) {
         perror("[ERROR] setsockopt PACKET_RX_RING failed");
         return -1;
     }
 
     // 4. Map Memory (The "Zero Copy" Step)
-    ring_ctx.total_size = ring_ctx.req.tp_block_nr * ring_ctx.req.tp_block_size;
+    ring->total_size = (size_t)ring->req.tp_block_nr * ring->req.tp_block_size;
+    ring->frame_idx = 0;
+    ring->frames_per_block = block_size / frame_size;
     
-    ring_ctx.buffer_start = mmap(NULL, ring_ctx.total_size, 
-                                 PROT_READ | PROT_WRITE, MAP_SHARED, sock_fd, 0);
+    ring->buffer_start = mmap(NULL, ring->total_size, 
+                              PROT_READ | PROT_WRITE, MAP_SHARED, sock_fd, 0);
 
-    if (ring_ctx.buffer_start == MAP_FAILED) {
+    if (ring->buffer_start == MAP_FAILED) {
+        ring->buffer_start = NULL;
         perror("[ERROR] mmap failed");
         return -1;
     }
 
-    log_message("[INFO] Zero-Copy Ring Initialized. Frames: %d, Total Memory: %lu bytes\n", 
-                ring_ctx.req.tp_frame_nr, ring_ctx.total_size);
+    char snap[32] = "full frames";
+    if (snaplen > 0) snprintf(snap, sizeof(snap), "snaplen %u", snaplen);
+    log_message("[INFO] [%s] Zero-Copy Ring Initialized. %u blocks x %u KB, %u frames of %u bytes (%s), "
+                "Total Memory: %lu bytes, NIC node %d, ring on node %d\n",
+                src->name, block_nr, block_size / 1024, ring->req.tp_frame_nr, frame_size, snap,
+                ring->total_size, src->numa_node, numa_node_of_address(ring->buffer_start));
     
     return 0;
 }
 
-void start_zero_copy_capture(int sock_fd) {
-    unsigned int frame_idx = 0;
-    struct tpacket2_hdr *header;
-    struct pollfd pfd;
-
-    // Setup polling
-    pfd.fd = sock_fd;
-    pfd.events = POLLIN;
+static inline struct tpacket2_hdr* ring_frame(const RingContext* ring, unsigned int idx) {
+    unsigned int block = idx / ring->frames_per_block;
+    unsigned int slot = idx % ring->frames_per_block;
+    return (struct tpacket2_hdr *)(ring->buffer_start + (size_t)block * ring->req.tp_block_size +
+                                   (size_t)slot * ring->req.tp_frame_size);
+}
 
-    log_message("[INFO] Starting High-Performance Capture Loop...\n");
+/**
+ * @brief Drains up to @p budget ready frames from a source's ring.
+ * @param first_ts_ns Output: kernel timestamp of the first frame processed.
+ * @return Number of frames processed (0 if the current frame still belongs to the kernel).
+ */
+static int mmap_rx_burst(CaptureSource* src, int budget, uint64_t* first_ts_ns) {
+    RingContext *ring = &src->ring;
+    int processed = 0;
 
-    while (keep_running) {
+    while (processed < budget) {
         // Compute pointer to the current frame header
-        header = (struct tpacket2_hdr *)(ring_ctx.buffer_start + (frame_idx * ring_ctx.req.tp_frame_size));
+        struct tpacket2_hdr *header = ring_frame(ring, ring->frame_idx);
 
-        // --- POLLING: Wait for the Kernel to give us data ---
         // Check Status Bit: If TP_STATUS_USER (1) is NOT set, the frame belongs to Kernel.
-        if ((header->tp_status & TP_STATUS_USER) == 0) {
-            // No data ready. Sleep efficiently.
-            int ret = poll(&pfd, 1, 100); // 100ms timeout
-            if (ret < 0) {
-                if (errno == EINTR) continue; // Interrupted by signal (Ctrl+C)
-                break; // Real error
-            }
-            continue;
+        if ((__atomic_load_n(&header->tp_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0) {
+            break;
         }
 
-        // --- PROCESSING: Data is ready in User Space ---
-        
         // Safety check for packet loss
         if (header->tp_status & TP_STATUS_LOSING) {
-             log_message("[WARN] Ring Buffer Full - Packet Dropped by Kernel\n");
+             log_limited(LOG_LEVEL_WARN, 1, 5, "[WARN] [%s] Ring Buffer Full - Packet Dropped by Kernel\n", src->name);
         }
         
         // Get pointer to the actual packet data
         // header->tp_mac is the offset to the MAC header
         unsigned char *packet_ptr = (unsigned char *)header + header->tp_mac;
         
-        // Dispatch to our parser (The "Traffic Cop")
-        // Note: tp_snaplen is the captured length
-        process_packet(packet_ptr, header->tp_snaplen);
+        // Dispatch to our parser (The "Traffic Cop") with this source's context
+        // Note: tp_snaplen is the captured length, tp_len the length on the wire
+        uint64_t timestamp_ns = (uint64_t)header->tp_sec * 1000000000ULL + header->tp_nsec;
+        if (processed == 0) *first_ts_ns = timestamp_ns;
+
+        // The kernel already knows whether the transport checksum can (or needs to) be checked
+        uint32_t capture_flags = 0;
+        if (header->tp_status & TP_STATUS_CSUMNOTREADY) capture_flags |= CAPTURE_CSUM_NOT_READY;
+        if (header->tp_status & TP_STATUS_CSUM_VALID) capture_flags |= CAPTURE_CSUM_VALID;
+
+        process_packet(&src->parser, packet_ptr, header->tp_snaplen, header->tp_len, timestamp_ns,
+                       capture_flags);
 
         // --- HANDSHAKE: Return Frame to Kernel ---
-        header->tp_status = TP_STATUS_KERNEL;
+        __atomic_store_n(&header->tp_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
         
         // Advance Ring Pointer
-        frame_idx = (frame_idx + 1) % ring_ctx.req.tp_frame_nr;
+        ring->frame_idx = (ring->frame_idx + 1) % ring->req.tp_frame_nr;
+        processed++;
+    }
+
+    return processed;
+}
+
+/**
+ * @brief Estimates the backlog from 16 probes ahead of the read position.
+ *
+ * The kernel fills TPACKET_V2 frames in ring order, so the backlog is the run
+ * of user-owned frames starting at the current one.
+ */
+static int mmap_occupancy(CaptureSource* src) {
+    const RingContext *ring = &src->ring;
+    unsigned int frames = ring->req.tp_frame_nr;
+    int ready = 0;
+
+    for (unsigned int k = 1; k <= 16; k++) {
+        unsigned int idx = (ring->frame_idx + (unsigned int)((uint64_t)frames * k / 16) - 1) % frames;
+        if ((__atomic_load_n(&ring_frame(ring, idx)->tp_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0) {
+            break;
+        }
+        ready++;
+    }
+    return ready * 100 / 16;
+}
+
+// The kernel resets the counters on every read
+static uint64_t mmap_drops(CaptureSource* src) {
+    struct tpacket_stats stats;
+    socklen_t len = sizeof(stats);
+    if (getsockopt(src->sock_fd, SOL_PACKET, PACKET_STATISTICS, &stats, &len) != 0) return 0;
+    return stats.tp_drops;
+}
+
+static int mmap_open(CaptureSource* src) {
+    src->sock_fd = create_raw_socket(src->name);
+    if (src->sock_fd == -1) {
+        return -1;
+    }
+
+    if (setup_zero_copy_ring(src) != 0) {
+        close_raw_socket(src->sock_fd, src->name);
+        src->sock_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+static void mmap_close(CaptureSource* src) {
+    cleanup_zero_copy_ring(src);
+    close_raw_socket(src->sock_fd, src->name);
+    src->sock_fd = -1;
+}
+
+const CaptureBackend mmap_capture_backend = {
+    .name = "mmap",
+    .open = mmap_open,
+    .rx_burst = mmap_rx_burst,
+    .occupancy = mmap_occupancy,
+    .drops = mmap_drops,
+    .close = mmap_close,
+};
+
+// --- Wait Strategies ---
+
+/**
+ * @brief Spin-wait hint: lets the sibling hyperthread run and saves power while spinning.
+ */
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+static const char* wait_strategy_name(WaitStrategy wait) {
+    switch (wait) {
+        case WAIT_BUSY_SPIN: return "spin";
+        case WAIT_ADAPTIVE:  return "adaptive";
+        default:             return "poll";
+    }
+}
+
+/**
+ * @brief One capture loop (the epoll loop, or one per-ring thread) and its wait metrics.
+ */
+typedef struct {
+    char name[IFNAMSIZ];
+    CaptureSource* sources[MAX_CAPTURE_SOURCES];
+    int count;
+    int epfd;
+    const CaptureLoopConfig* config;
+
+    // Wait state
+    uint64_t spin_start_ns;     // Adaptive mode: when the current spin began (0 = not spinning)
+    int idle;                   // Last pass found every ring empty
+
+    // Metrics for the current reporting interval
+    uint64_t packets;
+    uint64_t wakeups;           // Idle -> data transitions
+    uint64_t latency_samples;   // Wake-ups with a kernel timestamp
+    uint64_t sleeps;            // Blocking waits (syscalls)
+    uint64_t latency_sum_ns;
+    uint64_t latency_max_ns;
+    uint64_t latency_hist[40];  // log2(ns) buckets
+    uint64_t next_report_ms;
+    uint64_t last_report_ns;
+    uint64_t last_cpu_ns;
+} CaptureLoop;
+
+static uint64_t thread_cpu_ns(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_THREAD, &usage) != 0) return 0;
+    return ((uint64_t)usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000ULL +
+           ((uint64_t)usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000ULL;
+}
+
+static void record_latency(CaptureLoop* loop, uint64_t first_ts_ns) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t now_ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    uint64_t latency = (now_ns > first_ts_ns) ? now_ns - first_ts_ns : 0;
+
+    int bucket = latency ? 63 - __builtin_clzll(latency) : 0;
+    if (bucket >= 40) bucket = 39;
+
+    loop->latency_samples++;
+    loop->latency_sum_ns += latency;
+    loop->latency_hist[bucket]++;
+    if (latency > loop->latency_max_ns) loop->latency_max_ns = latency;
+}
+
+// Upper bound (in µs) of the histogram bucket holding the given percentile, capped at the max
+static double latency_percentile_us(const CaptureLoop* loop, double pct) {
+    uint64_t target = (uint64_t)(loop->latency_samples * pct / 100.0);
+    uint64_t seen = 0;
+    uint64_t bound = loop->latency_max_ns;
+    for (int i = 0; i < 40; i++) {
+        seen += loop->latency_hist[i];
+        if (seen > target) {
+            if ((1ULL << (i + 1)) < bound) bound = 1ULL << (i + 1);
+            break;
+        }
     }
+    return (double)bound / 1000.0;
 }
 
-void cleanup_zero_copy_ring(void) {
-    if (ring_ctx.buffer_start) {
-        munmap(ring_ctx.buffer_start, ring_ctx.total_size);
-        ring_ctx.buffer_start = NULL;
-        log_message("[INFO] Ring Buffer Unmapped. Memory freed.\n");
+static void report_loop_metrics(CaptureLoop* loop, uint64_t now_ns) {
+    uint64_t cpu_ns = thread_cpu_ns();
+    uint64_t wall_ns = now_ns - loop->last_report_ns;
+    double cpu_pct = wall_ns ? 100.0 * (double)(cpu_ns - loop->last_cpu_ns) / (double)wall_ns : 0.0;
+
+    uint64_t drops = 0;
+    for (int i = 0; i < loop->count; i++) {
+        CaptureSource* src = loop->sources[i];
+        if (src->backend->drops) drops += src->backend->drops(src);
+    }
+
+    char json[512];
+    snprintf(json, sizeof(json),
+        "{\"event\": \"capture_loop\","
+        "\"loop\": \"%s\","
+        "\"backend\": \"%s\","
+        "\"strategy\": \"%s\","
+        "\"packets\": %llu,"
+        "\"drops\": %llu,"
+        "\"pps\": %.0f,"
+        "\"wakeups\": %llu,"
+        "\"sleeps\": %llu,"
+        "\"latency_us_avg\": %.2f,"
+        "\"latency_us_p50\": %.2f,"
+        "\"latency_us_p99\": %.2f,"
+        "\"latency_us_max\": %.2f,"
+        "\"cpu_pct\": %.1f}",
+        loop->name, loop->sources[0]->backend->name, wait_strategy_name(loop->config->wait),
+        (unsigned long long)loop->packets, (unsigned long long)drops,
+        wall_ns ? (double)loop->packets * 1e9 / (double)wall_ns : 0.0,
+        (unsigned long long)loop->wakeups, (unsigned long long)loop->sleeps,
+        loop->latency_samples ? (double)loop->latency_sum_ns / loop->latency_samples / 1000.0 : 0.0,
+        latency_percentile_us(loop, 50.0), latency_percentile_us(loop, 99.0),
+        (double)loop->latency_max_ns / 1000.0, cpu_pct);
+    log_event(json);
+
+    loop->packets = 0;
+    loop->wakeups = 0;
+    loop->latency_samples = 0;
+    loop->sleeps = 0;
+    loop->latency_sum_ns = 0;
+    loop->latency_max_ns = 0;
+    memset(loop->latency_hist, 0, sizeof(loop->latency_hist));
+    loop->next_report_ms = clock_coarse_ms() + METRICS_INTERVAL_MS;
+    loop->last_report_ns = now_ns;
+    loop->last_cpu_ns = cpu_ns;
+}
+
+// Feeds the overload controller: backlog left behind, queueing delay, processing time
+static void observe_load(CaptureSource* src, OverloadControl* overload, int processed, uint64_t first_ts_ns,
+                         uint64_t start_ns) {
+    uint64_t end_ns = clock_now_ns();
+    uint64_t lag_ns = 0;
+    if (first_ts_ns) {
+        // Kernel timestamps are wall clock
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        uint64_t wall_ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec - (end_ns - start_ns);
+        lag_ns = (wall_ns > first_ts_ns) ? wall_ns - first_ts_ns : 0;
+    }
+
+    // A burst that stopped short drained the ring
+    int ring_pct = 0;
+    if (processed == RING_BATCH_BUDGET && src->backend->occupancy) {
+        ring_pct = src->backend->occupancy(src);
+    }
+    overload_observe(overload, (uint32_t)ring_pct, lag_ns, end_ns - start_ns, (uint32_t)processed);
+}
+
+/**
+ * @brief Waits for more frames according to the configured strategy.
+ * @return 0 to keep looping, -1 on a fatal error.
+ */
+static int wait_for_frames(CaptureLoop* loop) {
+    const CaptureLoopConfig* cfg = loop->config;
+    struct epoll_event events[MAX_CAPTURE_SOURCES];
+
+    if (cfg->wait == WAIT_BUSY_SPIN) {
+        // Never sleep: re-check the ring status words immediately
+        cpu_relax();
+        return 0;
+    }
+
+    if (cfg->wait == WAIT_ADAPTIVE) {
+        uint64_t now = clock_now_ns();
+        if (loop->spin_start_ns == 0) loop->spin_start_ns = now;
+        if (now - loop->spin_start_ns < (uint64_t)cfg->spin_budget_us * 1000ULL) {
+            cpu_relax();
+            return 0;
+        }
+    }
+
+    // Spin budget exhausted (or plain poll): sleep until one of the rings has data
+    loop->spin_start_ns = 0;
+    loop->sleeps++;
+    int ret = epoll_wait(loop->epfd, events, MAX_CAPTURE_SOURCES, 100); // 100ms timeout
+    if (ret < 0 && errno != EINTR) {
+        return -1; // Real error (EINTR = Ctrl+C)
+    }
+    return 0;
+}
+
+static void apply_busy_poll(CaptureSource* src, uint32_t busy_poll_us) {
+    int usec = (int)busy_poll_us;
+    if (setsockopt(src->sock_fd, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec)) < 0) {
+        log_message("[WARN] [%s] SO_BUSY_POLL not applied: %s\n", src->name, strerror(errno));
+        return;
+    }
+
+    int prefer = 1;
+    if (setsockopt(src->sock_fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer)) < 0) {
+        log_message("[WARN] [%s] SO_PREFER_BUSY_POLL not applied: %s\n", src->name, strerror(errno));
+    }
+    log_message("[INFO] [%s] Socket busy polling enabled (%u us)\n", src->name, busy_poll_us);
+}
+
+/**
+ * @brief Services the loop's rings until keep_running is cleared.
+ */
+static void run_capture_loop(CaptureLoop* loop) {
+    // Keep the worker on the cores next to its NIC (and the memory it touches)
+    int node = loop->sources[0]->numa_node;
+    if (node >= 0 && numa_node_count() > 1) {
+        if (numa_bind_thread(node) == 0) {
+            log_message("[INFO] [%s] Capture loop bound to NUMA node %d\n", loop->name, node);
+        } else {
+            log_message("[WARN] [%s] Could not bind capture loop to NUMA node %d\n", loop->name, node);
+        }
+    }
+
+    loop->epfd = epoll_create1(0);
+    if (loop->epfd < 0) {
+        perror("[ERROR] epoll_create1 failed");
+        return;
+    }
+
+    for (int i = 0; i < loop->count; i++) {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = loop->sources[i];
+        if (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, loop->sources[i]->sock_fd, &ev) < 0) {
+            perror("[ERROR] epoll_ctl failed");
+            close(loop->epfd);
+            return;
+        }
     }
-}
\ No newline at end of file
+
+    loop->next_report_ms = clock_coarse_ms() + METRICS_INTERVAL_MS;
+    loop->last_report_ns = clock_now_ns();
+    loop->last_cpu_ns = thread_cpu_ns();
+
+    while (keep_running) {
+        // Round-robin over all rings with a per-ring budget
+        int total = 0;
+        for (int i = 0; i < loop->count; i++) {
+            uint64_t first_ts_ns = 0;
+            CaptureSource* src = loop->sources[i];
+            OverloadControl* overload = src->parser.overload;
+            uint64_t start_ns = overload ? clock_now_ns() : 0;
+            int processed = src->backend->rx_burst(src, RING_BATCH_BUDGET, &first_ts_ns);
+            if (overload && processed > 0) {
+                observe_load(src, overload, processed, first_ts_ns, start_ns);
+            }
+            if (processed > 0 && loop->idle) {
+                // Wake-up latency needs a kernel receive timestamp
+                loop->wakeups++;
+                if (first_ts_ns) record_latency(loop, first_ts_ns);
+                loop->idle = 0;
+            }
+            loop->packets += processed;
+            total += processed;
+            parser_housekeeping(&src->parser);
+        }
+
+        if (clock_coarse_ms() >= loop->next_report_ms) {
+            report_loop_metrics(loop, clock_now_ns());
+        }
+
+        if (total > 0) {
+            loop->spin_start_ns = 0;
+            continue;
+        }
+
+        // Every ring is empty: wait according to the strategy
+        loop->idle = 1;
+        if (wait_for_frames(loop) != 0) {
+            break;
+        }
+    }
+
+    // Final partial interval
+    report_loop_metrics(loop, clock_now_ns());
+    close(loop->epfd);
+}
+
+static void* capture_thread(void* arg) {
+    run_capture_loop((CaptureLoop*)arg);
+    return NULL;
+}
+
+void start_zero_copy_capture(CaptureSource* sources, int count, const CaptureLoopConfig* config) {
+    int threaded = (config->mode == CAPTURE_LOOP_THREADS && count > 1);
+
+    log_message("[INFO] Starting High-Performance Capture Loop on %d interface(s) (%s, %s wait)...\n",
+                count, threaded ? "thread per ring" : "epoll", wait_strategy_name(config->wait));
+
+    for (int i = 0; i < count; i++) {
+        if (config->busy_poll_us > 0) {
+            apply_busy_poll(&sources[i], config->busy_poll_us);
+        }
+    }
+
+    static CaptureLoop loops[MAX_CAPTURE_SOURCES];
+    memset(loops, 0, sizeof(loops));
+
+    if (!threaded) {
+        // Unified event loop: one thread services every ring
+        CaptureLoop* loop = &loops[0];
+        snprintf(loop->name, sizeof(loop->name), "%s", count == 1 ? sources[0].name : "epoll");
+        loop->config = config;
+        loop->count = count;
+        for (int i = 0; i < count; i++) loop->sources[i] = &sources[i];
+        run_capture_loop(loop);
+        return;
+    }
+
+    // One dedicated thread (and loop) per ring
+    pthread_t threads[MAX_CAPTURE_SOURCES];
+    int started = 0;
+
+    for (int i = 0; i < count; i++) {
+        CaptureLoop* loop = &loops[i];
+        snprintf(loop->name, sizeof(loop->name), "%s", sources[i].name);
+        loop->config = config;
+        loop->count = 1;
+        loop->sources[0] = &sources[i];
+
+        if (pthread_create(&threads[i], NULL, capture_thread, loop) != 0) {
+            perror("[ERROR] Failed to create capture thread");
+            keep_running = 0;
+            break;
+        }
+        started++;
+    }
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+void cleanup_zero_copy_ring(CaptureSource* src) {
+    RingContext *ring = &src->ring;
+    if (ring->buffer_start) {
+        munmap(ring->buffer_start, ring->total_size);
+        ring->buffer_start = NULL;
+        log_message("[INFO] [%s] Ring Buffer Unmapped. Memory freed.\n", src->name);
+    }
+}
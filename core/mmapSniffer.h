@@ -3,35 +3,146 @@
  * @brief Zero-Copy Packet Capture Engine using Linux PACKET_MMAP.
  *
  * This module abstracts the complexity of Ring Buffers, mmap, and polling.
- * It provides a simple API to initialize and run a high-performance capture loop.
+ * It provides a simple API to initialize and run a high-performance capture loop
+ * over one or more interfaces.
  */
 
 #ifndef MMAP_SNIFFER_H
 #define MMAP_SNIFFER_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include <net/if.h>
+#include <linux/if_packet.h>
+#include "packetParser.h"
+#include "captureBackend.h"
+
+/**
+ * @brief Maximum number of interfaces captured by a single process.
+ */
+#define MAX_CAPTURE_SOURCES 8
+
+/**
+ * @brief Default RX ring memory per source (bytes).
+ */
+#define RING_DEFAULT_BUDGET (8u * 1024 * 1024)
+
+/**
+ * @brief Default ring block size (bytes). Power of two, a multiple of the page size.
+ */
+#define RING_DEFAULT_BLOCK  (128u * 1024)
+
+/**
+ * @brief Default frame slot size (bytes): a full Ethernet frame plus the tpacket header.
+ */
+#define RING_DEFAULT_FRAME  2048u
+
+/**
+ * @brief Header-only snaplen: Ethernet + IPv4 with options + TCP with options (14 + 60 + 54).
+ */
+#define RING_HEADER_ONLY_SNAPLEN 128u
+
+/**
+ * @brief RX ring geometry. The block count follows from the memory budget.
+ *
+ * With a snaplen, a socket filter returning that length makes the kernel copy
+ * only the head of each frame, and the frame slots shrink to fit it, so the
+ * same memory holds many more frames. Monitor sources always get whole frames
+ * (EAPOL and management bodies are needed).
+ */
+typedef struct {
+    size_t memory_budget;       // Bytes of ring memory per source
+    unsigned int block_size;    // Bytes per block (rounded to a power of two >= page size)
+    unsigned int frame_size;    // Bytes per frame slot (rounded to TPACKET_ALIGNMENT)
+    unsigned int snaplen;       // Bytes copied per Ethernet frame (0 = whole frames); sets the slot size
+} RingConfig;
+
+/**
+ * @brief Mapped RX ring of a single socket.
+ */
+typedef struct {
+    char *buffer_start;     // The pointer to the shared memory
+    size_t total_size;      // Total size of the ring
+    struct tpacket_req req; // Kernel configuration struct
+    unsigned int frame_idx; // Next frame to read
+    unsigned int frames_per_block; // Frames never straddle a block boundary
+} RingContext;
+
+/**
+ * @brief One capture source: an interface with its own socket, ring and parser dispatch.
+ */
+typedef struct CaptureSource {
+    char name[IFNAMSIZ];    // Interface name
+    int sock_fd;            // Bound socket (pollable, whatever the backend)
+    const CaptureBackend* backend; // Backend that owns the socket and ring
+    RingContext ring;       // Its RX ring (mmap backend)
+    void* backend_data;     // Backend-private state (AF_XDP socket)
+    int numa_node;          // NUMA node of the NIC (NUMA_NODE_ANY if unknown)
+    ParserContext parser;   // Per-source parser dispatch (mode, interface ID)
+} CaptureSource;
+
+/**
+ * @brief How the rings of several sources are serviced.
+ */
+typedef enum {
+    CAPTURE_LOOP_EPOLL,     // One thread multiplexes all rings with epoll
+    CAPTURE_LOOP_THREADS    // One dedicated thread per ring
+} CaptureLoopMode;
+
+/**
+ * @brief What a capture loop does when every ring it services is empty.
+ */
+typedef enum {
+    WAIT_POLL,              // Sleep in epoll_wait() (lowest CPU, highest wake-up latency)
+    WAIT_BUSY_SPIN,         // Spin on the ring status words with a pause hint (one full core)
+    WAIT_ADAPTIVE           // Spin for a budget, then fall back to epoll_wait()
+} WaitStrategy;
+
+/**
+ * @brief Capture loop settings.
+ */
+typedef struct {
+    CaptureLoopMode mode;
+    WaitStrategy wait;
+    uint32_t spin_budget_us;    // WAIT_ADAPTIVE: how long to spin before sleeping
+    uint32_t busy_poll_us;      // SO_BUSY_POLL on every socket (0 = off)
+} CaptureLoopConfig;
+
+/**
+ * @brief Sets the ring geometry used by sources opened afterwards.
+ */
+void set_ring_config(const RingConfig* config);
+
 /**
  * @brief Allocates the Ring Buffer in Kernel space and maps it to User space.
- * * Performs the setsockopt(PACKET_RX_RING) and mmap() calls.
- * * @param sock_fd The raw socket file descriptor (must be already bound).
+ * * Performs the setsockopt(PACKET_RX_RING) and mmap() calls. The kernel allocates
+ * the ring on the NIC's NUMA node, and the observed placement is logged.
+ * * @param src The capture source (its socket must be already bound).
  * @return 0 on success, -1 on failure.
  */
-int setup_zero_copy_ring(int sock_fd);
+int setup_zero_copy_ring(CaptureSource* src);
 
 /**
  * @brief Starts the main capture loop (Blocking).
  * * Enters an infinite loop (until keep_running is false) that:
- * 1. Polls the socket for new data.
- * 2. Reads packets directly from the mapped memory (Zero Copy).
- * 3. Dispatches them to the packetParser module.
- * * @param sock_fd The raw socket file descriptor.
+ * 1. Waits on the sockets for new data (epoll or one thread per source).
+ * 2. Asks each source's backend to drain its ring (Zero Copy).
+ * 3. The backend dispatches frames to the packetParser module with the source's context.
+ * * All sources feed the same logger, so output is merged into one export stream.
+ * * Each loop exports a "capture_loop" event every second with its packet rate, wake-up
+ * latency (kernel timestamp to user space) and CPU usage, to compare wait strategies
+ * and backends.
+ * * @param sources Array of initialized capture sources.
+ * @param count Number of sources.
+ * @param config Loop model and wait strategy.
  */
-void start_zero_copy_capture(int sock_fd);
+void start_zero_copy_capture(CaptureSource* sources, int count, const CaptureLoopConfig* config);
 
 /**
- * @brief Frees resources and unmaps the memory.
+ * @brief Frees resources and unmaps the memory of one source.
  */
-void cleanup_zero_copy_ring(void);
+void cleanup_zero_copy_ring(CaptureSource* src);
 
 int is_interface_monitor_mode(const char* iface_name);
 
-#endif // MMAP_SNIFFER_H
\ No newline at end of file
+#endif // MMAP_SNIFFER_H
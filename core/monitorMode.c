@@ -9,6 +9,7 @@
 #include <string.h>
 #include <time.h>
 #include <stdlib.h>
+#include <pthread.h>
 
 // --- Private Helper Prototypes (Static) ---
 static int mhz_to_channel(int freq);
@@ -16,6 +17,9 @@ static void save_handshake_to_file(const unsigned char* buffer, int size);
 static void write_pcap_global_header(FILE *fp);
 static void print_hex_dump(const unsigned char* buffer, int length);
 
+// Several monitor sources may capture handshakes concurrently (one thread per ring)
+static pthread_mutex_t pcap_file_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 
 void parse_monitor_packet(const unsigned char* buffer, int size, PacketMetadata* meta) {
     // 1. Validate Radiotap Header Length
@@ -46,6 +50,8 @@ void parse_monitor_packet(const unsigned char* buffer, int size, PacketMetadata*
     uint16_t frame_control = *(uint16_t*)(buffer + offset);
     uint8_t type = (frame_control >> 2) & 0x3;
     uint8_t subtype = (frame_control >> 4) & 0xF;
+    meta->wlan_type = type;
+    meta->wlan_subtype = subtype;
 
     // Extract MAC Addresses (Dest: +4, Src: +10)
     if (size >= offset + 16) {
@@ -90,8 +96,8 @@ void parse_monitor_packet(const unsigned char* buffer, int size, PacketMetadata*
                         snprintf(meta->ssid, sizeof(meta->ssid), (subtype == 4) ? "[BROADCAST]" : "<HIDDEN>");
                     }
                     
-                    // Log relevant WiFi events
-                    log_message("[%s] [%02X:%02X:%02X:%02X:%02X:%02X] -> '%s' | CH:%d | PWR:%d\n", 
+                    // Log relevant WiFi events (one per beacon: rate-limited)
+                    log_limited(LOG_LEVEL_INFO, 20, 50, "[%s] [%02X:%02X:%02X:%02X:%02X:%02X] -> '%s' | CH:%d | PWR:%d\n", 
                                 packet_type,
                                 meta->src_mac[0], meta->src_mac[1], meta->src_mac[2],
                                 meta->src_mac[3], meta->src_mac[4], meta->src_mac[5],
@@ -122,9 +128,10 @@ void parse_monitor_packet(const unsigned char* buffer, int size, PacketMetadata*
 
         if (found_handshake) {
             snprintf(meta->ssid, sizeof(meta->ssid), "[HANDSHAKE]");
+            meta->is_eapol = 1;
             
-            log_message("\n[!!!] >>> EAPOL HANDSHAKE CAPTURED! <<<\n");
-            log_message("[!!!] Target: %02X:%02X:%02X:%02X:%02X:%02X\n",
+            log_limited(LOG_LEVEL_INFO, 5, 10, "\n[!!!] >>> EAPOL HANDSHAKE CAPTURED! <<<\n");
+            log_limited(LOG_LEVEL_INFO, 5, 10, "[!!!] Target: %02X:%02X:%02X:%02X:%02X:%02X\n",
                         meta->src_mac[0], meta->src_mac[1], meta->src_mac[2],
                         meta->src_mac[3], meta->src_mac[4], meta->src_mac[5]);
 
@@ -162,9 +169,11 @@ static void write_pcap_global_header(FILE *fp) {
 
 static void save_handshake_to_file(const unsigned char* buffer, int size) {
     const char* filename = "captured_handshake.cap";
+    pthread_mutex_lock(&pcap_file_mutex);
     FILE *fp = fopen(filename, "ab"); // Append Binary mode
     
     if (!fp) {
+        pthread_mutex_unlock(&pcap_file_mutex);
         log_message("[ERROR] Could not open file %s for writing\n", filename);
         return;
     }
@@ -190,7 +199,8 @@ static void save_handshake_to_file(const unsigned char* buffer, int size) {
     fwrite(buffer, 1, size, fp);
     
     fclose(fp);
-    log_message("[DISK] Saved EAPOL packet (%d bytes) to %s\n", size, filename);
+    pthread_mutex_unlock(&pcap_file_mutex);
+    log_limited(LOG_LEVEL_INFO, 5, 10, "[DISK] Saved EAPOL packet (%d bytes) to %s\n", size, filename);
 }
 
 static void print_hex_dump(const unsigned char* buffer, int length) {
@@ -200,5 +210,5 @@ static void print_hex_dump(const unsigned char* buffer, int length) {
     for (int i = 0; i < length && i < 32; i++) { 
         pos += snprintf(debug_buf + pos, sizeof(debug_buf) - pos, "%02X ", buffer[i]);
     }
-    log_message("[HEX] %s\n", debug_buf);
+    log_at(LOG_LEVEL_DEBUG, "[HEX] %s\n", debug_buf);
 }
\ No newline at end of file
@@ -0,0 +1,180 @@
+/**
+ * @file overloadControl.c
+ * @brief Implementation of the degradation level controller.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "overloadControl.h"
+#include "logger.h"
+
+#define EVAL_PERIOD_MS      100
+#define RECOVER_BACKOFF_MAX 8       // Recovery delay grows up to this factor
+#define STABLE_RESET_MS     60000   // Normal this long: recovery delay back to the base
+
+static const char* const level_names[OVERLOAD_LEVELS] = {
+    "normal", "no_payload", "headers_only", "sampled", "aggregates"
+};
+
+void overload_config_defaults(OverloadConfig* config) {
+    config->ring_high_pct = 50;
+    config->ring_low_pct = 10;
+    config->queue_high = 16384;
+    config->queue_low = 2048;
+    config->lag_high_us = 50000;
+    config->lag_low_us = 5000;
+    config->escalate_ms = 200;
+    config->recover_ms = 5000;
+    config->shed_rate = 16;
+}
+
+const char* overload_level_name(OverloadLevel level) {
+    return (level >= OVERLOAD_NORMAL && level < OVERLOAD_LEVELS) ? level_names[level] : "?";
+}
+
+OverloadControl* overload_create(const OverloadConfig* config) {
+    OverloadControl* control = (OverloadControl*)calloc(1, sizeof(OverloadControl));
+    if (!control) return NULL;
+    control->config = *config;
+    control->recover_ms = config->recover_ms;
+    return control;
+}
+
+void overload_destroy(OverloadControl* control) {
+    free(control);
+}
+
+// Time at the current level, for the metrics
+static void account_level(OverloadControl* control, uint64_t now_ms) {
+    if (control->last_account_ms && now_ms > control->last_account_ms) {
+        control->ms_at_level[control->level] += now_ms - control->last_account_ms;
+    }
+    control->last_account_ms = now_ms;
+}
+
+static void change_level(OverloadControl* control, int if_id, uint64_t now_ms, OverloadLevel level,
+                         size_t queue_depth) {
+    OverloadLevel previous = control->level;
+    double ns_per_packet = control->packets ? (double)control->busy_ns / (double)control->packets : 0.0;
+
+    account_level(control, now_ms);
+    control->level = level;
+    control->level_since_ms = now_ms;
+    control->changes++;
+
+    char json[512];
+    snprintf(json, sizeof(json),
+        "{\"event\": \"overload\","
+        "\"if_id\": %d,"
+        "\"level\": %d,"
+        "\"name\": \"%s\","
+        "\"previous\": \"%s\","
+        "\"ring_pct\": %u,"
+        "\"queue_depth\": %zu,"
+        "\"lag_us\": %.1f,"
+        "\"ns_per_packet\": %.1f}",
+        if_id, (int)level, level_names[level], level_names[previous], control->ring_pct, queue_depth,
+        (double)control->lag_ns / 1000.0, ns_per_packet);
+    log_event(json);
+
+    if (level > previous) {
+        log_message("[WARN] Overload (ID %d): shedding to %s (ring %u%%, queue %zu, lag %.1f ms)\n", if_id,
+                    level_names[level], control->ring_pct, queue_depth, (double)control->lag_ns / 1e6);
+    } else {
+        log_message("[INFO] Overload (ID %d): recovered to %s\n", if_id, level_names[level]);
+    }
+}
+
+int overload_evaluate(OverloadControl* control, int if_id, uint64_t now_ms) {
+    if (now_ms < control->next_eval_ms) return 0;
+    control->next_eval_ms = now_ms + EVAL_PERIOD_MS;
+    if (control->last_account_ms == 0) control->last_account_ms = now_ms;
+
+    const OverloadConfig* cfg = &control->config;
+    size_t queue_depth = logger_queue_depth();
+    uint64_t lag_us = control->lag_ns / 1000;
+
+    int over = control->ring_pct >= cfg->ring_high_pct || queue_depth >= cfg->queue_high ||
+               lag_us >= cfg->lag_high_us;
+    int calm = control->ring_pct <= cfg->ring_low_pct && queue_depth <= cfg->queue_low &&
+               lag_us <= cfg->lag_low_us;
+
+    // Metrics keep the peaks of the publish interval
+    if (control->ring_pct > control->ring_pct_max) control->ring_pct_max = control->ring_pct;
+    if (queue_depth > control->queue_max) control->queue_max = queue_depth;
+    if (control->lag_ns > control->lag_ns_max) control->lag_ns_max = control->lag_ns;
+    control->metric_busy_ns += control->busy_ns;
+    control->metric_packets += control->packets;
+
+    int changed = 0;
+    if (over) {
+        control->calm_since_ms = 0;
+        if (control->pressure_since_ms == 0) control->pressure_since_ms = now_ms;
+        if (now_ms - control->pressure_since_ms >= cfg->escalate_ms && control->level < OVERLOAD_AGGREGATES) {
+            // Overloaded again right after recovering: the next recovery waits longer
+            if (control->recovered_ms && now_ms - control->recovered_ms < 2ULL * control->recover_ms &&
+                control->recover_ms < cfg->recover_ms * RECOVER_BACKOFF_MAX) {
+                control->recover_ms *= 2;
+            }
+            change_level(control, if_id, now_ms, control->level + 1, queue_depth);
+            control->pressure_since_ms = now_ms; // Give the step time to take effect
+            changed = 1;
+        }
+    } else if (calm) {
+        control->pressure_since_ms = 0;
+        if (control->calm_since_ms == 0) control->calm_since_ms = now_ms;
+        if (control->level > OVERLOAD_NORMAL && now_ms - control->calm_since_ms >= control->recover_ms) {
+            change_level(control, if_id, now_ms, control->level - 1, queue_depth);
+            control->calm_since_ms = now_ms;
+            control->recovered_ms = now_ms;
+            changed = 1;
+        } else if (control->level == OVERLOAD_NORMAL && now_ms - control->level_since_ms >= STABLE_RESET_MS) {
+            control->recover_ms = cfg->recover_ms;
+        }
+    } else {
+        // Between the thresholds: hold the level
+        control->pressure_since_ms = 0;
+        control->calm_since_ms = 0;
+    }
+
+    control->ring_pct = 0;
+    control->lag_ns = 0;
+    control->busy_ns = 0;
+    control->packets = 0;
+    return changed;
+}
+
+void overload_publish(OverloadControl* control, int if_id, uint64_t now_ms) {
+    account_level(control, now_ms);
+
+    char json[512];
+    snprintf(json, sizeof(json),
+        "{\"event\": \"overload_stats\","
+        "\"if_id\": %d,"
+        "\"level\": %d,"
+        "\"name\": \"%s\","
+        "\"changes\": %llu,"
+        "\"ms_at_level\": [%llu, %llu, %llu, %llu, %llu],"
+        "\"ring_pct_max\": %u,"
+        "\"queue_depth_max\": %zu,"
+        "\"lag_us_max\": %.1f,"
+        "\"ns_per_packet\": %.1f,"
+        "\"recover_ms\": %u}",
+        if_id, (int)control->level, level_names[control->level], (unsigned long long)control->changes,
+        (unsigned long long)control->ms_at_level[0], (unsigned long long)control->ms_at_level[1],
+        (unsigned long long)control->ms_at_level[2], (unsigned long long)control->ms_at_level[3],
+        (unsigned long long)control->ms_at_level[4], control->ring_pct_max, control->queue_max,
+        (double)control->lag_ns_max / 1000.0,
+        control->metric_packets ? (double)control->metric_busy_ns / (double)control->metric_packets : 0.0,
+        control->recover_ms);
+    log_event(json);
+
+    control->changes = 0;
+    memset(control->ms_at_level, 0, sizeof(control->ms_at_level));
+    control->ring_pct_max = 0;
+    control->queue_max = 0;
+    control->lag_ns_max = 0;
+    control->metric_busy_ns = 0;
+    control->metric_packets = 0;
+}
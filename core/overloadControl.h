@@ -0,0 +1,133 @@
+/**
+ * @file overloadControl.h
+ * @brief Load shedding: steps the packet path down through degradation levels under overload.
+ *
+ * Each capture source watches three signals of its own pipeline: how full its
+ * receive ring is, how long frames waited in it (kernel timestamp to
+ * processing, the capture stage's latency), and how deep the shared export
+ * queue is (the export stage). While any signal stays above its high threshold
+ * for escalate_ms, the source sheds one more stage:
+ *
+ *   1. no_payload    payload analyzers off (reassembly, DNS, TLS, HTTP)
+ *   2. headers_only  checksum verification and TCP performance analysis off
+ *   3. sampled       export sampling raised to at least 1-in-shed_rate
+ *   4. aggregates    no packet records: stats, flows and events only
+ *
+ * Every signal must stay below its low threshold for recover_ms before one
+ * stage comes back. Between the thresholds the level holds. A source that
+ * overloads again soon after recovering waits twice as long next time (up to
+ * 8x), so a load sitting right at capacity does not make it flap.
+ *
+ * Each source owns its controller; no locks are taken.
+ */
+
+#ifndef OVERLOAD_CONTROL_H
+#define OVERLOAD_CONTROL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {
+    OVERLOAD_NORMAL,
+    OVERLOAD_NO_PAYLOAD,
+    OVERLOAD_HEADERS_ONLY,
+    OVERLOAD_SAMPLED,
+    OVERLOAD_AGGREGATES,
+    OVERLOAD_LEVELS
+} OverloadLevel;
+
+/**
+ * @brief Process-wide thresholds.
+ */
+typedef struct {
+    uint32_t ring_high_pct;     // Ring occupancy (% of frames waiting)
+    uint32_t ring_low_pct;
+    size_t queue_high;          // Export queue depth (records)
+    size_t queue_low;
+    uint32_t lag_high_us;       // Time frames waited in the ring
+    uint32_t lag_low_us;
+    uint32_t escalate_ms;       // Sustained pressure before shedding one more stage
+    uint32_t recover_ms;        // Sustained calm before restoring one
+    uint32_t shed_rate;         // Minimum 1-in-N export sampling from OVERLOAD_SAMPLED on
+} OverloadConfig;
+
+/**
+ * @brief Per-source controller state (single writer, no locking).
+ */
+typedef struct {
+    OverloadConfig config;
+    OverloadLevel level;
+    uint64_t level_since_ms;
+
+    // Signal maxima since the last evaluation
+    uint32_t ring_pct;
+    uint64_t lag_ns;
+    uint64_t busy_ns;           // Time spent processing bursts
+    uint64_t packets;
+
+    uint64_t next_eval_ms;
+    uint64_t pressure_since_ms; // 0 = no sustained pressure
+    uint64_t calm_since_ms;     // 0 = not calm
+    uint64_t recovered_ms;      // Last step back up
+    uint32_t recover_ms;        // Current recovery delay (backs off when flapping)
+
+    // Metrics since the last publish
+    uint64_t changes;
+    uint64_t ms_at_level[OVERLOAD_LEVELS];
+    uint64_t last_account_ms;
+    uint32_t ring_pct_max;
+    size_t queue_max;
+    uint64_t lag_ns_max;
+    uint64_t metric_busy_ns;
+    uint64_t metric_packets;
+} OverloadControl;
+
+/**
+ * @brief Fills @p config with the defaults (ring 50/10 %, queue 16384/2048, lag 50/5 ms, 200 ms / 5 s).
+ */
+void overload_config_defaults(OverloadConfig* config);
+
+/**
+ * @return "normal", "no_payload", "headers_only", "sampled" or "aggregates".
+ */
+const char* overload_level_name(OverloadLevel level);
+
+/**
+ * @brief Allocates the controller of one capture source.
+ * @return OverloadControl* or NULL on allocation failure.
+ */
+OverloadControl* overload_create(const OverloadConfig* config);
+
+void overload_destroy(OverloadControl* control);
+
+/**
+ * @brief Records one burst (capture loop, after each rx_burst).
+ *
+ * @param ring_pct Ring occupancy after the burst, 0-100.
+ * @param lag_ns Age of the burst's first frame when processing started (0 = unknown).
+ * @param busy_ns Time the burst took.
+ * @param packets Frames in the burst.
+ */
+static inline void overload_observe(OverloadControl* control, uint32_t ring_pct, uint64_t lag_ns,
+                                    uint64_t busy_ns, uint32_t packets) {
+    if (ring_pct > control->ring_pct) control->ring_pct = ring_pct;
+    if (lag_ns > control->lag_ns) control->lag_ns = lag_ns;
+    control->busy_ns += busy_ns;
+    control->packets += packets;
+}
+
+/**
+ * @brief Re-evaluates the level (housekeeping; acts every 100 ms).
+ *
+ * Emits {"event": "overload"} on a level change.
+ *
+ * @return 1 if the level changed, 0 otherwise.
+ */
+int overload_evaluate(OverloadControl* control, int if_id, uint64_t now_ms);
+
+/**
+ * @brief Emits {"event": "overload_stats"} with the time spent at each level since the last call.
+ */
+void overload_publish(OverloadControl* control, int if_id, uint64_t now_ms);
+
+#endif // OVERLOAD_CONTROL_H
@@ -0,0 +1,147 @@
+/**
+ * @file packetDedup.c
+ * @brief Implementation of the time-windowed duplicate frame filter.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "packetDedup.h"
+#include "hash.h"
+#include "clock.h"
+#include "logger.h"
+
+#define ETH_HEADER_LEN 14
+#define VLAN_TAG_LEN   4
+
+/**
+ * @brief Copies the slice to hash into @p out with the per-hop fields cleared.
+ * @return Bytes copied.
+ */
+static uint32_t fingerprint_slice(const unsigned char* frame, uint32_t size, uint32_t slice,
+                                  unsigned char* out, uint32_t* l3_len) {
+    uint32_t offset = 0;
+    uint16_t ether_type = 0;
+
+    // Skip the MAC header and up to two VLAN tags: they differ between mirrored ports
+    if (size >= ETH_HEADER_LEN) {
+        offset = ETH_HEADER_LEN;
+        ether_type = (uint16_t)((frame[12] << 8) | frame[13]);
+        for (int tags = 0; tags < 2 && (ether_type == 0x8100 || ether_type == 0x88a8) &&
+                           offset + VLAN_TAG_LEN <= size; tags++) {
+            ether_type = (uint16_t)((frame[offset + 2] << 8) | frame[offset + 3]);
+            offset += VLAN_TAG_LEN;
+        }
+        if (ether_type != 0x0800 && ether_type != 0x86DD) offset = 0;
+    }
+
+    *l3_len = size - offset;
+    uint32_t n = *l3_len < slice ? *l3_len : slice;
+    memcpy(out, frame + offset, n);
+
+    if (offset && ether_type == 0x0800 && n >= 12) {
+        out[8] = 0;                 // TTL
+        out[10] = out[11] = 0;      // Header checksum
+    } else if (offset && ether_type == 0x86DD && n >= 8) {
+        out[7] = 0;                 // Hop limit
+    }
+    return n;
+}
+
+// --- Public API ---
+
+void dedup_config_defaults(DedupConfig* config) {
+    config->window_us = 1000;
+    config->slice = 64;
+    config->slots = DEDUP_DEFAULT_SLOTS;
+}
+
+PacketDedup* dedup_create(const DedupConfig* config) {
+    PacketDedup* dedup = (PacketDedup*)calloc(1, sizeof(PacketDedup));
+    if (!dedup) return NULL;
+
+    dedup->config = *config;
+    if (dedup->config.slice == 0) dedup->config.slice = 1;
+    if (dedup->config.slice > DEDUP_MAX_SLICE) dedup->config.slice = DEDUP_MAX_SLICE;
+
+    uint32_t buckets = 64;
+    while (buckets * DEDUP_SLOTS_PER_BUCKET < dedup->config.slots) buckets <<= 1;
+    dedup->bucket_mask = buckets - 1;
+
+    // Every frame touches a random bucket: hugepages keep the lookups TLB friendly
+    if (mem_region_alloc(&dedup->region, (size_t)buckets * DEDUP_SLOTS_PER_BUCKET * sizeof(DedupSlot),
+                         numa_default_node()) != 0) {
+        free(dedup);
+        return NULL;
+    }
+    dedup->slots = (DedupSlot*)dedup->region.base;
+    return dedup;
+}
+
+void dedup_destroy(PacketDedup* dedup) {
+    if (!dedup) return;
+    mem_region_free(&dedup->region);
+    free(dedup);
+}
+
+int dedup_check(PacketDedup* dedup, const unsigned char* frame, int size, uint64_t timestamp_ns) {
+    if (size <= 0) return 0;
+    dedup->packets++;
+
+    unsigned char slice[DEDUP_MAX_SLICE];
+    uint32_t l3_len;
+    uint32_t n = fingerprint_slice(frame, (uint32_t)size, dedup->config.slice, slice, &l3_len);
+
+    // The length seeds the hash, so frames that only differ past the slice stay distinct
+    uint64_t h = hash_bytes(slice, n, l3_len);
+    uint32_t tag = (uint32_t)(h >> 32);
+    if (tag == 0) tag = 1;
+
+    uint32_t now_us = (uint32_t)((timestamp_ns ? timestamp_ns : clock_now_ns()) / 1000);
+    DedupSlot* bucket = &dedup->slots[(h & dedup->bucket_mask) * DEDUP_SLOTS_PER_BUCKET];
+
+    DedupSlot* victim = &bucket[0];
+    uint32_t victim_age = 0;
+    for (int i = 0; i < DEDUP_SLOTS_PER_BUCKET; i++) {
+        DedupSlot* slot = &bucket[i];
+        if (slot->tag == 0) {
+            if (victim_age != UINT32_MAX) {
+                victim = slot;
+                victim_age = UINT32_MAX;
+            }
+            continue;
+        }
+
+        uint32_t age = now_us - slot->seen_us;
+        if (slot->tag == tag && age <= dedup->config.window_us) {
+            dedup->duplicates++;
+            dedup->duplicate_bytes += (uint64_t)size;
+            return 1;
+        }
+        if (age > victim_age) {
+            victim = slot;
+            victim_age = age;
+        }
+    }
+
+    victim->tag = tag;
+    victim->seen_us = now_us;
+    return 0;
+}
+
+void dedup_publish(PacketDedup* dedup, int if_id) {
+    char json[256];
+    snprintf(json, sizeof(json),
+        "{\"event\": \"dedup\","
+        "\"if_id\": %d,"
+        "\"packets\": %llu,"
+        "\"duplicates\": %llu,"
+        "\"duplicate_bytes\": %llu,"
+        "\"window_us\": %u}",
+        if_id,
+        (unsigned long long)dedup->packets, (unsigned long long)dedup->duplicates,
+        (unsigned long long)dedup->duplicate_bytes, dedup->config.window_us);
+    log_event(json);
+
+    dedup->packets = dedup->duplicates = dedup->duplicate_bytes = 0;
+}
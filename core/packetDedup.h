@@ -0,0 +1,89 @@
+/**
+ * @file packetDedup.h
+ * @brief Duplicate frame suppression for SPAN / mirror-port captures (runs before parsing).
+ *
+ * A mirror port often delivers the same frame two or three times within
+ * microseconds (once per mirrored port it crossed). Each frame is reduced to
+ * a 64-bit fingerprint of a configurable slice starting at the IP header, with
+ * the fields a router rewrites (TTL / hop limit and the IPv4 header checksum)
+ * masked out, so copies taken before and after a hop still match. The MAC
+ * header is left out for the same reason; non-IP frames are hashed from the
+ * first byte.
+ *
+ * Fingerprints are kept in a fixed-size, time-windowed hash set: one cache
+ * line of slots per bucket, each slot holding a tag and the time it was seen.
+ * A frame is a duplicate if its tag is in its bucket and younger than the
+ * window; otherwise it replaces the bucket's oldest slot. Memory is fixed and
+ * nothing ever needs to be expired.
+ *
+ * Each capture source owns its own instance, so no locks are taken.
+ */
+
+#ifndef PACKET_DEDUP_H
+#define PACKET_DEDUP_H
+
+#include <stdint.h>
+#include "mem_pool.h"
+
+#define DEDUP_SLOTS_PER_BUCKET 8        // One 64-byte cache line
+#define DEDUP_DEFAULT_SLOTS    65536    // 512 KB per source
+#define DEDUP_MAX_SLICE        256
+
+/**
+ * @brief Process-wide deduplication settings.
+ */
+typedef struct {
+    uint32_t window_us;         // Copies further apart are not duplicates
+    uint32_t slice;             // Bytes hashed from the IP header on (1 .. DEDUP_MAX_SLICE)
+    uint32_t slots;             // Fingerprints remembered (rounded up to a power of two)
+} DedupConfig;
+
+typedef struct {
+    uint32_t tag;               // Upper hash bits (0 = empty)
+    uint32_t seen_us;           // Low 32 bits of the capture time in µs (wraps every ~71 min)
+} DedupSlot;
+
+/**
+ * @brief Per-source deduplication state (single writer, no locking).
+ */
+typedef struct {
+    DedupConfig config;
+    MemRegion region;
+    DedupSlot* slots;
+    uint32_t bucket_mask;
+
+    // Counters since the last publish
+    uint64_t packets;
+    uint64_t duplicates;
+    uint64_t duplicate_bytes;
+} PacketDedup;
+
+/**
+ * @brief Fills @p config with the defaults (1 ms window, 64-byte slice).
+ */
+void dedup_config_defaults(DedupConfig* config);
+
+/**
+ * @brief Allocates the fingerprint set of one capture source.
+ * @return PacketDedup* or NULL on allocation failure.
+ */
+PacketDedup* dedup_create(const DedupConfig* config);
+
+void dedup_destroy(PacketDedup* dedup);
+
+/**
+ * @brief Checks a frame against the recent ones and remembers it.
+ *
+ * @param frame Frame bytes from the Ethernet header.
+ * @param size Frame length.
+ * @param timestamp_ns Capture time (0 = now).
+ * @return 1 if the frame is a duplicate (drop it), 0 otherwise.
+ */
+int dedup_check(PacketDedup* dedup, const unsigned char* frame, int size, uint64_t timestamp_ns);
+
+/**
+ * @brief Emits {"event": "dedup"} with the counters since the last call, then resets them.
+ */
+void dedup_publish(PacketDedup* dedup, int if_id);
+
+#endif // PACKET_DEDUP_H
@@ -0,0 +1,74 @@
+/**
+ * @file packetFilter.c
+ * @brief Parsing and printing of host / protocol / port filter specs.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include "packetFilter.h"
+
+int parse_packet_filter(const char* spec, PacketFilter* filter) {
+    char copy[256];
+    snprintf(copy, sizeof(copy), "%s", spec);
+    memset(filter, 0, sizeof(*filter));
+
+    char* save = NULL;
+    for (char* term = strtok_r(copy, ",", &save); term; term = strtok_r(NULL, ",", &save)) {
+        char* value = strchr(term, ':');
+        if (!value) return -1;
+        *value++ = '\0';
+
+        if (strcmp(term, "host") == 0) {
+            if (inet_pton(AF_INET, value, filter->addr) == 1) filter->ip_version = 4;
+            else if (inet_pton(AF_INET6, value, filter->addr) == 1) filter->ip_version = 6;
+            else return -1;
+        } else if (strcmp(term, "proto") == 0) {
+            if (strcmp(value, "tcp") == 0) filter->protocol = IPPROTO_TCP;
+            else if (strcmp(value, "udp") == 0) filter->protocol = IPPROTO_UDP;
+            else if (strcmp(value, "icmp") == 0) filter->protocol = IPPROTO_ICMP;
+            else if (strcmp(value, "icmpv6") == 0) filter->protocol = IPPROTO_ICMPV6;
+            else if (atoi(value) > 0 && atoi(value) < 256) filter->protocol = (uint8_t)atoi(value);
+            else return -1;
+        } else if (strcmp(term, "port") == 0) {
+            int port = atoi(value);
+            if (port <= 0 || port > 65535) return -1;
+            filter->port = (uint16_t)port;
+        } else {
+            return -1;
+        }
+        filter->active = 1;
+    }
+    return filter->active ? 0 : -1;
+}
+
+void packet_filter_describe(const PacketFilter* filter, char* out, size_t len) {
+    if (!filter->active) {
+        snprintf(out, len, "none");
+        return;
+    }
+
+    char host[INET6_ADDRSTRLEN] = "";
+    if (filter->ip_version) {
+        inet_ntop(filter->ip_version == 4 ? AF_INET : AF_INET6, filter->addr, host, sizeof(host));
+    }
+
+    size_t used = 0;
+    out[0] = '\0';
+    if (host[0]) used += (size_t)snprintf(out + used, len - used, "host:%s", host);
+    if (filter->protocol && used < len) {
+        const char* name = filter->protocol == IPPROTO_TCP ? "tcp" : filter->protocol == IPPROTO_UDP ? "udp" :
+                           filter->protocol == IPPROTO_ICMP ? "icmp" : filter->protocol == IPPROTO_ICMPV6 ? "icmpv6" : NULL;
+        if (name) {
+            used += (size_t)snprintf(out + used, len - used, "%sproto:%s", used ? "," : "", name);
+        } else {
+            used += (size_t)snprintf(out + used, len - used, "%sproto:%u", used ? "," : "", filter->protocol);
+        }
+    }
+    if (filter->port && used < len) {
+        snprintf(out + used, len - used, "%sport:%u", used ? "," : "", filter->port);
+    }
+}
@@ -0,0 +1,52 @@
+/**
+ * @file packetFilter.h
+ * @brief Host / protocol / port match on parsed packet metadata.
+ *
+ * Used for the time machine's trigger filter and the runtime export filter.
+ * Specs are comma-separated terms, e.g. "proto:tcp,port:23" or
+ * "host:10.0.0.5,proto:udp"; terms left out match anything.
+ */
+
+#ifndef PACKET_FILTER_H
+#define PACKET_FILTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "Types.h"
+
+typedef struct {
+    int active;                 // 0 = no filter set
+    uint8_t ip_version;         // Of addr (0 = any host)
+    uint8_t addr[16];           // Either endpoint
+    uint8_t protocol;           // IP protocol (0 = any)
+    uint16_t port;              // Either port (0 = any)
+} PacketFilter;
+
+/**
+ * @brief Parses a filter spec ("host:IP,proto:tcp|udp|icmp|icmpv6|N,port:N").
+ * @return 0 on success, -1 on a malformed spec.
+ */
+int parse_packet_filter(const char* spec, PacketFilter* filter);
+
+/**
+ * @brief Writes the spec of @p filter back ("none" if inactive).
+ */
+void packet_filter_describe(const PacketFilter* filter, char* out, size_t len);
+
+/**
+ * @return 1 if the packet is an IP packet matching every set term.
+ */
+static inline int packet_filter_match(const PacketFilter* f, const PacketMetadata* meta) {
+    if (meta->ip_version == 0) return 0;
+    if (f->protocol && meta->l3_protocol != f->protocol) return 0;
+    if (f->port && meta->src_port != f->port && meta->dest_port != f->port) return 0;
+    if (f->ip_version) {
+        size_t len = f->ip_version == 4 ? 4 : 16;
+        if (meta->ip_version != f->ip_version) return 0;
+        if (memcmp(meta->src_addr, f->addr, len) != 0 && memcmp(meta->dest_addr, f->addr, len) != 0) return 0;
+    }
+    return 1;
+}
+
+#endif // PACKET_FILTER_H
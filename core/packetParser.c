@@ -9,32 +9,496 @@
 #include "managedMode.h"
 #include "logger.h"
 #include "Types.h"
+#include "clock.h"
+#include "ipfix_exporter.h"
+#include "dnsLayer.h"
+#include "tlsFingerprint.h"
+#include "hash.h"
+#include "pcap_index.h"
 
-// Flag set by main.c based on interface type
-static int g_is_monitor_mode = 0;
+// Flow tracking settings, fixed before the sources are created
+static int g_flow_tracking = 0;
+static FlowTimeouts g_flow_timeouts;
+static int g_reassembly = 0;
+static ReassemblyConfig g_reassembly_config;
+static int g_dns = 0;
+static DnsConfig g_dns_config;
+static int g_tls = 0;
+static int g_http = 0;
+static HttpConfig g_http_config;
+static int g_dedup = 0;
+static DedupConfig g_dedup_config;
+static int g_checksums = 0;
+static int g_recording = 0;
+static RecorderConfig g_recorder_config;
+static int g_time_machine = 0;
+static TimeMachineConfig g_time_machine_config;
+static int g_archive = 0;
+static ArchiveConfig g_archive_config;
+static int g_overload = 0;
+static OverloadConfig g_overload_config;
+static int g_detect = 0;
+static DetectorConfig g_detect_config;
+static int g_vlan = 0;
+static int g_ipv6 = 1;
 
-void set_monitor_mode(int enabled) {
-    g_is_monitor_mode = enabled;
+static void export_expired_flow(FlowEntry* entry, void* user) {
+    ParserContext* ctx = (ParserContext*)user;
+
+    // Stream parsers annotate the record on close, so release before exporting
+    if (entry->record.end_reason != FLOW_END_ACTIVE) {
+        if (entry->session) tcp_reassembly_release(ctx->reassembly, entry);
+        if (entry->quic) tls_fingerprint_release(entry);
+    }
+    if (flow_exporter_enabled()) {
+        log_flow(&entry->record);
+    }
+    if (ctx->archive) {
+        archive_flow(ctx->archive, &entry->record);
+    }
+}
+
+void set_flow_tracking(const FlowTimeouts* timeouts) {
+    g_flow_tracking = (timeouts != NULL);
+    if (timeouts) g_flow_timeouts = *timeouts;
+}
+
+void set_tcp_reassembly(const ReassemblyConfig* config) {
+    g_reassembly = (config != NULL);
+    if (config) g_reassembly_config = *config;
+}
+
+void set_dedup(const DedupConfig* config) {
+    g_dedup = (config != NULL);
+    if (config) g_dedup_config = *config;
+}
+
+void set_checksum_verification(int enabled) {
+    g_checksums = enabled;
+}
+
+void set_vlan_parsing(int enabled) {
+    g_vlan = enabled;
+}
+
+void set_ipv6_parsing(int enabled) {
+    g_ipv6 = enabled;
+}
+
+void set_packet_recording(const RecorderConfig* config) {
+    g_recording = (config != NULL);
+    if (config) g_recorder_config = *config;
+}
+
+void set_time_machine(const TimeMachineConfig* config) {
+    g_time_machine = (config != NULL);
+    if (config) g_time_machine_config = *config;
+}
+
+int time_machine_enabled(void) {
+    return g_time_machine;
+}
+
+void set_metadata_archive(const ArchiveConfig* config) {
+    g_archive = (config != NULL);
+    if (config) g_archive_config = *config;
+}
+
+void set_overload_control(const OverloadConfig* config) {
+    g_overload = (config != NULL);
+    if (config) g_overload_config = *config;
+}
+
+void set_threat_detection(const DetectorConfig* config) {
+    g_detect = (config != NULL);
+    if (config) g_detect_config = *config;
+}
+
+void set_dns_analysis(const DnsConfig* config) {
+    g_dns = (config != NULL);
+    if (config) g_dns_config = *config;
+}
+
+void set_tls_fingerprinting(int enabled) {
+    if (enabled && !g_tls) tls_fingerprint_register();
+    g_tls = enabled;
+}
+
+void set_http_analysis(const HttpConfig* config) {
+    if (config && !g_http) tcp_reassembly_register(&http_stream_parser);
+    g_http = (config != NULL);
+    if (config) g_http_config = *config;
 }
 
-void process_packet(const unsigned char* buffer, int size) {
+// --- Specialized pipelines ---
+
+// Feature mask of a pipeline; the managed-mode bits are the parser's own
+#define PIPE_VLAN       PARSE_VLAN
+#define PIPE_IPV6       PARSE_IPV6
+#define PIPE_ANALYZERS  (1u << 2)   // Detection; on Ethernet also checksums, flows, TCP analysis, reassembly, DNS
+#define PIPE_STORAGE    (1u << 3)   // Dedup, recording, time machine, archive
+#define PIPE_MONITOR    (1u << 4)   // Radiotap / 802.11 instead of Ethernet
+#define PIPE_MASKS      32
+
+/**
+ * @brief The packet path, written once over a constant feature mask.
+ *
+ * Each instantiation below passes a literal mask, so the compiler drops the
+ * stages and header tests the source cannot need. What remains is only what
+ * varies per packet or at run time (overload level, export filter, sampling).
+ */
+static inline __attribute__((always_inline))
+void run_pipeline(ParserContext* ctx, const unsigned char* buffer, int size, int wire_len,
+                  uint64_t timestamp_ns, uint32_t capture_flags, const unsigned features) {
+    // Mirror-port copies are dropped before any parsing or accounting
+    if ((features & PIPE_STORAGE) && ctx->dedup && dedup_check(ctx->dedup, buffer, size, timestamp_ns)) {
+        return;
+    }
+
     PacketMetadata meta;
     memset(&meta, 0, sizeof(PacketMetadata));
-    meta.packet_size = size;
+    meta.packet_size = wire_len;
+    meta.timestamp_ns = timestamp_ns;
+    meta.if_id = (uint8_t)ctx->if_id;
 
     // --- Dispatch Logic ---
-    
-    if (g_is_monitor_mode) {
+
+    if (features & PIPE_MONITOR) {
         // Monitor Mode: Expect Radiotap + 802.11 frames
         parse_monitor_packet(buffer, size, &meta);
-    } 
+    }
     else {
         // Managed Mode: Standard Ethernet/IP packets
-        parse_managed_packet(buffer, size, &meta);
+        parse_managed_frame(buffer, size, &meta, features & (PIPE_VLAN | PIPE_IPV6));
+
+        if ((features & PIPE_ANALYZERS) && g_checksums && ctx->shed_level < OVERLOAD_HEADERS_ONLY) {
+            checksum_verify(&ctx->checksums, &meta, buffer, size, capture_flags);
+        }
+    }
+
+    if (features & PIPE_STORAGE) {
+        // --- Recording: the frame as captured, keyed by its flow for the index ---
+        if (ctx->recorder) {
+            uint64_t flow_hash = 0;
+            if (meta.ip_version == 4 || meta.ip_version == 6) {
+                flow_hash = hash_flow_key(meta.ip_version, meta.l3_protocol, meta.src_addr, meta.src_port,
+                                          meta.dest_addr, meta.dest_port, PCAP_INDEX_FLOW_SEED);
+            }
+            recorder_write(ctx->recorder, buffer, (uint32_t)size, (uint32_t)wire_len, timestamp_ns, flow_hash);
+        }
+
+        if (ctx->time_machine) {
+            time_machine_capture(ctx->time_machine, &meta, buffer, (uint32_t)size);
+        }
+    }
+
+    // --- Analytics (lock-free, per source) ---
+    traffic_stats_update(ctx->stats, &meta);
+
+    // Detection is never shed: floods are when it matters
+    if ((features & PIPE_ANALYZERS) && ctx->detector) {
+        threat_detector_process(ctx->detector, &meta);
+    }
+
+    if ((features & PIPE_ANALYZERS) && !(features & PIPE_MONITOR)) {
+        // Overload: payload analyzers go first, then the per-segment TCP analysis
+        int payload = ctx->shed_level < OVERLOAD_NO_PAYLOAD;
+
+        if (ctx->flows) {
+            int direction;
+            FlowEntry* entry = flow_table_update(ctx->flows, &meta, &direction);
+
+            if (entry && meta.l3_protocol == IPPROTO_TCP) {
+                if (ctx->shed_level < OVERLOAD_HEADERS_ONLY) {
+                    tcp_analyzer_update(&ctx->tcp_perf, &entry->tcp_state, &entry->record, direction, &meta);
+                }
+                // A receiver would discard a corrupted segment, so the stream must too
+                if (ctx->reassembly && payload && !(meta.csum_flags & CSUM_L4_BAD)) {
+                    tcp_reassembly_process(ctx->reassembly, entry, direction, &meta, buffer);
+                }
+            } else if (entry && g_tls && payload && !entry->quic_done && meta.l3_protocol == IPPROTO_UDP &&
+                       meta.payload_len > 0) {
+                tls_fingerprint_quic(entry, direction, buffer + meta.payload_offset, meta.payload_len);
+            }
+        }
+
+        // --- Application decoders ---
+        if (ctx->dns && payload && meta.l3_protocol == IPPROTO_UDP && meta.payload_len > 0 &&
+            (meta.src_port == DNS_PORT || meta.dest_port == DNS_PORT)) {
+            dns_stats_process(ctx->dns, &meta, buffer + meta.payload_offset, meta.payload_len);
+        }
+    }
+
+    // --- Export filter, then sampling: bound the per-packet export cost ---
+    if (ctx->shed_level >= OVERLOAD_AGGREGATES) {
+        return;
+    }
+    if (ctx->export_filter.active && !packet_filter_match(&ctx->export_filter, &meta)) {
+        return;
+    }
+    if (!sampler_keep(&ctx->sampler, &meta)) {
+        return;
     }
 
     // --- Final Reporting ---
-    
-    // Log all packets to the dashboard (UDP)
+
+    if ((features & PIPE_STORAGE) && ctx->archive) {
+        archive_packet(ctx->archive, &meta);
+    }
+
+    // Log sampled packets to the dashboard (UDP)
     log_packet(&meta);
-}
\ No newline at end of file
+}
+
+// Every mask select_pipeline() can produce: any Ethernet mask, monitor with analyzers and storage or not
+#define PIPELINE_MASKS(X) \
+    X(0)  X(1)  X(2)  X(3)  X(4)  X(5)  X(6)  X(7) \
+    X(8)  X(9)  X(10) X(11) X(12) X(13) X(14) X(15) \
+    X(16) X(20) X(24) X(28)
+
+#define DEFINE_PIPELINE(mask) \
+    static void pipeline_##mask(ParserContext* ctx, const unsigned char* buffer, int size, int wire_len, \
+                                uint64_t timestamp_ns, uint32_t capture_flags) { \
+        run_pipeline(ctx, buffer, size, wire_len, timestamp_ns, capture_flags, (mask)); \
+    }
+#define PIPELINE_ENTRY(mask) [mask] = pipeline_##mask,
+
+PIPELINE_MASKS(DEFINE_PIPELINE)
+
+static const PacketPipeline g_pipelines[PIPE_MASKS] = { PIPELINE_MASKS(PIPELINE_ENTRY) };
+
+// Picks the instantiation matching what this source actually runs
+static void select_pipeline(ParserContext* ctx) {
+    unsigned features = 0;
+
+    if (ctx->is_monitor) {
+        features |= PIPE_MONITOR;
+    } else {
+        if (g_vlan) features |= PIPE_VLAN;
+        if (g_ipv6) features |= PIPE_IPV6;
+        if (g_checksums || ctx->flows || ctx->dns) features |= PIPE_ANALYZERS;
+    }
+    if (ctx->detector) features |= PIPE_ANALYZERS;
+    if (ctx->dedup || ctx->recorder || ctx->time_machine || ctx->archive) features |= PIPE_STORAGE;
+
+    ctx->pipeline_features = features;
+    ctx->process = g_pipelines[features];
+
+    log_message("[INFO] Parser pipeline (ID %d): %s%s%s%s%s\n", ctx->if_id,
+                (features & PIPE_MONITOR) ? "radiotap" : "ethernet",
+                (features & PIPE_VLAN) ? " +vlan" : "",
+                (features & PIPE_IPV6) ? " +ipv6" : "",
+                (features & PIPE_ANALYZERS) ? " +analyzers" : "",
+                (features & PIPE_STORAGE) ? " +storage" : "");
+}
+
+// Copies newer runtime settings into the source's own state; the RCU quiescent point
+static void refresh_runtime_config(ParserContext* ctx) {
+    RuntimeConfig config;
+    if (!runtime_config_refresh(ctx->config_reader, &ctx->config_generation, &config)) return;
+
+    sampler_reconfigure(&ctx->sampler, &config.sampling);
+    ctx->export_filter = config.export_filter;
+    if (ctx->time_machine) {
+        time_machine_set_filter(ctx->time_machine, &config.trigger_filter);
+    }
+}
+
+int init_parser_context(ParserContext* ctx, int if_id, int is_monitor) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->if_id = if_id;
+    ctx->is_monitor = is_monitor;
+    ctx->config_reader = runtime_reader_register();
+
+    ctx->stats = traffic_stats_create();
+    if (!ctx->stats) return -1;
+    ctx->next_publish_ms = clock_coarse_ms() + traffic_stats_interval_ms();
+    sampler_init(&ctx->sampler, (uint64_t)if_id);
+
+    // Mirror-port duplicates are a wired problem: radiotap headers differ per copy anyway
+    if (g_dedup && !is_monitor) {
+        ctx->dedup = dedup_create(&g_dedup_config);
+        if (!ctx->dedup) return -1;
+        log_message("[INFO] Dedup (ID %d): %u-byte slice, %u us window\n", if_id,
+                    ctx->dedup->config.slice, ctx->dedup->config.window_us);
+    }
+
+    if (g_recording) {
+        uint32_t linktype = is_monitor ? PCAP_LINKTYPE_RADIOTAP : PCAP_LINKTYPE_ETHERNET;
+        ctx->recorder = recorder_create(&g_recorder_config, if_id, linktype);
+        if (!ctx->recorder) return -1;
+        log_message("[INFO] Recording (ID %d) to %s\n", if_id, g_recorder_config.directory);
+    }
+
+    // Monitor sources too: EAPOL handshakes are a trigger
+    if (g_time_machine) {
+        uint32_t linktype = is_monitor ? PCAP_LINKTYPE_RADIOTAP : PCAP_LINKTYPE_ETHERNET;
+        ctx->time_machine = time_machine_create(&g_time_machine_config, if_id, linktype);
+        if (!ctx->time_machine) return -1;
+        log_message("[INFO] Time machine (ID %d): %zu MB, dumps to %s\n", if_id,
+                    g_time_machine_config.buffer_bytes >> 20, g_time_machine_config.directory);
+    }
+
+    // Created before the flow table, which archives its expired flows
+    if (g_archive) {
+        ctx->archive = archive_create(&g_archive_config, if_id);
+        if (!ctx->archive) return -1;
+        log_message("[INFO] Archive (ID %d) to %s\n", if_id, g_archive_config.directory);
+    }
+
+    // Flows are an IP concept: monitor sources do not track them
+    if (g_flow_tracking && !is_monitor) {
+        // Sessions live in the flow entries: the reassembler must exist before the table
+        if (g_reassembly && tcp_reassembly_parser_count() > 0) {
+            ctx->reassembly = tcp_reassembler_create(&g_reassembly_config);
+            if (!ctx->reassembly) return -1;
+
+            if (g_http) {
+                ctx->http = http_stats_create(&g_http_config, if_id);
+                if (!ctx->http) return -1;
+                tcp_reassembly_set_worker(ctx->reassembly, &http_stream_parser, ctx->http);
+            }
+        }
+
+        ctx->flows = flow_table_create(FLOW_TABLE_DEFAULT_CAPACITY, &g_flow_timeouts,
+                                       export_expired_flow, ctx);
+        if (!ctx->flows) return -1;
+
+        char placement[128];
+        log_message("[INFO] Flow table (ID %d): %d slots, %s\n", if_id, FLOW_TABLE_DEFAULT_CAPACITY,
+                    flow_table_placement(ctx->flows, placement, sizeof(placement)));
+    }
+
+    if (g_dns && !is_monitor) {
+        ctx->dns = dns_stats_create(&g_dns_config, if_id);
+        if (!ctx->dns) return -1;
+    }
+
+    // Monitor sources too: deauthentication storms
+    if (g_detect) {
+        ctx->detector = threat_detector_create(&g_detect_config, if_id);
+        if (!ctx->detector) return -1;
+    }
+
+    if (g_overload) {
+        ctx->overload = overload_create(&g_overload_config);
+        if (!ctx->overload) return -1;
+    }
+
+    select_pipeline(ctx);
+    refresh_runtime_config(ctx);
+    return 0;
+}
+
+void cleanup_parser_context(ParserContext* ctx) {
+    runtime_reader_unregister(ctx->config_reader);
+    ctx->config_reader = -1;
+
+    if (ctx->flows) {
+        flow_table_destroy(ctx->flows);
+        ctx->flows = NULL;
+        tcp_analyzer_publish(&ctx->tcp_perf, ctx->if_id);
+    }
+    if (ctx->reassembly) {
+        // Destroying the table released every session
+        tcp_reassembly_publish(ctx->reassembly, ctx->if_id);
+        tcp_reassembler_destroy(ctx->reassembly);
+        ctx->reassembly = NULL;
+    }
+    if (ctx->http) {
+        http_stats_destroy(ctx->http);
+        ctx->http = NULL;
+    }
+    if (ctx->dns) {
+        dns_stats_destroy(ctx->dns);
+        ctx->dns = NULL;
+    }
+    if (ctx->archive) {
+        // After the flow table: destroying it archived the remaining flows
+        archive_publish(ctx->archive);
+        archive_destroy(ctx->archive);
+        ctx->archive = NULL;
+    }
+    if (ctx->dedup) {
+        dedup_publish(ctx->dedup, ctx->if_id);
+        dedup_destroy(ctx->dedup);
+        ctx->dedup = NULL;
+    }
+    if (ctx->recorder) {
+        // Flushes and indexes the open segment
+        recorder_destroy(ctx->recorder);
+        ctx->recorder = NULL;
+    }
+    if (ctx->time_machine) {
+        // Writes a dump still waiting for its post-trigger window
+        time_machine_publish(ctx->time_machine);
+        time_machine_destroy(ctx->time_machine);
+        ctx->time_machine = NULL;
+    }
+    if (g_checksums && !ctx->is_monitor) {
+        checksum_stats_publish(&ctx->checksums, ctx->if_id);
+    }
+    if (ctx->detector) {
+        threat_detector_publish(ctx->detector);
+        threat_detector_destroy(ctx->detector);
+        ctx->detector = NULL;
+    }
+    if (ctx->overload) {
+        overload_publish(ctx->overload, ctx->if_id, clock_coarse_ms());
+        overload_destroy(ctx->overload);
+        ctx->overload = NULL;
+    }
+    if (ctx->stats) {
+        traffic_stats_publish(ctx->stats);
+        traffic_stats_destroy(ctx->stats);
+        ctx->stats = NULL;
+    }
+}
+
+void parser_housekeeping(ParserContext* ctx) {
+    uint64_t now = clock_coarse_ms();
+
+    refresh_runtime_config(ctx);
+
+    if (now >= ctx->next_publish_ms) {
+        traffic_stats_publish(ctx->stats);
+        if (ctx->dedup) dedup_publish(ctx->dedup, ctx->if_id);
+        if (g_checksums && !ctx->is_monitor) checksum_stats_publish(&ctx->checksums, ctx->if_id);
+        if (ctx->recorder) recorder_publish(ctx->recorder);
+        if (ctx->time_machine) time_machine_publish(ctx->time_machine);
+        if (ctx->archive) archive_publish(ctx->archive);
+        if (ctx->flows) tcp_analyzer_publish(&ctx->tcp_perf, ctx->if_id);
+        if (ctx->reassembly) tcp_reassembly_publish(ctx->reassembly, ctx->if_id);
+        if (ctx->detector) threat_detector_publish(ctx->detector);
+        if (ctx->overload) overload_publish(ctx->overload, ctx->if_id, now);
+        ctx->next_publish_ms = now + traffic_stats_interval_ms();
+    }
+
+    if (ctx->overload && overload_evaluate(ctx->overload, ctx->if_id, now)) {
+        ctx->shed_level = ctx->overload->level;
+        sampler_set_shed_rate(&ctx->sampler,
+                              ctx->shed_level >= OVERLOAD_SAMPLED ? ctx->overload->config.shed_rate : 0);
+    }
+
+    sampler_adapt(&ctx->sampler, now);
+
+    if (ctx->flows) {
+        flow_table_expire(ctx->flows, clock_realtime_ms());
+    }
+
+    if (ctx->dns) {
+        dns_stats_housekeeping(ctx->dns);
+    }
+
+    if (ctx->http) {
+        http_stats_housekeeping(ctx->http);
+    }
+
+    if (ctx->time_machine) {
+        time_machine_housekeeping(ctx->time_machine);
+    }
+
+    if (ctx->archive) {
+        archive_housekeeping(ctx->archive);
+    }
+}
@@ -10,21 +10,270 @@
 #ifndef PACKETPARSER_H
 #define PACKETPARSER_H
 
+#include <stdint.h>
+#include "trafficStats.h"
+#include "sampler.h"
+#include "flowTable.h"
+#include "tcpAnalyzer.h"
+#include "tcpReassembly.h"
+#include "dnsStats.h"
+#include "httpStats.h"
+#include "packetDedup.h"
+#include "checksumVerify.h"
+#include "packetRecorder.h"
+#include "timeMachine.h"
+#include "metadataArchive.h"
+#include "runtimeConfig.h"
+#include "overloadControl.h"
+#include "threatDetector.h"
+
+typedef struct ParserContext ParserContext;
+
+/**
+ * @brief A packet path specialized for one combination of link type and features.
+ */
+typedef void (*PacketPipeline)(ParserContext* ctx, const unsigned char* buffer, int size, int wire_len,
+                               uint64_t timestamp_ns, uint32_t capture_flags);
+
+/**
+ * @brief Per-source parsing context.
+ *
+ * Each capture source (interface) owns one of these, so a monitor radio
+ * and a managed uplink can be parsed side by side in the same process.
+ */
+struct ParserContext {
+    int if_id;          // Index of the capture source, carried in the metadata
+    int is_monitor;     // 1 for Radiotap/802.11, 0 for Ethernet
+
+    // Per-source analytics, only touched by the thread servicing this source
+    TrafficStats* stats;
+    uint64_t next_publish_ms;
+
+    // Export sampling state
+    Sampler sampler;
+
+    // Runtime settings: RCU reader slot, generation applied, export filter copied from it
+    int config_reader;
+    uint64_t config_generation;
+    PacketFilter export_filter;
+
+    // Duplicate frame filter (NULL when disabled or in monitor mode)
+    PacketDedup* dedup;
+
+    // Checksum verification counters (used when verification is on)
+    ChecksumStats checksums;
+
+    // Flow tracking (NULL when disabled or in monitor mode)
+    FlowTable* flows;
+    TcpAnalyzer tcp_perf;   // TCP performance aggregate of this source's flows
+
+    // TCP stream reassembly (NULL unless flows are tracked and a stream parser is registered)
+    TcpReassembler* reassembly;
+
+    // DNS transaction analysis (NULL when disabled or in monitor mode)
+    DnsStats* dns;
+
+    // HTTP transaction analysis, bound to the reassembler's HTTP parser (NULL when disabled)
+    HttpStats* http;
+
+    // Indexed pcap recording (NULL when disabled)
+    PacketRecorder* recorder;
+
+    // Rolling buffer dumped on triggers (NULL when disabled)
+    TimeMachine* time_machine;
+
+    // Columnar archive of exported packet records and flow records (NULL when disabled)
+    MetadataArchive* archive;
+
+    // Flood, scan and deauth storm detection (NULL when disabled)
+    ThreatDetector* detector;
+
+    // Load shedding controller (NULL when disabled) and the stages it currently sheds
+    OverloadControl* overload;
+    OverloadLevel shed_level;
+
+    // Specialized packet path picked at init for this source's link type and features
+    PacketPipeline process;
+    unsigned pipeline_features;
+};
+
+/**
+ * @brief Enables per-source flow tracking for contexts created afterwards.
+ *
+ * Expired flows are queued for the flow exporter.
+ *
+ * @param timeouts Idle / active timeouts, or NULL to disable tracking.
+ */
+void set_flow_tracking(const FlowTimeouts* timeouts);
+
+/**
+ * @brief Enables TCP stream reassembly for contexts created afterwards.
+ *
+ * Only takes effect when flows are tracked and at least one stream parser is registered.
+ *
+ * @param config Memory limits and overlap policy, or NULL to disable reassembly.
+ */
+void set_tcp_reassembly(const ReassemblyConfig* config);
+
+/**
+ * @brief Drops duplicate frames (SPAN / mirror-port copies) for contexts created afterwards.
+ *
+ * @param config Window, hashed slice and table size, or NULL to disable.
+ */
+void set_dedup(const DedupConfig* config);
+
+/**
+ * @brief Verifies IPv4 header, TCP and UDP checksums on Ethernet sources.
+ *
+ * Results go to PacketMetadata.csum_flags and to per-source counters; TCP
+ * segments with a bad checksum are not fed to stream reassembly.
+ *
+ * @param enabled 1 to enable.
+ */
+void set_checksum_verification(int enabled);
+
+/**
+ * @brief Skips up to two 802.1Q / 802.1ad tags on Ethernet sources created afterwards.
+ *
+ * Off by default: tagged frames are then counted at layer 2 only.
+ *
+ * @param enabled 1 to enable.
+ */
+void set_vlan_parsing(int enabled);
+
+/**
+ * @brief Decodes IPv6 on Ethernet sources created afterwards (on by default).
+ *
+ * With it off the IPv6 parser is compiled out of the source's pipeline and
+ * IPv6 frames stop at layer 2.
+ *
+ * @param enabled 0 for an IPv4-only pipeline.
+ */
+void set_ipv6_parsing(int enabled);
+
+/**
+ * @brief Records every frame that passes deduplication to indexed pcap segments.
+ *
+ * One writer thread per source; monitor sources are written as radiotap.
+ *
+ * @param config Directory and rotation settings, or NULL to disable.
+ */
+void set_packet_recording(const RecorderConfig* config);
+
+/**
+ * @brief Keeps the last seconds of every source in memory and dumps them to pcapng on triggers.
+ *
+ * @param config Buffer size, dump window and triggers, or NULL to disable.
+ */
+void set_time_machine(const TimeMachineConfig* config);
+
+/**
+ * @brief Returns 1 if the time machine was enabled with set_time_machine().
+ */
+int time_machine_enabled(void);
+
+/**
+ * @brief Archives exported packet records and expired flow records in columnar files.
+ *
+ * Packet records are archived after sampling, like the export stream.
+ *
+ * @param config Directory, chunk size and rotation, or NULL to disable.
+ */
+void set_metadata_archive(const ArchiveConfig* config);
+
+/**
+ * @brief Sheds pipeline stages under overload for contexts created afterwards.
+ *
+ * The capture loop feeds each context's controller with ring occupancy and
+ * queueing delay; the level it picks gates the analyzers, the export sampling
+ * and the packet records in process_packet().
+ *
+ * @param config Thresholds and timing, or NULL to disable.
+ */
+void set_overload_control(const OverloadConfig* config);
+
+/**
+ * @brief Detects SYN / ICMP floods, port scans and 802.11 deauth storms for contexts created afterwards.
+ *
+ * Alerts are published as {"event": "alert"} records.
+ *
+ * @param config Thresholds and table size, or NULL to disable.
+ */
+void set_threat_detection(const DetectorConfig* config);
+
+/**
+ * @brief Enables DNS decoding and latency matching for contexts created afterwards.
+ *
+ * @param config Table sizes and export interval, or NULL to disable.
+ */
+void set_dns_analysis(const DnsConfig* config);
+
+/**
+ * @brief Decodes the TLS ClientHello of each flow (TCP and QUIC) into its flow record.
+ *
+ * Registers the TLS stream parser, so it must be called before flow tracking is
+ * configured and before the contexts are created.
+ *
+ * @param enabled 1 to enable.
+ */
+void set_tls_fingerprinting(int enabled);
+
+/**
+ * @brief Matches HTTP/1.x requests to responses and aggregates them per host.
+ *
+ * Registers the HTTP stream parser, so it must be called before flow tracking
+ * is configured and before the contexts are created.
+ *
+ * @param config Host cache size and export interval, or NULL to disable.
+ */
+void set_http_analysis(const HttpConfig* config);
+
 /**
- * @brief Sets the operation mode for packet parsing.
- * @param enabled 1 for Monitor Mode, 0 for Managed Mode.
+ * @brief Initializes a parser context for a capture source.
+ *
+ * Also selects the source's packet pipeline: one of a set of process_packet()
+ * variants generated from a feature mask (link type, VLAN, IPv6, analyzers,
+ * storage stages), so stages the source does not run cost no branch per packet.
+ * Settings must therefore be applied before the contexts are created.
+ *
+ * @param ctx Context to fill.
+ * @param if_id Interface ID to stamp on every packet from this source.
+ * @param is_monitor 1 for Monitor Mode, 0 for Managed Mode.
+ * @return 0 on success, -1 on allocation failure.
+ */
+int init_parser_context(ParserContext* ctx, int if_id, int is_monitor);
+
+/**
+ * @brief Publishes pending analytics and frees the context's resources.
+ */
+void cleanup_parser_context(ParserContext* ctx);
+
+/**
+ * @brief Periodic per-source work (publishing analytics, adaptive sampling, flow expiry).
+ *
+ * Called between batches, it is also where runtime setting changes are picked up.
+ *
+ * Called by the capture loop between batches, including when no traffic arrives.
+ * Cheap when nothing is due.
  */
-void set_monitor_mode(int enabled);
+void parser_housekeeping(ParserContext* ctx);
 
 /**
  * @brief Analyzes a raw packet and dispatches it to the correct handler.
  *
- * If monitor mode is enabled, it calls the Monitor Mode handler.
- * Otherwise, it assumes Ethernet framing (Managed Mode) and calls the Managed Mode handler.
+ * Runs the pipeline init_parser_context() selected: Monitor Mode sources parse
+ * Radiotap + 802.11, the others Ethernet framing (Managed Mode).
  *
+ * @param ctx Parsing context of the source the packet was captured on.
  * @param buffer Pointer to the start of the packet data (Zero-Copy safe).
- * @param size Total size of the received packet in bytes.
+ * @param size Bytes captured (may be cut short by a snaplen).
+ * @param wire_len Length of the frame on the wire.
+ * @param timestamp_ns Kernel capture timestamp (ns since epoch), 0 if unknown.
+ * @param capture_flags CAPTURE_CSUM_* hints from the ring, 0 if none.
  */
-void process_packet(const unsigned char* buffer, int size);
+static inline void process_packet(ParserContext* ctx, const unsigned char* buffer, int size, int wire_len,
+                                  uint64_t timestamp_ns, uint32_t capture_flags) {
+    ctx->process(ctx, buffer, size, wire_len, timestamp_ns, capture_flags);
+}
 
-#endif // PACKETPARSER_H
\ No newline at end of file
+#endif // PACKETPARSER_H
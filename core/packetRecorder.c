@@ -0,0 +1,406 @@
+/**
+ * @file packetRecorder.c
+ * @brief Implementation of the staged, indexed pcap recorder.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "packetRecorder.h"
+#include "pcap_index.h"
+#include "mem_pool.h"
+#include "logger.h"
+#include "clock.h"
+
+#define STAGE_ALIGN       8
+#define STAGE_PAD         0x1       // StageEntry.flags: skip to the start of the ring
+#define WRITER_IDLE_NS    1000000   // Writer sleep when the ring is empty
+#define WRITE_BUFFER      (1 << 20) // stdio buffer of the open segment
+
+/**
+ * @brief Header of a frame in the staging ring (followed by the frame bytes).
+ */
+typedef struct {
+    uint32_t size;              // Whole entry, aligned to STAGE_ALIGN
+    uint32_t caplen;
+    uint32_t wire_len;
+    uint32_t flags;
+    uint64_t ts_ns;
+    uint64_t flow_hash;
+} StageEntry;
+
+typedef struct {
+    uint64_t hash;
+    uint32_t offset;
+} IndexRef;
+
+struct PacketRecorder {
+    RecorderConfig config;
+    int if_id;
+    uint32_t linktype;
+
+    // Staging ring: positions grow forever, masked on access
+    MemRegion region;
+    uint8_t* ring;
+    uint64_t mask;
+    uint64_t tail;              // Producer (capture thread)
+    uint64_t head;              // Consumer (writer thread)
+
+    pthread_t thread;
+    int stopping;
+
+    // Open segment (writer thread only)
+    FILE* fp;
+    char path[512];
+    uint32_t sequence;
+    uint64_t offset;            // Bytes written to the segment
+    uint64_t opened_ms;
+    uint64_t first_ts_ns;
+    uint64_t last_ts_ns;
+    uint64_t base_ts_ns;
+    IndexRef* refs;
+    uint32_t ref_count;
+    uint32_t ref_capacity;
+    uint32_t* buckets;
+    uint32_t bucket_count;
+    uint32_t bucket_capacity;
+    int index_lost;             // An entry could not be stored: the segment gets no index
+
+    // Capture thread counters, reset on publish
+    uint64_t packets;
+    uint64_t bytes;
+    uint64_t dropped;
+
+    // Writer thread counters (read with relaxed atomics)
+    uint64_t segments;
+    uint64_t index_failures;
+};
+
+// --- Index ---
+
+static int compare_refs(const void* a, const void* b) {
+    const IndexRef* x = (const IndexRef*)a;
+    const IndexRef* y = (const IndexRef*)b;
+    if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+    return (x->offset > y->offset) - (x->offset < y->offset);
+}
+
+static int grow(void** array, uint32_t* capacity, size_t elem) {
+    uint32_t next = *capacity ? *capacity * 2 : 4096;
+    void* p = realloc(*array, (size_t)next * elem);
+    if (!p) return -1;
+    *array = p;
+    *capacity = next;
+    return 0;
+}
+
+// Remembers where a record starts (writer thread)
+static int index_record(PacketRecorder* r, uint64_t ts_ns, uint64_t flow_hash, uint32_t offset) {
+    if (r->ref_count == r->ref_capacity && grow((void**)&r->refs, &r->ref_capacity, sizeof(IndexRef)) != 0) {
+        return -1;
+    }
+    r->refs[r->ref_count].hash = flow_hash;
+    r->refs[r->ref_count].offset = offset;
+    r->ref_count++;
+
+    if (r->ref_count == 1) {
+        r->first_ts_ns = ts_ns;
+        r->base_ts_ns = ts_ns - ts_ns % ((uint64_t)r->config.bucket_ms * 1000000ULL);
+    }
+    if (ts_ns > r->last_ts_ns) r->last_ts_ns = ts_ns;
+
+    // Buckets only move forward; a frame stamped slightly earlier stays in the current one
+    uint64_t bucket = ts_ns > r->base_ts_ns ? (ts_ns - r->base_ts_ns) / ((uint64_t)r->config.bucket_ms * 1000000ULL) : 0;
+    while (r->bucket_count <= bucket) {
+        if (r->bucket_count == r->bucket_capacity &&
+            grow((void**)&r->buckets, &r->bucket_capacity, sizeof(uint32_t)) != 0) {
+            return -1;
+        }
+        r->buckets[r->bucket_count++] = offset;
+    }
+    return 0;
+}
+
+static int write_index(PacketRecorder* r) {
+    qsort(r->refs, r->ref_count, sizeof(IndexRef), compare_refs);
+
+    uint32_t flows = 0;
+    for (uint32_t i = 0; i < r->ref_count; i++) {
+        if (i == 0 || r->refs[i].hash != r->refs[i - 1].hash) flows++;
+    }
+
+    PcapIndexHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, PCAP_INDEX_MAGIC, sizeof(hdr.magic));
+    hdr.version = PCAP_INDEX_VERSION;
+    hdr.linktype = r->linktype;
+    hdr.first_ts_ns = r->first_ts_ns;
+    hdr.last_ts_ns = r->last_ts_ns;
+    hdr.base_ts_ns = r->base_ts_ns;
+    hdr.bucket_ms = r->config.bucket_ms;
+    hdr.buckets = r->bucket_count;
+    hdr.flows = flows;
+    hdr.packets = r->ref_count;
+    hdr.bucket_table = sizeof(hdr);
+    hdr.flow_table = (uint32_t)((hdr.bucket_table + (uint64_t)r->bucket_count * 4 + 7) & ~7ULL);
+    hdr.ref_table = hdr.flow_table + flows * (uint32_t)sizeof(PcapIndexFlow);
+
+    char tmp[528], final_path[520];
+    snprintf(final_path, sizeof(final_path), "%s%s", r->path, PCAP_INDEX_SUFFIX);
+    snprintf(tmp, sizeof(tmp), "%s.tmp", final_path);
+
+    FILE* fp = fopen(tmp, "wb");
+    if (!fp) return -1;
+
+    static const uint8_t zero[8] = { 0 };
+    int ok = fwrite(&hdr, sizeof(hdr), 1, fp) == 1;
+    if (r->bucket_count) ok &= fwrite(r->buckets, 4, r->bucket_count, fp) == r->bucket_count;
+    uint32_t pad = hdr.flow_table - (uint32_t)(hdr.bucket_table + r->bucket_count * 4);
+    if (pad) ok &= fwrite(zero, 1, pad, fp) == pad;
+
+    for (uint32_t i = 0; ok && i < r->ref_count; ) {
+        PcapIndexFlow flow = { .hash = r->refs[i].hash, .first_ref = i, .count = 0 };
+        while (i < r->ref_count && r->refs[i].hash == flow.hash) {
+            flow.count++;
+            i++;
+        }
+        ok &= fwrite(&flow, sizeof(flow), 1, fp) == 1;
+    }
+    for (uint32_t i = 0; ok && i < r->ref_count; i++) {
+        ok &= fwrite(&r->refs[i].offset, 4, 1, fp) == 1;
+    }
+
+    ok &= fclose(fp) == 0;
+    if (!ok || rename(tmp, final_path) != 0) {
+        remove(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+// --- Segments (writer thread) ---
+
+static void close_segment(PacketRecorder* r) {
+    if (!r->fp) return;
+
+    int ok = fclose(r->fp) == 0;
+    r->fp = NULL;
+    if (!ok || r->index_lost || write_index(r) != 0) {
+        __atomic_fetch_add(&r->index_failures, 1, __ATOMIC_RELAXED);
+        log_message("[WARN] Recorder: could not index %s\n", r->path);
+    }
+    __atomic_fetch_add(&r->segments, 1, __ATOMIC_RELAXED);
+
+    r->ref_count = 0;
+    r->bucket_count = 0;
+    r->index_lost = 0;
+    r->first_ts_ns = r->last_ts_ns = 0;
+}
+
+static int open_segment(PacketRecorder* r, uint64_t ts_ns) {
+    snprintf(r->path, sizeof(r->path), "%s/if%d-%llu-%06u.pcap", r->config.directory, r->if_id,
+             (unsigned long long)(ts_ns / 1000000000ULL), r->sequence++);
+
+    r->fp = fopen(r->path, "wb");
+    if (!r->fp) {
+        log_message("[WARN] Recorder: cannot create %s\n", r->path);
+        return -1;
+    }
+    setvbuf(r->fp, NULL, _IOFBF, WRITE_BUFFER);
+
+    PcapFileHeader fh = { .magic = PCAP_MAGIC_NSEC, .version_major = 2, .version_minor = 4,
+                          .thiszone = 0, .sigfigs = 0, .snaplen = 65535, .linktype = r->linktype };
+    if (fwrite(&fh, sizeof(fh), 1, r->fp) != 1) {
+        fclose(r->fp);
+        r->fp = NULL;
+        return -1;
+    }
+    r->offset = sizeof(fh);
+    r->opened_ms = clock_coarse_ms();
+    return 0;
+}
+
+static void write_frame(PacketRecorder* r, const StageEntry* e, const uint8_t* data) {
+    uint64_t record_len = sizeof(PcapRecordHeader) + e->caplen;
+
+    if (r->fp && r->offset + record_len > r->config.segment_bytes) close_segment(r);
+    if (!r->fp && open_segment(r, e->ts_ns) != 0) return;
+
+    PcapRecordHeader rh = {
+        .ts_sec = (uint32_t)(e->ts_ns / 1000000000ULL),
+        .ts_nsec = (uint32_t)(e->ts_ns % 1000000000ULL),
+        .incl_len = e->caplen,
+        .orig_len = e->wire_len
+    };
+    if (fwrite(&rh, sizeof(rh), 1, r->fp) != 1 || fwrite(data, 1, e->caplen, r->fp) != e->caplen) {
+        log_message("[WARN] Recorder: write to %s failed\n", r->path);
+        close_segment(r);
+        return;
+    }
+
+    // An index missing frames would hide them from queries: drop the segment's index instead
+    if (!r->index_lost && index_record(r, e->ts_ns, e->flow_hash, (uint32_t)r->offset) != 0) {
+        r->index_lost = 1;
+        log_message("[WARN] Recorder: out of memory indexing %s - segment left unindexed\n", r->path);
+    }
+    r->offset += record_len;
+}
+
+static void* writer_main(void* arg) {
+    PacketRecorder* r = (PacketRecorder*)arg;
+    uint64_t size = r->mask + 1;
+
+    while (1) {
+        uint64_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+        uint64_t head = r->head;
+
+        if (head == tail) {
+            if (__atomic_load_n(&r->stopping, __ATOMIC_ACQUIRE)) break;
+            if (r->fp && r->config.segment_seconds &&
+                clock_coarse_ms() - r->opened_ms >= (uint64_t)r->config.segment_seconds * 1000) {
+                close_segment(r);
+            }
+            struct timespec idle = { 0, WRITER_IDLE_NS };
+            nanosleep(&idle, NULL);
+            continue;
+        }
+
+        while (head != tail) {
+            uint64_t contiguous = size - (head & r->mask);
+            if (contiguous < sizeof(StageEntry)) {
+                head += contiguous;
+                continue;
+            }
+            const StageEntry* e = (const StageEntry*)(r->ring + (head & r->mask));
+            if (e->flags & STAGE_PAD) {
+                head += contiguous;
+                continue;
+            }
+            write_frame(r, e, (const uint8_t*)(e + 1));
+            head += e->size;
+        }
+        __atomic_store_n(&r->head, head, __ATOMIC_RELEASE);
+    }
+
+    close_segment(r);
+    return NULL;
+}
+
+// --- Public API ---
+
+void recorder_config_defaults(RecorderConfig* config) {
+    memset(config, 0, sizeof(*config));
+    snprintf(config->directory, sizeof(config->directory), ".");
+    config->segment_bytes = 256ULL * 1024 * 1024;
+    config->segment_seconds = 300;
+    config->bucket_ms = 1000;
+    config->buffer_bytes = 32u * 1024 * 1024;
+}
+
+PacketRecorder* recorder_create(const RecorderConfig* config, int if_id, uint32_t linktype) {
+    if (access(config->directory, W_OK | X_OK) != 0) {
+        log_message("[ERROR] Recorder: directory %s is not writable\n", config->directory);
+        return NULL;
+    }
+
+    PacketRecorder* r = (PacketRecorder*)calloc(1, sizeof(PacketRecorder));
+    if (!r) return NULL;
+
+    r->config = *config;
+    r->if_id = if_id;
+    r->linktype = linktype;
+    if (r->config.segment_bytes > PCAP_SEGMENT_MAX_BYTES) r->config.segment_bytes = PCAP_SEGMENT_MAX_BYTES;
+    if (r->config.segment_bytes < 1024 * 1024) r->config.segment_bytes = 1024 * 1024;
+    if (r->config.bucket_ms == 0) r->config.bucket_ms = 1000;
+
+    size_t size = 1024 * 1024;
+    while (size < r->config.buffer_bytes) size <<= 1;
+    if (mem_region_alloc(&r->region, size, numa_default_node()) != 0) {
+        free(r);
+        return NULL;
+    }
+    r->ring = (uint8_t*)r->region.base;
+    r->mask = size - 1;
+
+    if (pthread_create(&r->thread, NULL, writer_main, r) != 0) {
+        mem_region_free(&r->region);
+        free(r);
+        return NULL;
+    }
+    return r;
+}
+
+void recorder_destroy(PacketRecorder* r) {
+    if (!r) return;
+
+    __atomic_store_n(&r->stopping, 1, __ATOMIC_RELEASE);
+    pthread_join(r->thread, NULL);
+
+    mem_region_free(&r->region);
+    free(r->refs);
+    free(r->buckets);
+    free(r);
+}
+
+void recorder_write(PacketRecorder* r, const unsigned char* frame, uint32_t caplen,
+                    uint32_t wire_len, uint64_t timestamp_ns, uint64_t flow_hash) {
+    uint64_t size = r->mask + 1;
+    uint32_t need = (uint32_t)((sizeof(StageEntry) + caplen + STAGE_ALIGN - 1) & ~(uint64_t)(STAGE_ALIGN - 1));
+
+    uint64_t tail = r->tail;
+    uint64_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    uint64_t contiguous = size - (tail & r->mask);
+    uint64_t total = contiguous < need ? contiguous + need : need;
+
+    r->packets++;
+    if (tail + total - head > size) {
+        r->dropped++;
+        return;
+    }
+
+    // Entries never wrap: pad out the end of the ring and start over
+    if (contiguous < need) {
+        if (contiguous >= sizeof(StageEntry)) {
+            StageEntry* pad = (StageEntry*)(r->ring + (tail & r->mask));
+            pad->flags = STAGE_PAD;
+        }
+        tail += contiguous;
+    }
+
+    StageEntry* e = (StageEntry*)(r->ring + (tail & r->mask));
+    e->size = need;
+    e->caplen = caplen;
+    e->wire_len = wire_len;
+    e->flags = 0;
+    e->ts_ns = timestamp_ns ? timestamp_ns : clock_realtime_ns();
+    e->flow_hash = flow_hash;
+    memcpy(e + 1, frame, caplen);
+
+    r->bytes += caplen;
+    __atomic_store_n(&r->tail, tail + need, __ATOMIC_RELEASE);
+}
+
+void recorder_publish(PacketRecorder* r) {
+    char json[320];
+    snprintf(json, sizeof(json),
+        "{\"event\": \"recorder\","
+        "\"if_id\": %d,"
+        "\"packets\": %llu,"
+        "\"bytes\": %llu,"
+        "\"dropped\": %llu,"
+        "\"staged_bytes\": %llu,"
+        "\"segments\": %llu,"
+        "\"index_failures\": %llu}",
+        r->if_id,
+        (unsigned long long)r->packets, (unsigned long long)r->bytes, (unsigned long long)r->dropped,
+        (unsigned long long)(r->tail - __atomic_load_n(&r->head, __ATOMIC_ACQUIRE)),
+        (unsigned long long)__atomic_load_n(&r->segments, __ATOMIC_RELAXED),
+        (unsigned long long)__atomic_load_n(&r->index_failures, __ATOMIC_RELAXED));
+    log_event(json);
+
+    r->packets = r->bytes = r->dropped = 0;
+}
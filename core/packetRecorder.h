@@ -0,0 +1,70 @@
+/**
+ * @file packetRecorder.h
+ * @brief Continuous recording of a capture source to indexed pcap segments.
+ *
+ * The capture thread only copies each frame into a staging ring (single
+ * producer, single consumer, on hugepages); a writer thread per source drains
+ * it to disk, so a slow disk costs dropped recordings, never capture stalls.
+ * Segments rotate by size and age. When a segment closes, the writer sorts
+ * its per-packet (flow hash, offset) list and writes the sidecar index
+ * described in pcap_index.h, which `SnifferQuery` uses to pull out one flow
+ * or time range without scanning the archive.
+ */
+
+#ifndef PACKET_RECORDER_H
+#define PACKET_RECORDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Recording settings (shared by all sources).
+ */
+typedef struct {
+    char directory[256];        // Where segments are written
+    uint64_t segment_bytes;     // Rotate after this many bytes (at most PCAP_SEGMENT_MAX_BYTES)
+    uint32_t segment_seconds;   // ... or this age (0 = size only)
+    uint32_t bucket_ms;         // Time index granularity
+    size_t buffer_bytes;        // Staging ring between the capture and writer threads
+} RecorderConfig;
+
+typedef struct PacketRecorder PacketRecorder;
+
+/**
+ * @brief Fills @p config with the defaults (256 MB / 300 s segments, 1 s buckets, 32 MB ring).
+ */
+void recorder_config_defaults(RecorderConfig* config);
+
+/**
+ * @brief Starts the writer thread of one source.
+ *
+ * Segments are named "if<ID>-<first capture second>-<sequence>.pcap".
+ *
+ * @param linktype PCAP_LINKTYPE_* of the source's frames.
+ * @return PacketRecorder* or NULL on failure.
+ */
+PacketRecorder* recorder_create(const RecorderConfig* config, int if_id, uint32_t linktype);
+
+/**
+ * @brief Writes what is staged, closes and indexes the open segment, stops the thread.
+ */
+void recorder_destroy(PacketRecorder* recorder);
+
+/**
+ * @brief Stages a frame for writing (capture thread; never blocks, drops when the ring is full).
+ *
+ * @param frame Captured bytes.
+ * @param caplen Bytes captured.
+ * @param wire_len Length on the wire.
+ * @param timestamp_ns Capture time (ns since epoch, 0 = now).
+ * @param flow_hash hash_flow_key(..., PCAP_INDEX_FLOW_SEED), or 0 for non-IP frames.
+ */
+void recorder_write(PacketRecorder* recorder, const unsigned char* frame, uint32_t caplen,
+                    uint32_t wire_len, uint64_t timestamp_ns, uint64_t flow_hash);
+
+/**
+ * @brief Emits {"event": "recorder"} with the counters since the last call.
+ */
+void recorder_publish(PacketRecorder* recorder);
+
+#endif // PACKET_RECORDER_H
@@ -0,0 +1,159 @@
+/**
+ * @file runtimeConfig.c
+ * @brief RCU publication of the runtime settings (quiescent-state-based reclamation).
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "runtimeConfig.h"
+#include "logger.h"
+
+#define GRACE_POLL_NS       1000000     // Writer sleep while waiting for readers
+#define GRACE_TIMEOUT_MS    5000        // A reader this late is stuck or gone: retire instead of free
+
+typedef struct Snapshot {
+    RuntimeConfig config;
+    struct Snapshot* retired_next;      // Grace period timed out: freed at cleanup
+} Snapshot;
+
+/**
+ * @brief Quiescent-state counter of one reader, on its own cache line.
+ */
+typedef struct {
+    uint64_t epoch;                     // Last epoch seen at a quiescent state (0 = offline)
+    int used;
+} __attribute__((aligned(64))) ReaderSlot;
+
+static Snapshot* g_current = NULL;
+static uint64_t g_generation = 0;       // g_current's generation, checked first by readers
+static uint64_t g_epoch = 1;            // Bumped by each grace period
+static ReaderSlot g_readers[RUNTIME_MAX_READERS];
+
+// Serializes writers (control thread, reload); readers never take it
+static pthread_mutex_t g_writer_lock = PTHREAD_MUTEX_INITIALIZER;
+static Snapshot* g_retired = NULL;
+
+// --- Grace periods ---
+
+// Waits until every online reader has reported a quiescent state after this call
+static int synchronize_readers(void) {
+    uint64_t target = __atomic_add_fetch(&g_epoch, 1, __ATOMIC_SEQ_CST);
+    struct timespec pause = { 0, GRACE_POLL_NS };
+    uint32_t waited_ms = 0;
+
+    for (int i = 0; i < RUNTIME_MAX_READERS; i++) {
+        while (1) {
+            uint64_t seen = __atomic_load_n(&g_readers[i].epoch, __ATOMIC_SEQ_CST);
+            if (seen == 0 || seen >= target) break;
+            if (waited_ms >= GRACE_TIMEOUT_MS) return -1;
+            nanosleep(&pause, NULL);
+            waited_ms++;
+        }
+    }
+    return 0;
+}
+
+// --- Writer side ---
+
+int runtime_config_init(const RuntimeConfig* initial) {
+    return runtime_config_publish(initial) ? 0 : -1;
+}
+
+void runtime_config_cleanup(void) {
+    pthread_mutex_lock(&g_writer_lock);
+    free(g_current);
+    g_current = NULL;
+    __atomic_store_n(&g_generation, 0, __ATOMIC_RELEASE);
+    while (g_retired) {
+        Snapshot* next = g_retired->retired_next;
+        free(g_retired);
+        g_retired = next;
+    }
+    pthread_mutex_unlock(&g_writer_lock);
+}
+
+void runtime_config_get(RuntimeConfig* out) {
+    pthread_mutex_lock(&g_writer_lock);
+    if (g_current) {
+        *out = g_current->config;
+    } else {
+        memset(out, 0, sizeof(*out));
+    }
+    pthread_mutex_unlock(&g_writer_lock);
+}
+
+uint64_t runtime_config_publish(const RuntimeConfig* next) {
+    Snapshot* snapshot = (Snapshot*)calloc(1, sizeof(Snapshot));
+    if (!snapshot) return 0;
+
+    pthread_mutex_lock(&g_writer_lock);
+    snapshot->config = *next;
+    snapshot->config.generation = g_generation + 1;
+
+    Snapshot* old = g_current;
+    __atomic_store_n(&g_current, snapshot, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&g_generation, snapshot->config.generation, __ATOMIC_SEQ_CST);
+
+    if (old) {
+        if (synchronize_readers() == 0) {
+            free(old);
+        } else {
+            // Never free under a reader that may still copy it
+            old->retired_next = g_retired;
+            g_retired = old;
+            log_message("[WARN] Runtime config: a capture thread missed the grace period, "
+                        "generation %llu retired until exit\n", (unsigned long long)old->config.generation);
+        }
+    }
+    uint64_t generation = snapshot->config.generation;
+    pthread_mutex_unlock(&g_writer_lock);
+    return generation;
+}
+
+// --- Reader side ---
+
+int runtime_reader_register(void) {
+    for (int i = 0; i < RUNTIME_MAX_READERS; i++) {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&g_readers[i].used, &expected, 1, 0, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_RELAXED)) {
+            __atomic_store_n(&g_readers[i].epoch, __atomic_load_n(&g_epoch, __ATOMIC_SEQ_CST),
+                             __ATOMIC_SEQ_CST);
+            return i;
+        }
+    }
+    return -1;
+}
+
+void runtime_reader_unregister(int reader) {
+    if (reader < 0 || reader >= RUNTIME_MAX_READERS) return;
+    __atomic_store_n(&g_readers[reader].epoch, 0, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&g_readers[reader].used, 0, __ATOMIC_RELEASE);
+}
+
+int runtime_config_refresh(int reader, uint64_t* seen, RuntimeConfig* out) {
+    int changed = 0;
+
+    // Common case: one load of a read-mostly line
+    if (__atomic_load_n(&g_generation, __ATOMIC_ACQUIRE) != *seen) {
+        const Snapshot* current = __atomic_load_n(&g_current, __ATOMIC_SEQ_CST);
+        if (current) {
+            *out = current->config;
+            *seen = out->generation;
+            changed = 1;
+        }
+    }
+
+    // Quiescent state: the copy is done, no reference to any snapshot is held
+    if (reader >= 0 && reader < RUNTIME_MAX_READERS) {
+        uint64_t epoch = __atomic_load_n(&g_epoch, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&g_readers[reader].epoch, __ATOMIC_RELAXED) != epoch) {
+            __atomic_store_n(&g_readers[reader].epoch, epoch, __ATOMIC_SEQ_CST);
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file runtimeConfig.h
+ * @brief Settings that can change while capture runs, published as RCU snapshots.
+ *
+ * The current settings live in one immutable, heap-allocated snapshot. A writer
+ * (the control socket thread) builds a new snapshot, swaps the global pointer and
+ * frees the old one after a grace period. Capture threads never lock: between
+ * batches each source compares the published generation with its own, copies a
+ * newer snapshot into its private state, then reports a quiescent state. Once
+ * every registered reader has reported one after the swap, no reader can still
+ * be reading the old snapshot (quiescent-state-based reclamation).
+ */
+
+#ifndef RUNTIME_CONFIG_H
+#define RUNTIME_CONFIG_H
+
+#include <stdint.h>
+#include "sampler.h"
+#include "packetFilter.h"
+
+#define RUNTIME_MAX_READERS 64
+
+/**
+ * @brief One generation of the runtime settings.
+ */
+typedef struct {
+    uint64_t generation;        // Set by runtime_config_publish()
+    SamplingConfig sampling;    // Export sampling
+    PacketFilter export_filter; // Packet records exported (inactive = all)
+    PacketFilter trigger_filter; // Time machine TM_TRIGGER_FILTER
+} RuntimeConfig;
+
+/**
+ * @brief Publishes the startup settings (call before capture starts).
+ * @return 0 on success, -1 on allocation failure.
+ */
+int runtime_config_init(const RuntimeConfig* initial);
+
+/**
+ * @brief Frees the current snapshot (after every reader has unregistered).
+ */
+void runtime_config_cleanup(void);
+
+/**
+ * @brief Copies the current settings (writer side, e.g. to edit and republish).
+ */
+void runtime_config_get(RuntimeConfig* out);
+
+/**
+ * @brief Swaps in a copy of @p next, waits for a grace period and frees the previous snapshot.
+ *
+ * Writers are serialized. Blocks until every registered reader has passed a
+ * quiescent state, so it must not be called from a capture thread.
+ *
+ * @return The new generation, or 0 on allocation failure.
+ */
+uint64_t runtime_config_publish(const RuntimeConfig* next);
+
+/**
+ * @brief Registers a reader (one per capture source).
+ * @return Reader slot, or -1 if all RUNTIME_MAX_READERS are taken.
+ */
+int runtime_reader_register(void);
+
+/**
+ * @brief Takes a reader offline: grace periods no longer wait for it.
+ */
+void runtime_reader_unregister(int reader);
+
+/**
+ * @brief Between batches: picks up a newer snapshot and reports a quiescent state.
+ *
+ * @param seen Generation the caller last applied (updated).
+ * @param out Receives a copy of the settings when they changed.
+ * @return 1 if @p out was filled with newer settings, 0 otherwise.
+ */
+int runtime_config_refresh(int reader, uint64_t* seen, RuntimeConfig* out);
+
+#endif // RUNTIME_CONFIG_H
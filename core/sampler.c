@@ -0,0 +1,206 @@
+/**
+ * @file sampler.c
+ * @brief Implementation of the export sampling stage.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sampler.h"
+#include "logger.h"
+#include "hash.h"
+
+#define ADAPT_PERIOD_MS 50
+#define FLOW_HASH_SEED  0x464c4f57u
+
+// Startup settings; runtime changes go through sampler_reconfigure()
+static SamplingConfig g_config = {
+    .mode = SAMPLING_NONE,
+    .rate = 1,
+    .adaptive = 0,
+    .high_watermark = 8192,
+    .low_watermark = 1024,
+    .max_rate = 1024
+};
+
+void sampling_config_defaults(SamplingConfig* config) {
+    config->mode = SAMPLING_NONE;
+    config->rate = 1;
+    config->adaptive = 0;
+    config->high_watermark = 8192;
+    config->low_watermark = 1024;
+    config->max_rate = 1024;
+}
+
+int parse_sampling_spec(const char* spec, SamplingConfig* config) {
+    char mode[16] = "";
+    unsigned long rate = 1;
+
+    const char* colon = strchr(spec, ':');
+    size_t mode_len = colon ? (size_t)(colon - spec) : strlen(spec);
+    if (mode_len == 0 || mode_len >= sizeof(mode)) return -1;
+    memcpy(mode, spec, mode_len);
+
+    if (colon) {
+        char* end = NULL;
+        rate = strtoul(colon + 1, &end, 10);
+        if (*end != '\0' || rate == 0 || rate > 1000000) return -1;
+    }
+
+    if (strcmp(mode, "none") == 0)        config->mode = SAMPLING_NONE;
+    else if (strcmp(mode, "count") == 0)  config->mode = SAMPLING_COUNT;
+    else if (strcmp(mode, "random") == 0) config->mode = SAMPLING_RANDOM;
+    else if (strcmp(mode, "flow") == 0)   config->mode = SAMPLING_FLOW;
+    else return -1;
+
+    config->rate = (config->mode == SAMPLING_NONE) ? 1 : (uint32_t)rate;
+    return 0;
+}
+
+void sampling_describe(const SamplingConfig* config, char* out, size_t len) {
+    static const char* const names[] = { "none", "count", "random", "flow" };
+    if (config->mode == SAMPLING_NONE) {
+        snprintf(out, len, "none");
+    } else {
+        snprintf(out, len, "%s:%u", names[config->mode], config->rate);
+    }
+}
+
+static void normalize_config(SamplingConfig* config) {
+    // Adaptive mode needs an algorithm to scale: fall back to deterministic counting
+    if (config->adaptive && config->mode == SAMPLING_NONE) {
+        config->mode = SAMPLING_COUNT;
+        config->rate = 1;
+    }
+    if (config->rate == 0) {
+        config->rate = 1;
+    }
+    // Adaptive rates are the base rate doubled k times (see sampler_keep's flow mode):
+    // the cap is rounded down to the largest such rate
+    uint32_t max_rate = config->rate;
+    while (max_rate <= config->max_rate / 2) max_rate *= 2;
+    config->max_rate = max_rate;
+}
+
+void set_sampling_config(const SamplingConfig* config) {
+    g_config = *config;
+    normalize_config(&g_config);
+}
+
+void sampler_init(Sampler* sampler, uint64_t seed) {
+    sampler->rng = hash_mix64(seed + 0x9e3779b97f4a7c15ULL) | 1;
+    sampler_reconfigure(sampler, &g_config);
+}
+
+void sampler_reconfigure(Sampler* sampler, const SamplingConfig* config) {
+    sampler->config = *config;
+    normalize_config(&sampler->config);
+    sampler->rate = sampler->config.rate;
+    sampler->counter = 0;
+    sampler->next_adapt_ms = 0;
+}
+
+// --- Helpers ---
+
+static inline uint64_t xorshift64(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+// Direction-less flow hash, so both directions of a flow get the same decision
+static uint64_t flow_hash(const PacketMetadata* meta) {
+    uint8_t key[16 + 16 + 2 + 2 + 1];
+    const uint8_t *a, *b;
+    uint16_t port_a, port_b;
+    size_t addr_len = meta->is_monitor_mode ? 6 : 16;
+    const uint8_t* src = meta->is_monitor_mode ? meta->src_mac : meta->src_addr;
+    const uint8_t* dst = meta->is_monitor_mode ? meta->dest_mac : meta->dest_addr;
+
+    int cmp = memcmp(src, dst, addr_len);
+    if (cmp < 0 || (cmp == 0 && meta->src_port <= meta->dest_port)) {
+        a = src; port_a = meta->src_port;
+        b = dst; port_b = meta->dest_port;
+    } else {
+        a = dst; port_a = meta->dest_port;
+        b = src; port_b = meta->src_port;
+    }
+
+    memset(key, 0, sizeof(key));
+    memcpy(key, a, addr_len);
+    memcpy(key + 16, b, addr_len);
+    memcpy(key + 32, &port_a, 2);
+    memcpy(key + 34, &port_b, 2);
+    key[36] = meta->l3_protocol;
+
+    return hash_bytes(key, sizeof(key), FLOW_HASH_SEED);
+}
+
+// --- Public API ---
+
+void sampler_set_shed_rate(Sampler* sampler, uint32_t rate) {
+    sampler->shed_rate = rate;
+}
+
+int sampler_keep(Sampler* sampler, PacketMetadata* meta) {
+    uint32_t rate = sampler->rate;
+    int keep = 1;
+
+    if (rate < sampler->shed_rate) {
+        if (sampler->config.mode == SAMPLING_FLOW) {
+            // A multiple of the rate, so flows kept under overload are a subset of those kept normally
+            rate = (sampler->shed_rate + rate - 1) / rate * rate;
+        } else {
+            rate = sampler->shed_rate;
+        }
+    }
+
+    if (rate > 1) {
+        switch (sampler->config.mode) {
+            case SAMPLING_NONE:     // Only under an overload floor
+            case SAMPLING_COUNT:
+                if (++sampler->counter >= rate) {
+                    sampler->counter = 0;
+                } else {
+                    keep = 0;
+                }
+                break;
+            case SAMPLING_RANDOM:
+                keep = (xorshift64(&sampler->rng) % rate) == 0;
+                break;
+            case SAMPLING_FLOW:
+                // Rates only ever double, so flows kept at 2N are a subset of those kept at N
+                keep = (flow_hash(meta) % rate) == 0;
+                break;
+        }
+    }
+
+    if (keep) {
+        meta->sampling_rate = rate;
+    }
+    return keep;
+}
+
+void sampler_adapt(Sampler* sampler, uint64_t now_ms) {
+    const SamplingConfig* config = &sampler->config;
+    if (!config->adaptive || now_ms < sampler->next_adapt_ms) return;
+    sampler->next_adapt_ms = now_ms + ADAPT_PERIOD_MS;
+
+    size_t depth = logger_queue_depth();
+    uint32_t rate = sampler->rate;
+
+    // Exact doublings only: max_rate is the base rate times a power of two
+    if (depth > config->high_watermark && rate <= config->max_rate / 2) {
+        rate *= 2;
+        log_message("[WARN] Export queue at %zu records - sampling raised to 1-in-%u\n", depth, rate);
+    } else if (depth < config->low_watermark && rate / 2 >= config->rate) {
+        rate /= 2;
+        log_message("[INFO] Export queue drained (%zu records) - sampling lowered to 1-in-%u\n", depth, rate);
+    }
+
+    sampler->rate = rate;
+}
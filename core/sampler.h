@@ -0,0 +1,114 @@
+/**
+ * @file sampler.h
+ * @brief Export sampling stage (runs after parsing, before log_packet()).
+ *
+ * Analytics still see every packet; sampling only bounds how many per-packet
+ * records are exported. Every exported record carries the 1-in-N rate that
+ * was in effect, so consumers can scale counts back up.
+ */
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Types.h"
+
+/**
+ * @brief Sampling algorithm.
+ */
+typedef enum {
+    SAMPLING_NONE,      // Export every packet
+    SAMPLING_COUNT,     // Deterministic: every N-th packet
+    SAMPLING_RANDOM,    // Probabilistic: each packet with probability 1/N
+    SAMPLING_FLOW       // Hash-based: all packets of 1 in N flows
+} SamplingMode;
+
+/**
+ * @brief Process-wide sampling settings.
+ */
+typedef struct {
+    SamplingMode mode;
+    uint32_t rate;              // Base 1-in-N rate
+    int adaptive;               // Raise the rate when the export queue backs up
+    size_t high_watermark;      // Queue depth that doubles the rate
+    size_t low_watermark;       // Queue depth that halves it again (down to the base rate)
+    uint32_t max_rate;          // Upper bound for adaptive mode (rounded down to rate * 2^k)
+} SamplingConfig;
+
+/**
+ * @brief Per-source sampler state (single writer, no locking).
+ */
+typedef struct {
+    SamplingConfig config;      // Own copy: replaced between batches on a runtime reload
+    uint32_t rate;              // Effective 1-in-N rate
+    uint32_t shed_rate;         // Overload floor on the rate (0 = none)
+    uint32_t counter;           // Packets since the last kept one (count mode)
+    uint64_t rng;               // xorshift state (random mode)
+    uint64_t next_adapt_ms;
+} Sampler;
+
+/**
+ * @brief Fills @p config with defaults (no sampling, adaptive watermarks preset).
+ */
+void sampling_config_defaults(SamplingConfig* config);
+
+/**
+ * @brief Parses a "mode[:N]" spec such as "count:10", "random:100" or "flow:16".
+ * @return 0 on success, -1 on a malformed spec.
+ */
+int parse_sampling_spec(const char* spec, SamplingConfig* config);
+
+/**
+ * @brief Writes @p config back as a spec ("count:10", "none").
+ */
+void sampling_describe(const SamplingConfig* config, char* out, size_t len);
+
+/**
+ * @brief Installs the process-wide sampling settings (call before capture starts).
+ */
+void set_sampling_config(const SamplingConfig* config);
+
+/**
+ * @brief Initializes a per-source sampler.
+ *
+ * Adaptive rates only double or halve from the base rate, so flow mode keeps a
+ * subset of the same flows; max_rate is rounded down to the base rate times a
+ * power of two.
+ *
+ * @param seed Seed for the random mode (e.g. the interface ID).
+ */
+void sampler_init(Sampler* sampler, uint64_t seed);
+
+/**
+ * @brief Switches a per-source sampler to new settings (capture thread).
+ *
+ * The effective rate restarts from the new base rate; max_rate is rounded as in sampler_init().
+ */
+void sampler_reconfigure(Sampler* sampler, const SamplingConfig* config);
+
+/**
+ * @brief Sets an overload floor on the rate, applied even when sampling is off (0 = none).
+ *
+ * Without a sampling mode the floor samples deterministically, as count mode.
+ * In flow mode it is rounded up to a multiple of the rate.
+ */
+void sampler_set_shed_rate(Sampler* sampler, uint32_t rate);
+
+/**
+ * @brief Decides whether a parsed packet is exported.
+ *
+ * On a keep decision, stamps the effective rate into meta->sampling_rate.
+ *
+ * @return 1 to export, 0 to skip.
+ */
+int sampler_keep(Sampler* sampler, PacketMetadata* meta);
+
+/**
+ * @brief Adaptive mode: adjusts the rate from the export queue depth.
+ *
+ * Cheap to call often; only acts every few milliseconds.
+ */
+void sampler_adapt(Sampler* sampler, uint64_t now_ms);
+
+#endif // SAMPLER_H
@@ -0,0 +1,625 @@
+/**
+ * @file tcpReassembly.c
+ * @brief Implementation of per-worker TCP stream reassembly.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tcpReassembly.h"
+#include "mem_pool.h"
+#include "logger.h"
+
+#define TCP_SEGMENT_SIZE   2048                         // Store slot, header included
+#define TCP_SEGMENT_DATA   (TCP_SEGMENT_SIZE - 16)      // Payload bytes per slot
+#define TCP_MAX_WINDOW     (16u * 1024 * 1024)          // Farther ahead than this is bogus
+
+// TCP flag bits as packed by parse_tcp()
+#define TCP_FLAG_FIN 0x01
+#define TCP_FLAG_SYN 0x02
+#define TCP_FLAG_RST 0x04
+
+/**
+ * @brief Buffered out-of-order bytes [seq, seq + len), stored at data[off].
+ */
+typedef struct TcpSegment {
+    struct TcpSegment* next;
+    uint32_t seq;
+    uint16_t off;
+    uint16_t len;
+    uint8_t data[TCP_SEGMENT_DATA];
+} TcpSegment;
+
+/**
+ * @brief One direction of a connection.
+ */
+typedef struct {
+    uint32_t next_seq;      // Next byte to deliver
+    uint32_t fin_seq;       // Sequence number of the FIN, once seen
+    uint32_t buffered;      // Bytes held in segments
+    uint8_t tracking;       // next_seq is valid
+    uint8_t fin_pending;
+    uint8_t closed;         // FIN reached or RST: no more data
+    TcpSegment* head;       // Sorted by sequence number, non-overlapping
+} TcpStream;
+
+struct TcpSession {
+    TcpStream streams[2];
+    void* state[TCP_MAX_STREAM_PARSERS];    // Per-parser state (NULL = parser not attached)
+    uint32_t buffered;                      // Both directions
+    uint8_t attached;                       // Parsers still reading this flow
+    uint8_t in_lru;
+    struct TcpSession* lru_prev;
+    struct TcpSession* lru_next;            // Also links the free list
+};
+
+struct TcpReassembler {
+    ReassemblyConfig config;
+    void* workers[TCP_MAX_STREAM_PARSERS];  // Per-parser worker data, passed to open()
+
+    // Segment store
+    MemRegion seg_region;
+    TcpSegment* free_segments;
+    uint32_t seg_capacity;
+    uint32_t seg_free;
+
+    // Session store
+    MemRegion session_region;
+    struct TcpSession* free_sessions;
+
+    // Sessions holding buffered data, least recently extended first
+    struct TcpSession* lru_head;
+    struct TcpSession* lru_tail;
+
+    uint64_t now_ns;
+
+    // Counters (cumulative)
+    uint64_t sessions_active;
+    uint64_t sessions_opened;
+    uint64_t sessions_refused;      // Session store full
+    uint64_t sessions_finished;     // Every parser had what it needed before the flow ended
+    uint64_t bytes_delivered;
+    uint64_t out_of_order;          // Segments that had to be buffered
+    uint64_t overlaps;              // Segments overlapping buffered data
+    uint64_t gaps;
+    uint64_t gap_bytes;
+    uint64_t evictions;             // Streams flushed because the segment store was full
+    uint64_t flow_cap_hits;         // Streams flushed because of the per-flow cap
+    uint64_t dropped_bytes;         // Out of window or no room even after eviction
+};
+
+// Registered parsers (written before workers start, read-only afterwards)
+static const TcpStreamParser* parsers[TCP_MAX_STREAM_PARSERS];
+static int parser_count = 0;
+
+static inline int32_t seq_diff(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b);
+}
+
+// --- Registration & Configuration ---
+
+int tcp_reassembly_register(const TcpStreamParser* parser) {
+    if (parser_count >= TCP_MAX_STREAM_PARSERS) return -1;
+    parsers[parser_count++] = parser;
+    return 0;
+}
+
+int tcp_reassembly_parser_count(void) {
+    return parser_count;
+}
+
+void reassembly_config_defaults(ReassemblyConfig* config) {
+    config->memory_cap = 16u * 1024 * 1024;
+    config->flow_cap = 256u * 1024;
+    config->max_sessions = 16384;
+    config->overlap = TCP_OVERLAP_FIRST;
+}
+
+// --- Stores ---
+
+static TcpSegment* seg_pop(TcpReassembler* r) {
+    TcpSegment* seg = r->free_segments;
+    if (seg) {
+        r->free_segments = seg->next;
+        r->seg_free--;
+    }
+    return seg;
+}
+
+static void seg_push(TcpReassembler* r, TcpSegment* seg) {
+    seg->next = r->free_segments;
+    r->free_segments = seg;
+    r->seg_free++;
+}
+
+static void lru_remove(TcpReassembler* r, struct TcpSession* s) {
+    if (!s->in_lru) return;
+    if (s->lru_prev) s->lru_prev->lru_next = s->lru_next; else r->lru_head = s->lru_next;
+    if (s->lru_next) s->lru_next->lru_prev = s->lru_prev; else r->lru_tail = s->lru_prev;
+    s->lru_prev = s->lru_next = NULL;
+    s->in_lru = 0;
+}
+
+static void lru_touch(TcpReassembler* r, struct TcpSession* s) {
+    lru_remove(r, s);
+    if (s->buffered == 0) return;
+
+    s->lru_prev = r->lru_tail;
+    s->lru_next = NULL;
+    if (r->lru_tail) r->lru_tail->lru_next = s; else r->lru_head = s;
+    r->lru_tail = s;
+    s->in_lru = 1;
+}
+
+// --- Delivery ---
+
+static void deliver(TcpReassembler* r, struct TcpSession* s, int dir, FlowRecord* flow,
+                    const uint8_t* data, uint32_t len) {
+    TcpStreamInfo info = { .flow = flow, .dir = dir, .ts_ns = r->now_ns };
+    for (int i = 0; i < parser_count; i++) {
+        if (!s->state[i] || !parsers[i]->data(s->state[i], &info, data, len)) continue;
+
+        // Done with this flow: detach now, or on a later call if the record is not at hand
+        if (flow) {
+            parsers[i]->close(s->state[i], flow);
+            s->state[i] = NULL;
+            s->attached--;
+        }
+    }
+    r->bytes_delivered += len;
+}
+
+static void notify_gap(TcpReassembler* r, struct TcpSession* s, int dir, FlowRecord* flow, uint32_t len) {
+    TcpStreamInfo info = { .flow = flow, .dir = dir, .ts_ns = r->now_ns };
+    for (int i = 0; i < parser_count; i++) {
+        if (s->state[i] && parsers[i]->gap) parsers[i]->gap(s->state[i], &info, len);
+    }
+    r->gaps++;
+    r->gap_bytes += len;
+}
+
+static void check_fin(TcpStream* st) {
+    if (st->fin_pending && st->next_seq == st->fin_seq) {
+        st->closed = 1;
+    }
+}
+
+// Delivers every buffered segment that has become contiguous
+static void drain(TcpReassembler* r, struct TcpSession* s, int dir, FlowRecord* flow) {
+    TcpStream* st = &s->streams[dir];
+    TcpSegment* seg;
+
+    while ((seg = st->head) != NULL && seq_diff(seg->seq, st->next_seq) <= 0) {
+        int32_t skip = seq_diff(st->next_seq, seg->seq);
+        if (skip < seg->len) {
+            deliver(r, s, dir, flow, seg->data + seg->off + skip, (uint32_t)(seg->len - skip));
+            st->next_seq = seg->seq + seg->len;
+        }
+        st->head = seg->next;
+        st->buffered -= seg->len;
+        s->buffered -= seg->len;
+        seg_push(r, seg);
+    }
+
+    check_fin(st);
+    if (s->buffered == 0) lru_remove(r, s);
+}
+
+// Skips the hole in front of the first buffered segment
+static void skip_hole(TcpReassembler* r, struct TcpSession* s, int dir, FlowRecord* flow) {
+    TcpStream* st = &s->streams[dir];
+    if (!st->head) return;
+
+    int32_t missing = seq_diff(st->head->seq, st->next_seq);
+    if (missing > 0) {
+        notify_gap(r, s, dir, flow, (uint32_t)missing);
+        st->next_seq = st->head->seq;
+    }
+    drain(r, s, dir, flow);
+}
+
+static void flush_stream(TcpReassembler* r, struct TcpSession* s, int dir, FlowRecord* flow) {
+    while (s->streams[dir].head) {
+        skip_hole(r, s, dir, flow);
+    }
+}
+
+// Frees segments by flushing the least recently extended sessions
+static void ensure_segments(TcpReassembler* r, struct TcpSession* current, FlowRecord* flow, uint32_t need) {
+    while (r->seg_free < need && r->lru_head) {
+        struct TcpSession* victim = r->lru_head;
+        FlowRecord* victim_flow = (victim == current) ? flow : NULL;
+        flush_stream(r, victim, 0, victim_flow);
+        flush_stream(r, victim, 1, victim_flow);
+        r->evictions++;
+    }
+}
+
+// --- Segment Insertion ---
+
+// Links copies of [seq, seq + len) in front of *link; returns the link after the last copy
+static TcpSegment** insert_run(TcpReassembler* r, struct TcpSession* s, TcpStream* st,
+                               TcpSegment** link, uint32_t seq, const uint8_t* data, uint32_t len) {
+    while (len > 0) {
+        TcpSegment* seg = seg_pop(r);
+        if (!seg) {
+            r->dropped_bytes += len;
+            return NULL;
+        }
+
+        uint16_t chunk = (uint16_t)(len < TCP_SEGMENT_DATA ? len : TCP_SEGMENT_DATA);
+        seg->seq = seq;
+        seg->off = 0;
+        seg->len = chunk;
+        memcpy(seg->data, data, chunk);
+
+        seg->next = *link;
+        *link = seg;
+        link = &seg->next;
+
+        st->buffered += chunk;
+        s->buffered += chunk;
+        seq += chunk;
+        data += chunk;
+        len -= chunk;
+    }
+    return link;
+}
+
+// Keep buffered bytes, fill only the holes around them
+static void insert_keep_first(TcpReassembler* r, struct TcpSession* s, TcpStream* st,
+                              uint32_t seq, const uint8_t* data, uint32_t len) {
+    TcpSegment** link = &st->head;
+    uint32_t cur = seq;
+    uint32_t end = seq + len;
+
+    while (seq_diff(end, cur) > 0) {
+        TcpSegment* seg = *link;
+
+        // Segment entirely before the remaining range
+        if (seg && seq_diff(seg->seq + seg->len, cur) <= 0) {
+            link = &seg->next;
+            continue;
+        }
+
+        // Hole before the next buffered segment (or the end of the list)
+        int overlapping = (seg && seq_diff(seg->seq, end) < 0);
+        uint32_t piece_end = end;
+        if (overlapping) piece_end = seq_diff(seg->seq, cur) > 0 ? seg->seq : cur;
+        if (seq_diff(piece_end, cur) > 0) {
+            link = insert_run(r, s, st, link, cur, data + (cur - seq), piece_end - cur);
+            if (!link) return;
+            cur = piece_end;
+        }
+
+        if (overlapping) {
+            r->overlaps++;
+            uint32_t seg_end = seg->seq + seg->len;
+            if (seq_diff(seg_end, cur) > 0) cur = seg_end;
+            link = &seg->next;
+        }
+    }
+}
+
+// New bytes replace buffered ones: cut the overlapped range out of the list, then insert
+static void insert_keep_last(TcpReassembler* r, struct TcpSession* s, TcpStream* st,
+                             uint32_t seq, const uint8_t* data, uint32_t len) {
+    uint32_t end = seq + len;
+    TcpSegment** link = &st->head;
+    TcpSegment* seg;
+
+    while ((seg = *link) != NULL) {
+        uint32_t seg_start = seg->seq;
+        uint32_t seg_end = seg->seq + seg->len;
+
+        if (seq_diff(seg_end, seq) <= 0) {          // Before the new range
+            link = &seg->next;
+            continue;
+        }
+        if (seq_diff(seg_start, end) >= 0) break;   // After it
+
+        r->overlaps++;
+        int starts_before = seq_diff(seg_start, seq) < 0;
+        int ends_after = seq_diff(seg_end, end) > 0;
+
+        if (starts_before && ends_after) {
+            // Keep both sides: split the tail off into a new segment
+            TcpSegment* tail = seg_pop(r);
+            uint32_t keep_head = seq - seg_start;
+            uint32_t cut = seg->len - keep_head;
+            if (tail) {
+                uint32_t tail_len = seg_end - end;
+                tail->seq = end;
+                tail->off = 0;
+                tail->len = (uint16_t)tail_len;
+                memcpy(tail->data, seg->data + seg->off + (end - seg_start), tail_len);
+                tail->next = seg->next;
+                seg->next = tail;
+                cut -= tail_len;
+            } else {
+                r->dropped_bytes += seg_end - end;  // Pool exhausted: the tail is lost
+            }
+            seg->len = (uint16_t)keep_head;
+            st->buffered -= cut;
+            s->buffered -= cut;
+            link = &seg->next;
+        } else if (starts_before) {
+            uint32_t cut = seg_end - seq;           // Drop the segment's tail
+            seg->len -= (uint16_t)cut;
+            st->buffered -= cut;
+            s->buffered -= cut;
+            link = &seg->next;
+        } else if (ends_after) {
+            uint32_t cut = end - seg_start;         // Drop the segment's head
+            seg->seq += cut;
+            seg->off += (uint16_t)cut;
+            seg->len -= (uint16_t)cut;
+            st->buffered -= cut;
+            s->buffered -= cut;
+            break;
+        } else {
+            *link = seg->next;                      // Fully replaced
+            st->buffered -= seg->len;
+            s->buffered -= seg->len;
+            seg_push(r, seg);
+        }
+    }
+
+    // The range is free now: find its place and insert
+    link = &st->head;
+    while (*link && seq_diff((*link)->seq, seq) < 0) link = &(*link)->next;
+    insert_run(r, s, st, link, seq, data, len);
+}
+
+static void insert_segment(TcpReassembler* r, struct TcpSession* s, int dir, FlowRecord* flow,
+                           uint32_t seq, const uint8_t* data, uint32_t len) {
+    TcpStream* st = &s->streams[dir];
+
+    // Trim bytes that were already delivered (retransmissions)
+    int32_t delivered = seq_diff(st->next_seq, seq);
+    if (delivered > 0) {
+        if ((uint32_t)delivered >= len) return;
+        seq += (uint32_t)delivered;
+        data += delivered;
+        len -= (uint32_t)delivered;
+    }
+
+    // Fast path: in order with nothing buffered, deliver straight from the frame
+    if (seq == st->next_seq && st->head == NULL) {
+        deliver(r, s, dir, flow, data, len);
+        st->next_seq += len;
+        return;
+    }
+
+    if ((uint32_t)seq_diff(seq, st->next_seq) > TCP_MAX_WINDOW) {
+        r->dropped_bytes += len;
+        return;
+    }
+
+    // Make room first: eviction may skip this stream's own hole and move next_seq
+    uint32_t need = len / TCP_SEGMENT_DATA + 2;
+    if (r->seg_free < need && r->lru_head) {
+        ensure_segments(r, s, flow, need);
+        insert_segment(r, s, dir, flow, seq, data, len);
+        return;
+    }
+
+    if (seq != st->next_seq) r->out_of_order++;
+    if (r->config.overlap == TCP_OVERLAP_LAST) {
+        insert_keep_last(r, s, st, seq, data, len);
+    } else {
+        insert_keep_first(r, s, st, seq, data, len);
+    }
+
+    drain(r, s, dir, flow);
+    lru_touch(r, s);
+
+    // Per-flow cap: stop waiting for the hole
+    if (s->buffered > r->config.flow_cap) {
+        r->flow_cap_hits++;
+        while (s->buffered > r->config.flow_cap && st->head) {
+            skip_hole(r, s, dir, flow);
+        }
+        lru_touch(r, s);
+    }
+}
+
+// --- Sessions ---
+
+static struct TcpSession* open_session(TcpReassembler* r, const FlowRecord* flow) {
+    struct TcpSession* s = r->free_sessions;
+    if (!s) {
+        r->sessions_refused++;
+        return NULL;
+    }
+
+    memset(s->streams, 0, sizeof(s->streams));
+    memset(s->state, 0, sizeof(s->state));
+    s->buffered = 0;
+
+    int attached = 0;
+    for (int i = 0; i < parser_count; i++) {
+        s->state[i] = parsers[i]->open(r->workers[i], flow);
+        if (s->state[i]) attached++;
+    }
+    if (attached == 0) return NULL;
+    s->attached = (uint8_t)attached;
+
+    r->free_sessions = s->lru_next;
+    s->lru_next = s->lru_prev = NULL;
+    s->in_lru = 0;
+    r->sessions_active++;
+    r->sessions_opened++;
+    return s;
+}
+
+// Returns the session and its segments to the stores, without delivering anything
+static void free_session(TcpReassembler* r, FlowEntry* entry) {
+    struct TcpSession* s = entry->session;
+
+    for (int dir = 0; dir < 2; dir++) {
+        TcpSegment* seg;
+        while ((seg = s->streams[dir].head) != NULL) {
+            s->streams[dir].head = seg->next;
+            seg_push(r, seg);
+        }
+    }
+    s->buffered = 0;
+
+    lru_remove(r, s);
+    s->lru_next = r->free_sessions;
+    r->free_sessions = s;
+    r->sessions_active--;
+    entry->session = NULL;
+}
+
+TcpReassembler* tcp_reassembler_create(const ReassemblyConfig* config) {
+    TcpReassembler* r = (TcpReassembler*)calloc(1, sizeof(TcpReassembler));
+    if (!r) return NULL;
+    r->config = *config;
+
+    int node = numa_default_node();
+    if (mem_region_alloc(&r->seg_region, config->memory_cap, node) != 0 ||
+        mem_region_alloc(&r->session_region, (size_t)config->max_sessions * sizeof(struct TcpSession), node) != 0) {
+        tcp_reassembler_destroy(r);
+        return NULL;
+    }
+
+    r->seg_capacity = (uint32_t)(r->seg_region.size / sizeof(TcpSegment));
+    TcpSegment* segs = (TcpSegment*)r->seg_region.base;
+    for (uint32_t i = r->seg_capacity; i-- > 0;) seg_push(r, &segs[i]);
+
+    struct TcpSession* sessions = (struct TcpSession*)r->session_region.base;
+    for (uint32_t i = config->max_sessions; i-- > 0;) {
+        sessions[i].lru_next = r->free_sessions;
+        r->free_sessions = &sessions[i];
+    }
+    return r;
+}
+
+void tcp_reassembler_destroy(TcpReassembler* r) {
+    if (!r) return;
+    mem_region_free(&r->seg_region);
+    mem_region_free(&r->session_region);
+    free(r);
+}
+
+int tcp_reassembly_set_worker(TcpReassembler* r, const TcpStreamParser* parser, void* worker) {
+    for (int i = 0; i < parser_count; i++) {
+        if (parsers[i] == parser) {
+            r->workers[i] = worker;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void tcp_reassembly_process(TcpReassembler* r, FlowEntry* entry, int dir,
+                            const PacketMetadata* meta, const unsigned char* frame) {
+    struct TcpSession* s = entry->session;
+    FlowRecord* flow = &entry->record;
+    r->now_ns = meta->timestamp_ns;
+
+    if (!s) {
+        if (entry->session_declined) return;
+        s = open_session(r, flow);
+        if (!s) {
+            entry->session_declined = 1;
+            return;
+        }
+        entry->session = s;
+    }
+
+    // Reset: deliver what we have, then stop both directions
+    if (meta->tcp_flags & TCP_FLAG_RST) {
+        for (int d = 0; d < 2; d++) {
+            flush_stream(r, s, d, flow);
+            s->streams[d].closed = 1;
+        }
+        return;
+    }
+
+    TcpStream* st = &s->streams[dir];
+    if (st->closed) return;
+
+    uint32_t data_seq = meta->tcp_seq;
+    if (meta->tcp_flags & TCP_FLAG_SYN) {
+        data_seq++; // SYN consumes one sequence number
+        if (!st->tracking) {
+            st->next_seq = data_seq;
+            st->tracking = 1;
+        }
+    } else if (!st->tracking) {
+        // Picked up mid-stream: start at the first data we see
+        if (meta->payload_len == 0) return;
+        st->next_seq = data_seq;
+        st->tracking = 1;
+    }
+
+    if (meta->payload_len > 0 && meta->payload_offset > 0) {
+        insert_segment(r, s, dir, flow, data_seq, frame + meta->payload_offset, meta->payload_len);
+    }
+
+    if (meta->tcp_flags & TCP_FLAG_FIN) {
+        st->fin_pending = 1;
+        st->fin_seq = data_seq + meta->payload_wire_len;
+    }
+    check_fin(st);
+
+    // Nobody is reading anymore: the rest of the flow skips reassembly entirely
+    if (s->attached == 0) {
+        free_session(r, entry);
+        entry->session_declined = 1;
+        r->sessions_finished++;
+    }
+}
+
+void tcp_reassembly_release(TcpReassembler* r, FlowEntry* entry) {
+    struct TcpSession* s = entry->session;
+    if (!s) return;
+
+    FlowRecord* flow = &entry->record;
+    flush_stream(r, s, 0, flow);
+    flush_stream(r, s, 1, flow);
+
+    for (int i = 0; i < parser_count; i++) {
+        if (s->state[i]) {
+            parsers[i]->close(s->state[i], flow);
+            s->state[i] = NULL;
+        }
+    }
+    s->attached = 0;
+
+    free_session(r, entry);
+}
+
+void tcp_reassembly_publish(TcpReassembler* r, int if_id) {
+    char json[640];
+    snprintf(json, sizeof(json),
+        "{\"event\": \"reassembly\","
+        "\"if_id\": %d,"
+        "\"sessions\": %llu,"
+        "\"sessions_opened\": %llu,"
+        "\"sessions_refused\": %llu,"
+        "\"sessions_finished\": %llu,"
+        "\"buffered_bytes\": %llu,"
+        "\"segments_free\": %u,"
+        "\"bytes_delivered\": %llu,"
+        "\"out_of_order\": %llu,"
+        "\"overlaps\": %llu,"
+        "\"gaps\": %llu,"
+        "\"gap_bytes\": %llu,"
+        "\"evictions\": %llu,"
+        "\"flow_cap_hits\": %llu,"
+        "\"dropped_bytes\": %llu}",
+        if_id,
+        (unsigned long long)r->sessions_active, (unsigned long long)r->sessions_opened,
+        (unsigned long long)r->sessions_refused, (unsigned long long)r->sessions_finished,
+        (unsigned long long)(r->seg_capacity - r->seg_free) * TCP_SEGMENT_DATA, r->seg_free,
+        (unsigned long long)r->bytes_delivered, (unsigned long long)r->out_of_order,
+        (unsigned long long)r->overlaps, (unsigned long long)r->gaps,
+        (unsigned long long)r->gap_bytes, (unsigned long long)r->evictions,
+        (unsigned long long)r->flow_cap_hits, (unsigned long long)r->dropped_bytes);
+    log_event(json);
+}
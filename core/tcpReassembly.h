@@ -0,0 +1,149 @@
+/**
+ * @file tcpReassembly.h
+ * @brief TCP stream reassembly for payload analyzers, tied to the flow table.
+ *
+ * Each parser context (one per capture worker) owns a reassembler, so no locks
+ * are taken. Flows get a session only if a registered stream parser asks for
+ * them. Each direction tracks its next expected sequence number. In-order data
+ * is delivered straight from the capture frame. Out-of-order segments are copied
+ * into a pooled segment store until the hole is filled.
+ *
+ * A parser that has seen enough of a flow says so, and is detached; once no
+ * parser is left, the flow's session is freed and its later packets skip
+ * reassembly.
+ *
+ * Memory is bounded twice: per flow, and per worker by the segment store. When
+ * either bound is hit, the oldest buffered stream skips its hole: parsers get a
+ * gap notification, followed by the data after the gap.
+ */
+
+#ifndef TCP_REASSEMBLY_H
+#define TCP_REASSEMBLY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Types.h"
+#include "flowTable.h"
+
+/**
+ * @brief Maximum number of registered stream parsers.
+ */
+#define TCP_MAX_STREAM_PARSERS 8
+
+/**
+ * @brief Which copy wins when a new segment overlaps buffered data.
+ * Data already delivered to parsers is never replaced.
+ */
+typedef enum {
+    TCP_OVERLAP_FIRST,      // Keep the bytes received first (BSD / Windows behaviour)
+    TCP_OVERLAP_LAST        // New bytes replace buffered ones (Linux-style "favor new")
+} TcpOverlapPolicy;
+
+/**
+ * @brief Reassembly limits, per capture worker.
+ */
+typedef struct {
+    size_t memory_cap;          // Bytes of out-of-order segment storage
+    uint32_t flow_cap;          // Bytes buffered by a single flow before it skips its hole
+    uint32_t max_sessions;      // Concurrently reassembled flows
+    TcpOverlapPolicy overlap;
+} ReassemblyConfig;
+
+/**
+ * @brief Where a delivered chunk comes from.
+ */
+typedef struct {
+    FlowRecord* flow;           // Flow being reassembled (NULL when delivery is forced by memory pressure)
+    int dir;                    // 0 = initiator -> responder, 1 = reverse
+    uint64_t ts_ns;             // Capture time of the packet that completed the chunk
+} TcpStreamInfo;
+
+/**
+ * @brief An application parser fed with in-order stream bytes.
+ *
+ * All callbacks run on the worker that owns the flow. State returned by open()
+ * is private to one session and is freed by close(). Per-worker data (e.g. the
+ * parser's aggregates) is handed to open() through tcp_reassembly_set_worker().
+ */
+typedef struct {
+    const char* name;
+
+    /**
+     * @brief Called on the first TCP packet of a flow.
+     * @param worker Pointer set with tcp_reassembly_set_worker() (NULL if none).
+     * @return Per-session state, or NULL if the parser is not interested in this flow.
+     */
+    void* (*open)(void* worker, const FlowRecord* flow);
+
+    /**
+     * @brief Contiguous bytes, in stream order.
+     * @return Nonzero once the parser needs nothing more from this flow: it is closed and gets no more calls.
+     */
+    int (*data)(void* state, const TcpStreamInfo* info, const uint8_t* data, uint32_t len);
+
+    /**
+     * @brief @p len bytes were lost before the next data() call (optional).
+     */
+    void (*gap)(void* state, const TcpStreamInfo* info, uint32_t len);
+
+    /**
+     * @brief The flow ended. The parser may annotate @p flow before it is exported, and frees @p state.
+     */
+    void (*close)(void* state, FlowRecord* flow);
+} TcpStreamParser;
+
+typedef struct TcpReassembler TcpReassembler;
+
+/**
+ * @brief Registers a stream parser. Must be called before the parser contexts are created.
+ * @return 0 on success, -1 if the table is full.
+ */
+int tcp_reassembly_register(const TcpStreamParser* parser);
+
+/**
+ * @brief Number of registered stream parsers.
+ */
+int tcp_reassembly_parser_count(void);
+
+/**
+ * @brief Fills @p config with the default limits.
+ */
+void reassembly_config_defaults(ReassemblyConfig* config);
+
+/**
+ * @brief Creates a reassembler for one worker.
+ * @return TcpReassembler* or NULL on allocation failure.
+ */
+TcpReassembler* tcp_reassembler_create(const ReassemblyConfig* config);
+
+/**
+ * @brief Frees the reassembler. Sessions must have been released through their flows.
+ */
+void tcp_reassembler_destroy(TcpReassembler* reasm);
+
+/**
+ * @brief Sets the per-worker pointer passed to a parser's open() on this reassembler.
+ * @return 0 on success, -1 if the parser is not registered.
+ */
+int tcp_reassembly_set_worker(TcpReassembler* reasm, const TcpStreamParser* parser, void* worker);
+
+/**
+ * @brief Feeds one TCP packet of a tracked flow.
+ * @param entry Flow entry returned by flow_table_update().
+ * @param dir Direction returned by flow_table_update().
+ * @param frame Captured frame; meta's payload offsets point into it.
+ */
+void tcp_reassembly_process(TcpReassembler* reasm, FlowEntry* entry, int dir,
+                            const PacketMetadata* meta, const unsigned char* frame);
+
+/**
+ * @brief Ends a flow's session: flushes buffered data, closes parsers and frees the session.
+ */
+void tcp_reassembly_release(TcpReassembler* reasm, FlowEntry* entry);
+
+/**
+ * @brief Exports the worker's reassembly counters as a {"event": "reassembly"} record.
+ */
+void tcp_reassembly_publish(TcpReassembler* reasm, int if_id);
+
+#endif // TCP_REASSEMBLY_H
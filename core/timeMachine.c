@@ -0,0 +1,509 @@
+/**
+ * @file timeMachine.c
+ * @brief Implementation of the rolling packet buffer and its trigger-driven pcapng dumps.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "timeMachine.h"
+#include "pcap_index.h"
+#include "mem_pool.h"
+#include "logger.h"
+#include "clock.h"
+
+#define TM_ALIGN            8
+#define TM_MAX_FRAME        262144      // Longer frames are truncated in the buffer
+#define TM_AVG_FRAME        128         // Sizes the slot ring against the frame memory
+#define TM_RATE_WARMUP      5           // Seconds of history before a spike can fire
+#define TM_POLL_NS          100000000   // Dumper sleep while waiting for the post-trigger window
+
+#define PCAPNG_SHB          0x0A0D0D0Au
+#define PCAPNG_IDB          0x00000001u
+#define PCAPNG_EPB          0x00000006u
+#define PCAPNG_BYTE_ORDER   0x1A2B3C4Du
+
+static const char* const trigger_names[TM_TRIGGER_COUNT] = { "eapol", "filter", "rate", "signal" };
+
+// Bumped by the SIGUSR2 handler, compared by each source's housekeeping
+static int g_dump_requests = 0;
+
+/**
+ * @brief Where a buffered frame lives (one per frame, in capture order).
+ */
+typedef struct {
+    uint64_t pos;               // Monotonic position in the frame memory
+    uint64_t ts_ns;
+    uint32_t caplen;
+    uint32_t wire_len;
+} TmSlot;
+
+struct TimeMachine {
+    TimeMachineConfig config;
+    int if_id;
+    uint32_t linktype;
+
+    MemRegion region;
+    uint8_t* data;
+    uint64_t data_mask;
+    TmSlot* slots;
+    uint64_t slot_mask;
+
+    // Writer (capture thread). The dumper reads slot_head and data_reserve
+    uint64_t data_head;         // End of the last frame
+    uint64_t data_reserve;      // End of the frame being written
+    uint64_t slot_head;         // Frames appended so far
+
+    // Trigger state (capture thread)
+    uint64_t last_trigger_ns;
+    int requests_seen;
+    uint64_t rate_second;
+    uint64_t rate_count;
+    uint64_t rate_avg_milli;    // Average packets per second x 1000 (EWMA, 1/8)
+    uint32_t rate_history;
+    int rate_fired;
+
+    // Dump request, handed to the dumper thread
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    int stopping;
+    int pending;
+    TmTrigger pending_reason;
+    uint64_t pending_ts_ns;
+    uint8_t* copy;              // Dumper's frame buffer
+
+    // Capture thread counters, reset on publish
+    uint64_t packets;
+    uint64_t bytes;
+    uint64_t triggers[TM_TRIGGER_COUNT];
+    uint64_t merged;
+
+    // Dumper counters (read with relaxed atomics)
+    uint64_t dumps;
+    uint64_t dumped_packets;
+    uint64_t missed;
+    uint64_t failures;
+};
+
+// --- Configuration ---
+
+void time_machine_config_defaults(TimeMachineConfig* config) {
+    memset(config, 0, sizeof(*config));
+    snprintf(config->directory, sizeof(config->directory), ".");
+    config->buffer_bytes = 64u * 1024 * 1024;
+    config->pre_seconds = 10;
+    config->post_seconds = 2;
+    config->holdoff_seconds = 60;
+    config->rate_factor = 0;
+    config->rate_min_pps = 1000;
+}
+
+// --- pcapng ---
+
+static int write_block(FILE* fp, uint32_t type, const void* fixed, uint32_t fixed_len,
+                       const void* data, uint32_t data_len, const void* options, uint32_t options_len) {
+    static const uint8_t zero[4] = { 0 };
+    uint32_t pad = (4 - (data_len & 3)) & 3;
+    uint32_t total = 12 + fixed_len + data_len + pad + options_len;
+
+    int ok = fwrite(&type, 4, 1, fp) == 1 && fwrite(&total, 4, 1, fp) == 1;
+    if (fixed_len) ok = ok && fwrite(fixed, 1, fixed_len, fp) == fixed_len;
+    if (data_len) ok = ok && fwrite(data, 1, data_len, fp) == data_len;
+    if (pad) ok = ok && fwrite(zero, 1, pad, fp) == pad;
+    if (options_len) ok = ok && fwrite(options, 1, options_len, fp) == options_len;
+    return ok && fwrite(&total, 4, 1, fp) == 1 ? 0 : -1;
+}
+
+// Appends one option (code, length, value padded to 4 bytes)
+static uint32_t put_option(uint8_t* buf, uint16_t code, const void* value, uint16_t len) {
+    memcpy(buf, &code, 2);
+    memcpy(buf + 2, &len, 2);
+    if (len) memcpy(buf + 4, value, len);
+    uint32_t padded = (uint32_t)((len + 3u) & ~3u);
+    memset(buf + 4 + len, 0, padded - len);
+    return 4 + padded;
+}
+
+static int write_headers(FILE* fp, const TimeMachine* tm, TmTrigger reason, uint64_t trigger_ns) {
+    uint8_t options[256];
+    char comment[160];
+    snprintf(comment, sizeof(comment), "Time machine dump of if %d: %s trigger at %llu.%09llu",
+             tm->if_id, trigger_names[reason], (unsigned long long)(trigger_ns / 1000000000ULL),
+             (unsigned long long)(trigger_ns % 1000000000ULL));
+
+    struct __attribute__((packed)) {
+        uint32_t byte_order;
+        uint16_t major;
+        uint16_t minor;
+        int64_t section_length;
+    } shb = { PCAPNG_BYTE_ORDER, 1, 0, -1 };
+    uint32_t len = put_option(options, 1, comment, (uint16_t)strlen(comment));   // opt_comment
+    len += put_option(options + len, 0, NULL, 0);                               // opt_endofopt
+    if (write_block(fp, PCAPNG_SHB, &shb, sizeof(shb), NULL, 0, options, len) != 0) return -1;
+
+    struct __attribute__((packed)) {
+        uint16_t linktype;
+        uint16_t reserved;
+        uint32_t snaplen;
+    } idb = { (uint16_t)tm->linktype, 0, 0 };
+    uint8_t resolution = 9;                                                     // Nanoseconds
+    len = put_option(options, 9, &resolution, 1);                               // if_tsresol
+    len += put_option(options + len, 0, NULL, 0);
+    return write_block(fp, PCAPNG_IDB, &idb, sizeof(idb), NULL, 0, options, len);
+}
+
+// --- Reading the live buffer (dumper thread) ---
+
+// Copies slot @p seq; returns 0 if the writer had not reused it
+static int read_slot(TimeMachine* tm, uint64_t seq, TmSlot* out) {
+    *out = tm->slots[seq & tm->slot_mask];
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint64_t head = __atomic_load_n(&tm->slot_head, __ATOMIC_RELAXED);
+    return head - seq <= tm->slot_mask ? 0 : -1;
+}
+
+// Copies the frame of @p slot; returns 0 if the writer had not overwritten it
+static int read_frame(TimeMachine* tm, const TmSlot* slot) {
+    uint64_t size = tm->data_mask + 1;
+    uint64_t offset = slot->pos & tm->data_mask;
+    if (slot->caplen > TM_MAX_FRAME || offset + slot->caplen > size) return -1;
+
+    memcpy(tm->copy, tm->data + offset, slot->caplen);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint64_t reserve = __atomic_load_n(&tm->data_reserve, __ATOMIC_RELAXED);
+    return reserve - slot->pos <= size ? 0 : -1;
+}
+
+// First buffered frame at or after @p ts_ns (frames are in timestamp order)
+static uint64_t find_start(TimeMachine* tm, uint64_t ts_ns, int* clamped) {
+    uint64_t head = __atomic_load_n(&tm->slot_head, __ATOMIC_ACQUIRE);
+    uint64_t lo = head > tm->slot_mask ? head - tm->slot_mask : 0;
+    uint64_t hi = head;
+    TmSlot slot;
+
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (read_slot(tm, mid, &slot) != 0 || slot.ts_ns < ts_ns) lo = mid + 1;
+        else hi = mid;
+    }
+    *clamped = (lo == (head > tm->slot_mask ? head - tm->slot_mask : 0)) && lo > 0;
+    return lo;
+}
+
+static void dump_window(TimeMachine* tm, TmTrigger reason, uint64_t trigger_ns) {
+    uint64_t pre_ns = (uint64_t)tm->config.pre_seconds * 1000000000ULL;
+    uint64_t start_ns = trigger_ns > pre_ns ? trigger_ns - pre_ns : 0;
+    uint64_t end_ns = trigger_ns + (uint64_t)tm->config.post_seconds * 1000000000ULL;
+
+    char path[320], tmp[328];
+    snprintf(path, sizeof(path), "%s/tm-if%d-%llu-%s.pcapng", tm->config.directory, tm->if_id,
+             (unsigned long long)(trigger_ns / 1000000000ULL), trigger_names[reason]);
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    FILE* fp = fopen(tmp, "wb");
+    if (!fp) {
+        __atomic_fetch_add(&tm->failures, 1, __ATOMIC_RELAXED);
+        log_message("[WARN] Time machine: cannot create %s\n", tmp);
+        return;
+    }
+    setvbuf(fp, NULL, _IOFBF, 1 << 20);
+    int ok = write_headers(fp, tm, reason, trigger_ns) == 0;
+
+    uint64_t written = 0, missed = 0;
+    uint64_t first_ns = 0;
+    int clamped = 0;
+    uint64_t seq = find_start(tm, start_ns, &clamped);
+    TmSlot slot;
+
+    while (ok) {
+        uint64_t head = __atomic_load_n(&tm->slot_head, __ATOMIC_ACQUIRE);
+        if (seq >= head) break;
+
+        // Lapped: the writer reused the slots we had not read yet
+        if (read_slot(tm, seq, &slot) != 0) {
+            uint64_t oldest = head - tm->slot_mask;
+            missed += oldest - seq;
+            seq = oldest;
+            continue;
+        }
+        if (slot.ts_ns > end_ns) break;
+        seq++;
+        if (slot.ts_ns < start_ns) continue;
+
+        if (read_frame(tm, &slot) != 0) {
+            missed++;
+            continue;
+        }
+        struct __attribute__((packed)) {
+            uint32_t interface_id;
+            uint32_t ts_high;
+            uint32_t ts_low;
+            uint32_t caplen;
+            uint32_t wire_len;
+        } epb = { 0, (uint32_t)(slot.ts_ns >> 32), (uint32_t)slot.ts_ns, slot.caplen, slot.wire_len };
+        ok = write_block(fp, PCAPNG_EPB, &epb, sizeof(epb), tm->copy, slot.caplen, NULL, 0) == 0;
+        if (written++ == 0) first_ns = slot.ts_ns;
+    }
+
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok || rename(tmp, path) != 0) {
+        remove(tmp);
+        __atomic_fetch_add(&tm->failures, 1, __ATOMIC_RELAXED);
+        log_message("[WARN] Time machine: writing %s failed\n", path);
+        return;
+    }
+
+    __atomic_fetch_add(&tm->dumps, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&tm->dumped_packets, written, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&tm->missed, missed, __ATOMIC_RELAXED);
+    log_message("[DISK] Time machine (ID %d): %llu packets to %s\n", tm->if_id, (unsigned long long)written, path);
+
+    // The window reached further back than the buffer: say how much of it was kept
+    if (clamped || missed) {
+        double kept = (written && first_ns < trigger_ns) ? (double)(trigger_ns - first_ns) / 1e9 : 0.0;
+        log_message("[WARN] Time machine (ID %d): buffer held %.2fs of the %us before the trigger "
+                    "(%llu frames overwritten during the dump); raise --tm-mb\n", tm->if_id, kept,
+                    tm->config.pre_seconds, (unsigned long long)missed);
+    }
+}
+
+static void* dumper_main(void* arg) {
+    TimeMachine* tm = (TimeMachine*)arg;
+
+    pthread_mutex_lock(&tm->lock);
+    while (1) {
+        while (!tm->pending && !tm->stopping) pthread_cond_wait(&tm->cond, &tm->lock);
+        if (!tm->pending) break;
+
+        TmTrigger reason = tm->pending_reason;
+        uint64_t trigger_ns = tm->pending_ts_ns;
+        pthread_mutex_unlock(&tm->lock);
+
+        // Let the post-trigger window fill (cut short on shutdown)
+        uint64_t deadline = trigger_ns + (uint64_t)tm->config.post_seconds * 1000000000ULL;
+        while (!__atomic_load_n(&tm->stopping, __ATOMIC_ACQUIRE) && clock_realtime_ns() < deadline) {
+            struct timespec nap = { 0, TM_POLL_NS };
+            nanosleep(&nap, NULL);
+        }
+        dump_window(tm, reason, trigger_ns);
+
+        pthread_mutex_lock(&tm->lock);
+        tm->pending = 0;
+    }
+    pthread_mutex_unlock(&tm->lock);
+    return NULL;
+}
+
+// --- Triggers (capture thread) ---
+
+static void fire(TimeMachine* tm, TmTrigger reason, uint64_t ts_ns, int forced) {
+    tm->triggers[reason]++;
+
+    // Operator requests bypass the hold-off; automatic triggers would otherwise dump on every match
+    uint64_t holdoff_ns = (uint64_t)tm->config.holdoff_seconds * 1000000000ULL;
+    if (!forced && tm->last_trigger_ns && ts_ns < tm->last_trigger_ns + holdoff_ns) {
+        tm->merged++;
+        return;
+    }
+
+    pthread_mutex_lock(&tm->lock);
+    int busy = tm->pending;
+    if (!busy) {
+        tm->pending = 1;
+        tm->pending_reason = reason;
+        tm->pending_ts_ns = ts_ns;
+        pthread_cond_signal(&tm->cond);
+    }
+    pthread_mutex_unlock(&tm->lock);
+
+    if (busy) {
+        tm->merged++;
+        return;
+    }
+    tm->last_trigger_ns = ts_ns;
+    log_message("[INFO] Time machine (ID %d): %s trigger, dumping %us before / %us after\n", tm->if_id,
+                trigger_names[reason], tm->config.pre_seconds, tm->config.post_seconds);
+}
+
+// Packets per second against their running average; fires once per spiking second
+static void check_rate(TimeMachine* tm, uint64_t ts_ns) {
+    uint64_t second = ts_ns / 1000000000ULL;
+
+    if (second != tm->rate_second) {
+        if (tm->rate_second) {
+            // Spiking seconds stay out of the average; idle gaps pull it down
+            uint64_t gap = second - tm->rate_second;
+            if (!tm->rate_fired) {
+                uint64_t sample = tm->rate_count * 1000;
+                tm->rate_avg_milli = tm->rate_history ? tm->rate_avg_milli - tm->rate_avg_milli / 8 + sample / 8 : sample;
+                tm->rate_history++;
+            }
+            for (uint64_t i = 1; i < gap && i < 32; i++) {
+                tm->rate_avg_milli -= tm->rate_avg_milli / 8;
+                tm->rate_history++;
+            }
+        }
+        tm->rate_second = second;
+        tm->rate_count = 0;
+        tm->rate_fired = 0;
+    }
+
+    tm->rate_count++;
+    if (!tm->rate_fired && tm->rate_history >= TM_RATE_WARMUP && tm->rate_count >= tm->config.rate_min_pps &&
+        tm->rate_count * 1000 > tm->rate_avg_milli * tm->config.rate_factor) {
+        tm->rate_fired = 1;
+        fire(tm, TM_TRIGGER_RATE, ts_ns, 0);
+    }
+}
+
+// --- Public API ---
+
+TimeMachine* time_machine_create(const TimeMachineConfig* config, int if_id, uint32_t linktype) {
+    if (access(config->directory, W_OK | X_OK) != 0) {
+        log_message("[ERROR] Time machine: directory %s is not writable\n", config->directory);
+        return NULL;
+    }
+
+    TimeMachine* tm = (TimeMachine*)calloc(1, sizeof(TimeMachine));
+    if (!tm) return NULL;
+    tm->config = *config;
+    tm->if_id = if_id;
+    tm->linktype = linktype;
+    tm->requests_seen = __atomic_load_n(&g_dump_requests, __ATOMIC_RELAXED);
+
+    size_t data_size = 1024 * 1024;
+    while (data_size < config->buffer_bytes) data_size <<= 1;
+    size_t slot_count = 4096;
+    while (slot_count < data_size / TM_AVG_FRAME) slot_count <<= 1;
+
+    tm->copy = (uint8_t*)malloc(TM_MAX_FRAME);
+    if (!tm->copy || mem_region_alloc(&tm->region, data_size + slot_count * sizeof(TmSlot),
+                                      numa_default_node()) != 0) {
+        free(tm->copy);
+        free(tm);
+        return NULL;
+    }
+    tm->data = (uint8_t*)tm->region.base;
+    tm->data_mask = data_size - 1;
+    tm->slots = (TmSlot*)(tm->data + data_size);
+    tm->slot_mask = slot_count - 1;
+
+    pthread_mutex_init(&tm->lock, NULL);
+    pthread_cond_init(&tm->cond, NULL);
+    if (pthread_create(&tm->thread, NULL, dumper_main, tm) != 0) {
+        mem_region_free(&tm->region);
+        free(tm->copy);
+        free(tm);
+        return NULL;
+    }
+    return tm;
+}
+
+void time_machine_destroy(TimeMachine* tm) {
+    if (!tm) return;
+
+    pthread_mutex_lock(&tm->lock);
+    __atomic_store_n(&tm->stopping, 1, __ATOMIC_RELEASE);
+    pthread_cond_signal(&tm->cond);
+    pthread_mutex_unlock(&tm->lock);
+    pthread_join(tm->thread, NULL);
+
+    pthread_mutex_destroy(&tm->lock);
+    pthread_cond_destroy(&tm->cond);
+    mem_region_free(&tm->region);
+    free(tm->copy);
+    free(tm);
+}
+
+void time_machine_capture(TimeMachine* tm, const PacketMetadata* meta, const unsigned char* frame,
+                          uint32_t caplen) {
+    uint64_t ts_ns = meta->timestamp_ns ? meta->timestamp_ns : clock_realtime_ns();
+    if (caplen > TM_MAX_FRAME) caplen = TM_MAX_FRAME;
+
+    // Frames never wrap: skip the tail of the memory if this one does not fit
+    uint64_t size = tm->data_mask + 1;
+    uint64_t pos = tm->data_head;
+    uint64_t contiguous = size - (pos & tm->data_mask);
+    if (caplen > contiguous) pos += contiguous;
+    uint64_t end = pos + ((caplen + TM_ALIGN - 1) & ~(uint64_t)(TM_ALIGN - 1));
+
+    // Announce the overwrite before making it (seqlock order), so the dumper can tell
+    __atomic_store_n(&tm->data_reserve, end, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy(tm->data + (pos & tm->data_mask), frame, caplen);
+    TmSlot* slot = &tm->slots[tm->slot_head & tm->slot_mask];
+    slot->pos = pos;
+    slot->ts_ns = ts_ns;
+    slot->caplen = caplen;
+    slot->wire_len = (uint32_t)meta->packet_size;
+
+    tm->data_head = end;
+    __atomic_store_n(&tm->slot_head, tm->slot_head + 1, __ATOMIC_RELEASE);
+
+    tm->packets++;
+    tm->bytes += caplen;
+
+    // --- Triggers: evaluated after the append, so the dump contains the trigger frame ---
+    if (meta->is_eapol) {
+        fire(tm, TM_TRIGGER_EAPOL, ts_ns, 0);
+    }
+    if (tm->config.filter.active && packet_filter_match(&tm->config.filter, meta)) {
+        fire(tm, TM_TRIGGER_FILTER, ts_ns, 0);
+    }
+    if (tm->config.rate_factor) {
+        check_rate(tm, ts_ns);
+    }
+}
+
+void time_machine_set_filter(TimeMachine* tm, const PacketFilter* filter) {
+    tm->config.filter = *filter;
+}
+
+void time_machine_housekeeping(TimeMachine* tm) {
+    int requests = __atomic_load_n(&g_dump_requests, __ATOMIC_RELAXED);
+    if (requests != tm->requests_seen) {
+        tm->requests_seen = requests;
+        fire(tm, TM_TRIGGER_SIGNAL, clock_realtime_ns(), 1);
+    }
+}
+
+void time_machine_request_dump(void) {
+    __atomic_fetch_add(&g_dump_requests, 1, __ATOMIC_RELAXED);
+}
+
+void time_machine_publish(TimeMachine* tm) {
+    char json[512];
+    snprintf(json, sizeof(json),
+        "{\"event\": \"time_machine\","
+        "\"if_id\": %d,"
+        "\"packets\": %llu,"
+        "\"bytes\": %llu,"
+        "\"eapol_triggers\": %llu,"
+        "\"filter_triggers\": %llu,"
+        "\"rate_triggers\": %llu,"
+        "\"signal_triggers\": %llu,"
+        "\"merged\": %llu,"
+        "\"dumps\": %llu,"
+        "\"dumped_packets\": %llu,"
+        "\"missed\": %llu,"
+        "\"failures\": %llu}",
+        tm->if_id,
+        (unsigned long long)tm->packets, (unsigned long long)tm->bytes,
+        (unsigned long long)tm->triggers[TM_TRIGGER_EAPOL], (unsigned long long)tm->triggers[TM_TRIGGER_FILTER],
+        (unsigned long long)tm->triggers[TM_TRIGGER_RATE], (unsigned long long)tm->triggers[TM_TRIGGER_SIGNAL],
+        (unsigned long long)tm->merged,
+        (unsigned long long)__atomic_load_n(&tm->dumps, __ATOMIC_RELAXED),
+        (unsigned long long)__atomic_load_n(&tm->dumped_packets, __ATOMIC_RELAXED),
+        (unsigned long long)__atomic_load_n(&tm->missed, __ATOMIC_RELAXED),
+        (unsigned long long)__atomic_load_n(&tm->failures, __ATOMIC_RELAXED));
+    log_event(json);
+
+    tm->packets = tm->bytes = tm->merged = 0;
+    memset(tm->triggers, 0, sizeof(tm->triggers));
+}
@@ -0,0 +1,97 @@
+/**
+ * @file timeMachine.h
+ * @brief Rolling in-memory packet buffer, dumped to pcapng when a trigger fires.
+ *
+ * Each source keeps its most recent frames in a circular buffer on hugepages.
+ * The capture thread appends without locks, overwriting the oldest frames.
+ * When a trigger fires (EAPOL frame, filter match, packet rate spike or
+ * SIGUSR2), a dumper thread waits for the post-trigger window to pass, then
+ * copies the frames around the trigger out of the live buffer into a pcapng
+ * file. Capture never pauses. Frames the writer overwrites while they are being
+ * copied are detected and counted as lost.
+ */
+
+#ifndef TIME_MACHINE_H
+#define TIME_MACHINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Types.h"
+#include "packetFilter.h"
+
+/**
+ * @brief What fired a dump.
+ */
+typedef enum {
+    TM_TRIGGER_EAPOL,       // 802.1X / WPA handshake frame
+    TM_TRIGGER_FILTER,      // Frame matched the trigger filter
+    TM_TRIGGER_RATE,        // Packet rate above the spike threshold
+    TM_TRIGGER_SIGNAL,      // SIGUSR2 (operator request)
+    TM_TRIGGER_COUNT
+} TmTrigger;
+
+/**
+ * @brief Buffer and trigger settings (shared by all sources).
+ */
+typedef struct {
+    char directory[256];        // Where dumps are written
+    size_t buffer_bytes;        // Frame memory per source
+    uint32_t pre_seconds;       // Dumped before the trigger
+    uint32_t post_seconds;      // Dumped after the trigger
+    uint32_t holdoff_seconds;   // Later triggers are merged into the previous dump
+    PacketFilter filter;        // Frames that fire TM_TRIGGER_FILTER
+    uint32_t rate_factor;       // Spike: a second with rate_factor x the average rate (0 = off)
+    uint32_t rate_min_pps;      // ... and at least this many packets
+} TimeMachineConfig;
+
+typedef struct TimeMachine TimeMachine;
+
+/**
+ * @brief Fills @p config with the defaults (64 MB, 10 s before / 2 s after, 60 s hold-off).
+ */
+void time_machine_config_defaults(TimeMachineConfig* config);
+
+/**
+ * @brief Allocates the buffer of one source and starts its dumper thread.
+ *
+ * @param linktype PCAP_LINKTYPE_* of the source's frames.
+ * @return TimeMachine* or NULL on failure.
+ */
+TimeMachine* time_machine_create(const TimeMachineConfig* config, int if_id, uint32_t linktype);
+
+/**
+ * @brief Writes a pending dump with what is buffered, then stops the thread and frees the buffer.
+ */
+void time_machine_destroy(TimeMachine* tm);
+
+/**
+ * @brief Appends a parsed frame and evaluates the per-packet triggers (capture thread).
+ *
+ * @param meta Metadata of the frame (wire length, timestamp, EAPOL flag, 5-tuple).
+ * @param frame Captured bytes.
+ * @param caplen Bytes captured.
+ */
+void time_machine_capture(TimeMachine* tm, const PacketMetadata* meta, const unsigned char* frame,
+                          uint32_t caplen);
+
+/**
+ * @brief Replaces the trigger filter (capture thread, e.g. after a runtime reload).
+ */
+void time_machine_set_filter(TimeMachine* tm, const PacketFilter* filter);
+
+/**
+ * @brief Picks up dump requests made with time_machine_request_dump() (capture thread).
+ */
+void time_machine_housekeeping(TimeMachine* tm);
+
+/**
+ * @brief Asks every source for a dump (async-signal-safe, for the SIGUSR2 handler).
+ */
+void time_machine_request_dump(void);
+
+/**
+ * @brief Emits {"event": "time_machine"}: packets and triggers since the last call, dump totals.
+ */
+void time_machine_publish(TimeMachine* tm);
+
+#endif // TIME_MACHINE_H
@@ -0,0 +1,400 @@
+/**
+ * @file xdpSniffer.c
+ * @brief Implementation of the AF_XDP capture backend.
+ */
+
+#define _GNU_SOURCE
+#include "xdpSniffer.h"
+#include "mmapSniffer.h"
+#include "packetParser.h"
+#include "logger.h"
+#include "rawSocket.h"
+#include "mem_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <net/if.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+
+#ifndef AF_XDP
+#define AF_XDP 44
+#endif
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+#define XDP_NUM_FRAMES  4096    // UMEM chunks (all of them circulate through the fill ring)
+#define XDP_FRAME_SIZE  2048    // Chunk size: one frame per chunk
+#define XDP_RX_SIZE     2048    // RX ring entries
+#define XDP_CQ_SIZE     64      // Completion ring (required by bind, unused without TX)
+
+/**
+ * @brief User-space view of one of the socket's single-producer/single-consumer rings.
+ */
+typedef struct {
+    uint32_t* producer;
+    uint32_t* consumer;
+    void* descs;
+    uint32_t mask;
+    void* map;
+    size_t map_len;
+} XdpRing;
+
+/**
+ * @brief Per-source AF_XDP state (CaptureSource::backend_data).
+ */
+typedef struct {
+    int ifindex;
+    MemRegion umem_region; // Hugepage-backed, on the NIC's node
+    unsigned char* umem;
+    size_t umem_len;
+    XdpRing fill;
+    XdpRing comp;
+    XdpRing rx;
+    int map_fd;
+    int prog_fd;
+    int link_fd;
+    int promisc;            // Promiscuous mode was enabled by us
+    uint64_t drops_reported; // XDP_STATISTICS drops already returned by xdp_drops()
+} XdpSocket;
+
+static XdpConfig xdp_config = { .queue_id = 0, .native_mode = 0 };
+
+void set_xdp_config(const XdpConfig* config) {
+    xdp_config = *config;
+}
+
+// --- BPF Helpers ---
+
+static int sys_bpf(int cmd, union bpf_attr* attr) {
+    return (int)syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+static int create_xsk_map(uint32_t entries) {
+    union bpf_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.map_type = BPF_MAP_TYPE_XSKMAP;
+    attr.key_size = sizeof(uint32_t);
+    attr.value_size = sizeof(uint32_t);
+    attr.max_entries = entries;
+    return sys_bpf(BPF_MAP_CREATE, &attr);
+}
+
+static int update_xsk_map(int map_fd, uint32_t key, int xsk_fd) {
+    uint32_t value = (uint32_t)xsk_fd;
+    union bpf_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.map_fd = map_fd;
+    attr.key = (uint64_t)(uintptr_t)&key;
+    attr.value = (uint64_t)(uintptr_t)&value;
+    attr.flags = BPF_ANY;
+    return sys_bpf(BPF_MAP_UPDATE_ELEM, &attr);
+}
+
+/**
+ * @brief Loads: return bpf_redirect_map(&xsks, ctx->rx_queue_index, XDP_PASS);
+ * Queues without a socket in the map fall back to XDP_PASS.
+ */
+static int load_redirect_program(int map_fd) {
+    struct bpf_insn prog[] = {
+        // r2 = ctx->rx_queue_index
+        { .code = BPF_LDX | BPF_MEM | BPF_W, .dst_reg = BPF_REG_2, .src_reg = BPF_REG_1,
+          .off = offsetof(struct xdp_md, rx_queue_index) },
+        // r1 = map (64-bit immediate, two instructions)
+        { .code = BPF_LD | BPF_DW | BPF_IMM, .dst_reg = BPF_REG_1, .src_reg = BPF_PSEUDO_MAP_FD,
+          .imm = map_fd },
+        { .code = 0 },
+        // r3 = XDP_PASS (fallback action)
+        { .code = BPF_ALU64 | BPF_MOV | BPF_K, .dst_reg = BPF_REG_3, .imm = XDP_PASS },
+        { .code = BPF_JMP | BPF_CALL, .imm = BPF_FUNC_redirect_map },
+        { .code = BPF_JMP | BPF_EXIT },
+    };
+
+    char verifier_log[1024] = "";
+    union bpf_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.prog_type = BPF_PROG_TYPE_XDP;
+    attr.insns = (uint64_t)(uintptr_t)prog;
+    attr.insn_cnt = sizeof(prog) / sizeof(prog[0]);
+    attr.license = (uint64_t)(uintptr_t)"GPL";
+    attr.log_buf = (uint64_t)(uintptr_t)verifier_log;
+    attr.log_size = sizeof(verifier_log);
+    attr.log_level = 1;
+
+    int fd = sys_bpf(BPF_PROG_LOAD, &attr);
+    if (fd < 0) {
+        log_message("[ERROR] XDP program rejected: %s\n%s\n", strerror(errno), verifier_log);
+    }
+    return fd;
+}
+
+// Attaches through a BPF link, which the kernel detaches when the link fd is closed (Linux 5.9+)
+static int attach_program(int prog_fd, int ifindex, int native_mode) {
+    union bpf_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.link_create.prog_fd = (uint32_t)prog_fd;
+    attr.link_create.target_ifindex = (uint32_t)ifindex;
+    attr.link_create.attach_type = BPF_XDP;
+    attr.link_create.flags = native_mode ? XDP_FLAGS_DRV_MODE : XDP_FLAGS_SKB_MODE;
+    return sys_bpf(BPF_LINK_CREATE, &attr);
+}
+
+// --- Rings ---
+
+static int map_ring(int fd, XdpRing* ring, const struct xdp_ring_offset* off,
+                    uint32_t entries, size_t desc_size, off_t pgoff) {
+    ring->map_len = off->desc + entries * desc_size;
+    ring->map = mmap(NULL, ring->map_len, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, pgoff);
+    if (ring->map == MAP_FAILED) {
+        ring->map = NULL;
+        return -1;
+    }
+
+    unsigned char* base = (unsigned char*)ring->map;
+    ring->producer = (uint32_t*)(base + off->producer);
+    ring->consumer = (uint32_t*)(base + off->consumer);
+    ring->descs = base + off->desc;
+    ring->mask = entries - 1;
+    return 0;
+}
+
+static void unmap_ring(XdpRing* ring) {
+    if (ring->map) {
+        munmap(ring->map, ring->map_len);
+        ring->map = NULL;
+    }
+}
+
+static int setup_umem_and_rings(int fd, XdpSocket* xsk, int node) {
+    // 1. Register the packet buffer area (UMEM)
+    if (mem_region_alloc(&xsk->umem_region, (size_t)XDP_NUM_FRAMES * XDP_FRAME_SIZE, node) != 0) {
+        perror("[ERROR] UMEM allocation failed");
+        return -1;
+    }
+    xsk->umem = (unsigned char*)xsk->umem_region.base;
+    xsk->umem_len = (size_t)XDP_NUM_FRAMES * XDP_FRAME_SIZE;
+
+    struct xdp_umem_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.addr = (uint64_t)(uintptr_t)xsk->umem;
+    reg.len = xsk->umem_len;
+    reg.chunk_size = XDP_FRAME_SIZE;
+    if (setsockopt(fd, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) < 0) {
+        perror("[ERROR] setsockopt XDP_UMEM_REG failed");
+        return -1;
+    }
+
+    // 2. Size the rings
+    int fill_size = XDP_NUM_FRAMES, comp_size = XDP_CQ_SIZE, rx_size = XDP_RX_SIZE;
+    if (setsockopt(fd, SOL_XDP, XDP_UMEM_FILL_RING, &fill_size, sizeof(fill_size)) < 0 ||
+        setsockopt(fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &comp_size, sizeof(comp_size)) < 0 ||
+        setsockopt(fd, SOL_XDP, XDP_RX_RING, &rx_size, sizeof(rx_size)) < 0) {
+        perror("[ERROR] setsockopt XDP ring size failed");
+        return -1;
+    }
+
+    // 3. Map them
+    struct xdp_mmap_offsets off;
+    socklen_t optlen = sizeof(off);
+    if (getsockopt(fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen) < 0) {
+        perror("[ERROR] getsockopt XDP_MMAP_OFFSETS failed");
+        return -1;
+    }
+
+    if (map_ring(fd, &xsk->fill, &off.fr, fill_size, sizeof(uint64_t), XDP_UMEM_PGOFF_FILL_RING) != 0 ||
+        map_ring(fd, &xsk->comp, &off.cr, comp_size, sizeof(uint64_t), XDP_UMEM_PGOFF_COMPLETION_RING) != 0 ||
+        map_ring(fd, &xsk->rx, &off.rx, rx_size, sizeof(struct xdp_desc), XDP_PGOFF_RX_RING) != 0) {
+        perror("[ERROR] mmap of XDP rings failed");
+        return -1;
+    }
+
+    // 4. Hand every chunk to the kernel
+    uint64_t* fill = (uint64_t*)xsk->fill.descs;
+    for (uint32_t i = 0; i < XDP_NUM_FRAMES; i++) {
+        fill[i] = (uint64_t)i * XDP_FRAME_SIZE;
+    }
+    __atomic_store_n(xsk->fill.producer, XDP_NUM_FRAMES, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// --- Backend Operations ---
+
+static void xdp_close(CaptureSource* src) {
+    XdpSocket* xsk = (XdpSocket*)src->backend_data;
+    if (!xsk) return;
+
+    // Detach first so the interface stops redirecting into a closing socket
+    if (xsk->link_fd >= 0) close(xsk->link_fd);
+    if (xsk->prog_fd >= 0) close(xsk->prog_fd);
+    if (xsk->map_fd >= 0) close(xsk->map_fd);
+
+    if (src->sock_fd >= 0) {
+        struct xdp_statistics stats;
+        socklen_t optlen = sizeof(stats);
+        if (getsockopt(src->sock_fd, SOL_XDP, XDP_STATISTICS, &stats, &optlen) == 0) {
+            log_message("[INFO] [%s] AF_XDP drops: ring full %llu, fill empty %llu, other %llu\n",
+                        src->name, (unsigned long long)stats.rx_ring_full,
+                        (unsigned long long)stats.rx_fill_ring_empty_descs,
+                        (unsigned long long)stats.rx_dropped);
+        }
+    }
+
+    unmap_ring(&xsk->rx);
+    unmap_ring(&xsk->comp);
+    unmap_ring(&xsk->fill);
+
+    if (src->sock_fd >= 0) {
+        close(src->sock_fd);
+        src->sock_fd = -1;
+    }
+    if (xsk->promisc) set_promiscuous_mode(src->name, 0);
+    mem_region_free(&xsk->umem_region);
+
+    free(xsk);
+    src->backend_data = NULL;
+}
+
+static int xdp_open(CaptureSource* src) {
+    XdpSocket* xsk = (XdpSocket*)calloc(1, sizeof(XdpSocket));
+    if (!xsk) return -1;
+    xsk->map_fd = xsk->prog_fd = xsk->link_fd = -1;
+    src->backend_data = xsk;
+
+    xsk->ifindex = (int)if_nametoindex(src->name);
+    if (xsk->ifindex == 0) {
+        perror("[ERROR] Interface not found");
+        goto fail;
+    }
+
+    src->sock_fd = socket(AF_XDP, SOCK_RAW, 0);
+    if (src->sock_fd < 0) {
+        perror("[ERROR] AF_XDP socket creation failed");
+        goto fail;
+    }
+
+    if (setup_umem_and_rings(src->sock_fd, xsk, src->numa_node) != 0) {
+        goto fail;
+    }
+
+    // Generic XDP can only copy into the UMEM; native mode lets the kernel pick zero-copy
+    struct sockaddr_xdp sxdp;
+    memset(&sxdp, 0, sizeof(sxdp));
+    sxdp.sxdp_family = AF_XDP;
+    sxdp.sxdp_ifindex = (uint32_t)xsk->ifindex;
+    sxdp.sxdp_queue_id = xdp_config.queue_id;
+    sxdp.sxdp_flags = xdp_config.native_mode ? 0 : XDP_COPY;
+    if (bind(src->sock_fd, (struct sockaddr*)&sxdp, sizeof(sxdp)) < 0) {
+        perror("[ERROR] AF_XDP bind failed");
+        goto fail;
+    }
+
+    xsk->map_fd = create_xsk_map(xdp_config.queue_id + 1);
+    if (xsk->map_fd < 0) {
+        perror("[ERROR] XSKMAP creation failed");
+        goto fail;
+    }
+    if (update_xsk_map(xsk->map_fd, xdp_config.queue_id, src->sock_fd) < 0) {
+        perror("[ERROR] XSKMAP update failed");
+        goto fail;
+    }
+
+    xsk->prog_fd = load_redirect_program(xsk->map_fd);
+    if (xsk->prog_fd < 0) {
+        goto fail;
+    }
+
+    xsk->link_fd = attach_program(xsk->prog_fd, xsk->ifindex, xdp_config.native_mode);
+    if (xsk->link_fd < 0) {
+        perror("[ERROR] XDP attach failed");
+        goto fail;
+    }
+
+    if (set_promiscuous_mode(src->name, 1) != 0) {
+        goto fail;
+    }
+    xsk->promisc = 1;
+
+    char placement[128];
+    log_message("[INFO] [%s] AF_XDP socket on queue %u (%s mode). UMEM: %d frames, %s\n",
+                src->name, xdp_config.queue_id, xdp_config.native_mode ? "native" : "generic",
+                XDP_NUM_FRAMES, mem_region_describe(&xsk->umem_region, placement, sizeof(placement)));
+    log_message("[WARN] [%s] AF_XDP consumes captured packets: they no longer reach the host stack\n",
+                src->name);
+    return 0;
+
+fail:
+    xdp_close(src);
+    return -1;
+}
+
+static int xdp_rx_burst(CaptureSource* src, int budget, uint64_t* first_ts_ns) {
+    XdpSocket* xsk = (XdpSocket*)src->backend_data;
+    XdpRing* rx = &xsk->rx;
+    XdpRing* fill = &xsk->fill;
+
+    uint32_t cons = *rx->consumer;
+    uint32_t avail = __atomic_load_n(rx->producer, __ATOMIC_ACQUIRE) - cons;
+    if (avail == 0) return 0;
+    if (avail > (uint32_t)budget) avail = (uint32_t)budget;
+
+    // No per-packet kernel timestamp in the RX descriptor: stamp the batch on arrival
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t now_ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    *first_ts_ns = 0;
+
+    // Every chunk is owned by exactly one ring, so the fill ring always has room
+    uint32_t fill_prod = *fill->producer;
+    const struct xdp_desc* descs = (const struct xdp_desc*)rx->descs;
+    uint64_t* fill_addrs = (uint64_t*)fill->descs;
+
+    for (uint32_t i = 0; i < avail; i++) {
+        const struct xdp_desc* desc = &descs[(cons + i) & rx->mask];
+        process_packet(&src->parser, xsk->umem + desc->addr, (int)desc->len, (int)desc->len, now_ns, 0);
+
+        // Recycle the chunk (the descriptor address includes the headroom offset)
+        fill_addrs[(fill_prod + i) & fill->mask] = desc->addr & ~(uint64_t)(XDP_FRAME_SIZE - 1);
+    }
+
+    __atomic_store_n(rx->consumer, cons + avail, __ATOMIC_RELEASE);
+    __atomic_store_n(fill->producer, fill_prod + avail, __ATOMIC_RELEASE);
+    return (int)avail;
+}
+
+static int xdp_occupancy(CaptureSource* src) {
+    const XdpRing* rx = &((XdpSocket*)src->backend_data)->rx;
+    uint32_t waiting = __atomic_load_n(rx->producer, __ATOMIC_ACQUIRE) - *rx->consumer;
+    return (int)((uint64_t)waiting * 100 / (rx->mask + 1));
+}
+
+// XDP_STATISTICS counts from socket creation: report the increase
+static uint64_t xdp_drops(CaptureSource* src) {
+    XdpSocket* xsk = (XdpSocket*)src->backend_data;
+    struct xdp_statistics stats;
+    socklen_t optlen = sizeof(stats);
+    if (getsockopt(src->sock_fd, SOL_XDP, XDP_STATISTICS, &stats, &optlen) != 0) return 0;
+
+    uint64_t total = stats.rx_ring_full + stats.rx_fill_ring_empty_descs + stats.rx_dropped;
+    uint64_t delta = total - xsk->drops_reported;
+    xsk->drops_reported = total;
+    return delta;
+}
+
+const CaptureBackend xdp_capture_backend = {
+    .name = "xdp",
+    .open = xdp_open,
+    .rx_burst = xdp_rx_burst,
+    .occupancy = xdp_occupancy,
+    .drops = xdp_drops,
+    .close = xdp_close,
+};
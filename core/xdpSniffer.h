@@ -0,0 +1,31 @@
+/**
+ * @file xdpSniffer.h
+ * @brief AF_XDP capture backend.
+ *
+ * Packets are redirected by a minimal XDP program into an AF_XDP socket whose
+ * UMEM is shared with user space, bypassing the sk_buff path of AF_PACKET.
+ * The program and maps are built with raw bpf() calls, so no libbpf is needed.
+ *
+ * Note: a redirected packet is consumed by the sniffer and no longer reaches the
+ * host network stack. Use this backend on a mirror/SPAN port or a test veth.
+ */
+
+#ifndef XDP_SNIFFER_H
+#define XDP_SNIFFER_H
+
+#include <stdint.h>
+
+/**
+ * @brief AF_XDP backend settings, shared by all XDP sources.
+ */
+typedef struct {
+    uint32_t queue_id;      // NIC RX queue bound to the socket
+    int native_mode;        // 1 = driver (native) XDP, 0 = generic (SKB) XDP
+} XdpConfig;
+
+/**
+ * @brief Sets the configuration used by sources opened afterwards.
+ */
+void set_xdp_config(const XdpConfig* config);
+
+#endif // XDP_SNIFFER_H
@@ -0,0 +1,154 @@
+/**
+ * @file dnsLayer.c
+ * @brief Implementation of DNS message decoding.
+ */
+
+#include <string.h>
+#include "dnsLayer.h"
+
+#define DNS_HEADER_LEN 12
+#define DNS_TYPE_A     1
+#define DNS_TYPE_CNAME 5
+#define DNS_TYPE_AAAA  28
+
+static uint16_t read16(const unsigned char* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t read32(const unsigned char* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/**
+ * @brief Reads a possibly compressed name.
+ *
+ * Every compression pointer must jump before the lowest offset visited so far,
+ * which bounds the walk without a separate loop counter.
+ *
+ * @param out Presentation form (lowercase, unusual bytes replaced by '?'), or NULL to skip the name.
+ * @return Offset just past the name in the record, or -1 if malformed.
+ */
+static int read_name(const unsigned char* msg, int len, int offset, char* out) {
+    int pos = offset;
+    int lowest = offset;
+    int next = -1;          // Where the record continues (set at the first pointer)
+    int n = 0;
+
+    while (1) {
+        if (pos >= len) return -1;
+        uint8_t label = msg[pos];
+
+        if (label == 0) {
+            if (next < 0) next = pos + 1;
+            break;
+        }
+
+        if ((label & 0xC0) == 0xC0) {
+            if (pos + 1 >= len) return -1;
+            int target = ((label & 0x3F) << 8) | msg[pos + 1];
+            if (target >= lowest) return -1;
+            if (next < 0) next = pos + 2;
+            lowest = pos = target;
+            continue;
+        }
+        if (label & 0xC0) return -1;                    // Obsolete extended label types
+        if (pos + 1 + label > len) return -1;
+        if (n + label + 1 > DNS_MAX_NAME) return -1;    // RFC 1035 name length limit
+
+        if (out) {
+            if (n > 0) out[n++] = '.';
+            for (int i = 0; i < label; i++) {
+                unsigned char c = msg[pos + 1 + i];
+                if (c >= 'A' && c <= 'Z') c = (unsigned char)(c + ('a' - 'A'));
+                else if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '*')) c = '?';
+                out[n++] = (char)c;
+            }
+        } else {
+            n += label + 1;
+        }
+        pos += 1 + label;
+    }
+
+    if (out) {
+        if (n == 0) out[n++] = '.';
+        out[n] = '\0';
+    }
+    return next;
+}
+
+int parse_dns(const unsigned char* payload, int len, DnsMessage* msg) {
+    memset(msg, 0, sizeof(*msg));
+    if (len < DNS_HEADER_LEN) return -1;
+
+    // --- Header ---
+    msg->id = read16(payload);
+    msg->is_response = (payload[2] & 0x80) != 0;
+    msg->opcode = (payload[2] >> 3) & 0x0F;
+    msg->truncated = (payload[2] & 0x02) != 0;
+    msg->rcode = payload[3] & 0x0F;
+    msg->qdcount = read16(payload + 4);
+    msg->ancount = read16(payload + 6);
+
+    int offset = DNS_HEADER_LEN;
+
+    // --- Question (only the first one; more than one is not used in practice) ---
+    if (msg->qdcount > 0) {
+        offset = read_name(payload, len, offset, msg->qname);
+        if (offset < 0 || offset + 4 > len) return -1;
+        msg->qtype = read16(payload + offset);
+        msg->qclass = read16(payload + offset + 2);
+        offset += 4;
+
+        for (int i = 1; i < msg->qdcount; i++) {
+            offset = read_name(payload, len, offset, NULL);
+            if (offset < 0 || offset + 4 > len) return 0; // Header and first question are still valid
+            offset += 4;
+        }
+    }
+
+    // --- Answers (stop quietly at the first truncated record) ---
+    for (int i = 0; i < msg->ancount; i++) {
+        offset = read_name(payload, len, offset, NULL);
+        if (offset < 0 || offset + 10 > len) break;
+
+        uint16_t type = read16(payload + offset);
+        uint32_t ttl = read32(payload + offset + 4);
+        uint16_t rdlength = read16(payload + offset + 8);
+        offset += 10;
+        if (offset + rdlength > len) break;
+        offset += rdlength;
+
+        if (type == DNS_TYPE_A || type == DNS_TYPE_AAAA) msg->answers_addr++;
+        else if (type == DNS_TYPE_CNAME) msg->answers_cname++;
+        if (msg->answers == 0 || ttl < msg->min_ttl) msg->min_ttl = ttl;
+        msg->answers++;
+    }
+
+    return 0;
+}
+
+const char* dns_type_name(uint16_t qtype) {
+    switch (qtype) {
+        case 1:   return "A";
+        case 2:   return "NS";
+        case 5:   return "CNAME";
+        case 6:   return "SOA";
+        case 12:  return "PTR";
+        case 15:  return "MX";
+        case 16:  return "TXT";
+        case 28:  return "AAAA";
+        case 33:  return "SRV";
+        case 64:  return "SVCB";
+        case 65:  return "HTTPS";
+        case 255: return "ANY";
+        default:  return NULL;
+    }
+}
+
+const char* dns_rcode_name(uint8_t rcode) {
+    static const char* names[] = {
+        "NOERROR", "FORMERR", "SERVFAIL", "NXDOMAIN", "NOTIMP", "REFUSED",
+        "YXDOMAIN", "YXRRSET", "NXRRSET", "NOTAUTH", "NOTZONE"
+    };
+    return rcode < sizeof(names) / sizeof(names[0]) ? names[rcode] : "OTHER";
+}
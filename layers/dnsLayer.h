@@ -0,0 +1,71 @@
+/**
+ * @file dnsLayer.h
+ * @brief DNS message decoding (RFC 1035), straight from the captured payload.
+ *
+ * The decoder reads the header, the first question and the answer records in
+ * place; only the query name is copied out, in presentation form. Every read is
+ * bounds-checked and compression pointers must point backwards, so truncated or
+ * hostile messages cannot loop or read past the payload.
+ */
+
+#ifndef DNS_LAYER_H
+#define DNS_LAYER_H
+
+#include <stdint.h>
+
+#define DNS_PORT 53
+
+/**
+ * @brief Longest name in presentation form (RFC 1035: 255 octets on the wire).
+ */
+#define DNS_MAX_NAME 255
+
+#define DNS_RCODE_NOERROR   0
+#define DNS_RCODE_SERVFAIL  2
+#define DNS_RCODE_NXDOMAIN  3
+
+/**
+ * @brief Decoded DNS message.
+ */
+typedef struct {
+    uint16_t id;
+    uint8_t is_response;        // QR bit
+    uint8_t opcode;
+    uint8_t rcode;
+    uint8_t truncated;          // TC bit
+    uint16_t qdcount;
+    uint16_t ancount;
+
+    // First question
+    char qname[DNS_MAX_NAME + 1];   // Lowercase, no trailing dot ("." for the root)
+    uint16_t qtype;
+    uint16_t qclass;
+
+    // Answer section
+    uint16_t answers;           // Records decoded before the end (or a malformed record)
+    uint16_t answers_addr;      // A / AAAA records
+    uint16_t answers_cname;
+    uint32_t min_ttl;           // Smallest TTL among the decoded answers (0 if none)
+} DnsMessage;
+
+/**
+ * @brief Decodes a DNS message.
+ *
+ * @param payload UDP payload (or a TCP message without its length prefix).
+ * @param len Payload length.
+ * @param msg Output.
+ * @return 0 on success (header and question decoded), -1 if malformed.
+ */
+int parse_dns(const unsigned char* payload, int len, DnsMessage* msg);
+
+/**
+ * @brief Short name of a query type ("A", "AAAA", ...), or NULL if not a common one.
+ */
+const char* dns_type_name(uint16_t qtype);
+
+/**
+ * @brief Name of a response code ("NOERROR", "NXDOMAIN", ...).
+ */
+const char* dns_rcode_name(uint8_t rcode);
+
+#endif // DNS_LAYER_H
@@ -0,0 +1,175 @@
+/**
+ * @file httpLayer.c
+ * @brief Implementation of HTTP/1.x head decoding.
+ */
+
+#include <string.h>
+#include <strings.h>
+#include "httpLayer.h"
+
+#define HTTP_MAX_METHOD 16
+
+static int is_token_char(char c) {
+    return (c >= 'A' && c <= 'Z') || c == '-' || c == '_';
+}
+
+static char safe_char(char c) {
+    return (c > 0x20 && c < 0x7f && c != '"' && c != '\\') ? c : '?';
+}
+
+uint32_t http_head_end(const char* data, uint32_t len, uint32_t from) {
+    // The end may straddle the previous search boundary
+    uint32_t pos = from > 2 ? from - 2 : 0;
+
+    while (pos < len) {
+        const char* nl = (const char*)memchr(data + pos, '\n', len - pos);
+        if (!nl) return 0;
+
+        uint32_t i = (uint32_t)(nl - data);
+        if (i + 1 < len && data[i + 1] == '\n') return i + 2;
+        if (i + 2 < len && data[i + 1] == '\r' && data[i + 2] == '\n') return i + 3;
+        pos = i + 1;
+    }
+    return 0;
+}
+
+int http_looks_like_request(const char* data, uint32_t len) {
+    for (uint32_t i = 0; i < len && i <= HTTP_MAX_METHOD; i++) {
+        if (data[i] == ' ') return i > 0;
+        if (!is_token_char(data[i])) return 0;
+    }
+    return len > HTTP_MAX_METHOD ? 0 : -1;
+}
+
+const char* http_method_name(uint8_t method) {
+    static const char* names[] = { "GET", "HEAD", "POST", "PUT", "DELETE", "OTHER" };
+    return method < HTTP_METHOD_COUNT ? names[method] : "OTHER";
+}
+
+// --- Lines & Headers ---
+
+/**
+ * @brief Returns the line starting at @p pos (without CR LF) and advances @p pos past it.
+ */
+static const char* next_line(const char* head, uint32_t len, uint32_t* pos, uint32_t* line_len) {
+    if (*pos >= len) return NULL;
+
+    const char* line = head + *pos;
+    const char* nl = (const char*)memchr(line, '\n', len - *pos);
+    uint32_t n = nl ? (uint32_t)(nl - line) : len - *pos;
+    *pos += n + (nl ? 1 : 0);
+    if (n > 0 && line[n - 1] == '\r') n--;
+    *line_len = n;
+    return line;
+}
+
+static int parse_content_length(const char* v, uint32_t n, int64_t* out) {
+    if (n == 0 || n > 18) return -1;
+    int64_t value = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (v[i] < '0' || v[i] > '9') return -1;
+        value = value * 10 + (v[i] - '0');
+    }
+    *out = value;
+    return 0;
+}
+
+// Reads the headers that matter, starting after the first line
+static int parse_headers(const char* head, uint32_t len, uint32_t pos, HttpHead* out) {
+    const char* line;
+    uint32_t n;
+
+    while ((line = next_line(head, len, &pos, &n)) != NULL && n > 0) {
+        const char* colon = (const char*)memchr(line, ':', n);
+        if (!colon) continue;
+
+        uint32_t name_len = (uint32_t)(colon - line);
+        const char* v = colon + 1;
+        uint32_t v_len = n - name_len - 1;
+        while (v_len > 0 && (*v == ' ' || *v == '\t')) { v++; v_len--; }
+        while (v_len > 0 && (v[v_len - 1] == ' ' || v[v_len - 1] == '\t')) v_len--;
+
+        // Lengths differ, so most headers are rejected before comparing bytes
+        if (name_len == 4 && strncasecmp(line, "host", 4) == 0) {
+            uint32_t k = 0;
+            for (; k < v_len && k < HTTP_MAX_HOST - 1; k++) {
+                char c = v[k];
+                if (c >= 'A' && c <= 'Z') c = (char)(c + ('a' - 'A'));
+                out->host[k] = safe_char(c);
+            }
+            out->host[k] = '\0';
+        } else if (name_len == 14 && strncasecmp(line, "content-length", 14) == 0) {
+            if (parse_content_length(v, v_len, &out->content_length) != 0) return -1;
+        } else if (name_len == 17 && strncasecmp(line, "transfer-encoding", 17) == 0) {
+            out->chunked = v_len >= 7 && strncasecmp(v + v_len - 7, "chunked", 7) == 0;
+        }
+    }
+    return 0;
+}
+
+static void init_head(HttpHead* out) {
+    memset(out, 0, sizeof(*out));
+    out->content_length = -1;
+}
+
+// --- Request & Status Lines ---
+
+static uint8_t method_of(const char* m, uint32_t n) {
+    switch (n) {
+        case 3:
+            if (memcmp(m, "GET", 3) == 0) return HTTP_METHOD_GET;
+            if (memcmp(m, "PUT", 3) == 0) return HTTP_METHOD_PUT;
+            break;
+        case 4:
+            if (memcmp(m, "HEAD", 4) == 0) return HTTP_METHOD_HEAD;
+            if (memcmp(m, "POST", 4) == 0) return HTTP_METHOD_POST;
+            break;
+        case 6:
+            if (memcmp(m, "DELETE", 6) == 0) return HTTP_METHOD_DELETE;
+            break;
+    }
+    return HTTP_METHOD_OTHER;
+}
+
+int parse_http_request(const char* head, uint32_t len, HttpHead* out) {
+    init_head(out);
+
+    uint32_t pos = 0, n;
+    const char* line = next_line(head, len, &pos, &n);
+    if (!line) return -1;
+
+    // METHOD SP target SP HTTP/1.x
+    const char* sp1 = (const char*)memchr(line, ' ', n);
+    if (!sp1 || sp1 == line || sp1 - line > HTTP_MAX_METHOD) return -1;
+    const char* target = sp1 + 1;
+    const char* sp2 = (const char*)memchr(target, ' ', n - (uint32_t)(target - line));
+    if (!sp2 || (uint32_t)(line + n - sp2) < 9 || memcmp(sp2 + 1, "HTTP/1.", 7) != 0) return -1;
+
+    out->method = method_of(line, (uint32_t)(sp1 - line));
+
+    // Path prefix: query strings are left out (they vary, and may carry identifiers)
+    uint32_t k = 0;
+    for (const char* c = target; c < sp2 && *c != '?' && *c != '#' && k < HTTP_MAX_PATH - 1; c++) {
+        out->path[k++] = safe_char(*c);
+    }
+    out->path[k] = '\0';
+
+    return parse_headers(head, len, pos, out);
+}
+
+int parse_http_response(const char* head, uint32_t len, HttpHead* out) {
+    init_head(out);
+
+    uint32_t pos = 0, n;
+    const char* line = next_line(head, len, &pos, &n);
+
+    // HTTP/1.x SP 3DIGIT [SP reason]
+    if (!line || n < 12 || memcmp(line, "HTTP/1.", 7) != 0 || line[8] != ' ') return -1;
+    for (int i = 9; i < 12; i++) {
+        if (line[i] < '0' || line[i] > '9') return -1;
+    }
+    out->status = (uint16_t)((line[9] - '0') * 100 + (line[10] - '0') * 10 + (line[11] - '0'));
+    if (out->status < 100) return -1;
+
+    return parse_headers(head, len, pos, out);
+}
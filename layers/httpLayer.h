@@ -0,0 +1,84 @@
+/**
+ * @file httpLayer.h
+ * @brief HTTP/1.x message head decoding (RFC 9112), in place.
+ *
+ * Heads are located with memchr(), which the C library vectorizes, and header
+ * names are matched by length before any byte comparison, so most lines are
+ * skipped after a single check. Only the fields needed to frame messages and
+ * describe requests are extracted.
+ */
+
+#ifndef HTTP_LAYER_H
+#define HTTP_LAYER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Longest head accepted (request/status line plus headers).
+ */
+#define HTTP_MAX_HEAD 8192
+
+#define HTTP_MAX_HOST 64
+#define HTTP_MAX_PATH 32
+
+typedef enum {
+    HTTP_METHOD_GET,
+    HTTP_METHOD_HEAD,
+    HTTP_METHOD_POST,
+    HTTP_METHOD_PUT,
+    HTTP_METHOD_DELETE,
+    HTTP_METHOD_OTHER,
+    HTTP_METHOD_COUNT
+} HttpMethod;
+
+/**
+ * @brief Decoded request or response head.
+ */
+typedef struct {
+    // Request line
+    uint8_t method;                 // HttpMethod
+    char path[HTTP_MAX_PATH];       // Target up to the query string, truncated
+    char host[HTTP_MAX_HOST];       // Host header, lowercase ("" if absent)
+
+    // Status line
+    uint16_t status;
+
+    // Framing
+    int64_t content_length;         // -1 if absent
+    uint8_t chunked;                // Transfer-Encoding ends in "chunked"
+} HttpHead;
+
+/**
+ * @brief Finds the blank line that ends a head.
+ *
+ * @param data Bytes from the start of the head.
+ * @param len Bytes available.
+ * @param from Where to resume a previous search (bytes already known not to hold the end).
+ * @return Head length including the blank line, or 0 if it is not complete yet.
+ */
+uint32_t http_head_end(const char* data, uint32_t len, uint32_t from);
+
+/**
+ * @brief Quick check that a stream starts like an HTTP request ("TOKEN ").
+ * @return 1 if it may be HTTP, 0 if not, -1 if too few bytes to tell.
+ */
+int http_looks_like_request(const char* data, uint32_t len);
+
+/**
+ * @brief Decodes a request head.
+ * @return 0 on success, -1 if malformed.
+ */
+int parse_http_request(const char* head, uint32_t len, HttpHead* out);
+
+/**
+ * @brief Decodes a response head.
+ * @return 0 on success, -1 if malformed.
+ */
+int parse_http_response(const char* head, uint32_t len, HttpHead* out);
+
+/**
+ * @brief Method name ("GET", ...; "OTHER" for the rest).
+ */
+const char* http_method_name(uint8_t method);
+
+#endif // HTTP_LAYER_H
@@ -4,6 +4,7 @@
  */
 
 #define _GNU_SOURCE
+#include <string.h>
 #include <netinet/ip.h>
 #include <netinet/ip6.h>
 #include <arpa/inet.h>
@@ -29,7 +30,10 @@ uint8_t parse_ip(const unsigned char* buffer, int size, int* header_len, PacketM
     meta->ip_version = 4;
     inet_ntop(AF_INET, &iph->saddr, meta->src_ip, INET6_ADDRSTRLEN);
     inet_ntop(AF_INET, &iph->daddr, meta->dest_ip, INET6_ADDRSTRLEN);
+    memcpy(meta->src_addr, &iph->saddr, 4);
+    memcpy(meta->dest_addr, &iph->daddr, 4);
     meta->l3_protocol = iph->protocol;
+    meta->ip_length = ntohs(iph->tot_len);
 
     // Calculate the length of the IP header (IHL is in 32-bit words, so multiply by 4)
     *header_len = iph->ihl * 4;
@@ -56,7 +60,10 @@ uint8_t parse_ipv6(const unsigned char* buffer, int size, int* header_len, Packe
     meta->ip_version = 6;
     inet_ntop(AF_INET6, &ip6h->ip6_src, meta->src_ip, INET6_ADDRSTRLEN);
     inet_ntop(AF_INET6, &ip6h->ip6_dst, meta->dest_ip, INET6_ADDRSTRLEN);
+    memcpy(meta->src_addr, &ip6h->ip6_src, 16);
+    memcpy(meta->dest_addr, &ip6h->ip6_dst, 16);
     meta->l3_protocol = ip6h->ip6_nxt;
+    meta->ip_length = (uint16_t)(40 + ntohs(ip6h->ip6_plen));
 
     // IPv6 header is fixed 40 bytes
     *header_len = 40; 
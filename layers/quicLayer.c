@@ -0,0 +1,289 @@
+/**
+ * @file quicLayer.c
+ * @brief Implementation of QUIC Initial packet decryption.
+ */
+
+#include <string.h>
+#include "quicLayer.h"
+
+#ifdef HAVE_LIBCRYPTO
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#endif
+
+#define QUIC_MAX_CID      20
+#define QUIC_SAMPLE_LEN   16
+#define QUIC_TAG_LEN      16
+
+#define QUIC_FRAME_PADDING    0x00
+#define QUIC_FRAME_PING       0x01
+#define QUIC_FRAME_ACK        0x02
+#define QUIC_FRAME_ACK_ECN    0x03
+#define QUIC_FRAME_CRYPTO     0x06
+#define QUIC_FRAME_CLOSE      0x1c
+
+/**
+ * @brief Layout of a long-header Initial packet.
+ */
+typedef struct {
+    uint32_t version;
+    const uint8_t* dcid;
+    uint8_t dcid_len;
+    uint32_t pn_offset;         // Protected packet number
+    uint32_t end;               // End of the packet (Length field)
+} InitialHeader;
+
+// Reads a variable-length integer (RFC 9000, 16); returns bytes used, 0 if truncated
+static int read_varint(const uint8_t* p, uint32_t len, uint64_t* value) {
+    if (len == 0) return 0;
+    int size = 1 << (p[0] >> 6);
+    if ((uint32_t)size > len) return 0;
+
+    uint64_t v = p[0] & 0x3f;
+    for (int i = 1; i < size; i++) v = (v << 8) | p[i];
+    *value = v;
+    return size;
+}
+
+static uint32_t read32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+int quic_is_initial(const uint8_t* data, uint32_t len) {
+    if (len < 5 || (data[0] & 0xc0) != 0xc0) return 0;   // Long header, fixed bit
+
+    // The packet type bits are numbered differently in each version
+    uint8_t type = (data[0] >> 4) & 0x03;
+    switch (read32(data + 1)) {
+        case QUIC_VERSION_1: return type == 0;
+        case QUIC_VERSION_2: return type == 1;
+        default:             return 0;
+    }
+}
+
+static int parse_initial_header(const uint8_t* data, uint32_t len, InitialHeader* hdr) {
+    if (!quic_is_initial(data, len)) return -1;
+    hdr->version = read32(data + 1);
+
+    uint32_t pos = 5;
+    if (pos + 1 > len || data[pos] > QUIC_MAX_CID || pos + 1 + data[pos] > len) return -1;
+    hdr->dcid_len = data[pos];
+    hdr->dcid = data + pos + 1;
+    pos += 1u + data[pos];
+
+    if (pos + 1 > len || data[pos] > QUIC_MAX_CID || pos + 1 + data[pos] > len) return -1;
+    pos += 1u + data[pos];          // Source Connection ID
+
+    uint64_t token_len, length;
+    int n = read_varint(data + pos, len - pos, &token_len);
+    if (n == 0 || token_len > len - pos - n) return -1;
+    pos += n + (uint32_t)token_len;
+
+    n = read_varint(data + pos, len - pos, &length);
+    if (n == 0 || length > len - pos - n) return -1;
+    pos += n;
+
+    // Room for the longest packet number plus the header protection sample
+    if (length < 4 + QUIC_SAMPLE_LEN) return -1;
+    hdr->pn_offset = pos;
+    hdr->end = pos + (uint32_t)length;
+    return 0;
+}
+
+// --- Frames ---
+
+int quic_crypto_frames(const uint8_t* payload, uint32_t len, QuicCryptoCallback cb, void* user) {
+    uint32_t pos = 0;
+    while (pos < len) {
+        uint8_t type = payload[pos++];
+        uint64_t a, b, c;
+        int n;
+
+        switch (type) {
+            case QUIC_FRAME_PADDING:
+            case QUIC_FRAME_PING:
+                break;
+
+            case QUIC_FRAME_CRYPTO:
+                if (!(n = read_varint(payload + pos, len - pos, &a))) return -1;
+                pos += n;
+                if (!(n = read_varint(payload + pos, len - pos, &b)) || b > len - pos - n) return -1;
+                pos += n;
+                cb(user, a, payload + pos, (uint32_t)b);
+                pos += (uint32_t)b;
+                break;
+
+            case QUIC_FRAME_ACK:
+            case QUIC_FRAME_ACK_ECN: {
+                // Largest Acknowledged, ACK Delay, Range Count, First Range, then the ranges
+                uint64_t fields = 4;
+                for (uint64_t i = 0; i < fields; i++) {
+                    if (!(n = read_varint(payload + pos, len - pos, &c))) return -1;
+                    pos += n;
+                    if (i == 2) {
+                        if (c > len) return -1;
+                        fields += 2 * c;
+                    }
+                }
+                for (int i = 0; type == QUIC_FRAME_ACK_ECN && i < 3; i++) {
+                    if (!(n = read_varint(payload + pos, len - pos, &c))) return -1;
+                    pos += n;
+                }
+                break;
+            }
+
+            case QUIC_FRAME_CLOSE:
+                // Error Code, Frame Type, Reason Phrase
+                if (!(n = read_varint(payload + pos, len - pos, &a))) return -1;
+                pos += n;
+                if (!(n = read_varint(payload + pos, len - pos, &a))) return -1;
+                pos += n;
+                if (!(n = read_varint(payload + pos, len - pos, &b)) || b > len - pos - n) return -1;
+                pos += n + (uint32_t)b;
+                break;
+
+            default:
+                return -1;          // Not allowed in Initial packets
+        }
+    }
+    return 0;
+}
+
+#ifdef HAVE_LIBCRYPTO
+
+// --- Key Derivation (RFC 9001, 5.2) ---
+
+static const uint8_t salt_v1[20] = {
+    0x38, 0x76, 0x2c, 0xf7, 0xf5, 0x59, 0x34, 0xb3, 0x4d, 0x17,
+    0x9a, 0xe6, 0xa4, 0xc8, 0x0c, 0xad, 0xcc, 0xbb, 0x7f, 0x0a
+};
+
+static const uint8_t salt_v2[20] = {
+    0x0d, 0xed, 0xe3, 0xde, 0xf7, 0x00, 0xa6, 0xdb, 0x81, 0x93,
+    0x81, 0xbe, 0x6e, 0x26, 0x9d, 0xcb, 0xf9, 0xbd, 0x2e, 0xd9
+};
+
+// HKDF-Expand-Label with an empty context, for outputs of at most one SHA-256 block
+static int expand_label(const uint8_t secret[32], const char* label, uint8_t* out, uint8_t out_len) {
+    uint8_t info[64];
+    size_t label_len = strlen(label);
+    size_t pos = 0;
+
+    info[pos++] = 0;
+    info[pos++] = out_len;
+    info[pos++] = (uint8_t)(6 + label_len);
+    memcpy(info + pos, "tls13 ", 6);
+    memcpy(info + pos + 6, label, label_len);
+    pos += 6 + label_len;
+    info[pos++] = 0;            // Context
+    info[pos++] = 1;            // Block counter T(1)
+
+    uint8_t block[32];
+    unsigned int block_len = sizeof(block);
+    if (!HMAC(EVP_sha256(), secret, 32, info, pos, block, &block_len)) return -1;
+    memcpy(out, block, out_len);
+    return 0;
+}
+
+int quic_decryption_available(void) {
+    return 1;
+}
+
+int quic_derive_client_keys(const uint8_t* data, uint32_t len, QuicInitialKeys* keys) {
+    InitialHeader hdr;
+    if (parse_initial_header(data, len, &hdr) != 0) return -1;
+
+    int v2 = (hdr.version == QUIC_VERSION_2);
+    const uint8_t* salt = v2 ? salt_v2 : salt_v1;
+
+    uint8_t initial[32], client[32];
+    unsigned int initial_len = sizeof(initial);
+    if (!HMAC(EVP_sha256(), salt, 20, hdr.dcid, hdr.dcid_len, initial, &initial_len)) return -1;
+
+    keys->version = hdr.version;
+    if (expand_label(initial, "client in", client, 32) != 0 ||
+        expand_label(client, v2 ? "quicv2 key" : "quic key", keys->key, 16) != 0 ||
+        expand_label(client, v2 ? "quicv2 iv" : "quic iv", keys->iv, 12) != 0 ||
+        expand_label(client, v2 ? "quicv2 hp" : "quic hp", keys->hp, 16) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// --- Packet Protection (RFC 9001, 5.3 and 5.4) ---
+
+static int header_mask(const uint8_t hp[16], const uint8_t* sample, uint8_t mask[16]) {
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    int out_len = 0;
+    int ok = ctx && EVP_EncryptInit_ex(ctx, EVP_aes_128_ecb(), NULL, hp, NULL) &&
+             EVP_CIPHER_CTX_set_padding(ctx, 0) &&
+             EVP_EncryptUpdate(ctx, mask, &out_len, sample, QUIC_SAMPLE_LEN) && out_len == 16;
+    EVP_CIPHER_CTX_free(ctx);
+    return ok ? 0 : -1;
+}
+
+int quic_decrypt_initial(const QuicInitialKeys* keys, const uint8_t* data, uint32_t len,
+                         uint8_t* out, uint32_t cap) {
+    InitialHeader hdr;
+    if (parse_initial_header(data, len, &hdr) != 0 || hdr.version != keys->version) return -1;
+
+    // The sample starts four bytes in, as if the packet number were at its longest
+    uint8_t mask[16];
+    if (header_mask(keys->hp, data + hdr.pn_offset + 4, mask) != 0) return -1;
+
+    uint8_t first = data[0] ^ (mask[0] & 0x0f);
+    uint32_t pn_len = (first & 0x03) + 1u;
+
+    // Unprotected packet number
+    uint8_t pn_bytes[4];
+    uint64_t pn = 0;
+    for (uint32_t i = 0; i < pn_len; i++) {
+        pn_bytes[i] = data[hdr.pn_offset + i] ^ mask[1 + i];
+        pn = (pn << 8) | pn_bytes[i];
+    }
+
+    // Nonce: IV XOR the packet number, right-aligned
+    uint8_t nonce[12];
+    memcpy(nonce, keys->iv, sizeof(nonce));
+    for (int i = 0; i < 8; i++) nonce[11 - i] ^= (uint8_t)(pn >> (8 * i));
+
+    uint32_t header_len = hdr.pn_offset + pn_len;
+    const uint8_t* ciphertext = data + header_len;
+    if (hdr.end < header_len + QUIC_TAG_LEN) return -1;
+    uint32_t ct_len = hdr.end - header_len - QUIC_TAG_LEN;
+    if (ct_len > cap) return -1;
+
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    int n = 0, total = 0;
+    int ok = ctx && EVP_DecryptInit_ex(ctx, EVP_aes_128_gcm(), NULL, keys->key, nonce) &&
+             // The unprotected header is the associated data
+             EVP_DecryptUpdate(ctx, NULL, &n, &first, 1) &&
+             EVP_DecryptUpdate(ctx, NULL, &n, data + 1, (int)hdr.pn_offset - 1) &&
+             EVP_DecryptUpdate(ctx, NULL, &n, pn_bytes, (int)pn_len) &&
+             EVP_DecryptUpdate(ctx, out, &n, ciphertext, (int)ct_len);
+    total = n;
+    ok = ok && EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, QUIC_TAG_LEN, (void*)(ciphertext + ct_len)) &&
+         EVP_DecryptFinal_ex(ctx, out + total, &n) > 0;
+    EVP_CIPHER_CTX_free(ctx);
+
+    return ok ? total + n : -1;
+}
+
+#else
+
+int quic_decryption_available(void) {
+    return 0;
+}
+
+int quic_derive_client_keys(const uint8_t* data, uint32_t len, QuicInitialKeys* keys) {
+    (void)data; (void)len; (void)keys;
+    return -1;
+}
+
+int quic_decrypt_initial(const QuicInitialKeys* keys, const uint8_t* data, uint32_t len,
+                         uint8_t* out, uint32_t cap) {
+    (void)keys; (void)data; (void)len; (void)out; (void)cap;
+    return -1;
+}
+
+#endif // HAVE_LIBCRYPTO
@@ -0,0 +1,70 @@
+/**
+ * @file quicLayer.h
+ * @brief QUIC Initial packet decryption (RFC 9001, RFC 9369), to reach the ClientHello.
+ *
+ * Initial packets are protected with keys derived from the Destination
+ * Connection ID the client picked, so a passive observer can remove the
+ * protection and read the CRYPTO frames that carry the TLS handshake.
+ *
+ * Decryption uses libcrypto (AES-128-GCM, HMAC-SHA256). In builds without it
+ * quic_decryption_available() returns 0 and the other calls fail.
+ */
+
+#ifndef QUIC_LAYER_H
+#define QUIC_LAYER_H
+
+#include <stdint.h>
+
+#define QUIC_VERSION_1 0x00000001
+#define QUIC_VERSION_2 0x6b3343cf
+
+/**
+ * @brief Client Initial packet protection keys of one connection.
+ */
+typedef struct {
+    uint32_t version;
+    uint8_t key[16];            // AEAD key
+    uint8_t iv[12];             // AEAD nonce base
+    uint8_t hp[16];             // Header protection key
+} QuicInitialKeys;
+
+/**
+ * @brief Called for every CRYPTO frame of a decrypted packet.
+ */
+typedef void (*QuicCryptoCallback)(void* user, uint64_t offset, const uint8_t* data, uint32_t len);
+
+/**
+ * @brief Returns 1 if this build can decrypt Initial packets.
+ */
+int quic_decryption_available(void);
+
+/**
+ * @brief Checks whether a UDP payload starts with an Initial packet of a supported version.
+ * Cheap: looks at the first five bytes only.
+ */
+int quic_is_initial(const uint8_t* data, uint32_t len);
+
+/**
+ * @brief Derives the client's Initial keys from the packet's Destination Connection ID.
+ * @return 0 on success, -1 if the header is malformed or decryption is unavailable.
+ */
+int quic_derive_client_keys(const uint8_t* data, uint32_t len, QuicInitialKeys* keys);
+
+/**
+ * @brief Removes header protection from the first packet of a datagram and decrypts it.
+ *
+ * @param data UDP payload (coalesced packets after the Initial are ignored).
+ * @param out Receives the plaintext frames.
+ * @param cap Size of @p out.
+ * @return Plaintext length, or -1 if the packet does not authenticate.
+ */
+int quic_decrypt_initial(const QuicInitialKeys* keys, const uint8_t* data, uint32_t len,
+                         uint8_t* out, uint32_t cap);
+
+/**
+ * @brief Walks the frames of a decrypted Initial packet.
+ * @return 0 if every frame was understood, -1 at the first malformed or unexpected frame.
+ */
+int quic_crypto_frames(const uint8_t* payload, uint32_t len, QuicCryptoCallback cb, void* user);
+
+#endif // QUIC_LAYER_H
@@ -0,0 +1,225 @@
+/**
+ * @file tlsLayer.c
+ * @brief Implementation of ClientHello decoding and JA3 fingerprinting.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "tlsLayer.h"
+#include "md5.h"
+
+#define TLS_RANDOM_LEN 32
+
+#define TLS_EXT_SERVER_NAME        0
+#define TLS_EXT_SUPPORTED_GROUPS   10
+#define TLS_EXT_EC_POINT_FORMATS   11
+#define TLS_EXT_ALPN               16
+#define TLS_EXT_SUPPORTED_VERSIONS 43
+
+static uint16_t read16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t read24(const uint8_t* p) {
+    return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+}
+
+// RFC 8701 reserves 0x0a0a, 0x1a1a, ... 0xfafa to keep peers tolerant of unknown values
+static int is_grease(uint16_t v) {
+    return (v & 0x0f0f) == 0x0a0a && (v >> 8) == (v & 0xff);
+}
+
+// --- Extensions ---
+
+static int parse_server_name(const uint8_t* p, uint32_t len, TlsClientHello* hello) {
+    if (len < 2 || read16(p) + 2u > len) return -1;
+    uint32_t end = 2u + read16(p);
+
+    for (uint32_t pos = 2; pos + 3 <= end;) {
+        uint8_t type = p[pos];
+        uint16_t name_len = read16(p + pos + 1);
+        if (pos + 3 + name_len > end) return -1;
+        if (type == 0 && !hello->sni) {     // host_name
+            hello->sni = p + pos + 3;
+            hello->sni_len = name_len;
+        }
+        pos += 3 + name_len;
+    }
+    return 0;
+}
+
+static int parse_alpn(const uint8_t* p, uint32_t len, TlsClientHello* hello) {
+    if (len < 2 || read16(p) + 2u > len) return -1;
+    uint32_t end = 2u + read16(p);
+    if (end < 3 || p[2] == 0 || 3u + p[2] > end) return -1;
+
+    hello->alpn = p + 3;
+    hello->alpn_len = p[2];
+    return 0;
+}
+
+static int parse_supported_versions(const uint8_t* p, uint32_t len, TlsClientHello* hello) {
+    if (len < 1 || p[0] + 1u > len || (p[0] & 1)) return -1;
+
+    for (uint32_t pos = 1; pos + 2 <= 1u + p[0]; pos += 2) {
+        uint16_t v = read16(p + pos);
+        if (!is_grease(v) && v > hello->version) hello->version = v;
+    }
+    return 0;
+}
+
+static int parse_extension(uint16_t type, const uint8_t* p, uint32_t len, TlsClientHello* hello) {
+    switch (type) {
+        case TLS_EXT_SERVER_NAME:
+            return parse_server_name(p, len, hello);
+        case TLS_EXT_ALPN:
+            return parse_alpn(p, len, hello);
+        case TLS_EXT_SUPPORTED_VERSIONS:
+            return parse_supported_versions(p, len, hello);
+        case TLS_EXT_SUPPORTED_GROUPS:
+            if (len < 2 || read16(p) + 2u > len || (read16(p) & 1)) return -1;
+            hello->groups = p + 2;
+            hello->groups_len = read16(p);
+            return 0;
+        case TLS_EXT_EC_POINT_FORMATS:
+            if (len < 1 || p[0] + 1u > len) return -1;
+            hello->point_formats = p + 1;
+            hello->point_formats_len = p[0];
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+// --- ClientHello ---
+
+uint32_t tls_handshake_record_length(const uint8_t* data, uint32_t len) {
+    if (len < TLS_RECORD_HEADER_LEN || data[0] != TLS_CONTENT_HANDSHAKE || data[1] != 3 || data[2] > 4) {
+        return 0;
+    }
+    uint16_t length = read16(data + 3);
+    return (length > 0 && length <= TLS_MAX_RECORD) ? length : 0;
+}
+
+int parse_tls_client_hello(const uint8_t* msg, uint32_t len, TlsClientHello* hello) {
+    memset(hello, 0, sizeof(*hello));
+    if (len < TLS_HANDSHAKE_HEADER_LEN || msg[0] != TLS_HANDSHAKE_CLIENT_HELLO) return -1;
+
+    uint32_t end = TLS_HANDSHAKE_HEADER_LEN + read24(msg + 1);
+    if (end > len) return -1;
+
+    // legacy_version, random, legacy_session_id
+    uint32_t pos = TLS_HANDSHAKE_HEADER_LEN;
+    if (pos + 2 + TLS_RANDOM_LEN + 1 > end) return -1;
+    hello->legacy_version = read16(msg + pos);
+    hello->version = hello->legacy_version;
+    pos += 2 + TLS_RANDOM_LEN;
+    pos += 1u + msg[pos];
+
+    // cipher_suites
+    if (pos + 2 > end) return -1;
+    uint16_t ciphers_len = read16(msg + pos);
+    if ((ciphers_len & 1) || pos + 2 + ciphers_len > end) return -1;
+    hello->ciphers = msg + pos + 2;
+    hello->ciphers_len = ciphers_len;
+    pos += 2u + ciphers_len;
+
+    // legacy_compression_methods
+    if (pos + 1 > end || pos + 1 + msg[pos] > end) return -1;
+    pos += 1u + msg[pos];
+
+    // Extensions are optional before TLS 1.3
+    if (pos == end) return 0;
+    if (pos + 2 > end) return -1;
+    uint16_t ext_len = read16(msg + pos);
+    if (pos + 2 + ext_len > end) return -1;
+    hello->extensions = msg + pos + 2;
+    hello->extensions_len = ext_len;
+
+    // A supported_versions list replaces legacy_version (RFC 8446, 4.2.1)
+    int has_versions = 0;
+    uint16_t legacy = hello->version;
+    hello->version = 0;
+
+    const uint8_t* ext = hello->extensions;
+    for (uint32_t off = 0; off + 4 <= ext_len;) {
+        uint16_t type = read16(ext + off);
+        uint16_t body = read16(ext + off + 2);
+        if (off + 4 + body > ext_len) return -1;
+        if (parse_extension(type, ext + off + 4, body, hello) != 0) return -1;
+        if (type == TLS_EXT_SUPPORTED_VERSIONS) has_versions = 1;
+        off += 4u + body;
+    }
+
+    if (!has_versions || hello->version == 0) hello->version = legacy;
+    return 0;
+}
+
+// --- Fingerprint ---
+
+// Appends "v-v-v" for a list of big-endian values, skipping GREASE
+static void md5_list(Md5Context* md5, const uint8_t* p, uint32_t len, int width) {
+    char num[8];
+    int first = 1;
+    for (uint32_t i = 0; i + width <= len; i += width) {
+        uint16_t v = (width == 2) ? read16(p + i) : p[i];
+        if (width == 2 && is_grease(v)) continue;
+        int n = snprintf(num, sizeof(num), first ? "%u" : "-%u", v);
+        md5_update(md5, num, (size_t)n);
+        first = 0;
+    }
+}
+
+static void copy_printable(char* dst, size_t cap, const uint8_t* src, uint32_t len) {
+    memset(dst, 0, cap);
+    if (len >= cap) len = (uint32_t)cap - 1;
+    for (uint32_t i = 0; i < len; i++) {
+        dst[i] = (src[i] > 0x20 && src[i] < 0x7f && src[i] != '"' && src[i] != '\\') ? (char)src[i] : '?';
+    }
+}
+
+// Keeps the first @p cap non-GREASE values of a two-byte list
+static uint8_t copy_list(uint16_t* dst, int cap, const uint8_t* p, uint32_t len) {
+    int count = 0;
+    for (uint32_t i = 0; i + 2 <= len && count < cap; i += 2) {
+        uint16_t v = read16(p + i);
+        if (!is_grease(v)) dst[count++] = v;
+    }
+    return (uint8_t)count;
+}
+
+void tls_fill_info(const TlsClientHello* hello, TlsInfo* info) {
+    info->version = hello->version;
+    info->cipher_count = copy_list(info->ciphers, TLS_CIPHERS_MAX, hello->ciphers, hello->ciphers_len);
+    copy_printable(info->sni, sizeof(info->sni), hello->sni, hello->sni_len);
+    copy_printable(info->alpn, sizeof(info->alpn), hello->alpn, hello->alpn_len);
+
+    Md5Context md5;
+    char num[8];
+    md5_init(&md5);
+
+    int n = snprintf(num, sizeof(num), "%u,", hello->legacy_version);
+    md5_update(&md5, num, (size_t)n);
+    md5_list(&md5, hello->ciphers, hello->ciphers_len, 2);
+    md5_update(&md5, ",", 1);
+
+    // Extension types, in the order sent
+    int first = 1;
+    info->extension_count = 0;
+    const uint8_t* ext = hello->extensions;
+    for (uint32_t off = 0; off + 4 <= hello->extensions_len; off += 4u + read16(ext + off + 2)) {
+        uint16_t type = read16(ext + off);
+        if (is_grease(type)) continue;
+        if (info->extension_count < TLS_EXTENSIONS_MAX) info->extensions[info->extension_count++] = type;
+        n = snprintf(num, sizeof(num), first ? "%u" : "-%u", type);
+        md5_update(&md5, num, (size_t)n);
+        first = 0;
+    }
+    md5_update(&md5, ",", 1);
+
+    md5_list(&md5, hello->groups, hello->groups_len, 2);
+    md5_update(&md5, ",", 1);
+    md5_list(&md5, hello->point_formats, hello->point_formats_len, 1);
+
+    md5_final(&md5, info->ja3);
+}
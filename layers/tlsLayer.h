@@ -0,0 +1,71 @@
+/**
+ * @file tlsLayer.h
+ * @brief TLS ClientHello decoding (RFC 8446) and JA3 fingerprinting.
+ *
+ * The decoder walks the ClientHello in place: cipher suites, extensions and
+ * groups stay pointers into the message. The fingerprint is computed from
+ * them, and the first cipher suites and extension types are copied out. Every length is checked against its enclosing block, so truncated
+ * or hostile messages are rejected instead of read past.
+ */
+
+#ifndef TLS_LAYER_H
+#define TLS_LAYER_H
+
+#include <stdint.h>
+#include "Types.h"
+
+#define TLS_RECORD_HEADER_LEN     5
+#define TLS_HANDSHAKE_HEADER_LEN  4
+#define TLS_CONTENT_HANDSHAKE     22
+#define TLS_HANDSHAKE_CLIENT_HELLO 1
+
+/**
+ * @brief Largest record payload allowed (RFC 8446: 2^14 plus expansion).
+ */
+#define TLS_MAX_RECORD 18432
+
+/**
+ * @brief Decoded ClientHello. Pointers refer to the message that was parsed.
+ */
+typedef struct {
+    uint16_t legacy_version;
+    uint16_t version;                   // Highest supported_versions entry, else legacy_version
+    const uint8_t* ciphers;             // Cipher suites, two bytes each
+    uint16_t ciphers_len;
+    const uint8_t* extensions;          // Raw extension block
+    uint16_t extensions_len;
+    const uint8_t* groups;              // supported_groups, two bytes each
+    uint16_t groups_len;
+    const uint8_t* point_formats;       // ec_point_formats, one byte each
+    uint8_t point_formats_len;
+    const uint8_t* sni;                 // First host_name of server_name (not terminated)
+    uint16_t sni_len;
+    const uint8_t* alpn;                // First protocol of ALPN (not terminated)
+    uint8_t alpn_len;
+} TlsClientHello;
+
+/**
+ * @brief Checks for a TLS handshake record header.
+ * @return Record payload length, 0 if the bytes do not start a handshake record.
+ */
+uint32_t tls_handshake_record_length(const uint8_t* data, uint32_t len);
+
+/**
+ * @brief Decodes a ClientHello handshake message.
+ *
+ * @param msg Handshake message, starting at its 4-byte header.
+ * @param len Bytes available; the whole message must be present.
+ * @param hello Output.
+ * @return 0 on success, -1 if this is not a well-formed ClientHello.
+ */
+int parse_tls_client_hello(const uint8_t* msg, uint32_t len, TlsClientHello* hello);
+
+/**
+ * @brief Fills a flow's TLS summary: version, SNI, ALPN, cipher suites, extension types and the JA3 hash.
+ *
+ * JA3 is the MD5 of "version,ciphers,extensions,groups,point_formats" in
+ * decimal, '-'-separated, with GREASE values (RFC 8701) left out.
+ */
+void tls_fill_info(const TlsClientHello* hello, TlsInfo* info);
+
+#endif // TLS_LAYER_H
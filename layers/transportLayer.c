@@ -9,9 +9,68 @@
 #include <netinet/ip_icmp.h>
 #include <netinet/icmp6.h>
 #include <arpa/inet.h>
+#include <string.h>
 #include "transportLayer.h"
 #include "logger.h"
 
+/**
+ * @brief Decodes the TCP option list.
+ *
+ * @param opt First option byte.
+ * @param len Option bytes present in the capture.
+ * @param out Decoded options.
+ */
+static void parse_tcp_options(const unsigned char* opt, int len, TcpOptions* out) {
+    int i = 0;
+    while (i < len) {
+        uint8_t kind = opt[i];
+        if (kind == TCPOPT_EOL) break;
+        if (kind == TCPOPT_NOP) {
+            i++;
+            continue;
+        }
+        if (i + 1 >= len) break;
+
+        int opt_len = opt[i + 1];
+        if (opt_len < 2 || i + opt_len > len) break; // Malformed or truncated
+
+        switch (kind) {
+            case TCPOPT_MAXSEG:
+                if (opt_len == TCPOLEN_MAXSEG) {
+                    out->mss = (uint16_t)((opt[i + 2] << 8) | opt[i + 3]);
+                    out->present |= TCP_OPT_MSS;
+                }
+                break;
+            case TCPOPT_WINDOW:
+                if (opt_len == TCPOLEN_WINDOW) {
+                    out->wscale = opt[i + 2] > 14 ? 14 : opt[i + 2]; // RFC 7323 limit
+                    out->present |= TCP_OPT_WSCALE;
+                }
+                break;
+            case TCPOPT_SACK_PERMITTED:
+                out->present |= TCP_OPT_SACK_PERM;
+                break;
+            case TCPOPT_SACK:
+                out->sack_blocks = (uint8_t)((opt_len - 2) / 8);
+                out->present |= TCP_OPT_SACK;
+                break;
+            case TCPOPT_TIMESTAMP:
+                if (opt_len == TCPOLEN_TIMESTAMP) {
+                    uint32_t v;
+                    memcpy(&v, opt + i + 2, 4);
+                    out->ts_val = ntohl(v);
+                    memcpy(&v, opt + i + 6, 4);
+                    out->ts_ecr = ntohl(v);
+                    out->present |= TCP_OPT_TIMESTAMP;
+                }
+                break;
+            default:
+                break;
+        }
+        i += opt_len;
+    }
+}
+
 /**
  * @brief Parses TCP header.
  * 
@@ -29,25 +88,24 @@ void parse_tcp(const unsigned char* buffer, int size, PacketMetadata* meta) {
 
     meta->src_port = ntohs(tcph->source);
     meta->dest_port = ntohs(tcph->dest);
-    
-    // Pack flags into a single byte for simplicity or keep separate
-    // Here we just store the raw flags byte (th_flags is uint8_t)
-    // Note: struct tcphdr might use bitfields or th_flags depending on system
-    // On Linux/GNU, th_flags is standard.
-    #ifdef __FAVOR_BSD
-    meta->tcp_flags = tcph->th_flags;
-    #else
-    // Construct flags manually if needed, or cast
-    // For standard Linux headers, we can access bitfields but it's messy to pack.
-    // Let's just pack the key ones we care about into our uint8_t
-    meta->tcp_flags = 0;
-    if (tcph->syn) meta->tcp_flags |= 0x02;
-    if (tcph->ack) meta->tcp_flags |= 0x10;
-    if (tcph->rst) meta->tcp_flags |= 0x04;
-    if (tcph->fin) meta->tcp_flags |= 0x01;
-    if (tcph->psh) meta->tcp_flags |= 0x08;
-    if (tcph->urg) meta->tcp_flags |= 0x20;
-    #endif
+    meta->tcp_seq = ntohl(tcph->seq);
+    meta->tcp_ack = ntohl(tcph->ack_seq);
+    meta->tcp_window = ntohs(tcph->window);
+
+    // Byte 13 holds the eight flag bits in wire order (CWR ECE URG ACK PSH RST SYN FIN)
+    meta->tcp_flags = buffer[13];
+
+    // Payload follows the header and its options
+    int header_len = tcph->doff * 4;
+    if (header_len >= (int)sizeof(struct tcphdr) && header_len <= size) {
+        meta->payload_offset = (uint16_t)(meta->l4_offset + header_len);
+        meta->payload_len = (uint16_t)(size - header_len);
+    }
+
+    if (header_len > (int)sizeof(struct tcphdr)) {
+        int options_len = (header_len <= size ? header_len : size) - (int)sizeof(struct tcphdr);
+        parse_tcp_options(buffer + sizeof(struct tcphdr), options_len, &meta->tcp_opts);
+    }
 }
 
 /**
@@ -67,6 +125,13 @@ void parse_udp(const unsigned char* buffer, int size, PacketMetadata* meta) {
 
     meta->src_port = ntohs(udph->source);
     meta->dest_port = ntohs(udph->dest);
+
+    int datagram_len = ntohs(udph->len);
+    if (datagram_len < (int)sizeof(struct udphdr) || datagram_len > size) {
+        datagram_len = size; // Truncated capture or bogus length
+    }
+    meta->payload_offset = (uint16_t)(meta->l4_offset + sizeof(struct udphdr));
+    meta->payload_len = (uint16_t)(datagram_len - sizeof(struct udphdr));
 }
 
 /**
@@ -1,11 +1,26 @@
-#include "rawSocket.h"
 #include "mmapSniffer.h" // <--- The new API
 #include "packetParser.h"
 #include "logger.h"
+#include "trafficStats.h"
+#include "sampler.h"
+#include "ipfix_exporter.h"
+#include "captureBackend.h"
+#include "xdpSniffer.h"
+#include "mem_pool.h"
+#include "tcpReassembly.h"
+#include "dnsStats.h"
+#include "httpStats.h"
+#include "quicLayer.h"
+#include "checksum.h"
+#include "udp_sender.h"
+#include "runtimeConfig.h"
+#include "controlSocket.h"
+#include "config_file.h"
 #include <stdio.h>
 #include <signal.h>
 #include <string.h>
 #include <stdlib.h>
+#include <getopt.h>
 
 // Global flag
 volatile int keep_running = 1;
@@ -15,45 +30,809 @@ void handle_signal(int signal) {
     keep_running = 0;
 }
 
+// SIGHUP: re-read the config file
+static void handle_reload_signal(int signal) {
+    (void)signal;
+    control_request_reload();
+}
+
+// SIGUSR2: dump the time machine buffers now
+static void handle_dump_signal(int signal) {
+    (void)signal;
+    time_machine_request_dump();
+}
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s [options] <interface> [interface ...]\n", prog);
+    printf("  -c, --config FILE    Read settings from FILE: \"option = value\" lines with long option names,\n");
+    printf("                       \"interface = NAME\" per interface; command-line options win\n");
+    printf("      --control PATH   Unix control socket to change sampling, filters, destinations and log level\n");
+    printf("                       at run time (SIGHUP or \"reload\" re-reads --config)\n");
+    printf("      --events IP:PORT Destination of packet records and JSON events (default: %s:%d)\n",
+           LOGGER_DEFAULT_EVENT_IP, LOGGER_DEFAULT_EVENT_PORT);
+    printf("      --record-format FMT     Packet records as json (default, one per datagram) or binary\n");
+    printf("                              (fixed-size records batched per datagram, for the dashboard)\n");
+    printf("      --export-filter SPEC    Export only packet records matching host:IP,proto:P,port:N\n");
+    printf("      --log-level LEVEL       Text log verbosity: error, warn, info (default) or debug\n");
+    printf("      --overload       Shed stages under overload: payload analyzers, then checksums and TCP analysis,\n");
+    printf("                       then 1-in-16 export sampling, then packet records (stats and flows stay)\n");
+    printf("      --overload-lag MS       Ring queueing delay that counts as overload (default: 50)\n");
+    printf("      --overload-queue N      Export queue depth that counts as overload (default: 16384)\n");
+    printf("  -t, --threads        Service each ring from a dedicated thread (default: single epoll loop)\n");
+    printf("  -s, --sample MODE:N  Export sampling: none, count:N, random:N or flow:N (default: none)\n");
+    printf("  -a, --adaptive       Raise the sampling rate automatically when the export queue backs up\n");
+    printf("  -x, --export-flows IP:PORT  Track flows and export expired records to an IPFIX collector\n");
+    printf("  -f, --flow-format FMT       Flow export format: ipfix (default) or v9\n");
+    printf("      --idle-timeout SEC      Flow idle timeout (default: 15)\n");
+    printf("      --active-timeout SEC    Flow active timeout (default: 60)\n");
+    printf("      --reasm-mb MB           TCP reassembly buffer per interface (default: 16)\n");
+    printf("      --reasm-flow-kb KB      TCP reassembly buffer per flow (default: 256)\n");
+    printf("      --overlap POLICY        Overlapping TCP data: first (default) or last\n");
+    printf("      --dedup          Drop duplicate frames (SPAN / mirror-port copies) before parsing\n");
+    printf("      --dedup-window USEC     Copies further apart are kept (default: 1000)\n");
+    printf("      --dedup-slice BYTES     Bytes hashed from the IP header on (default: 64, max 256)\n");
+    printf("      --checksums      Verify IPv4, TCP and UDP checksums; flag and count bad ones\n");
+    printf("      --vlan           Parse through up to two 802.1Q / 802.1ad tags (default: tagged frames stop at L2)\n");
+    printf("      --ipv4-only      Leave IPv6 out of the Ethernet parsing pipeline\n");
+    printf("      --record DIR     Record frames to time- and flow-indexed pcap segments (see SnifferQuery)\n");
+    printf("      --record-segment-mb MB  Rotate segments at this size (default: 256, max 4095)\n");
+    printf("      --record-segment-sec SEC  ... or this age (default: 300, 0 = size only)\n");
+    printf("      --time-machine DIR      Keep recent packets in memory, dump them to DIR as pcapng on a trigger\n");
+    printf("                              (EAPOL, --tm-filter match, --tm-rate-spike, or SIGUSR2)\n");
+    printf("      --tm-mb MB              Buffer memory per interface (default: 64)\n");
+    printf("      --tm-before SEC         Seconds dumped before the trigger (default: 10)\n");
+    printf("      --tm-after SEC          Seconds dumped after the trigger (default: 2)\n");
+    printf("      --tm-holdoff SEC        Triggers this soon after a dump are merged into it (default: 60)\n");
+    printf("      --tm-filter SPEC        Trigger on matching packets: host:IP,proto:tcp|udp|N,port:N\n");
+    printf("      --tm-rate-spike FACTOR  Trigger when a second carries FACTOR x the average packet rate\n");
+    printf("      --archive DIR           Archive exported packet records and flow records as compressed\n");
+    printf("                              columnar files (read with SnifferArchive)\n");
+    printf("      --archive-rotate SEC    Start new archive files after SEC seconds (default: 3600)\n");
+    printf("      --detect         Alert on SYN / ICMP floods, horizontal and vertical scans and 802.11 deauth storms\n");
+    printf("      --detect-syn PPS        SYNs per second to one host, over 10 s (default: 1000)\n");
+    printf("      --detect-icmp PPS       Echo requests per second to one host (default: 500)\n");
+    printf("      --detect-scan N         Hosts (one port) or ports (one host) probed by one source in 10 s\n");
+    printf("                              (default: 32, max %d)\n", DETECT_MAX_DISTINCT);
+    printf("      --detect-deauth PPS     Deauth / disassoc frames per second (default: 10)\n");
+    printf("  -d, --dns            Decode DNS, match queries to responses, export per-name aggregates\n");
+    printf("      --dns-interval SEC      DNS aggregate export interval (default: 10)\n");
+    printf("      --tls            Decode TLS/QUIC ClientHellos: SNI, ALPN, version and JA3 per flow\n");
+    printf("      --http           Match HTTP/1.x requests to responses, export per-host rates and latency\n");
+    printf("      --http-interval SEC     HTTP aggregate export interval (default: 10)\n");
+    printf("  -b, --backend NAME   Capture backend: mmap (AF_PACKET ring, default) or xdp (AF_XDP)\n");
+    printf("      --xdp-queue N           AF_XDP: RX queue to bind (default: 0)\n");
+    printf("      --xdp-native            AF_XDP: attach in driver mode instead of generic (SKB) mode\n");
+    printf("      --ring-mb MB            RX ring memory per interface (default: 8)\n");
+    printf("      --ring-block KB         RX ring block size (default: 128)\n");
+    printf("      --frame-size BYTES      RX ring frame slot size (default: 2048)\n");
+    printf("      --snaplen BYTES         Copy only the first BYTES of each Ethernet frame; slots shrink to fit\n");
+    printf("      --header-only           Same as --snaplen %u (L2-L4 headers); monitor sources keep full frames\n",
+           RING_HEADER_ONLY_SNAPLEN);
+    printf("  -w, --wait STRATEGY  Idle wait: poll (default), spin or adaptive (spin, then sleep)\n");
+    printf("      --spin-budget USEC      Adaptive wait: spin time before sleeping (default: 50)\n");
+    printf("      --busy-poll USEC        Enable SO_BUSY_POLL on the capture sockets\n");
+}
+
+// --- Settings ---
+
+/**
+ * @brief Everything the command line and the config file can set.
+ */
+typedef struct {
+    CaptureLoopConfig loop_config;
+    SamplingConfig sampling;
+    char collector_ip[64];
+    int collector_port;
+    FlowExportFormat flow_format;
+    const CaptureBackend* backend;
+    XdpConfig xdp_config;
+    RingConfig ring_config;
+    FlowTimeouts flow_timeouts;
+    int dns;
+    int tls;
+    int http;
+    int dedup;
+    int checksums;
+    int vlan;
+    int ipv4_only;
+    int recording;
+    RecorderConfig recorder_config;
+    int time_machine;
+    TimeMachineConfig tm_config;
+    int archive;
+    ArchiveConfig archive_config;
+    int overload;
+    OverloadConfig overload_config;
+    int detect;
+    DetectorConfig detect_config;
+    DedupConfig dedup_config;
+    DnsConfig dns_config;
+    HttpConfig http_config;
+    ReassemblyConfig reassembly;
+    char event_ip[64];
+    int event_port;
+    PacketFilter export_filter;
+    LogLevel log_level;
+    RecordFormat record_format;
+    char config_path[256];
+    char control_path[108];
+    char interfaces[MAX_CAPTURE_SOURCES][IFNAMSIZ];
+    int interface_count;
+} Settings;
+
+static const struct option long_options[] = {
+    {"config",   required_argument, NULL, 'c'},
+    {"control",        required_argument, NULL, 1035},
+    {"events",         required_argument, NULL, 1036},
+    {"export-filter",  required_argument, NULL, 1037},
+    {"log-level",      required_argument, NULL, 1038},
+    {"overload",       no_argument,       NULL, 1039},
+    {"overload-lag",   required_argument, NULL, 1040},
+    {"overload-queue", required_argument, NULL, 1041},
+    {"vlan",           no_argument,       NULL, 1042},
+    {"ipv4-only",      no_argument,       NULL, 1043},
+    {"detect",         no_argument,       NULL, 1044},
+    {"detect-syn",     required_argument, NULL, 1045},
+    {"detect-icmp",    required_argument, NULL, 1046},
+    {"detect-scan",    required_argument, NULL, 1047},
+    {"detect-deauth",  required_argument, NULL, 1048},
+    {"record-format",  required_argument, NULL, 1049},
+    {"threads",  no_argument,       NULL, 't'},
+    {"sample",   required_argument, NULL, 's'},
+    {"adaptive", no_argument,       NULL, 'a'},
+    {"export-flows",   required_argument, NULL, 'x'},
+    {"flow-format",    required_argument, NULL, 'f'},
+    {"idle-timeout",   required_argument, NULL, 1001},
+    {"active-timeout", required_argument, NULL, 1002},
+    {"dns",            no_argument,       NULL, 'd'},
+    {"dns-interval",   required_argument, NULL, 1013},
+    {"tls",            no_argument,       NULL, 1014},
+    {"http",           no_argument,       NULL, 1015},
+    {"http-interval",  required_argument, NULL, 1016},
+    {"dedup",          no_argument,       NULL, 1017},
+    {"dedup-window",   required_argument, NULL, 1018},
+    {"dedup-slice",    required_argument, NULL, 1019},
+    {"checksums",      no_argument,       NULL, 1020},
+    {"record",         required_argument, NULL, 1023},
+    {"record-segment-mb",  required_argument, NULL, 1024},
+    {"record-segment-sec", required_argument, NULL, 1025},
+    {"time-machine",   required_argument, NULL, 1026},
+    {"tm-mb",          required_argument, NULL, 1027},
+    {"tm-before",      required_argument, NULL, 1028},
+    {"tm-after",       required_argument, NULL, 1029},
+    {"tm-holdoff",     required_argument, NULL, 1030},
+    {"tm-filter",      required_argument, NULL, 1031},
+    {"tm-rate-spike",  required_argument, NULL, 1032},
+    {"archive",        required_argument, NULL, 1033},
+    {"archive-rotate", required_argument, NULL, 1034},
+    {"backend",        required_argument, NULL, 'b'},
+    {"xdp-queue",      required_argument, NULL, 1005},
+    {"xdp-native",     no_argument,       NULL, 1006},
+    {"ring-mb",        required_argument, NULL, 1007},
+    {"ring-block",     required_argument, NULL, 1008},
+    {"frame-size",     required_argument, NULL, 1009},
+    {"snaplen",        required_argument, NULL, 1021},
+    {"header-only",    no_argument,       NULL, 1022},
+    {"reasm-mb",       required_argument, NULL, 1010},
+    {"reasm-flow-kb",  required_argument, NULL, 1011},
+    {"overlap",        required_argument, NULL, 1012},
+    {"wait",           required_argument, NULL, 'w'},
+    {"spin-budget",    required_argument, NULL, 1003},
+    {"busy-poll",      required_argument, NULL, 1004},
+    {"help",     no_argument,       NULL, 'h'},
+    {NULL, 0, NULL, 0}
+};
+
+static const char* const short_options = "c:ts:ax:f:db:w:h";
+
+// Startup settings and command line, kept for reloads
+static Settings g_settings;
+static int g_argc;
+static char** g_argv;
+
+static void settings_defaults(Settings* s) {
+    memset(s, 0, sizeof(*s)); // Settings are compared with memcmp() on reload
+    s->loop_config.mode = CAPTURE_LOOP_EPOLL;
+    s->loop_config.wait = WAIT_POLL;
+    s->loop_config.spin_budget_us = 50;
+    sampling_config_defaults(&s->sampling);
+    s->flow_format = FLOW_EXPORT_IPFIX;
+    s->backend = &mmap_capture_backend;
+    s->ring_config.memory_budget = RING_DEFAULT_BUDGET;
+    s->ring_config.block_size = RING_DEFAULT_BLOCK;
+    s->ring_config.frame_size = RING_DEFAULT_FRAME;
+    s->flow_timeouts.idle_timeout_ms = 15000;
+    s->flow_timeouts.active_timeout_ms = 60000;
+    recorder_config_defaults(&s->recorder_config);
+    time_machine_config_defaults(&s->tm_config);
+    archive_config_defaults(&s->archive_config);
+    overload_config_defaults(&s->overload_config);
+    dedup_config_defaults(&s->dedup_config);
+    dns_config_defaults(&s->dns_config);
+    detector_config_defaults(&s->detect_config);
+    http_config_defaults(&s->http_config);
+    reassembly_config_defaults(&s->reassembly);
+    snprintf(s->event_ip, sizeof(s->event_ip), "%s", LOGGER_DEFAULT_EVENT_IP);
+    s->event_port = LOGGER_DEFAULT_EVENT_PORT;
+    s->log_level = LOG_LEVEL_INFO;
+}
+
+/**
+ * @brief Applies one option (command line or config file).
+ * @return 0 on success, -1 on an invalid value (reported on stderr).
+ */
+static int apply_option(Settings* s, int opt, const char* arg) {
+    switch (opt) {
+        case 't':
+            s->loop_config.mode = CAPTURE_LOOP_THREADS;
+            break;
+        case 's':
+            if (parse_sampling_spec(arg, &s->sampling) != 0) {
+                fprintf(stderr, "[ERROR] Invalid sampling spec '%s'\n", arg);
+                return -1;
+            }
+            break;
+        case 'a':
+            s->sampling.adaptive = 1;
+            break;
+        case 'x': {
+            const char* colon = strrchr(arg, ':');
+            if (!colon || colon == arg || (size_t)(colon - arg) >= sizeof(s->collector_ip) ||
+                (s->collector_port = atoi(colon + 1)) <= 0 || s->collector_port > 65535) {
+                fprintf(stderr, "[ERROR] Invalid collector '%s' (expected IP:PORT)\n", arg);
+                return -1;
+            }
+            memcpy(s->collector_ip, arg, colon - arg);
+            s->collector_ip[colon - arg] = '\0';
+            break;
+        }
+        case 'f':
+            if (strcmp(arg, "ipfix") == 0) {
+                s->flow_format = FLOW_EXPORT_IPFIX;
+            } else if (strcmp(arg, "v9") == 0) {
+                s->flow_format = FLOW_EXPORT_NETFLOW_V9;
+            } else {
+                fprintf(stderr, "[ERROR] Unknown flow format '%s'\n", arg);
+                return -1;
+            }
+            break;
+        case 1001:
+            s->flow_timeouts.idle_timeout_ms = (uint32_t)atoi(arg) * 1000;
+            break;
+        case 1002:
+            s->flow_timeouts.active_timeout_ms = (uint32_t)atoi(arg) * 1000;
+            break;
+        case 'd':
+            s->dns = 1;
+            break;
+        case 1013:
+            s->dns_config.interval_ms = (uint32_t)atoi(arg) * 1000;
+            break;
+        case 1014:
+            s->tls = 1;
+            break;
+        case 1015:
+            s->http = 1;
+            break;
+        case 1016:
+            s->http_config.interval_ms = (uint32_t)atoi(arg) * 1000;
+            break;
+        case 1017:
+            s->dedup = 1;
+            break;
+        case 1018:
+            s->dedup_config.window_us = (uint32_t)atoi(arg);
+            break;
+        case 1019:
+            s->dedup_config.slice = (uint32_t)atoi(arg);
+            break;
+        case 1020:
+            s->checksums = 1;
+            break;
+        case 1023:
+            s->recording = 1;
+            snprintf(s->recorder_config.directory, sizeof(s->recorder_config.directory), "%s", arg);
+            break;
+        case 1024:
+            s->recorder_config.segment_bytes = (uint64_t)atoi(arg) * 1024 * 1024;
+            break;
+        case 1025:
+            s->recorder_config.segment_seconds = (uint32_t)atoi(arg);
+            break;
+        case 1026:
+            s->time_machine = 1;
+            snprintf(s->tm_config.directory, sizeof(s->tm_config.directory), "%s", arg);
+            break;
+        case 1027:
+            s->tm_config.buffer_bytes = (size_t)atoi(arg) * 1024 * 1024;
+            break;
+        case 1028:
+            s->tm_config.pre_seconds = (uint32_t)atoi(arg);
+            break;
+        case 1029:
+            s->tm_config.post_seconds = (uint32_t)atoi(arg);
+            break;
+        case 1030:
+            s->tm_config.holdoff_seconds = (uint32_t)atoi(arg);
+            break;
+        case 1031:
+            if (parse_packet_filter(arg, &s->tm_config.filter) != 0) {
+                fprintf(stderr, "[ERROR] Invalid trigger filter '%s'\n", arg);
+                return -1;
+            }
+            break;
+        case 1032:
+            s->tm_config.rate_factor = (uint32_t)atoi(arg);
+            break;
+        case 1033:
+            s->archive = 1;
+            snprintf(s->archive_config.directory, sizeof(s->archive_config.directory), "%s", arg);
+            break;
+        case 1034:
+            s->archive_config.rotate_seconds = (uint32_t)atoi(arg);
+            break;
+        case 'b':
+            s->backend = find_capture_backend(arg);
+            if (!s->backend) {
+                fprintf(stderr, "[ERROR] Unknown capture backend '%s'\n", arg);
+                return -1;
+            }
+            break;
+        case 1005:
+            s->xdp_config.queue_id = (uint32_t)atoi(arg);
+            break;
+        case 1006:
+            s->xdp_config.native_mode = 1;
+            break;
+        case 1007:
+            s->ring_config.memory_budget = (size_t)atoi(arg) * 1024 * 1024;
+            break;
+        case 1008:
+            s->ring_config.block_size = (unsigned int)atoi(arg) * 1024;
+            break;
+        case 1009:
+            s->ring_config.frame_size = (unsigned int)atoi(arg);
+            break;
+        case 1021:
+            s->ring_config.snaplen = (unsigned int)atoi(arg);
+            break;
+        case 1022:
+            s->ring_config.snaplen = RING_HEADER_ONLY_SNAPLEN;
+            break;
+        case 1010:
+            s->reassembly.memory_cap = (size_t)atoi(arg) * 1024 * 1024;
+            break;
+        case 1011:
+            s->reassembly.flow_cap = (uint32_t)atoi(arg) * 1024;
+            break;
+        case 1012:
+            if (strcmp(arg, "first") == 0) {
+                s->reassembly.overlap = TCP_OVERLAP_FIRST;
+            } else if (strcmp(arg, "last") == 0) {
+                s->reassembly.overlap = TCP_OVERLAP_LAST;
+            } else {
+                fprintf(stderr, "[ERROR] Unknown overlap policy '%s'\n", arg);
+                return -1;
+            }
+            break;
+        case 'w':
+            if (strcmp(arg, "poll") == 0) {
+                s->loop_config.wait = WAIT_POLL;
+            } else if (strcmp(arg, "spin") == 0) {
+                s->loop_config.wait = WAIT_BUSY_SPIN;
+            } else if (strcmp(arg, "adaptive") == 0) {
+                s->loop_config.wait = WAIT_ADAPTIVE;
+            } else {
+                fprintf(stderr, "[ERROR] Unknown wait strategy '%s'\n", arg);
+                return -1;
+            }
+            break;
+        case 1003:
+            s->loop_config.spin_budget_us = (uint32_t)atoi(arg);
+            break;
+        case 1004:
+            s->loop_config.busy_poll_us = (uint32_t)atoi(arg);
+            break;
+        case 1035:
+            snprintf(s->control_path, sizeof(s->control_path), "%s", arg);
+            break;
+        case 1036: {
+            const char* colon = strrchr(arg, ':');
+            if (!colon || colon == arg || (size_t)(colon - arg) >= sizeof(s->event_ip) ||
+                (s->event_port = atoi(colon + 1)) <= 0 || s->event_port > 65535) {
+                fprintf(stderr, "[ERROR] Invalid event target '%s' (expected IP:PORT)\n", arg);
+                return -1;
+            }
+            memcpy(s->event_ip, arg, colon - arg);
+            s->event_ip[colon - arg] = '\0';
+            break;
+        }
+        case 1037:
+            if (strcmp(arg, "none") == 0) {
+                memset(&s->export_filter, 0, sizeof(s->export_filter));
+            } else if (parse_packet_filter(arg, &s->export_filter) != 0) {
+                fprintf(stderr, "[ERROR] Invalid export filter '%s'\n", arg);
+                return -1;
+            }
+            break;
+        case 1038:
+            if (parse_log_level(arg, &s->log_level) != 0) {
+                fprintf(stderr, "[ERROR] Unknown log level '%s'\n", arg);
+                return -1;
+            }
+            break;
+        case 1039:
+            s->overload = 1;
+            break;
+        case 1040:
+            // Recovery needs the delay well below the trigger
+            s->overload_config.lag_high_us = (uint32_t)atoi(arg) * 1000;
+            s->overload_config.lag_low_us = s->overload_config.lag_high_us / 10;
+            break;
+        case 1041:
+            s->overload_config.queue_high = (size_t)atoi(arg);
+            s->overload_config.queue_low = s->overload_config.queue_high / 8;
+            break;
+        case 1042:
+            s->vlan = 1;
+            break;
+        case 1043:
+            s->ipv4_only = 1;
+            break;
+        case 1044:
+            s->detect = 1;
+            break;
+        case 1045:
+            s->detect_config.syn_pps = (uint32_t)atoi(arg);
+            break;
+        case 1046:
+            s->detect_config.icmp_pps = (uint32_t)atoi(arg);
+            break;
+        case 1047:
+            s->detect_config.scan_hosts = (uint32_t)atoi(arg);
+            s->detect_config.scan_ports = s->detect_config.scan_hosts;
+            break;
+        case 1048:
+            s->detect_config.deauth_pps = (uint32_t)atoi(arg);
+            break;
+        case 1049:
+            if (parse_record_format(arg, &s->record_format) != 0) {
+                fprintf(stderr, "[ERROR] Unknown record format '%s'\n", arg);
+                return -1;
+            }
+            break;
+        default:
+            return -1;
+    }
+    return 0;
+}
+
+static int add_interface(Settings* s, const char* name) {
+    if (s->interface_count >= MAX_CAPTURE_SOURCES || strlen(name) >= IFNAMSIZ) return -1;
+    snprintf(s->interfaces[s->interface_count++], IFNAMSIZ, "%s", name);
+    return 0;
+}
+
+// Config file line: "option = value" (long option name), "flag [= yes|no]" or "interface = NAME"
+static int config_entry(const char* key, const char* value, void* user) {
+    Settings* s = (Settings*)user;
+
+    if (strcmp(key, "interface") == 0) {
+        return value ? add_interface(s, value) : -1;
+    }
+
+    for (const struct option* o = long_options; o->name; o++) {
+        if (strcmp(o->name, key) != 0) continue;
+        if (o->val == 'c' || o->val == 'h') return -1;
+
+        if (o->has_arg == no_argument) {
+            if (value && (strcmp(value, "no") == 0 || strcmp(value, "false") == 0 ||
+                          strcmp(value, "off") == 0 || strcmp(value, "0") == 0)) {
+                return 0;
+            }
+            return apply_option(s, o->val, NULL);
+        }
+        return value ? apply_option(s, o->val, value) : -1;
+    }
+    return -1;
+}
+
+/**
+ * @brief Applies the command line over @p s; interfaces given there replace the file's.
+ * @return 0 on success, -1 on an invalid option.
+ */
+static int parse_command_line(int argc, char** argv, Settings* s) {
+    int interfaces = 0;
+    int opt;
+
+    optind = 0; // Full rescan (also on reload)
+    opterr = 1;
+    while ((opt = getopt_long(argc, argv, short_options, long_options, NULL)) != -1) {
+        if (opt == 'c') continue; // Read first, by load_settings()
+        if (opt == 'h' || opt == '?') {
+            print_usage(argv[0]);
+            return -1;
+        }
+        if (apply_option(s, opt, optarg) != 0) {
+            return -1;
+        }
+    }
+
+    for (int i = optind; i < argc; i++) {
+        if (interfaces++ == 0) s->interface_count = 0;
+        if (add_interface(s, argv[i]) != 0) return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Defaults, then the config file named by -c, then the rest of the command line.
+ */
+static int load_settings(int argc, char** argv, Settings* s) {
+    settings_defaults(s);
+
+    int opt;
+    optind = 0;
+    opterr = 0; // Reported by the full pass
+    while ((opt = getopt_long(argc, argv, short_options, long_options, NULL)) != -1) {
+        if (opt == 'c') snprintf(s->config_path, sizeof(s->config_path), "%s", optarg);
+    }
+
+    if (s->config_path[0] && config_file_read(s->config_path, config_entry, s) != 0) {
+        return -1;
+    }
+    return parse_command_line(argc, argv, s);
+}
+
+static void build_runtime_config(const Settings* s, RuntimeConfig* config) {
+    memset(config, 0, sizeof(*config));
+    config->sampling = s->sampling;
+    config->export_filter = s->export_filter;
+    config->trigger_filter = s->tm_config.filter;
+}
+
+// Clears what a reload can change, so the rest can be compared
+static void clear_reloadable(Settings* s, int keep_collector) {
+    memset(&s->sampling, 0, sizeof(s->sampling));
+    memset(&s->export_filter, 0, sizeof(s->export_filter));
+    memset(&s->tm_config.filter, 0, sizeof(s->tm_config.filter));
+    s->log_level = LOG_LEVEL_INFO;
+    memset(s->event_ip, 0, sizeof(s->event_ip));
+    s->event_port = 0;
+    if (!keep_collector) {
+        memset(s->collector_ip, 0, sizeof(s->collector_ip));
+        s->collector_port = 0;
+    }
+}
+
+/**
+ * @brief Control thread: re-reads the config file and command line, applies what can change live.
+ */
+static int reload_settings(char* reply, size_t len) {
+    static Settings next;
+    if (load_settings(g_argc, g_argv, &next) != 0) {
+        snprintf(reply, len, "invalid settings in %s (details on stderr), nothing changed", g_settings.config_path);
+        return -1;
+    }
+
+    RuntimeConfig config;
+    build_runtime_config(&next, &config);
+    uint64_t generation = runtime_config_publish(&config);
+    if (generation == 0) {
+        snprintf(reply, len, "out of memory, nothing changed");
+        return -1;
+    }
+
+    // The file wins over earlier control socket changes, as for the snapshot
+    char events[80], collector[80], wanted[80];
+    logger_targets(events, sizeof(events), collector, sizeof(collector));
+    logger_set_level(next.log_level);
+    snprintf(wanted, sizeof(wanted), "%s:%d", next.event_ip, next.event_port);
+    if (strcmp(wanted, events) != 0) {
+        logger_set_event_target(next.event_ip, next.event_port);
+    }
+    // The collector can move, but flow export cannot be switched on or off live
+    int collector_live = g_settings.collector_port > 0 && next.collector_port > 0;
+    snprintf(wanted, sizeof(wanted), "%s:%d", next.collector_ip, next.collector_port);
+    if (collector_live && strcmp(wanted, collector) != 0) {
+        logger_set_flow_collector(next.collector_ip, next.collector_port);
+    }
+
+    static Settings before, after;
+    before = g_settings;
+    after = next;
+    clear_reloadable(&before, !collector_live);
+    clear_reloadable(&after, !collector_live);
+    int restart = memcmp(&before, &after, sizeof(Settings)) != 0;
+
+    // Keep the live values, so the next reload compares against them
+    g_settings.sampling = next.sampling;
+    g_settings.export_filter = next.export_filter;
+    g_settings.tm_config.filter = next.tm_config.filter;
+    g_settings.log_level = next.log_level;
+    memcpy(g_settings.event_ip, next.event_ip, sizeof(g_settings.event_ip));
+    g_settings.event_port = next.event_port;
+    if (collector_live) {
+        memcpy(g_settings.collector_ip, next.collector_ip, sizeof(g_settings.collector_ip));
+        g_settings.collector_port = next.collector_port;
+    }
+
+    snprintf(reply, len, "generation %llu%s", (unsigned long long)generation,
+             restart ? "; other changed settings take effect after a restart" : "");
+    return 0;
+}
+
 int main(int argc, char** argv) {
     // Disable stdout buffering for immediate log output
     setbuf(stdout, NULL);
-    
-    if (argc != 2) {
-        printf("Usage: %s <interface>\n", argv[0]);
+
+    Settings* s = &g_settings;
+    g_argc = argc;
+    g_argv = argv;
+    if (load_settings(argc, argv, s) != 0) {
+        return 1;
+    }
+
+    int count = s->interface_count;
+    if (count < 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    set_sampling_config(&s->sampling);
+    set_xdp_config(&s->xdp_config);
+    set_ring_config(&s->ring_config);
+
+    // Pools and tables follow the first NIC's NUMA node
+    numa_set_default_node(numa_node_of_interface(s->interfaces[0]));
+
+    // The exporter runs on the logger thread, so it must exist before the logger starts
+    if (s->collector_port > 0) {
+        if (init_flow_exporter(s->collector_ip, s->collector_port, s->flow_format) != 0) {
+            return 1;
+        }
+        logger_set_flow_collector(s->collector_ip, s->collector_port);
+    }
+    if (logger_set_event_target(s->event_ip, s->event_port) != 0) {
+        fprintf(stderr, "[ERROR] Invalid event target %s:%d\n", s->event_ip, s->event_port);
         return 1;
     }
+    logger_set_level(s->log_level);
+    udp_sender_set_format(s->record_format);
+
+    // Capture threads pick up later changes to these between batches
+    RuntimeConfig runtime;
+    build_runtime_config(s, &runtime);
+    if (runtime_config_init(&runtime) != 0) {
+        return 1;
+    }
+
+    if (s->dedup) {
+        set_dedup(&s->dedup_config);
+    }
+
+    set_checksum_verification(s->checksums);
+    set_vlan_parsing(s->vlan);
+    set_ipv6_parsing(!s->ipv4_only);
+
+    if (s->recording) {
+        set_packet_recording(&s->recorder_config);
+    }
+
+    if (s->time_machine) {
+        set_time_machine(&s->tm_config);
+    }
+
+    if (s->archive) {
+        set_metadata_archive(&s->archive_config);
+    }
+
+    if (s->overload) {
+        set_overload_control(&s->overload_config);
+    }
+
+    if (s->detect) {
+        set_threat_detection(&s->detect_config);
+    }
+
+    if (s->dns) {
+        set_dns_analysis(&s->dns_config);
+    }
+
+    if (s->tls) {
+        set_tls_fingerprinting(1);
+    }
+
+    if (s->http) {
+        set_http_analysis(&s->http_config);
+    }
+
+    // The exporter and the archive consume flow records; stream parsers hang their sessions on flows
+    if (s->collector_port > 0 || s->archive || tcp_reassembly_parser_count() > 0) {
+        set_flow_tracking(&s->flow_timeouts);
+        set_tcp_reassembly(&s->reassembly);
+    }
 
     init_logger();
+    init_traffic_stats(1000);
+    if (s->checksums) {
+        log_message("[INFO] Checksum verification: %s summation\n", csum_implementation());
+    }
+    if (s->ring_config.snaplen > 0 && (s->dns || s->tls || s->http)) {
+        log_message("[WARN] Snaplen %u truncates payloads: DNS/TLS/HTTP decoding sees partial data\n",
+                    s->ring_config.snaplen);
+    }
+    if (s->tls && !quic_decryption_available()) {
+        log_message("[INFO] Built without libcrypto: QUIC ClientHellos are not decoded\n");
+    }
     signal(SIGINT, handle_signal);
+    if (s->time_machine) {
+        signal(SIGUSR2, handle_dump_signal);
+    }
 
-    const char* interface = argv[1];
-    
-    // Detect monitor mode using Kernel IOCTL (Robust)
-    int is_monitor = is_interface_monitor_mode(interface);
-    set_monitor_mode(is_monitor);
-    
-    log_message("[INFO] Initializing Sniffer on %s (%s mode)...\n", 
-                interface, is_monitor ? "Monitor" : "Managed");
-
-    // 1. Create Socket (Standard)
-    int sock_fd = create_raw_socket(interface);
-    if (sock_fd == -1) return 1;
-
-    // 2. Setup Zero-Copy Engine
-    if (setup_zero_copy_ring(sock_fd) != 0) {
-        close_raw_socket(sock_fd, interface);
-        return 1;
+    CaptureSource sources[MAX_CAPTURE_SOURCES];
+    memset(sources, 0, sizeof(sources));
+    int initialized = 0;
+    int opened = 0;
+    int status = 0;
+
+    for (int i = 0; i < count; i++) {
+        CaptureSource *src = &sources[i];
+        strncpy(src->name, s->interfaces[i], IFNAMSIZ - 1);
+        src->numa_node = numa_node_of_interface(src->name);
+
+        // Detect monitor mode using Kernel IOCTL (Robust), per interface
+        int is_monitor = is_interface_monitor_mode(src->name);
+        int rc = init_parser_context(&src->parser, i, is_monitor);
+        initialized++; // A failed init is partly set up: it is cleaned up too
+        if (rc != 0) {
+            fprintf(stderr, "[ERROR] Out of memory for parser context\n");
+            status = 1;
+            break;
+        }
+
+        log_message("[INFO] Initializing Sniffer on %s (ID %d, %s mode)...\n",
+                    src->name, i, is_monitor ? "Monitor" : "Managed");
+
+        // 1. Open Socket + Zero-Copy Ring through the backend
+        // Radiotap sources stay on AF_PACKET: XDP redirect would steal the radio's frames
+        src->backend = is_monitor ? &mmap_capture_backend : s->backend;
+        if (src->backend->open(src) != 0) {
+            status = 1;
+            break;
+        }
+        opened++;
     }
 
-    // 3. Start The Loop (Blocking)
-    start_zero_copy_capture(sock_fd);
+    // Control plane: the socket, and reloads of the config file
+    if (status == 0 && (s->control_path[0] || s->config_path[0])) {
+        if (control_start(s->control_path[0] ? s->control_path : NULL,
+                          s->config_path[0] ? reload_settings : NULL) != 0) {
+            status = 1;
+        } else if (s->config_path[0]) {
+            signal(SIGHUP, handle_reload_signal);
+        }
+    }
 
-    // 4. Cleanup
-    cleanup_zero_copy_ring();
-    close_raw_socket(sock_fd, interface);
+    // 2. Start The Loop (Blocking)
+    if (status == 0) {
+        start_zero_copy_capture(sources, count, &s->loop_config);
+    }
+    control_stop();
+
+    // 3. Cleanup
+    for (int i = 0; i < opened; i++) {
+        sources[i].backend->close(&sources[i]);
+    }
+    for (int i = 0; i < initialized; i++) {
+        cleanup_parser_context(&sources[i].parser);
+    }
+    runtime_config_cleanup();
+    cleanup_traffic_stats();
     cleanup_logger();
 
-    printf("Sniffer stopped gracefully.\n");
-    return 0;
-}
\ No newline at end of file
+    if (status == 0) {
+        printf("Sniffer stopped gracefully.\n");
+    }
+    return status;
+}
@@ -1,10 +1,12 @@
-from time import sleep
+from time import monotonic
 from rich.live import Live
 
 # Import local modules
 from data_listener import PacketListener
 import ui_renderer
 
+RENDER_INTERVAL = 0.25 # Seconds between table rebuilds (matches the Live refresh rate)
+
 def main():
     # 1. Initialize UDP listener
     listener = PacketListener()
@@ -15,26 +17,34 @@ def main():
     
     # 3. Main loop
     with Live(layout, refresh_per_second=4, screen=True):
+        next_render = 0.0
         while True:
             try:
-                # A. Fetch new data
+                # A. Fetch new data (keeps draining between redraws)
                 listener.fetch_packets()
-                
-                # B. Update UI components
-                table = ui_renderer.render_packet_table(listener.get_history())
-                stats = ui_renderer.render_stats_panel(
-                    listener.get_top_talkers(),
-                    listener.get_protocol_stats(),
-                    listener.get_total_traffic()
-                )
-                
-                # C. Update layout
-                layout["packets"].update(table)
-                layout["stats"].update(stats)
-                
-                # D. Short sleep for CPU
-                sleep(0.1)
-                
+
+                now = monotonic()
+                if now >= next_render:
+                    # B. Update UI components
+                    table = ui_renderer.render_packet_table(listener.get_history())
+                    stats = ui_renderer.render_stats_panel(
+                        listener.get_top_talkers(),
+                        listener.get_protocol_stats(),
+                        listener.get_total_traffic(),
+                        listener.get_top_ports(),
+                        listener.get_distinct_counts(),
+                        listener.get_alerts(),
+                        listener.get_batches_lost()
+                    )
+
+                    # C. Update layout
+                    layout["packets"].update(table)
+                    layout["stats"].update(stats)
+                    next_render = now + RENDER_INTERVAL
+
+                # D. Sleep until more data arrives
+                listener.wait(0.05)
+
             except KeyboardInterrupt:
                 break
 
@@ -0,0 +1,110 @@
+"""
+Compares the packets per second each capture backend sustains on a veth pair.
+
+Usage (root):
+    ip link add vb0 type veth peer name vb1 && ip link set vb0 up && ip link set vb1 up
+    sudo python3 python/bench_backends.py --tx vb0 --rx vb1 [--seconds 5] [--backends mmap,xdp]
+
+For every backend the sniffer is started on the RX end, a raw-socket sender floods
+the TX end with small UDP frames, and the sniffer's "capture_loop" events (sent to
+127.0.0.1:5005) are averaged. Per-packet export is sampled away so the export path
+does not limit the capture rate.
+"""
+import argparse
+import json
+import socket
+import struct
+import subprocess
+import threading
+import time
+
+EVENT_PORT = 5005
+
+
+def build_frame(index):
+    """Ethernet/IPv4/UDP frame, 64 bytes on the wire, source rotated over 256 hosts."""
+    payload = b"\x00" * 18
+    udp = struct.pack("!HHHH", 1000 + index % 64, 9999, 8 + len(payload), 0) + payload
+    ip = struct.pack("!BBHHHBBH4s4s", 0x45, 0, 20 + len(udp), 0, 0, 64, 17, 0,
+                     bytes([10, 0, 0, index % 256]), bytes([10, 0, 1, 1]))
+    return b"\xff" * 6 + b"\x02\x00\x00\x00\x00\x01" + b"\x08\x00" + ip + udp
+
+
+def flood(iface, seconds):
+    sock = socket.socket(socket.AF_PACKET, socket.SOCK_RAW)
+    sock.bind((iface, 0))
+    frames = [build_frame(i) for i in range(256)]
+    sent = 0
+    end = time.time() + seconds
+    while time.time() < end:
+        for frame in frames:
+            sock.send(frame)
+        sent += len(frames)
+    sock.close()
+    return sent
+
+
+def collect_events(stop, events):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("127.0.0.1", EVENT_PORT))
+    sock.settimeout(0.2)
+    while not stop.is_set():
+        try:
+            data, _ = sock.recvfrom(65535)
+        except socket.timeout:
+            continue
+        record = json.loads(data)
+        if record.get("event") == "capture_loop":
+            events.append(record)
+    sock.close()
+
+
+def run_backend(args, backend):
+    events = []
+    stop = threading.Event()
+    listener = threading.Thread(target=collect_events, args=(stop, events))
+    listener.start()
+
+    sniffer = subprocess.Popen([args.sniffer, "--backend", backend, "--wait", args.wait,
+                                "--sample", "count:1000000", args.rx],
+                               stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    time.sleep(1.0)
+    start = len(events)
+    sent = flood(args.tx, args.seconds)
+    time.sleep(0.5)
+    sniffer.send_signal(2)  # SIGINT: graceful stop (the loop reports its last partial interval)
+    sniffer.wait()
+    time.sleep(0.3)
+    stop.set()
+    listener.join()
+    busy = events[start:]
+
+    captured = sum(e["packets"] for e in busy)
+    full = [e for e in busy if e["packets"] > 0]
+    pps = sum(e["pps"] for e in full) / len(full) if full else 0.0
+    cpu = sum(e["cpu_pct"] for e in full) / len(full) if full else 0.0
+    return {"backend": backend, "sent_pps": sent / args.seconds, "captured_pps": pps,
+            "captured": captured, "sent": sent, "cpu_pct": cpu}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--tx", required=True, help="veth end the traffic is sent on")
+    parser.add_argument("--rx", required=True, help="veth peer the sniffer captures")
+    parser.add_argument("--seconds", type=float, default=5.0)
+    parser.add_argument("--backends", default="mmap,xdp")
+    parser.add_argument("--wait", default="poll", help="sniffer wait strategy")
+    parser.add_argument("--sniffer", default="./build/Sniffer")
+    args = parser.parse_args()
+
+    results = [run_backend(args, b) for b in args.backends.split(",")]
+
+    print(f"{'backend':<8} {'sent pps':>12} {'captured pps':>14} {'captured':>10} {'loss %':>8} {'cpu %':>7}")
+    for r in results:
+        loss = 100.0 * (1 - r["captured"] / r["sent"]) if r["sent"] else 0.0
+        print(f"{r['backend']:<8} {r['sent_pps']:>12.0f} {r['captured_pps']:>14.0f} "
+              f"{r['captured']:>10} {max(loss, 0.0):>8.2f} {r['cpu_pct']:>7.1f}")
+
+
+if __name__ == "__main__":
+    main()
@@ -1,71 +1,262 @@
 import socket
 import json
+import select
+import struct
 from collections import Counter, deque
 from datetime import datetime
 
+import numpy as np
+
+# --- Binary packet records (sniffer --record-format binary, see common/udp_sender.h) ---
+BATCH_MAGIC = b'SPB1'
+BATCH_HEADER = struct.Struct('<4sBBHHHI')   # magic, version, reserved, count, record_size, reserved, sequence
+
+RECORD_FIELDS = [
+    ('timestamp_ns', '<u8'),
+    ('src_addr', 'u1', (16,)),
+    ('dest_addr', 'u1', (16,)),
+    ('src_mac', 'u1', (6,)),
+    ('dest_mac', 'u1', (6,)),
+    ('size', '<u4'),
+    ('sampling_rate', '<u4'),
+    ('src_port', '<u2'),
+    ('dest_port', '<u2'),
+    ('ether_type', '<u2'),
+    ('channel', '<u2'),
+    ('ip_version', 'u1'),
+    ('l3_protocol', 'u1'),
+    ('tcp_flags', 'u1'),
+    ('csum_flags', 'u1'),
+    ('if_id', 'u1'),
+    ('proto', 'u1'),
+    ('subtype', 'u1'),
+    ('signal_dbm', 'i1'),
+    ('ssid', 'S32'),
+]
+RECORD_DTYPE = np.dtype(RECORD_FIELDS)
+assert RECORD_DTYPE.itemsize == 108
+
+# RecordProto / RecordSubtype codes, in order
+PROTO_NAMES = ["Other", "802.11", "ARP", "TCP", "UDP", "ICMP", "IGMP", "IPv4", "ICMPv6", "IPv6"]
+SUBTYPE_NAMES = ["", "PROBE_REQ", "DATA", "EAPOL", "BEACON"]
+PROTO_80211 = PROTO_NAMES.index("802.11")
+
+# Breakdown keys: the protocol, or the subtype for WiFi records (as for JSON records)
+KEY_NAMES = PROTO_NAMES + [name or "Unknown" for name in SUBTYPE_NAMES]
+
+_dtypes = {RECORD_DTYPE.itemsize: RECORD_DTYPE}
+
+
+def record_dtype(record_size):
+    """Record layout for a given stride: a newer sniffer may append fields, which are skipped"""
+    if record_size not in _dtypes:
+        if record_size < RECORD_DTYPE.itemsize:
+            return None
+        _dtypes[record_size] = np.dtype({'names': RECORD_DTYPE.names,
+                                         'formats': [RECORD_DTYPE.fields[n][0] for n in RECORD_DTYPE.names],
+                                         'offsets': [RECORD_DTYPE.fields[n][1] for n in RECORD_DTYPE.names],
+                                         'itemsize': record_size})
+    return _dtypes[record_size]
+
+
+def batch_header(data):
+    """Returns (count, record_size, sequence) of a binary batch datagram, or None"""
+    if len(data) < BATCH_HEADER.size or data[:4] != BATCH_MAGIC:
+        return None
+    _, _, _, count, record_size, _, sequence = BATCH_HEADER.unpack_from(data)
+    if record_dtype(record_size) is None or BATCH_HEADER.size + count * record_size > len(data):
+        return None
+    return count, record_size, sequence
+
+
+def decode_batch(data):
+    """Returns (sequence, records array) of a binary batch datagram, or None"""
+    header = batch_header(data)
+    if header is None:
+        return None
+    count, record_size, sequence = header
+    return sequence, np.frombuffer(data, dtype=record_dtype(record_size), count=count, offset=BATCH_HEADER.size)
+
+
+def _address(version, raw):
+    if version == 4:
+        return socket.inet_ntop(socket.AF_INET, raw[:4])
+    if version == 6:
+        return socket.inet_ntop(socket.AF_INET6, raw)
+    return ""
+
+
+def record_to_dict(rec):
+    """Converts one binary record to the JSON record's keys (only done for displayed rows)"""
+    proto = int(rec['proto'])
+    subtype = int(rec['subtype'])
+    version = int(rec['ip_version'])
+    return {
+        'src_mac': rec['src_mac'].tobytes().hex(':').upper(),
+        'dest_mac': rec['dest_mac'].tobytes().hex(':').upper(),
+        'src_ip': _address(version, rec['src_addr'].tobytes()),
+        'dest_ip': _address(version, rec['dest_addr'].tobytes()),
+        'type': PROTO_NAMES[proto] if proto < len(PROTO_NAMES) else "Other",
+        'subtype': SUBTYPE_NAMES[subtype] if subtype < len(SUBTYPE_NAMES) else "",
+        'src_port': int(rec['src_port']),
+        'dest_port': int(rec['dest_port']),
+        'tcp_flags': int(rec['tcp_flags']),
+        'size': int(rec['size']),
+        'is_monitor': int(proto == PROTO_80211),
+        'signal_dbm': int(rec['signal_dbm']),
+        'channel': int(rec['channel']),
+        'ssid': rec['ssid'].decode('utf-8', 'replace'),
+        'if_id': int(rec['if_id']),
+        'sampling_rate': int(rec['sampling_rate']),
+        'csum_flags': int(rec['csum_flags']),
+        'timestamp': datetime.fromtimestamp(int(rec['timestamp_ns']) / 1e9).strftime("%H:%M:%S"),
+    }
+
+
 class PacketListener:
     """
     Listens for UDP connection from C Sniffer and processes data.
+
+    Binary batches are decoded with numpy and aggregated per batch; only the
+    rows on screen are turned into dicts. JSON records and events still work.
     """
-    def __init__(self, ip="127.0.0.1", port=5005, history_size=25):
+    def __init__(self, ip="127.0.0.1", port=5005, history_size=25, rcvbuf=16 << 20):
         # Create socket
         self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, rcvbuf) # Absorb bursts between redraws
         self.sock.bind((ip, port))
         self.sock.setblocking(False) # Prevent interface blocking
-        
+
         # Data structures
         self.history = deque(maxlen=history_size) # Keep only last 25
-        self.ip_counter = Counter()               # Count addresses (IP or MAC)
-        self.protocol_counter = Counter()         # Count protocols
-        self.total_bytes = 0
+        self.protocol_counter = Counter()         # Count protocols (JSON records)
+        self.key_counts = np.zeros(len(KEY_NAMES)) # Count protocols (binary records, by KEY_NAMES index)
+        self.snapshot = {}                        # Latest C-side stats snapshot (top-K, distinct counts)
+        self.alerts = deque(maxlen=5)             # Latest threat detector alerts
+        self.next_sequence = None                 # Expected binary batch number
+        self.batches_lost = 0
+
+    def wait(self, timeout):
+        """Sleeps until data arrives or the timeout expires"""
+        select.select([self.sock], [], [], timeout)
 
-    def fetch_packets(self):
-        """Reads all packets accumulated in buffer"""
-        while True:
+    def fetch_packets(self, budget=65536):
+        """Reads the datagrams accumulated in buffer (at most budget, so the screen still refreshes)"""
+        batches = []
+        now = datetime.now().strftime("%H:%M:%S")
+        for _ in range(budget):
             try:
-                data, _ = self.sock.recvfrom(4096)
-                packet = json.loads(data.decode('utf-8'))
-                
-                # Add local time for display
-                packet['timestamp'] = datetime.now().strftime("%H:%M:%S")
-                
-                self._update_stats(packet)
-                
+                data = self.sock.recv(65535)
             except BlockingIOError:
                 break # No more data at the moment
-            except json.JSONDecodeError as e:
+
+            if data[:4] == BATCH_MAGIC:
+                batches.append(data)
+                continue
+
+            try:
+                packet = json.loads(data)
+            except (json.JSONDecodeError, UnicodeDecodeError) as e:
                 print(f"[ERROR] JSON decode failed: {e}")
                 print(f"[ERROR] Raw data: {data[:200]}")
                 continue
-            except Exception as e:
-                print(f"[ERROR] Unexpected error: {e}")
+
+            # Periodic analytics computed by the sniffer itself
+            event = packet.get('event')
+            if event == 'stats':
+                self.snapshot = packet
+                continue
+            if event == 'alert':
+                packet['timestamp'] = now
+                self.alerts.append(packet)
+                continue
+            if event:
+                continue # Other events are not packets
+
+            # Add local time for display
+            packet['timestamp'] = now
+            self._update_stats(packet)
+
+        if batches:
+            self._ingest_batches(batches)
+
+    def _ingest_batches(self, batches):
+        # One array per record size (a single one unless the sniffer was upgraded mid-run):
+        # joining the payloads and decoding once is far cheaper than concatenating arrays
+        payloads = {}
+        for data in batches:
+            header = batch_header(data)
+            if header is None:
                 continue
+            count, record_size, sequence = header
+            self._track_sequence(sequence)
+            payloads.setdefault(record_size, []).append(data[BATCH_HEADER.size:BATCH_HEADER.size + count * record_size])
+
+        for record_size, chunks in payloads.items():
+            records = np.frombuffer(b''.join(chunks), dtype=record_dtype(record_size))
+            self._aggregate(records)
+
+    def _aggregate(self, records):
+        # Breakdown for the whole burst at once; a sampled record stands for sampling_rate packets
+        proto = records['proto']
+        subtype = records['subtype']
+        proto = np.where(proto < len(PROTO_NAMES), proto, 0)
+        subtype = np.where(subtype < len(SUBTYPE_NAMES), subtype, 0)
+        keys = np.where(proto == PROTO_80211, len(PROTO_NAMES) + subtype, proto)
+        weights = np.maximum(records['sampling_rate'], 1)
+        self.key_counts += np.bincount(keys, weights=weights, minlength=len(KEY_NAMES))
+
+        for rec in records[-self.history.maxlen:]:
+            self.history.append(record_to_dict(rec))
+
+    def _track_sequence(self, sequence):
+        if self.next_sequence is not None:
+            gap = (sequence - self.next_sequence) & 0xFFFFFFFF
+            if gap < 0x80000000:
+                self.batches_lost += gap
+            # Otherwise the sniffer restarted and counts from 0 again
+        self.next_sequence = (sequence + 1) & 0xFFFFFFFF
 
     def _update_stats(self, packet):
         self.history.append(packet)
-        self.total_bytes += packet.get('size', 0)
-        
+
         # Identify protocol type for statistics
         # If WiFi, use subtype (e.g. BEACON), otherwise type (e.g. TCP)
         p_type = packet.get('subtype') if packet.get('type') == '802.11' else packet.get('type')
         if not p_type: p_type = "Unknown"
-        self.protocol_counter[p_type] += 1
-        
-        # Count source (MAC for WiFi, IP for Ethernet)
-        src = packet.get('src_mac') if packet.get('type') == '802.11' else packet.get('src_ip')
-        
-        if src and src != "N/A":
-            self.ip_counter[src] += 1
+
+        # A sampled record stands for sampling_rate packets
+        self.protocol_counter[p_type] += packet.get('sampling_rate', 1) or 1
 
     # --- Getters ---
     def get_history(self):
         return self.history
 
     def get_top_talkers(self, n=10):
-        return self.ip_counter.most_common(n)
+        # Sources are ranked in C (Space-Saving sketch); MAC for WiFi, IP for Ethernet
+        return [tuple(entry) for entry in self.snapshot.get('top_src', [])[:n]]
+
+    def get_top_ports(self, n=5):
+        return [tuple(entry) for entry in self.snapshot.get('top_ports', [])[:n]]
+
+    def get_distinct_counts(self):
+        return {
+            'src': self.snapshot.get('distinct_src', 0),
+            'dst': self.snapshot.get('distinct_dst', 0),
+            'conv': self.snapshot.get('distinct_conv', 0),
+        }
+
+    def get_alerts(self):
+        return list(self.alerts)
+
+    def get_batches_lost(self):
+        return self.batches_lost
 
     def get_protocol_stats(self):
-        return self.protocol_counter.most_common()
+        counts = Counter(self.protocol_counter)
+        for index in np.flatnonzero(self.key_counts):
+            counts[KEY_NAMES[index]] += int(self.key_counts[index])
+        return counts.most_common()
 
     def get_total_traffic(self):
-        return self.total_bytes
\ No newline at end of file
+        return self.snapshot.get('bytes', 0)
@@ -0,0 +1,202 @@
+"""
+End-to-end throughput report: offered load vs. captured vs. dropped vs. exported.
+
+Usage (root):
+    sudo python3 python/e2e_report.py --rates 100000,300000,0 [--seconds 5] [--size 60]
+        [--pcap FILE] [--method ring|mmsg] [--sniffer-args "--checksums --sample count:10"]
+
+A veth pair is created with one end in a private network namespace. SnifferGen
+runs inside the namespace and sends synthetic (or --pcap) frames at each target
+rate (0 = as fast as possible); the sniffer captures the peer end in the root
+namespace and exports to a local collector. Every stage is counted:
+
+    offered     frames SnifferGen handed to the kernel
+    link drop   frames the veth pair dropped (tx end + rx end)
+    delivered   frames that reached the capture interface
+    captured    frames the sniffer processed ("capture_loop" events)
+    ring drop   frames the kernel dropped for lack of ring space
+    exported    packet records received by the collector, scaled by their sampling_rate
+                (JSON or --record-format binary batches)
+    rcvbuf      records lost in the collector's own socket buffer (UDP RcvbufErrors)
+
+The namespace and the veth pair are removed at exit.
+"""
+import argparse
+import json
+import re
+import shlex
+import socket
+import subprocess
+import threading
+import time
+
+SAMPLING_RATE = re.compile(rb'"sampling_rate":\s*(\d+)')
+
+
+def run(*cmd, check=True):
+    return subprocess.run(cmd, check=check, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+
+
+def setup_link(netns, rx, tx):
+    run("ip", "netns", "add", netns)
+    run("ip", "link", "add", rx, "type", "veth", "peer", "name", tx, "netns", netns)
+    run("ip", "link", "set", rx, "up")
+    run("ip", "-n", netns, "link", "set", tx, "up")
+    run("ip", "-n", netns, "link", "set", "lo", "up")
+    # Keep IPv6 neighbour discovery out of the counts
+    try:
+        with open(f"/proc/sys/net/ipv6/conf/{rx}/disable_ipv6", "w") as f:
+            f.write("1")
+    except OSError:
+        pass
+
+
+def teardown_link(netns, rx):
+    run("ip", "netns", "del", netns, check=False)
+    run("ip", "link", "del", rx, check=False)
+
+
+def link_stats(dev, netns=None):
+    cmd = ["ip"] + (["-n", netns] if netns else []) + ["-j", "-s", "link", "show", "dev", dev]
+    stats = json.loads(run(*cmd).stdout)[0]["stats64"]
+    return {"rx": stats["rx"]["packets"], "rx_dropped": stats["rx"]["dropped"],
+            "tx": stats["tx"]["packets"], "tx_dropped": stats["tx"]["dropped"]}
+
+
+def udp_rcvbuf_errors():
+    with open("/proc/net/snmp") as f:
+        rows = [line.split() for line in f if line.startswith("Udp:")]
+    return int(rows[1][rows[0].index("RcvbufErrors")])
+
+
+class Collector(threading.Thread):
+    """Counts packet records and sums the capture_loop events of one run."""
+
+    def __init__(self, port):
+        super().__init__(daemon=True)
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 32 << 20)
+        self.sock.bind(("127.0.0.1", port))
+        self.sock.settimeout(0.2)
+        self.stop = threading.Event()
+        self.reset()
+
+    def reset(self):
+        self.records = 0
+        self.represented = 0
+        self.captured = 0
+        self.ring_drops = 0
+        self.cpu = []
+
+    def run(self):
+        while not self.stop.is_set():
+            try:
+                data, _ = self.sock.recvfrom(65535)
+            except socket.timeout:
+                continue
+            if data[:4] == b"SPB1":
+                from data_listener import decode_batch  # numpy, only needed for --record-format binary
+                batch = decode_batch(data)
+                if batch:
+                    self.records += len(batch[1])
+                    self.represented += int(batch[1]["sampling_rate"].clip(min=1).sum())
+                continue
+            if b'"event"' not in data:
+                match = SAMPLING_RATE.search(data)
+                self.records += 1
+                self.represented += int(match.group(1)) if match else 1
+                continue
+            record = json.loads(data)
+            if record.get("event") == "capture_loop":
+                self.captured += record["packets"]
+                self.ring_drops += record.get("drops", 0)
+                if record["packets"]:
+                    self.cpu.append(record["cpu_pct"])
+        self.sock.close()
+
+
+def run_rate(args, rate):
+    collector = Collector(args.port)
+    collector.start()
+    sniffer = subprocess.Popen([args.sniffer, "--events", f"127.0.0.1:{args.port}"]
+                               + shlex.split(args.sniffer_args) + [args.rx],
+                               stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    time.sleep(args.warmup)
+    collector.reset()
+    rx0, tx0 = link_stats(args.rx), link_stats(args.tx, args.netns)
+    rcvbuf0 = udp_rcvbuf_errors()
+
+    gen_cmd = ["ip", "netns", "exec", args.netns, args.gen, "-i", args.tx, "-p", str(rate),
+               "-s", str(args.seconds), "-l", str(args.size), "-f", str(args.flows), "-m", args.method, "-q"]
+    if args.pcap:
+        gen_cmd += ["-r", args.pcap]
+    generator = json.loads(run(*gen_cmd).stdout.strip().splitlines()[-1])
+
+    time.sleep(args.drain)
+    rx1, tx1 = link_stats(args.rx), link_stats(args.tx, args.netns)
+    sniffer.send_signal(2)  # SIGINT: the loop reports its last partial interval
+    sniffer.wait()
+    time.sleep(0.5)
+    collector.stop.set()
+    collector.join()
+
+    return {
+        "target_pps": rate,
+        "offered": generator["sent"],
+        "offered_pps": generator["pps"],
+        "link_drops": (tx1["tx_dropped"] - tx0["tx_dropped"]) + (rx1["rx_dropped"] - rx0["rx_dropped"]),
+        "delivered": rx1["rx"] - rx0["rx"],
+        "captured": collector.captured,
+        "ring_drops": collector.ring_drops,
+        "records": collector.records,
+        "exported": collector.represented,
+        "rcvbuf_errors": udp_rcvbuf_errors() - rcvbuf0,
+        "cpu_pct": sum(collector.cpu) / len(collector.cpu) if collector.cpu else 0.0,
+    }
+
+
+def print_report(results):
+    print(f"{'target pps':>10} {'offered pps':>12} {'offered':>10} {'link drop':>10} {'delivered':>10} "
+          f"{'captured':>10} {'ring drop':>10} {'exported':>10} {'rcvbuf':>8} {'loss %':>7} {'cpu %':>6}")
+    for r in results:
+        loss = 100.0 * (1 - r["exported"] / r["offered"]) if r["offered"] else 0.0
+        target = str(r["target_pps"]) if r["target_pps"] else "max"
+        print(f"{target:>10} {r['offered_pps']:>12.0f} {r['offered']:>10} {r['link_drops']:>10} "
+              f"{r['delivered']:>10} {r['captured']:>10} {r['ring_drops']:>10} {r['exported']:>10} "
+              f"{r['rcvbuf_errors']:>8} {max(loss, 0.0):>7.2f} {r['cpu_pct']:>6.1f}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--rates", default="100000,0", help="comma-separated target pps (0 = max)")
+    parser.add_argument("--seconds", type=float, default=5.0)
+    parser.add_argument("--size", type=int, default=60, help="synthetic frame size without FCS")
+    parser.add_argument("--flows", type=int, default=256)
+    parser.add_argument("--pcap", help="replay this Ethernet pcap instead of synthetic frames")
+    parser.add_argument("--method", default="ring", help="SnifferGen send method: ring or mmsg")
+    parser.add_argument("--sniffer-args", default="", help="extra sniffer options")
+    parser.add_argument("--sniffer", default="./build/Sniffer")
+    parser.add_argument("--gen", default="./build/SnifferGen")
+    parser.add_argument("--netns", default="sniffer-e2e")
+    parser.add_argument("--rx", default="e2e-rx", help="veth end the sniffer captures (root namespace)")
+    parser.add_argument("--tx", default="e2e-tx", help="veth end SnifferGen sends on (in --netns)")
+    parser.add_argument("--port", type=int, default=5005, help="collector port (sniffer --events)")
+    parser.add_argument("--warmup", type=float, default=1.5)
+    parser.add_argument("--drain", type=float, default=1.0)
+    parser.add_argument("--json", action="store_true", help="print the results as JSON")
+    args = parser.parse_args()
+
+    setup_link(args.netns, args.rx, args.tx)
+    try:
+        results = [run_rate(args, int(rate)) for rate in args.rates.split(",")]
+    finally:
+        teardown_link(args.netns, args.rx)
+
+    if args.json:
+        print(json.dumps(results, indent=2))
+    else:
+        print_report(results)
+
+
+if __name__ == "__main__":
+    main()
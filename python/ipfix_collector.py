@@ -0,0 +1,190 @@
+"""
+Minimal IPFIX / NetFlow v9 collector for checking the sniffer's flow export locally.
+
+Usage:
+    python3 python/ipfix_collector.py [--port 4739]
+
+Decodes template and data sets, prints each flow record and warns about
+sequence number gaps (lost or reordered export messages).
+"""
+import argparse
+import ipaddress
+import socket
+import struct
+
+# Information elements the sniffer exports: id -> name (reverse elements get a "reverse" prefix)
+IPFIX_NAMES = {
+    1: "octets", 2: "packets", 4: "proto", 6: "tcp_flags", 7: "src_port",
+    8: "src_ip", 10: "ingress_if", 11: "dst_port", 12: "dst_ip",
+    27: "src_ip", 28: "dst_ip", 136: "end_reason",
+    152: "start_ms", 153: "end_ms",
+}
+V9_NAMES = {
+    1: "octets", 2: "packets", 4: "proto", 6: "tcp_flags", 7: "src_port",
+    8: "src_ip", 10: "ingress_if", 11: "dst_port", 12: "dst_ip",
+    21: "last_switched", 22: "first_switched", 23: "reverse_octets",
+    24: "reverse_packets", 27: "src_ip", 28: "dst_ip",
+}
+# Enterprise elements carrying TCP performance and TLS details (SNIFFER_PEN in ipfix_exporter.c)
+SNIFFER_PEN = 32473
+SNIFFER_NAMES = {
+    1: "syn_rtt_us", 2: "ack_rtt_us", 3: "rtt_min_us", 4: "rtt_avg_us", 5: "rtt_max_us",
+    6: "rtt_samples", 7: "retrans", 8: "reverse_retrans", 9: "ooo", 10: "reverse_ooo",
+    11: "zero_win", 12: "reverse_zero_win", 13: "mss", 14: "reverse_mss",
+    15: "tls_version", 16: "tls_sni", 17: "tls_alpn", 18: "ja3",
+    19: "tls_cipher_count", 20: "tls_ciphers", 21: "tls_extension_count", 22: "tls_extensions",
+}
+LIST_FIELDS = {"tls_ciphers": "tls_cipher_count", "tls_extensions": "tls_extension_count"}
+STRING_FIELDS = ("tls_sni", "tls_alpn")
+END_REASONS = {1: "idle", 2: "active", 3: "end-of-flow", 4: "forced", 5: "lack-of-resources"}
+
+
+class Collector:
+    def __init__(self):
+        self.templates = {}       # (version, domain, template_id) -> [(name, length)]
+        self.expected_seq = {}    # (version, domain) -> next expected sequence number
+        self.records = 0
+
+    # --- Message Parsing ---
+    def handle(self, data):
+        version = struct.unpack_from("!H", data, 0)[0]
+        if version == 10:
+            self._handle_ipfix(data)
+        elif version == 9:
+            self._handle_v9(data)
+        else:
+            print(f"[WARN] Unknown export version {version}")
+
+    def _handle_ipfix(self, data):
+        _, length, export_time, seq, domain = struct.unpack_from("!HHIII", data, 0)
+        data_records = self._parse_sets(10, domain, data[16:length], template_set_id=2)
+        self._check_sequence(10, domain, seq, data_records)
+
+    def _handle_v9(self, data):
+        _, count, uptime, unix_secs, seq, source_id = struct.unpack_from("!HHIIII", data, 0)
+        self._parse_sets(9, source_id, data[20:], template_set_id=0)
+        # v9 sequence numbers count export packets, not records
+        self._check_sequence(9, source_id, seq, 1)
+
+    def _check_sequence(self, version, domain, seq, increment):
+        key = (version, domain)
+        expected = self.expected_seq.get(key)
+        if expected is not None and seq != expected:
+            print(f"[WARN] Sequence gap: expected {expected}, got {seq}")
+        self.expected_seq[key] = (seq + increment) & 0xFFFFFFFF
+
+    def _parse_sets(self, version, domain, body, template_set_id):
+        offset = 0
+        data_records = 0
+        while offset + 4 <= len(body):
+            set_id, set_len = struct.unpack_from("!HH", body, offset)
+            if set_len < 4:
+                break
+            payload = body[offset + 4: offset + set_len]
+            if set_id == template_set_id:
+                self._parse_templates(version, domain, payload)
+            elif set_id >= 256:
+                data_records += self._parse_data(version, domain, set_id, payload)
+            offset += set_len
+        return data_records
+
+    def _parse_templates(self, version, domain, payload):
+        offset = 0
+        names = IPFIX_NAMES if version == 10 else V9_NAMES
+        while offset + 4 <= len(payload):
+            template_id, field_count = struct.unpack_from("!HH", payload, offset)
+            offset += 4
+            fields = []
+            for _ in range(field_count):
+                field_id, length = struct.unpack_from("!HH", payload, offset)
+                offset += 4
+                pen = 0
+                if version == 10 and field_id & 0x8000:
+                    pen = struct.unpack_from("!I", payload, offset)[0]
+                    offset += 4
+                    field_id &= 0x7FFF
+                if pen == SNIFFER_PEN:
+                    name = SNIFFER_NAMES.get(field_id, f"pen{pen}.{field_id}")
+                elif pen == 29305:
+                    name = "reverse_" + names.get(field_id, f"ie{field_id}")
+                elif pen:
+                    name = f"pen{pen}.{field_id}"
+                else:
+                    name = names.get(field_id, f"ie{field_id}")
+                fields.append((name, length))
+            if template_id not in [t for (_, _, t) in self.templates]:
+                print(f"[INFO] Template {template_id} ({len(fields)} fields) received")
+            self.templates[(version, domain, template_id)] = fields
+
+    def _parse_data(self, version, domain, template_id, payload):
+        fields = self.templates.get((version, domain, template_id))
+        if not fields:
+            print(f"[WARN] Data set for unknown template {template_id}, skipping")
+            return 0
+        record_len = sum(length for _, length in fields)
+        count = 0
+        offset = 0
+        while offset + record_len <= len(payload):
+            record = {}
+            for name, length in fields:
+                raw = payload[offset: offset + length]
+                offset += length
+                if name in ("src_ip", "dst_ip"):
+                    record[name] = str(ipaddress.ip_address(raw))
+                elif name in STRING_FIELDS:
+                    record[name] = raw.rstrip(b"\0").decode("ascii", "replace")
+                elif name == "ja3":
+                    record[name] = raw.hex()
+                elif name in LIST_FIELDS:
+                    used = record.get(LIST_FIELDS[name], 0)
+                    record[name] = [int.from_bytes(raw[i:i + 2], "big") for i in range(0, 2 * used, 2)]
+                else:
+                    record[name] = int.from_bytes(raw, "big")
+            self._print_record(record)
+            count += 1
+        self.records += count
+        return count
+
+    @staticmethod
+    def _print_record(r):
+        reason = END_REASONS.get(r.get("end_reason"), "-")
+        duration = r.get("end_ms", r.get("last_switched", 0)) - r.get("start_ms", r.get("first_switched", 0))
+        print(f"{r.get('src_ip')}:{r.get('src_port')} <-> {r.get('dst_ip')}:{r.get('dst_port')} "
+              f"proto={r.get('proto')} if={r.get('ingress_if')} "
+              f"fwd={r.get('packets')}p/{r.get('octets')}B "
+              f"rev={r.get('reverse_packets')}p/{r.get('reverse_octets')}B "
+              f"dur={duration}ms end={reason}")
+        if "rtt_samples" in r:
+            print(f"    tcp: handshake={r['syn_rtt_us']}+{r['ack_rtt_us']}us "
+                  f"rtt={r['rtt_min_us']}/{r['rtt_avg_us']}/{r['rtt_max_us']}us ({r['rtt_samples']} samples) "
+                  f"retrans={r['retrans']}/{r['reverse_retrans']} ooo={r['ooo']}/{r['reverse_ooo']} "
+                  f"zero_win={r['zero_win']}/{r['reverse_zero_win']} mss={r['mss']}/{r['reverse_mss']}")
+        if "tls_version" in r:
+            print(f"    tls: version=0x{r['tls_version']:04x} sni={r['tls_sni'] or '-'} "
+                  f"alpn={r['tls_alpn'] or '-'} ja3={r['ja3']}")
+            if "tls_ciphers" in r:
+                print(f"    tls: ciphers={','.join(f'0x{c:04x}' for c in r['tls_ciphers'])} "
+                      f"extensions={','.join(str(e) for e in r['tls_extensions'])}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--ip", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=4739)
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((args.ip, args.port))
+    print(f"[*] Listening for IPFIX / NetFlow v9 on {args.ip}:{args.port}")
+
+    collector = Collector()
+    try:
+        while True:
+            data, _ = sock.recvfrom(65535)
+            collector.handle(data)
+    except KeyboardInterrupt:
+        print(f"\n[*] {collector.records} flow records received")
+
+
+if __name__ == "__main__":
+    main()
@@ -3,12 +3,15 @@ from rich.panel import Panel
 from rich.table import Table
 from rich.text import Text
 from rich import box
+from functools import lru_cache
 import socket
 
+# getservbyport reads /etc/services on every call: resolve each port once
+@lru_cache(maxsize=65536)
 def get_service_name(port):
     try:
         return socket.getservbyport(port)
-    except:
+    except (OSError, OverflowError):
         return str(port)
 
 def format_address(ip, port):
@@ -46,6 +49,7 @@ def render_packet_table(packet_history):
     
     # Define columns
     table.add_column("Time", style="dim", width=8)
+    table.add_column("If", justify="center", width=3)
     table.add_column("Proto", justify="center", width=8)
     table.add_column("Source", style="cyan")
     table.add_column("Destination", style="magenta")
@@ -180,6 +184,7 @@ def render_packet_table(packet_history):
         # Add row to table
         table.add_row(
             pkt.get('timestamp', ''),
+            str(pkt.get('if_id', 0)),
             Text(type_display, style=style),
             source,
             dest,
@@ -189,7 +194,7 @@ def render_packet_table(packet_history):
             
     return table
 
-def render_stats_panel(top_talkers, protocols, total_bytes):
+def render_stats_panel(top_talkers, protocols, total_bytes, top_ports=(), distinct=None, alerts=(), batches_lost=0):
     """Generates the statistics panel on the right"""
     text = Text()
     
@@ -201,6 +206,20 @@ def render_stats_panel(top_talkers, protocols, total_bytes):
         if len(src) > 18: display_src = src[:17] + ".."
         text.append(f"{display_src:<18} : {count}\n", style="cyan")
 
+    if top_ports:
+        text.append("\n🔌 Top Ports\n", style="bold underline gold1")
+        for port, count in top_ports:
+            text.append(f"{port:<18} : {count}\n", style="magenta")
+
+    if distinct:
+        text.append(f"\n🔢 Distinct: {distinct['src']} src / {distinct['dst']} dst / {distinct['conv']} conv\n", style="dim")
+
+    if alerts:
+        text.append("\n🚨 Alerts\n", style="bold underline red")
+        for alert in alerts:
+            who = alert.get('source') or alert.get('target') or alert.get('transmitter', '*')
+            text.append(f"{alert['timestamp']} {alert['type']:<15} {who}\n", style="bold red")
+
     # Part 2: Protocol Types
     text.append("\n📊 Breakdown\n", style="bold underline green")
     for proto, count in protocols:
@@ -208,5 +227,7 @@ def render_stats_panel(top_talkers, protocols, total_bytes):
         
     # Part 3: Total Traffic
     text.append(f"\n📦 Total: {total_bytes / 1024:.2f} KB", style="bold white on blue")
+    if batches_lost:
+        text.append(f"\n⚠ Lost record batches: {batches_lost}", style="bold yellow")
     
     return Panel(text, title="Network Stats", border_style="red")
\ No newline at end of file
@@ -89,6 +89,19 @@ int create_raw_socket(const char *interface_name)
     return sock_fd;
 }
 
+int set_promiscuous_mode(const char *interface_name, int enable) {
+    // Interface ioctls work on any AF_INET socket
+    int temp_sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (temp_sock == -1) {
+        perror("[ERROR] Socket creation failed");
+        return -1;
+    }
+
+    int ret = modify_promisc_mode(temp_sock, interface_name, enable);
+    close(temp_sock);
+    return ret;
+}
+
 void close_raw_socket(int sock_fd, const char *interface_name) {
     if (sock_fd != -1) {
         // Restore interface to normal mode (Disable Promisc)
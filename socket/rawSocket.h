@@ -13,4 +13,11 @@ int create_raw_socket(const char *interface_name);
  */
 void close_raw_socket(int sock_fd, const char *interface_name);
 
+/**
+ * @brief Enables or disables promiscuous mode on an interface.
+ * For capture paths that do not own an AF_PACKET socket (e.g. AF_XDP).
+ * @return 0 on success, -1 on failure.
+ */
+int set_promiscuous_mode(const char *interface_name, int enable);
+
 #endif // RAWSOCKET_H
\ No newline at end of file
@@ -0,0 +1,392 @@
+/**
+ * @file archiveQuery.c
+ * @brief SnifferArchive: scans and filters columnar packet / flow archives.
+ *
+ * Chunks whose footer min/max rule out the filter are skipped without
+ * reading their data. For the others, only the filter columns are decoded
+ * first; the output columns are decoded only if some row matched.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include "columnar.h"
+
+typedef struct {
+    uint64_t start_ns;
+    uint64_t end_ns;
+    int has_host;
+    uint8_t host[16];
+    int port;                   // -1 = any
+    int protocol;               // -1 = any
+    int if_id;                  // -1 = any
+} Filter;
+
+/**
+ * @brief Filter columns of one archive (-1 when the schema lacks them).
+ */
+typedef struct {
+    int time_start;             // Packets: ts_ns; flows: start_ms
+    int time_end;               // Flows: end_ms (-1 for packets)
+    uint64_t time_scale;        // ns per unit
+    int addr[2];
+    int port[2];
+    int protocol;
+    int if_id;
+    int ip_version;
+} SchemaView;
+
+typedef struct {
+    uint64_t files;
+    uint64_t chunks;
+    uint64_t skipped;
+    uint64_t rows;
+    uint64_t matched;
+} ScanStats;
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s [options] FILE.scol [FILE.scol ...]\n", prog);
+    printf("  -s, --start SEC      Rows at or after this time (epoch seconds, fractions allowed)\n");
+    printf("  -e, --end SEC        Rows up to this time\n");
+    printf("  -H, --host IP        Either address\n");
+    printf("  -p, --port N         Either port\n");
+    printf("  -P, --proto P        tcp, udp, icmp or a protocol number\n");
+    printf("  -i, --if ID          Capture source\n");
+    printf("  -C, --columns LIST   Comma-separated output columns (default: all)\n");
+    printf("  -c, --count          Print only the number of matching rows\n");
+    printf("  -v, --verbose        Print scan statistics to stderr\n");
+}
+
+static uint64_t parse_time(const char* text) {
+    double seconds = strtod(text, NULL);
+    return seconds > 0 ? (uint64_t)(seconds * 1e9) : 0;
+}
+
+static void resolve_view(const ColumnarReader* r, SchemaView* v) {
+    memset(v, -1, sizeof(*v));
+    v->time_scale = 1;
+
+    if (strcmp(columnar_schema(r), "flows") == 0) {
+        v->time_start = columnar_find_column(r, "start_ms");
+        v->time_end = columnar_find_column(r, "end_ms");
+        v->time_scale = 1000000;
+        v->addr[0] = columnar_find_column(r, "addr_a");
+        v->addr[1] = columnar_find_column(r, "addr_b");
+        v->port[0] = columnar_find_column(r, "port_a");
+        v->port[1] = columnar_find_column(r, "port_b");
+    } else {
+        v->time_start = columnar_find_column(r, "ts_ns");
+        v->addr[0] = columnar_find_column(r, "src_addr");
+        v->addr[1] = columnar_find_column(r, "dst_addr");
+        v->port[0] = columnar_find_column(r, "src_port");
+        v->port[1] = columnar_find_column(r, "dst_port");
+    }
+    v->protocol = columnar_find_column(r, "protocol");
+    v->if_id = columnar_find_column(r, "if_id");
+    v->ip_version = columnar_find_column(r, "ip_version");
+}
+
+// --- Chunk pruning from the footer ---
+
+static int int_may_match(const ColumnarChunk* c, int column, uint64_t value) {
+    if (column < 0) return 1;
+    return value >= columnar_stats_min(&c->stats[column]) && value <= columnar_stats_max(&c->stats[column]);
+}
+
+static int chunk_may_match(const ColumnarChunk* c, const SchemaView* v, const Filter* f) {
+    if (v->time_start >= 0) {
+        uint64_t end_col = v->time_end >= 0 ? (uint64_t)v->time_end : (uint64_t)v->time_start;
+        uint64_t first = columnar_stats_min(&c->stats[v->time_start]) * v->time_scale;
+        uint64_t last = columnar_stats_max(&c->stats[end_col]) * v->time_scale;
+        if (last < f->start_ns || first > f->end_ns) return 0;
+    }
+    if (f->protocol >= 0 && !int_may_match(c, v->protocol, (uint64_t)f->protocol)) return 0;
+    if (f->if_id >= 0 && !int_may_match(c, v->if_id, (uint64_t)f->if_id)) return 0;
+    if (f->port >= 0 && !int_may_match(c, v->port[0], (uint64_t)f->port) &&
+        !int_may_match(c, v->port[1], (uint64_t)f->port)) {
+        return 0;
+    }
+    if (f->has_host) {
+        int possible = 0;
+        for (int i = 0; i < 2; i++) {
+            if (v->addr[i] < 0) return 1;
+            const ColumnChunkStats* st = &c->stats[v->addr[i]];
+            if (memcmp(f->host, st->min, 16) >= 0 && memcmp(f->host, st->max, 16) <= 0) possible = 1;
+        }
+        if (!possible) return 0;
+    }
+    return 1;
+}
+
+// --- Output ---
+
+static void print_value(const ColumnDesc* d, const uint64_t* ints, const uint8_t* bytes, uint32_t row,
+                        const uint64_t* ip_version) {
+    if (d->type == COL_INT) {
+        printf("%llu", (unsigned long long)ints[row]);
+        return;
+    }
+
+    const uint8_t* v = bytes + (size_t)row * d->width;
+    if (d->width == 16 && ip_version) {
+        char text[INET6_ADDRSTRLEN] = "";
+        if (ip_version[row] == 4) inet_ntop(AF_INET, v, text, sizeof(text));
+        else if (ip_version[row] == 6) inet_ntop(AF_INET6, v, text, sizeof(text));
+        fputs(text, stdout);
+        return;
+    }
+    for (uint32_t i = 0; i < d->width && v[i]; i++) {
+        putchar((v[i] >= 0x20 && v[i] < 0x7F && v[i] != ',') ? v[i] : '?');
+    }
+}
+
+static int scan_file(const char* path, const Filter* f, const char* columns_spec, int count_only,
+                     ScanStats* stats) {
+    ColumnarReader* r = columnar_open(path);
+    if (!r) {
+        fprintf(stderr, "[WARN] %s: not an archive, skipped\n", path);
+        return -1;
+    }
+    stats->files++;
+
+    SchemaView v;
+    resolve_view(r, &v);
+    uint32_t ncols = columnar_column_count(r);
+
+    // Output columns
+    int output[COLUMNAR_MAX_COLUMNS];
+    uint32_t nout = 0;
+    if (!count_only) {
+        if (columns_spec) {
+            char spec[512];
+            snprintf(spec, sizeof(spec), "%s", columns_spec);
+            char* save = NULL;
+            for (char* name = strtok_r(spec, ",", &save); name && nout < COLUMNAR_MAX_COLUMNS;
+                 name = strtok_r(NULL, ",", &save)) {
+                int idx = columnar_find_column(r, name);
+                if (idx < 0) {
+                    fprintf(stderr, "[WARN] %s: no column '%s'\n", path, name);
+                    continue;
+                }
+                output[nout++] = idx;
+            }
+        } else {
+            for (uint32_t i = 0; i < ncols; i++) output[nout++] = (int)i;
+        }
+        if (stats->files == 1) {
+            for (uint32_t i = 0; i < nout; i++) {
+                printf("%s%.*s", i ? "," : "", COLUMNAR_NAME_LEN, columnar_column(r, (uint32_t)output[i])->name);
+            }
+            printf("\n");
+        }
+    }
+
+    // Decoded columns of the current chunk
+    void* decoded[COLUMNAR_MAX_COLUMNS] = { NULL };
+    int loaded[COLUMNAR_MAX_COLUMNS];
+    uint8_t* selected = NULL;
+    uint32_t capacity = 0;
+    int status = 0;
+
+    ColumnarChunk chunk;
+    int more;
+    while ((more = columnar_next_chunk(r, &chunk)) == 1) {
+        stats->chunks++;
+        if (!chunk_may_match(&chunk, &v, f)) {
+            stats->skipped++;
+            continue;
+        }
+        stats->rows += chunk.rows;
+
+        if (chunk.rows > capacity) {
+            for (uint32_t c = 0; c < ncols; c++) {
+                const ColumnDesc* d = columnar_column(r, c);
+                size_t width = d->type == COL_INT ? sizeof(uint64_t) : d->width;
+                free(decoded[c]);
+                decoded[c] = malloc((size_t)chunk.rows * width);
+            }
+            free(selected);
+            selected = (uint8_t*)malloc(chunk.rows);
+            capacity = chunk.rows;
+        }
+        int allocated = selected != NULL;
+        for (uint32_t c = 0; c < ncols; c++) allocated = allocated && decoded[c] != NULL;
+        if (!allocated) {
+            fprintf(stderr, "[ERROR] Out of memory for a %u-row chunk\n", chunk.rows);
+            status = -1;
+            break;
+        }
+        memset(loaded, 0, sizeof(loaded));
+
+#define LOAD(col) ((col) < 0 || loaded[col] || \
+                   (columnar_read_column(r, &chunk, (uint32_t)(col), decoded[col]) == 0 && (loaded[col] = 1)))
+
+        // --- Filter columns only ---
+        int ok = 1;
+        if (f->start_ns > 0 || f->end_ns < UINT64_MAX) ok = ok && LOAD(v.time_start) && LOAD(v.time_end);
+        if (f->has_host) ok = ok && LOAD(v.addr[0]) && LOAD(v.addr[1]) && LOAD(v.ip_version);
+        if (f->port >= 0) ok = ok && LOAD(v.port[0]) && LOAD(v.port[1]);
+        if (f->protocol >= 0) ok = ok && LOAD(v.protocol);
+        if (f->if_id >= 0) ok = ok && LOAD(v.if_id);
+        if (!ok) {
+            fprintf(stderr, "[ERROR] %s: corrupt chunk\n", path);
+            status = -1;
+            break;
+        }
+
+        uint32_t matched = 0;
+        for (uint32_t row = 0; row < chunk.rows; row++) {
+            int keep = 1;
+            if (v.time_start >= 0 && loaded[v.time_start]) {
+                uint64_t first = ((uint64_t*)decoded[v.time_start])[row] * v.time_scale;
+                uint64_t last = v.time_end >= 0 ? ((uint64_t*)decoded[v.time_end])[row] * v.time_scale : first;
+                keep = last >= f->start_ns && first <= f->end_ns;
+            }
+            if (keep && f->has_host && v.addr[0] >= 0) {
+                size_t len = ((uint64_t*)decoded[v.ip_version])[row] == 4 ? 4 : 16;
+                keep = memcmp((uint8_t*)decoded[v.addr[0]] + (size_t)row * 16, f->host, len) == 0 ||
+                       memcmp((uint8_t*)decoded[v.addr[1]] + (size_t)row * 16, f->host, len) == 0;
+            }
+            if (keep && f->port >= 0 && v.port[0] >= 0) {
+                keep = ((uint64_t*)decoded[v.port[0]])[row] == (uint64_t)f->port ||
+                       ((uint64_t*)decoded[v.port[1]])[row] == (uint64_t)f->port;
+            }
+            if (keep && f->protocol >= 0 && v.protocol >= 0) {
+                keep = ((uint64_t*)decoded[v.protocol])[row] == (uint64_t)f->protocol;
+            }
+            if (keep && f->if_id >= 0 && v.if_id >= 0) {
+                keep = ((uint64_t*)decoded[v.if_id])[row] == (uint64_t)f->if_id;
+            }
+            selected[row] = (uint8_t)keep;
+            matched += (uint32_t)keep;
+        }
+        stats->matched += matched;
+        if (matched == 0 || count_only) continue;
+
+        // --- Output columns, only for chunks with matches ---
+        for (uint32_t i = 0; ok && i < nout; i++) {
+            ok = LOAD(output[i]);
+            if (ok && columnar_column(r, (uint32_t)output[i])->type == COL_BYTES) ok = LOAD(v.ip_version);
+        }
+#undef LOAD
+        if (!ok) {
+            fprintf(stderr, "[ERROR] %s: corrupt chunk\n", path);
+            status = -1;
+            break;
+        }
+
+        const uint64_t* ip_version = v.ip_version >= 0 ? (const uint64_t*)decoded[v.ip_version] : NULL;
+        for (uint32_t row = 0; row < chunk.rows; row++) {
+            if (!selected[row]) continue;
+            for (uint32_t i = 0; i < nout; i++) {
+                const ColumnDesc* d = columnar_column(r, (uint32_t)output[i]);
+                if (i) putchar(',');
+                print_value(d, (const uint64_t*)decoded[output[i]], (const uint8_t*)decoded[output[i]], row,
+                            ip_version);
+            }
+            putchar('\n');
+        }
+    }
+    if (more < 0) {
+        fprintf(stderr, "[ERROR] %s: corrupt chunk header\n", path);
+        status = -1;
+    }
+
+    for (uint32_t c = 0; c < COLUMNAR_MAX_COLUMNS; c++) free(decoded[c]);
+    free(selected);
+    columnar_close(r);
+    return status;
+}
+
+int main(int argc, char** argv) {
+    Filter filter = { 0, UINT64_MAX, 0, { 0 }, -1, -1, -1 };
+    const char* columns = NULL;
+    int count_only = 0;
+    int verbose = 0;
+
+    static const struct option long_options[] = {
+        {"start",   required_argument, NULL, 's'},
+        {"end",     required_argument, NULL, 'e'},
+        {"host",    required_argument, NULL, 'H'},
+        {"port",    required_argument, NULL, 'p'},
+        {"proto",   required_argument, NULL, 'P'},
+        {"if",      required_argument, NULL, 'i'},
+        {"columns", required_argument, NULL, 'C'},
+        {"count",   no_argument,       NULL, 'c'},
+        {"verbose", no_argument,       NULL, 'v'},
+        {"help",    no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:e:H:p:P:i:C:cvh", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 's':
+                filter.start_ns = parse_time(optarg);
+                break;
+            case 'e':
+                filter.end_ns = parse_time(optarg);
+                break;
+            case 'H':
+                if (inet_pton(AF_INET, optarg, filter.host) != 1 && inet_pton(AF_INET6, optarg, filter.host) != 1) {
+                    fprintf(stderr, "[ERROR] Bad address '%s'\n", optarg);
+                    return 1;
+                }
+                filter.has_host = 1;
+                break;
+            case 'p':
+                filter.port = atoi(optarg);
+                break;
+            case 'P':
+                if (strcmp(optarg, "tcp") == 0) filter.protocol = IPPROTO_TCP;
+                else if (strcmp(optarg, "udp") == 0) filter.protocol = IPPROTO_UDP;
+                else if (strcmp(optarg, "icmp") == 0) filter.protocol = IPPROTO_ICMP;
+                else filter.protocol = atoi(optarg);
+                break;
+            case 'i':
+                filter.if_id = atoi(optarg);
+                break;
+            case 'C':
+                columns = optarg;
+                break;
+            case 'c':
+                count_only = 1;
+                break;
+            case 'v':
+                verbose = 1;
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    if (optind >= argc) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    ScanStats stats = { 0, 0, 0, 0, 0 };
+    int status = 0;
+    for (int i = optind; i < argc; i++) {
+        if (scan_file(argv[i], &filter, columns, count_only, &stats) != 0) status = 1;
+    }
+    if (count_only) printf("%llu\n", (unsigned long long)stats.matched);
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (verbose) {
+        double ms = (double)(t1.tv_sec - t0.tv_sec) * 1e3 + (double)(t1.tv_nsec - t0.tv_nsec) / 1e6;
+        fprintf(stderr, "[INFO] %llu files, %llu chunks (%llu skipped), %llu rows scanned, %llu matched, %.1f ms\n",
+                (unsigned long long)stats.files, (unsigned long long)stats.chunks,
+                (unsigned long long)stats.skipped, (unsigned long long)stats.rows,
+                (unsigned long long)stats.matched, ms);
+    }
+    return status;
+}
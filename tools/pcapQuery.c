@@ -0,0 +1,395 @@
+/**
+ * @file pcapQuery.c
+ * @brief SnifferQuery: extracts a flow and/or time range from recorded pcap segments.
+ *
+ * Only segments whose index overlaps the time range are opened. A flow query
+ * reads the flow's own record list; a time query starts at the range's time
+ * bucket and stops after its last one. Matches from all segments are merged
+ * by timestamp into one pcap file.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include "pcap_index.h"
+#include "hash.h"
+
+#define MAX_FRAME 262144
+
+typedef struct {
+    int active;
+    uint64_t hash;
+} FlowFilter;
+
+typedef struct {
+    uint64_t ts_ns;
+    uint32_t segment;
+    uint32_t offset;
+    uint32_t length;        // Record header + data
+} Match;
+
+typedef struct {
+    Match* items;
+    size_t count;
+    size_t capacity;
+} MatchList;
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s -d DIR -o OUT.pcap [options]\n", prog);
+    printf("  -d, --dir DIR        Directory written by Sniffer --record\n");
+    printf("  -o, --output FILE    Output pcap ('-' for stdout)\n");
+    printf("  -f, --flow A:P,B:P,PROTO   One flow, either direction (PROTO: tcp, udp or a number;\n");
+    printf("                             IPv6 as [addr]:port)\n");
+    printf("  -s, --start SEC      Start time, epoch seconds (fractions allowed)\n");
+    printf("  -e, --end SEC        End time, epoch seconds (inclusive)\n");
+    printf("  -i, --if ID          Only segments of this capture source\n");
+}
+
+// --- Arguments ---
+
+static uint64_t parse_time(const char* text) {
+    double seconds = strtod(text, NULL);
+    return seconds > 0 ? (uint64_t)(seconds * 1e9) : 0;
+}
+
+// Parses "1.2.3.4:80" or "[2001:db8::1]:443"
+static int parse_endpoint(const char* text, uint8_t* version, uint8_t addr[16], uint16_t* port) {
+    char host[64];
+    const char* colon;
+
+    memset(addr, 0, 16);
+    if (text[0] == '[') {
+        const char* close = strchr(text, ']');
+        if (!close || close[1] != ':' || (size_t)(close - text - 1) >= sizeof(host)) return -1;
+        memcpy(host, text + 1, (size_t)(close - text - 1));
+        host[close - text - 1] = '\0';
+        colon = close + 1;
+        *version = 6;
+        if (inet_pton(AF_INET6, host, addr) != 1) return -1;
+    } else {
+        colon = strrchr(text, ':');
+        if (!colon || (size_t)(colon - text) >= sizeof(host)) return -1;
+        memcpy(host, text, (size_t)(colon - text));
+        host[colon - text] = '\0';
+        *version = 4;
+        if (inet_pton(AF_INET, host, addr) != 1) return -1;
+    }
+    *port = (uint16_t)atoi(colon + 1);
+    return 0;
+}
+
+static int parse_flow(const char* text, FlowFilter* filter) {
+    char copy[256];
+    snprintf(copy, sizeof(copy), "%s", text);
+
+    char* a = strtok(copy, ",");
+    char* b = strtok(NULL, ",");
+    char* proto = strtok(NULL, ",");
+    if (!a || !b || !proto) return -1;
+
+    uint8_t version_a, version_b, addr_a[16], addr_b[16];
+    uint16_t port_a, port_b;
+    if (parse_endpoint(a, &version_a, addr_a, &port_a) != 0 ||
+        parse_endpoint(b, &version_b, addr_b, &port_b) != 0 || version_a != version_b) {
+        return -1;
+    }
+
+    uint8_t protocol;
+    if (strcmp(proto, "tcp") == 0) protocol = IPPROTO_TCP;
+    else if (strcmp(proto, "udp") == 0) protocol = IPPROTO_UDP;
+    else protocol = (uint8_t)atoi(proto);
+
+    filter->active = 1;
+    filter->hash = hash_flow_key(version_a, protocol, addr_a, port_a, addr_b, port_b, PCAP_INDEX_FLOW_SEED);
+    return 0;
+}
+
+// --- Matching ---
+
+static int add_match(MatchList* list, uint64_t ts_ns, uint32_t segment, uint32_t offset, uint32_t length) {
+    if (list->count == list->capacity) {
+        size_t next = list->capacity ? list->capacity * 2 : 1024;
+        Match* p = (Match*)realloc(list->items, next * sizeof(Match));
+        if (!p) return -1;
+        list->items = p;
+        list->capacity = next;
+    }
+    list->items[list->count++] = (Match){ ts_ns, segment, offset, length };
+    return 0;
+}
+
+// Reads the record header at @p offset; returns 1 when it is within [start, end]
+static int read_record(int fd, uint32_t offset, uint64_t start, uint64_t end, uint64_t* ts_ns, uint32_t* length) {
+    PcapRecordHeader rh;
+    if (pread(fd, &rh, sizeof(rh), offset) != (ssize_t)sizeof(rh) || rh.incl_len > MAX_FRAME) return -1;
+
+    *ts_ns = (uint64_t)rh.ts_sec * 1000000000ULL + rh.ts_nsec;
+    *length = (uint32_t)sizeof(rh) + rh.incl_len;
+    return *ts_ns >= start && *ts_ns <= end;
+}
+
+static const PcapIndexFlow* find_flow(const PcapIndexHeader* hdr, const uint8_t* base, uint64_t hash) {
+    const PcapIndexFlow* flows = (const PcapIndexFlow*)(base + hdr->flow_table);
+    uint32_t lo = 0, hi = hdr->flows;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (flows[mid].hash < hash) lo = mid + 1;
+        else hi = mid;
+    }
+    return (lo < hdr->flows && flows[lo].hash == hash) ? &flows[lo] : NULL;
+}
+
+static int index_valid(const PcapIndexHeader* hdr, size_t size) {
+    if (size < sizeof(*hdr) || memcmp(hdr->magic, PCAP_INDEX_MAGIC, sizeof(hdr->magic)) != 0 ||
+        hdr->version != PCAP_INDEX_VERSION || hdr->bucket_ms == 0) {
+        return 0;
+    }
+    return (uint64_t)hdr->bucket_table + (uint64_t)hdr->buckets * 4 <= hdr->flow_table &&
+           (uint64_t)hdr->flow_table + (uint64_t)hdr->flows * sizeof(PcapIndexFlow) <= hdr->ref_table &&
+           (uint64_t)hdr->ref_table + (uint64_t)hdr->packets * 4 <= size;
+}
+
+/**
+ * @brief Collects the matching records of one segment.
+ *
+ * @return Number of matches, or -1 if the index cannot be used.
+ */
+static long query_segment(const char* index_path, int fd, uint64_t segment_size, uint32_t segment,
+                          const FlowFilter* flow, uint64_t start, uint64_t end, uint32_t* linktype,
+                          MatchList* out) {
+    int ifd = open(index_path, O_RDONLY);
+    if (ifd < 0) return -1;
+
+    struct stat st;
+    if (fstat(ifd, &st) != 0 || st.st_size == 0) {
+        close(ifd);
+        return -1;
+    }
+    uint8_t* base = (uint8_t*)mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, ifd, 0);
+    close(ifd);
+    if (base == MAP_FAILED) return -1;
+
+    const PcapIndexHeader* hdr = (const PcapIndexHeader*)base;
+    long found = 0;
+
+    if (!index_valid(hdr, (size_t)st.st_size)) {
+        found = -1;
+    } else if (hdr->packets > 0 && hdr->last_ts_ns >= start && hdr->first_ts_ns <= end) {
+        *linktype = hdr->linktype;
+        uint64_t ts_ns;
+        uint32_t length;
+
+        if (flow->active) {
+            const PcapIndexFlow* f = find_flow(hdr, base, flow->hash);
+            const uint32_t* refs = (const uint32_t*)(base + hdr->ref_table);
+
+            for (uint32_t i = 0; f && i < f->count && f->first_ref + i < hdr->packets; i++) {
+                uint32_t offset = refs[f->first_ref + i];
+                if (read_record(fd, offset, start, end, &ts_ns, &length) == 1 &&
+                    add_match(out, ts_ns, segment, offset, length) == 0) {
+                    found++;
+                }
+            }
+        } else {
+            // Buckets bound the scan: records of one bucket are contiguous
+            const uint32_t* buckets = (const uint32_t*)(base + hdr->bucket_table);
+            uint64_t bucket_ns = (uint64_t)hdr->bucket_ms * 1000000ULL;
+            uint64_t first = start > hdr->base_ts_ns ? (start - hdr->base_ts_ns) / bucket_ns : 0;
+            uint64_t last = end > hdr->base_ts_ns ? (end - hdr->base_ts_ns) / bucket_ns + 1 : 1;
+
+            uint64_t offset = first < hdr->buckets ? buckets[first] : segment_size;
+            uint64_t stop = last < hdr->buckets ? buckets[last] : segment_size;
+
+            while (offset < stop) {
+                int in_range = read_record(fd, (uint32_t)offset, start, end, &ts_ns, &length);
+                if (in_range < 0) break;
+                if (in_range && add_match(out, ts_ns, segment, (uint32_t)offset, length) == 0) found++;
+                offset += length;
+            }
+        }
+    }
+
+    munmap(base, (size_t)st.st_size);
+    return found;
+}
+
+static int compare_matches(const void* a, const void* b) {
+    const Match* x = (const Match*)a;
+    const Match* y = (const Match*)b;
+    if (x->ts_ns != y->ts_ns) return x->ts_ns < y->ts_ns ? -1 : 1;
+    if (x->segment != y->segment) return x->segment < y->segment ? -1 : 1;
+    return (x->offset > y->offset) - (x->offset < y->offset);
+}
+
+static int is_segment_name(const char* name, int if_id) {
+    size_t len = strlen(name);
+    if (len < 6 || strcmp(name + len - 5, ".pcap") != 0 || strncmp(name, "if", 2) != 0) return 0;
+    return if_id < 0 || atoi(name + 2) == if_id;
+}
+
+static int compare_names(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+int main(int argc, char** argv) {
+    const char* dir = NULL;
+    const char* output = NULL;
+    FlowFilter flow = { 0, 0 };
+    uint64_t start = 0, end = UINT64_MAX;
+    int if_id = -1;
+
+    static const struct option long_options[] = {
+        {"dir",    required_argument, NULL, 'd'},
+        {"output", required_argument, NULL, 'o'},
+        {"flow",   required_argument, NULL, 'f'},
+        {"start",  required_argument, NULL, 's'},
+        {"end",    required_argument, NULL, 'e'},
+        {"if",     required_argument, NULL, 'i'},
+        {"help",   no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "d:o:f:s:e:i:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'd':
+                dir = optarg;
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case 'f':
+                if (parse_flow(optarg, &flow) != 0) {
+                    fprintf(stderr, "[ERROR] Bad flow '%s' (expected A:PORT,B:PORT,PROTO)\n", optarg);
+                    return 1;
+                }
+                break;
+            case 's':
+                start = parse_time(optarg);
+                break;
+            case 'e':
+                end = parse_time(optarg);
+                break;
+            case 'i':
+                if_id = atoi(optarg);
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (!dir || !output || start > end) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // --- Segments, in name (capture time) order ---
+    DIR* d = opendir(dir);
+    if (!d) {
+        fprintf(stderr, "[ERROR] Cannot open %s\n", dir);
+        return 1;
+    }
+    char** names = NULL;
+    size_t name_count = 0, name_capacity = 0;
+    struct dirent* de;
+    while ((de = readdir(d)) != NULL) {
+        if (!is_segment_name(de->d_name, if_id)) continue;
+        if (name_count == name_capacity) {
+            name_capacity = name_capacity ? name_capacity * 2 : 64;
+            names = (char**)realloc(names, name_capacity * sizeof(char*));
+            if (!names) return 1;
+        }
+        names[name_count++] = strdup(de->d_name);
+    }
+    closedir(d);
+    if (name_count) qsort(names, name_count, sizeof(char*), compare_names);
+
+    int* fds = (int*)calloc(name_count ? name_count : 1, sizeof(int));
+    MatchList matches = { NULL, 0, 0 };
+    uint32_t linktype = 0;
+    int have_linktype = 0;
+    size_t searched = 0, unindexed = 0;
+
+    for (size_t i = 0; i < name_count; i++) {
+        char path[4096], index_path[4112];
+        snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+        snprintf(index_path, sizeof(index_path), "%s%s", path, PCAP_INDEX_SUFFIX);
+
+        fds[i] = open(path, O_RDONLY);
+        struct stat st;
+        if (fds[i] < 0 || fstat(fds[i], &st) != 0) continue;
+
+        // Each call appends; drop them again if the segment's link type does not fit the output
+        size_t before = matches.count;
+        uint32_t segment_linktype = linktype;
+        long found = query_segment(index_path, fds[i], (uint64_t)st.st_size, (uint32_t)i, &flow, start, end,
+                                   &segment_linktype, &matches);
+        if (found < 0) {
+            // Still being written, or the recorder stopped before indexing it
+            unindexed++;
+            continue;
+        }
+        searched++;
+        if (found == 0) continue;
+
+        if (!have_linktype) {
+            linktype = segment_linktype;
+            have_linktype = 1;
+        } else if (segment_linktype != linktype) {
+            fprintf(stderr, "[WARN] %s: link type %u differs from %u, skipped (use --if)\n",
+                    names[i], segment_linktype, linktype);
+            matches.count = before;
+        }
+    }
+
+    if (matches.count) qsort(matches.items, matches.count, sizeof(Match), compare_matches);
+
+    // --- Output ---
+    FILE* out = strcmp(output, "-") == 0 ? stdout : fopen(output, "wb");
+    if (!out) {
+        fprintf(stderr, "[ERROR] Cannot create %s\n", output);
+        return 1;
+    }
+    PcapFileHeader fh = { .magic = PCAP_MAGIC_NSEC, .version_major = 2, .version_minor = 4,
+                          .thiszone = 0, .sigfigs = 0, .snaplen = 65535,
+                          .linktype = have_linktype ? linktype : PCAP_LINKTYPE_ETHERNET };
+    int status = fwrite(&fh, sizeof(fh), 1, out) == 1 ? 0 : 1;
+
+    uint8_t* record = (uint8_t*)malloc(sizeof(PcapRecordHeader) + MAX_FRAME);
+    uint64_t bytes = 0;
+    for (size_t i = 0; status == 0 && record && i < matches.count; i++) {
+        const Match* m = &matches.items[i];
+        if (pread(fds[m->segment], record, m->length, m->offset) != (ssize_t)m->length ||
+            fwrite(record, 1, m->length, out) != m->length) {
+            status = 1;
+        }
+        bytes += m->length - sizeof(PcapRecordHeader);
+    }
+    if (out != stdout && fclose(out) != 0) status = 1;
+
+    fprintf(stderr, "[INFO] %zu packets (%llu bytes) from %zu indexed segments", matches.count,
+            (unsigned long long)bytes, searched);
+    if (unindexed) fprintf(stderr, ", %zu without an index skipped", unindexed);
+    fprintf(stderr, "\n");
+
+    for (size_t i = 0; i < name_count; i++) {
+        if (fds[i] >= 0) close(fds[i]);
+        free(names[i]);
+    }
+    free(names);
+    free(fds);
+    free(matches.items);
+    free(record);
+    return status;
+}
@@ -0,0 +1,659 @@
+/**
+ * @file trafficGen.c
+ * @brief SnifferGen: sends synthetic or replayed frames on an interface at a target rate.
+ *
+ * Frames are either built (Ethernet/IPv4 UDP or TCP, cycling over --flows
+ * 5-tuples) or read from a pcap file (Ethernet link type, replayed in a loop).
+ * They go out through a PACKET_TX_RING, where one send() transmits a whole
+ * batch, or with sendmmsg(). The rate is paced per batch against the monotonic
+ * clock; --pps 0 sends as fast as the interface takes frames.
+ *
+ * A JSON summary line is printed on stdout at the end, so scripts (see
+ * python/e2e_report.py) can compare the offered load with what was captured.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <getopt.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <net/ethernet.h>
+#include <netinet/in.h>
+#include <linux/if_packet.h>
+#include "pcap_index.h"
+#include "checksum.h"
+
+#define PCAP_MAGIC_USEC     0xa1b2c3d4u
+#define MAX_PCAP_FRAMES     (1u << 20)
+#define MIN_FRAME           60          // Ethernet minimum without the FCS
+#define MAX_FRAME           1514
+
+#define TX_FRAME_SIZE       2048        // Ring slot: header + one MTU-sized frame
+#define TX_BLOCK_SIZE       (1u << 16)
+#define TX_FRAME_NR         4096
+#define MAX_BATCH           1024
+#define DRAIN_TIMEOUT_MS    1000
+
+typedef enum {
+    SEND_RING,
+    SEND_MMSG
+} SendMethod;
+
+typedef struct {
+    unsigned char* data;
+    uint32_t len;
+    uint32_t seq;               // Synthetic TCP: sequence number of the next send
+    uint16_t tcp_offset;        // Synthetic TCP: header offset in data (0 = frame sent as is)
+    uint16_t payload;           // Synthetic TCP: payload bytes, the sequence step
+} Frame;
+
+typedef struct {
+    Frame* items;
+    size_t count;
+    int advance_seq;            // Synthetic TCP frames: sequence numbers move on with every send
+} FrameSet;
+
+/**
+ * @brief TPACKET_V2 transmit ring.
+ */
+typedef struct {
+    unsigned char* map;
+    size_t map_len;
+    unsigned int frame_nr;
+    unsigned int next;          // Next slot to fill
+    unsigned int reclaim;       // Oldest slot not yet seen back from the kernel
+    unsigned int in_flight;     // Slots handed to the kernel and not reclaimed
+} TxRing;
+
+typedef struct {
+    uint64_t sent;
+    uint64_t bytes;
+    uint64_t errors;            // Frames the kernel rejected
+} TxCounters;
+
+static volatile sig_atomic_t stop = 0;
+
+static void handle_signal(int signal) {
+    (void)signal;
+    stop = 1;
+}
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s -i IFACE [options]\n", prog);
+    printf("  -i, --iface IFACE    Interface to send on (e.g. one end of a veth pair)\n");
+    printf("  -p, --pps N          Target rate in frames per second (default: 0 = as fast as possible)\n");
+    printf("  -s, --seconds SEC    Send for SEC seconds (default: 5)\n");
+    printf("  -n, --count N        Stop after N frames (default: time only)\n");
+    printf("  -r, --pcap FILE      Replay the frames of an Ethernet pcap file in a loop\n");
+    printf("  -l, --size BYTES     Synthetic frame size without FCS, %d-%d (default: %d)\n",
+           MIN_FRAME, MAX_FRAME, MIN_FRAME);
+    printf("  -f, --flows N        Synthetic 5-tuples to cycle over (default: 256)\n");
+    printf("      --proto PROTO    Synthetic frames: udp (default) or tcp\n");
+    printf("  -m, --method NAME    ring (PACKET_TX_RING, default) or mmsg (sendmmsg)\n");
+    printf("  -b, --batch N        Frames per send call (default: 64, max %d)\n", MAX_BATCH);
+    printf("      --qdisc-bypass   Hand frames straight to the driver (PACKET_QDISC_BYPASS)\n");
+    printf("  -q, --quiet          No per-second progress on stderr\n");
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// --- Frames ---
+
+static int add_frame(FrameSet* set, size_t* capacity, const unsigned char* data, uint32_t len) {
+    if (set->count == *capacity) {
+        size_t grown = *capacity ? *capacity * 2 : 1024;
+        Frame* items = (Frame*)realloc(set->items, grown * sizeof(Frame));
+        if (!items) return -1;
+        set->items = items;
+        *capacity = grown;
+    }
+    unsigned char* copy = (unsigned char*)malloc(len);
+    if (!copy) return -1;
+    memcpy(copy, data, len);
+    memset(&set->items[set->count], 0, sizeof(Frame));
+    set->items[set->count].data = copy;
+    set->items[set->count].len = len;
+    set->count++;
+    return 0;
+}
+
+static void free_frames(FrameSet* set) {
+    for (size_t i = 0; i < set->count; i++) free(set->items[i].data);
+    free(set->items);
+    set->items = NULL;
+    set->count = 0;
+}
+
+static uint16_t fold_complement(uint64_t sum) {
+    return (uint16_t)~csum_fold(sum);
+}
+
+/**
+ * @brief Writes the frame's next sequence number into @p data (a copy of the frame, or the frame itself).
+ *
+ * The TCP checksum is updated incrementally (RFC 1624) from the sequence
+ * number currently in @p data, so the payload is not summed again.
+ */
+static void stamp_seq(Frame* frame, unsigned char* data) {
+    unsigned char* tcp = data + frame->tcp_offset;
+    uint16_t old_words[2], new_words[2], csum;
+    uint32_t seq = htonl(frame->seq);
+    memcpy(old_words, tcp + 4, 4);
+    memcpy(new_words, &seq, 4);
+    memcpy(&csum, tcp + 16, 2);
+
+    uint64_t sum = (uint16_t)~csum;
+    sum += (uint16_t)~old_words[0] + (uint16_t)~old_words[1];
+    sum += new_words[0] + new_words[1];
+    csum = fold_complement(sum);
+
+    memcpy(tcp + 4, &seq, 4);
+    memcpy(tcp + 16, &csum, 2);
+    frame->seq += frame->payload;
+}
+
+/**
+ * @brief Builds one Ethernet/IPv4 frame per flow; checksums are filled in.
+ *
+ * Flow i comes from 10.0.<i/256>.<i%256>:<1024 + i%60000> and goes to 10.255.0.1:9.
+ * TCP frames are ACK/PSH segments; each send advances its flow's sequence
+ * number by the payload length, so every flow is an in-order stream.
+ */
+static int build_synthetic(FrameSet* set, uint32_t flows, uint32_t size, int tcp) {
+    static const unsigned char dest_mac[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 };
+    static const unsigned char src_mac[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+    unsigned char frame[MAX_FRAME];
+    size_t capacity = 0;
+
+    uint32_t l4_len = tcp ? 20 : 8;
+    if (size < 14 + 20 + l4_len) size = 14 + 20 + l4_len;
+
+    for (uint32_t i = 0; i < flows; i++) {
+        memset(frame, 0, sizeof(frame));
+        memcpy(frame, dest_mac, 6);
+        memcpy(frame + 6, src_mac, 6);
+        frame[12] = 0x08;
+        frame[13] = 0x00;
+
+        unsigned char* ip = frame + 14;
+        uint16_t ip_len = (uint16_t)(size - 14);
+        ip[0] = 0x45;
+        ip[2] = (uint8_t)(ip_len >> 8);
+        ip[3] = (uint8_t)ip_len;
+        ip[6] = 0x40;                       // Don't fragment
+        ip[8] = 64;
+        ip[9] = tcp ? IPPROTO_TCP : IPPROTO_UDP;
+        ip[12] = 10;
+        ip[14] = (uint8_t)(i >> 8);
+        ip[15] = (uint8_t)i;
+        ip[16] = 10;
+        ip[17] = 255;
+        ip[19] = 1;
+        uint16_t ip_csum = fold_complement(csum_partial(ip, 20, 0));
+        memcpy(ip + 10, &ip_csum, 2);
+
+        unsigned char* l4 = ip + 20;
+        uint16_t segment_len = (uint16_t)(ip_len - 20);
+        uint16_t src_port = (uint16_t)(1024 + i % 60000);
+        l4[0] = (uint8_t)(src_port >> 8);
+        l4[1] = (uint8_t)src_port;
+        l4[3] = 9;                          // Discard
+        if (tcp) {
+            l4[7] = 1;                      // Sequence number
+            l4[11] = 1;                     // Acknowledgment number
+            l4[12] = 5 << 4;
+            l4[13] = 0x18;                  // ACK, PSH
+            l4[14] = 0xFF;                  // Window
+            l4[15] = 0xFF;
+        } else {
+            l4[4] = (uint8_t)(segment_len >> 8);
+            l4[5] = (uint8_t)segment_len;
+        }
+        for (uint32_t p = l4_len; p < segment_len; p++) l4[p] = (uint8_t)p;
+
+        // Pseudo-header, then the segment
+        unsigned char pseudo[12] = { 0 };
+        memcpy(pseudo, ip + 12, 8);
+        pseudo[9] = ip[9];
+        pseudo[10] = (uint8_t)(segment_len >> 8);
+        pseudo[11] = (uint8_t)segment_len;
+        uint16_t l4_csum = fold_complement(csum_partial(l4, segment_len, csum_partial(pseudo, 12, 0)));
+        if (!tcp && l4_csum == 0) l4_csum = 0xFFFF;
+        memcpy(l4 + (tcp ? 16 : 6), &l4_csum, 2);
+
+        if (add_frame(set, &capacity, frame, size) != 0) return -1;
+        if (tcp) {
+            Frame* added = &set->items[set->count - 1];
+            added->seq = 1;
+            added->tcp_offset = 14 + 20;
+            added->payload = (uint16_t)(segment_len - l4_len);
+        }
+    }
+    set->advance_seq = tcp;
+    return 0;
+}
+
+static int load_pcap(FrameSet* set, const char* path, uint32_t max_len) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "[ERROR] Cannot open %s\n", path);
+        return -1;
+    }
+
+    PcapFileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        (header.magic != PCAP_MAGIC_USEC && header.magic != PCAP_MAGIC_NSEC)) {
+        fprintf(stderr, "[ERROR] %s is not a pcap file (pcapng and big-endian files are not supported)\n", path);
+        fclose(file);
+        return -1;
+    }
+    if (header.linktype != PCAP_LINKTYPE_ETHERNET) {
+        fprintf(stderr, "[ERROR] %s: link type %u, only Ethernet (1) can be replayed\n", path, header.linktype);
+        fclose(file);
+        return -1;
+    }
+
+    unsigned char* buffer = (unsigned char*)malloc(65536);
+    size_t capacity = 0, skipped = 0;
+    PcapRecordHeader record;
+    int result = 0;
+
+    while (buffer && set->count < MAX_PCAP_FRAMES && fread(&record, sizeof(record), 1, file) == 1) {
+        if (record.incl_len > 65536 || fread(buffer, 1, record.incl_len, file) != record.incl_len) {
+            fprintf(stderr, "[WARN] %s: truncated record, stopping there\n", path);
+            break;
+        }
+        // Captures cut by a snaplen go out as captured
+        if (record.incl_len < 14 || record.incl_len > max_len) {
+            skipped++;
+            continue;
+        }
+        if (add_frame(set, &capacity, buffer, record.incl_len) != 0) {
+            result = -1;
+            break;
+        }
+    }
+    free(buffer);
+    fclose(file);
+
+    if (skipped) fprintf(stderr, "[WARN] %s: %zu frames skipped (shorter than 14 or longer than %u bytes)\n",
+                         path, skipped, max_len);
+    if (set->count == 0) {
+        fprintf(stderr, "[ERROR] %s: no frame to replay\n", path);
+        return -1;
+    }
+    return result;
+}
+
+// --- Socket ---
+
+static int open_socket(const char* iface, int qdisc_bypass) {
+    // Protocol 0: the socket only transmits, no frame is queued to it
+    int fd = socket(AF_PACKET, SOCK_RAW, 0);
+    if (fd < 0) {
+        perror("[ERROR] socket(AF_PACKET) failed (root required)");
+        return -1;
+    }
+
+    struct sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family = AF_PACKET;
+    addr.sll_ifindex = (int)if_nametoindex(iface);
+    if (addr.sll_ifindex == 0 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "[ERROR] Cannot bind to %s: %s\n", iface, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    if (qdisc_bypass) {
+        int one = 1;
+        if (setsockopt(fd, SOL_PACKET, PACKET_QDISC_BYPASS, &one, sizeof(one)) < 0) {
+            fprintf(stderr, "[WARN] PACKET_QDISC_BYPASS not applied: %s\n", strerror(errno));
+        }
+    }
+    return fd;
+}
+
+// --- PACKET_TX_RING ---
+
+static int setup_tx_ring(int fd, TxRing* ring) {
+    int version = TPACKET_V2;
+    if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) {
+        perror("[ERROR] PACKET_VERSION failed");
+        return -1;
+    }
+
+    struct tpacket_req req;
+    req.tp_block_size = TX_BLOCK_SIZE;
+    req.tp_frame_size = TX_FRAME_SIZE;
+    req.tp_frame_nr = TX_FRAME_NR;
+    req.tp_block_nr = TX_FRAME_NR / (TX_BLOCK_SIZE / TX_FRAME_SIZE);
+    if (setsockopt(fd, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req)) < 0) {
+        perror("[ERROR] PACKET_TX_RING failed");
+        return -1;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    ring->map_len = (size_t)req.tp_block_size * req.tp_block_nr;
+    ring->frame_nr = req.tp_frame_nr;
+    ring->map = (unsigned char*)mmap(NULL, ring->map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                     fd, 0);
+    if (ring->map == MAP_FAILED) {
+        perror("[ERROR] mmap of the TX ring failed");
+        ring->map = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static struct tpacket2_hdr* tx_slot(const TxRing* ring, unsigned int idx) {
+    return (struct tpacket2_hdr*)(ring->map + (size_t)idx * TX_FRAME_SIZE);
+}
+
+// Takes back the slots the kernel is done with, counting rejected frames
+static void reclaim_slots(TxRing* ring, TxCounters* counters) {
+    while (ring->in_flight > 0) {
+        struct tpacket2_hdr* hdr = tx_slot(ring, ring->reclaim);
+        uint32_t status = __atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE);
+        if (status & (TP_STATUS_SEND_REQUEST | TP_STATUS_SENDING)) break;
+        if (status & TP_STATUS_WRONG_FORMAT) {
+            counters->errors++;
+            counters->sent--;
+            counters->bytes -= hdr->tp_len;
+            __atomic_store_n(&hdr->tp_status, TP_STATUS_AVAILABLE, __ATOMIC_RELEASE);
+        }
+        ring->reclaim = (ring->reclaim + 1) % ring->frame_nr;
+        ring->in_flight--;
+    }
+}
+
+// Kernel transmits every slot marked TP_STATUS_SEND_REQUEST
+static int kick_ring(int fd) {
+    if (send(fd, NULL, 0, MSG_DONTWAIT) < 0 && errno != EAGAIN && errno != ENOBUFS && errno != EINTR) {
+        perror("[ERROR] send on the TX ring failed");
+        return -1;
+    }
+    return 0;
+}
+
+static int send_ring(int fd, TxRing* ring, FrameSet* frames, size_t* cursor, uint32_t want,
+                     TxCounters* counters) {
+    reclaim_slots(ring, counters);
+    uint32_t room = ring->frame_nr - ring->in_flight;
+    if (want > room) want = room;
+    if (want == 0) {
+        // Ring full: wait for the kernel to free slots
+        struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+        if (kick_ring(fd) != 0) return -1;
+        poll(&pfd, 1, 1);
+        return 0;
+    }
+
+    const unsigned int data_offset = TPACKET2_HDRLEN - sizeof(struct sockaddr_ll);
+    for (uint32_t i = 0; i < want; i++) {
+        Frame* frame = &frames->items[*cursor];
+        struct tpacket2_hdr* hdr = tx_slot(ring, ring->next);
+        memcpy((unsigned char*)hdr + data_offset, frame->data, frame->len);
+        if (frames->advance_seq) stamp_seq(frame, (unsigned char*)hdr + data_offset);
+        hdr->tp_len = frame->len;
+        __atomic_store_n(&hdr->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+
+        ring->next = (ring->next + 1) % ring->frame_nr;
+        ring->in_flight++;
+        counters->sent++;
+        counters->bytes += frame->len;
+        if (++*cursor == frames->count) *cursor = 0;
+    }
+    return kick_ring(fd) == 0 ? (int)want : -1;
+}
+
+// Waits for the frames still queued in the ring (a stop must not discard them)
+static void drain_ring(int fd, TxRing* ring, TxCounters* counters) {
+    uint64_t deadline = now_ns() + DRAIN_TIMEOUT_MS * 1000000ULL;
+    while (ring->in_flight > 0 && now_ns() < deadline) {
+        kick_ring(fd);
+        reclaim_slots(ring, counters);
+        if (ring->in_flight > 0) {
+            struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+            poll(&pfd, 1, 1);
+        }
+    }
+    if (ring->in_flight > 0) {
+        fprintf(stderr, "[WARN] %u frames still queued in the TX ring at exit\n", ring->in_flight);
+        counters->sent -= ring->in_flight;
+    }
+}
+
+// --- sendmmsg ---
+
+static int send_mmsg(int fd, FrameSet* frames, size_t* cursor, uint32_t want, TxCounters* counters) {
+    struct mmsghdr msgs[MAX_BATCH];
+    struct iovec iov[MAX_BATCH];
+    size_t start = *cursor;
+
+    // Sequence numbers are stamped into the frames themselves: one send per flow and batch
+    if (frames->advance_seq && want > frames->count) want = (uint32_t)frames->count;
+
+    memset(msgs, 0, want * sizeof(struct mmsghdr));
+    for (uint32_t i = 0; i < want; i++) {
+        Frame* frame = &frames->items[(start + i) % frames->count];
+        if (frames->advance_seq) stamp_seq(frame, frame->data);
+        iov[i].iov_base = frame->data;
+        iov[i].iov_len = frame->len;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int sent = sendmmsg(fd, msgs, want, 0);
+    if (sent < 0 && errno != ENOBUFS && errno != EAGAIN && errno != EINTR) {
+        perror("[ERROR] sendmmsg failed");
+        return -1;
+    }
+    if (sent < 0) sent = 0; // Full device queue: retried on the next round
+    if (frames->advance_seq) {
+        // Unsent frames keep their sequence numbers for the retry
+        for (uint32_t i = (uint32_t)sent; i < want; i++) {
+            Frame* frame = &frames->items[(start + i) % frames->count];
+            frame->seq -= frame->payload;
+        }
+    }
+    for (int i = 0; i < sent; i++) counters->bytes += msgs[i].msg_len;
+    counters->sent += (uint64_t)sent;
+    *cursor = (start + (size_t)sent) % frames->count;
+    return sent;
+}
+
+// --- Main ---
+
+int main(int argc, char** argv) {
+    const char* iface = NULL;
+    const char* pcap_path = NULL;
+    uint64_t pps = 0;
+    double seconds = 5.0;
+    uint64_t count = 0;
+    uint32_t size = MIN_FRAME;
+    uint32_t flows = 256;
+    int tcp = 0;
+    SendMethod method = SEND_RING;
+    uint32_t batch = 64;
+    int qdisc_bypass = 0;
+    int quiet = 0;
+
+    static const struct option long_options[] = {
+        {"iface",        required_argument, NULL, 'i'},
+        {"pps",          required_argument, NULL, 'p'},
+        {"seconds",      required_argument, NULL, 's'},
+        {"count",        required_argument, NULL, 'n'},
+        {"pcap",         required_argument, NULL, 'r'},
+        {"size",         required_argument, NULL, 'l'},
+        {"flows",        required_argument, NULL, 'f'},
+        {"proto",        required_argument, NULL, 1001},
+        {"method",       required_argument, NULL, 'm'},
+        {"batch",        required_argument, NULL, 'b'},
+        {"qdisc-bypass", no_argument,       NULL, 1002},
+        {"quiet",        no_argument,       NULL, 'q'},
+        {"help",         no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "i:p:s:n:r:l:f:m:b:qh", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'i':
+                iface = optarg;
+                break;
+            case 'p':
+                pps = strtoull(optarg, NULL, 10);
+                break;
+            case 's':
+                seconds = strtod(optarg, NULL);
+                break;
+            case 'n':
+                count = strtoull(optarg, NULL, 10);
+                break;
+            case 'r':
+                pcap_path = optarg;
+                break;
+            case 'l':
+                size = (uint32_t)atoi(optarg);
+                break;
+            case 'f':
+                flows = (uint32_t)atoi(optarg);
+                break;
+            case 1001:
+                if (strcmp(optarg, "tcp") == 0) {
+                    tcp = 1;
+                } else if (strcmp(optarg, "udp") != 0) {
+                    fprintf(stderr, "[ERROR] Unknown protocol '%s' (expected udp or tcp)\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'm':
+                if (strcmp(optarg, "ring") == 0) {
+                    method = SEND_RING;
+                } else if (strcmp(optarg, "mmsg") == 0) {
+                    method = SEND_MMSG;
+                } else {
+                    fprintf(stderr, "[ERROR] Unknown method '%s' (expected ring or mmsg)\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'b':
+                batch = (uint32_t)atoi(optarg);
+                break;
+            case 1002:
+                qdisc_bypass = 1;
+                break;
+            case 'q':
+                quiet = 1;
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (!iface || seconds <= 0 || size < MIN_FRAME || size > MAX_FRAME || flows == 0 ||
+        batch == 0 || batch > MAX_BATCH) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // --- Frames ---
+    FrameSet frames = { NULL, 0, 0 };
+    uint32_t max_len = method == SEND_RING ? TX_FRAME_SIZE - (TPACKET2_HDRLEN - sizeof(struct sockaddr_ll))
+                                           : 65535;
+    if (pcap_path ? load_pcap(&frames, pcap_path, max_len) != 0 : build_synthetic(&frames, flows, size, tcp) != 0) {
+        free_frames(&frames);
+        return 1;
+    }
+
+    int fd = open_socket(iface, qdisc_bypass);
+    if (fd < 0) {
+        free_frames(&frames);
+        return 1;
+    }
+    TxRing ring = { 0 };
+    if (method == SEND_RING && setup_tx_ring(fd, &ring) != 0) {
+        close(fd);
+        free_frames(&frames);
+        return 1;
+    }
+
+    signal(SIGINT, handle_signal);
+    signal(SIGTERM, handle_signal);
+
+    // --- Paced send loop ---
+    TxCounters counters = { 0, 0, 0 };
+    size_t cursor = 0;
+    const uint64_t start = now_ns();
+    const uint64_t end = start + (uint64_t)(seconds * 1e9);
+    uint64_t next_progress = start + 1000000000ULL;
+    uint64_t progress_sent = 0;
+    int failed = 0;
+
+    while (!stop && !failed) {
+        uint64_t now = now_ns();
+        if (now >= end || (count && counters.sent >= count)) break;
+
+        uint64_t want = batch;
+        if (pps) {
+            uint64_t due = (uint64_t)((double)(now - start) * (double)pps / 1e9) + 1;
+            want = due > counters.sent ? due - counters.sent : 0;
+            if (want == 0) {
+                // Ahead of schedule: sleep off longer gaps, spin through short ones
+                uint64_t next_due = start + (uint64_t)((double)counters.sent * 1e9 / (double)pps);
+                if (next_due > now + 100000) {
+                    struct timespec pause = { 0, (long)(next_due - now - 50000) };
+                    nanosleep(&pause, NULL);
+                }
+                continue;
+            }
+            if (want > batch) want = batch;
+        }
+        if (count && want > count - counters.sent) want = count - counters.sent;
+
+        int sent = method == SEND_RING ? send_ring(fd, &ring, &frames, &cursor, (uint32_t)want, &counters)
+                                       : send_mmsg(fd, &frames, &cursor, (uint32_t)want, &counters);
+        if (sent < 0) failed = 1;
+
+        if (!quiet && now >= next_progress) {
+            fprintf(stderr, "[INFO] %.0f s: %llu pps\n", (double)(now - start) / 1e9,
+                    (unsigned long long)(counters.sent - progress_sent));
+            progress_sent = counters.sent;
+            next_progress += 1000000000ULL;
+        }
+    }
+
+    if (method == SEND_RING) {
+        drain_ring(fd, &ring, &counters);
+        munmap(ring.map, ring.map_len);
+    }
+    double elapsed = (double)(now_ns() - start) / 1e9;
+    close(fd);
+
+    printf("{\"method\": \"%s\", \"source\": \"%s\", \"frames\": %zu, \"target_pps\": %llu, "
+           "\"sent\": %llu, \"bytes\": %llu, \"errors\": %llu, \"seconds\": %.3f, \"pps\": %.0f, \"mbps\": %.1f}\n",
+           method == SEND_RING ? "ring" : "mmsg", pcap_path ? pcap_path : (tcp ? "synthetic-tcp" : "synthetic-udp"),
+           frames.count, (unsigned long long)pps, (unsigned long long)counters.sent,
+           (unsigned long long)counters.bytes, (unsigned long long)counters.errors, elapsed,
+           elapsed > 0 ? (double)counters.sent / elapsed : 0.0,
+           elapsed > 0 ? (double)counters.bytes * 8.0 / elapsed / 1e6 : 0.0);
+
+    free_frames(&frames);
+    return failed ? 1 : 0;
+}